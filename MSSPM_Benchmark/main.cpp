@@ -0,0 +1,186 @@
+
+#include "nmfBenchmarkRunner.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QThread>
+
+#include <iostream>
+
+namespace {
+
+const std::vector<std::string> GrowthForms        = {"Linear","Logistic"};
+const std::vector<std::string> HarvestForms       = {"Null","Catch","Effort (qE)","Exploitation (F)"};
+const std::vector<std::string> CompetitionForms   = {"Null","NO_K","MS-PROD","AGG-PROD"};
+const std::vector<std::string> PredationForms     = {"Null","Type I","Type II","Type III"};
+const std::vector<std::string> ObjectiveCriteria  = {"Least Squares","Model Efficiency","Maximum Likelihood"};
+const std::vector<std::string> ScalingAlgorithms  = {"Min Max","Mean"};
+
+bool toIntList(const QString& Value,
+               std::vector<int>& List)
+{
+    bool ok;
+
+    List.clear();
+    for (const QString& item : Value.split(",",Qt::SkipEmptyParts)) {
+        List.push_back(item.trimmed().toInt(&ok));
+        if (! ok || (List.back() < 1)) {
+            return false;
+        }
+    }
+    return ! List.empty();
+}
+
+/**
+ * @brief Every combination of forms and objectives
+ */
+void loadAllCases(const nmfBenchmarkCase& Size,
+                  std::vector<nmfBenchmarkCase>& Cases)
+{
+    nmfBenchmarkCase aCase = Size;
+
+    for (const std::string& growthForm : GrowthForms) {
+        aCase.GrowthForm = growthForm;
+        for (const std::string& harvestForm : HarvestForms) {
+            aCase.HarvestForm = harvestForm;
+            for (const std::string& competitionForm : CompetitionForms) {
+                aCase.CompetitionForm = competitionForm;
+                for (const std::string& predationForm : PredationForms) {
+                    aCase.PredationForm = predationForm;
+                    for (const std::string& objectiveCriterion : ObjectiveCriteria) {
+                        aCase.ObjectiveCriterion = objectiveCriterion;
+                        for (const std::string& scalingAlgorithm : ScalingAlgorithms) {
+                            aCase.ScalingAlgorithm = scalingAlgorithm;
+                            Cases.push_back(aCase);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief A baseline model plus, for each form family and objective, the baseline with
+ * only that one changed, so every form and objective is covered without the full product
+ */
+void loadSweepCases(const nmfBenchmarkCase& Size,
+                    std::vector<nmfBenchmarkCase>& Cases)
+{
+    nmfBenchmarkCase baseline = Size;
+    nmfBenchmarkCase aCase;
+
+    baseline.GrowthForm         = "Logistic";
+    baseline.HarvestForm        = "Catch";
+    baseline.CompetitionForm    = "Null";
+    baseline.PredationForm      = "Null";
+    baseline.ObjectiveCriterion = "Least Squares";
+    baseline.ScalingAlgorithm   = "Min Max";
+    Cases.push_back(baseline);
+
+    for (const std::string& growthForm : GrowthForms) {
+        aCase = baseline;
+        aCase.GrowthForm = growthForm;
+        Cases.push_back(aCase);
+    }
+    for (const std::string& harvestForm : HarvestForms) {
+        aCase = baseline;
+        aCase.HarvestForm = harvestForm;
+        Cases.push_back(aCase);
+    }
+    for (const std::string& competitionForm : CompetitionForms) {
+        aCase = baseline;
+        aCase.CompetitionForm = competitionForm;
+        Cases.push_back(aCase);
+    }
+    for (const std::string& predationForm : PredationForms) {
+        aCase = baseline;
+        aCase.PredationForm = predationForm;
+        Cases.push_back(aCase);
+    }
+    for (const std::string& objectiveCriterion : ObjectiveCriteria) {
+        aCase = baseline;
+        aCase.ObjectiveCriterion = objectiveCriterion;
+        Cases.push_back(aCase);
+    }
+    for (const std::string& scalingAlgorithm : ScalingAlgorithms) {
+        aCase = baseline;
+        aCase.ScalingAlgorithm = scalingAlgorithm;
+        Cases.push_back(aCase);
+    }
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("msspm-benchmark");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+                "Times the MSSPM estimation hot path (objective functions, parameter extraction, "
+                "rescaling and model form evaluation) on synthetic models and reports ns/evaluation, "
+                "allocations/evaluation and evaluations/second/core.");
+    parser.addHelpOption();
+    QCommandLineOption speciesOption(  {"s","species"}, "Comma separated numbers of species.","list","2,10,50,200");
+    QCommandLineOption yearsOption(    {"y","years"},   "Comma separated run lengths in years.","list","10,50,150");
+    QCommandLineOption allOption(      "all",           "Run every combination of forms and objectives instead of "
+                                                        "changing one at a time from a Logistic/Catch baseline.");
+    QCommandLineOption connectanceOption("connectance", "Fraction of the possible species pairs that interact; "
+                                                        "below 0.5 the interactions are evaluated sparsely.","fraction","1.0");
+    QCommandLineOption filterOption(   {"f","filter"},  "Only run the benchmarks whose names contain this text.","text");
+    QCommandLineOption minTimeOption(  "min-time",      "Milliseconds spent timing each benchmark on each pass.","ms","100");
+    QCommandLineOption threadsOption(  {"t","threads"}, "Threads for the evaluations/second/core pass. "
+                                                        "Defaults to the number of cores.","count",
+                                                        QString::number(QThread::idealThreadCount()));
+    QCommandLineOption jsonOption(     {"j","json"},    "Also write the results to this JSON file.","file");
+    parser.addOptions({speciesOption,yearsOption,allOption,connectanceOption,filterOption,minTimeOption,threadsOption,jsonOption});
+    parser.process(app);
+
+    std::vector<int> numSpecies;
+    std::vector<int> runLengths;
+    int minTimeMs  = parser.value(minTimeOption).toInt();
+    int numThreads = parser.value(threadsOption).toInt();
+    bool isConnectance;
+    double connectance = parser.value(connectanceOption).toDouble(&isConnectance);
+    if (! toIntList(parser.value(speciesOption),numSpecies) ||
+        ! toIntList(parser.value(yearsOption),runLengths)   ||
+        (minTimeMs < 1) || (numThreads < 1)) {
+        std::cerr << "Error: Species, years, min-time and threads must be positive numbers.\n" << std::endl;
+        parser.showHelp(1);
+    }
+    if (! isConnectance || (connectance <= 0) || (connectance > 1)) {
+        std::cerr << "Error: Connectance must be greater than 0 and at most 1.\n" << std::endl;
+        parser.showHelp(1);
+    }
+
+    std::vector<nmfBenchmarkCase> cases;
+    for (int species : numSpecies) {
+        for (int years : runLengths) {
+            nmfBenchmarkCase size;
+            size.NumSpecies  = species;
+            size.RunLength   = years;
+            size.Connectance = connectance;
+            if (parser.isSet(allOption)) {
+                loadAllCases(size,cases);
+            } else {
+                loadSweepCases(size,cases);
+            }
+        }
+    }
+
+    nmfBenchmarkRunner runner(minTimeMs,numThreads,parser.value(filterOption).toStdString());
+    for (const nmfBenchmarkCase& aCase : cases) {
+        runner.run(aCase);
+    }
+
+    if (parser.isSet(jsonOption)) {
+        if (! runner.writeJson(parser.value(jsonOption).toStdString())) {
+            std::cerr << "Error: Couldn't write: " << parser.value(jsonOption).toStdString() << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,69 @@
+
+#include "nmfBenchmarkAllocations.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+// Constant initialized, so it's safe to use before main and from any thread
+thread_local long long t_NumAllocations = 0;
+
+void* allocate(std::size_t Size)
+{
+    ++t_NumAllocations;
+    if (void* ptr = std::malloc((Size == 0) ? 1 : Size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+}
+
+long long
+nmfBenchmarkAllocations::count()
+{
+    return t_NumAllocations;
+}
+
+void* operator new(std::size_t Size)
+{
+    return allocate(Size);
+}
+
+void* operator new[](std::size_t Size)
+{
+    return allocate(Size);
+}
+
+void* operator new(std::size_t Size, const std::nothrow_t&) noexcept
+{
+    ++t_NumAllocations;
+    return std::malloc((Size == 0) ? 1 : Size);
+}
+
+void* operator new[](std::size_t Size, const std::nothrow_t&) noexcept
+{
+    ++t_NumAllocations;
+    return std::malloc((Size == 0) ? 1 : Size);
+}
+
+void operator delete(void* Ptr) noexcept
+{
+    std::free(Ptr);
+}
+
+void operator delete[](void* Ptr) noexcept
+{
+    std::free(Ptr);
+}
+
+void operator delete(void* Ptr, std::size_t) noexcept
+{
+    std::free(Ptr);
+}
+
+void operator delete[](void* Ptr, std::size_t) noexcept
+{
+    std::free(Ptr);
+}
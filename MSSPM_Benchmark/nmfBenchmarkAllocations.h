@@ -0,0 +1,44 @@
+/**
+ * @file nmfBenchmarkAllocations.h
+ * @brief Definition for the heap allocation counter of MSSPM_Benchmark
+ *
+ * This file contains the definition for nmfBenchmarkAllocations. MSSPM_Benchmark
+ * replaces the global operator new so every heap allocation made by a thread,
+ * including those made inside the estimator and model libraries, is counted.
+ * The replacement only lives in the benchmark executable.
+ *
+ * @copyright
+ * Public Domain Notice\n
+ *
+ * National Oceanic And Atmospheric Administration\n\n
+ *
+ * This software is a "United States Government Work" under the terms of the
+ * United States Copyright Act.  It was written as part of the author's official
+ * duties as a United States Government employee/contractor and thus cannot be copyrighted.
+ * This software is freely available to the public for use. The National Oceanic
+ * And Atmospheric Administration and the U.S. Government have not placed any
+ * restriction on its use or reproduction.  Although all reasonable efforts have
+ * been taken to ensure the accuracy and reliability of the software and data,
+ * the National Oceanic And Atmospheric Administration and the U.S. Government
+ * do not and cannot warrant the performance or results that may be obtained
+ * by using this software or data. The National Oceanic And Atmospheric
+ * Administration and the U.S. Government disclaim all warranties, express
+ * or implied, including warranties of performance, merchantability or fitness
+ * for any particular purpose.\n\n
+ *
+ * Please cite the author(s) in any work or product based on this material.
+ */
+
+#pragma once
+
+/**
+ * @brief Counts the heap allocations made on the calling thread
+ */
+class nmfBenchmarkAllocations
+{
+public:
+    /**
+     * @brief Number of times operator new has been called on the calling thread
+     */
+    static long long count();
+};
@@ -0,0 +1,85 @@
+
+#include "nmfBenchmarkModel.h"
+#include "nmfSyntheticSystemGenerator.h"
+
+#include <algorithm>
+#include <cstdint>
+
+double
+nmfBenchmarkModel::getRandom(std::uint64_t& State,
+                             const double& Min,
+                             const double& Max)
+{
+    // SplitMix64, so every platform draws the same numbers
+    std::uint64_t z = (State += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z =  z ^ (z >> 31);
+
+    return Min + (Max-Min) * double(z >> 11) / 9007199254740992.0; // 2^53
+}
+
+int
+nmfBenchmarkModel::getNumGuilds(const int& NumSpecies)
+{
+    return std::max(1,(NumSpecies+4)/5);
+}
+
+bool
+nmfBenchmarkModel::build(const nmfBenchmarkCase& Case,
+                         nmfStructsQt::ModelDataStruct& dataStruct,
+                         std::string& ErrorMsg)
+{
+    nmfSyntheticSystemSettings settings;
+    nmfSyntheticSystem system;
+
+    // Interactions that together take about a tenth of a species' growth. The links
+    // missing at a Connectance below 1 get [0,0] ranges, as in a sparse food web. The seed only depends on the size, so every form combination of a size
+    // starts from the same draws.
+    settings.NumSpecies          = Case.NumSpecies;
+    settings.NumGuilds           = getNumGuilds(Case.NumSpecies);
+    settings.RunLength           = Case.RunLength;
+    settings.GrowthForm          = Case.GrowthForm;
+    settings.HarvestForm         = Case.HarvestForm;
+    settings.CompetitionForm     = Case.CompetitionForm;
+    settings.PredationForm       = Case.PredationForm;
+    settings.ObjectiveCriterion  = Case.ObjectiveCriterion;
+    settings.ScalingAlgorithm    = Case.ScalingAlgorithm;
+    settings.Connectance         = Case.Connectance;
+    settings.InteractionStrength = 0.1;
+    settings.Seed                = 1000003ULL*Case.NumSpecies + Case.RunLength;
+
+    if (! nmfSyntheticSystemGenerator::generate(settings,system,ErrorMsg)) {
+        return false;
+    }
+    dataStruct = system.dataStruct;
+
+    return true;
+}
+
+void
+nmfBenchmarkModel::loadCandidates(const std::vector<std::pair<double,double> >& ParameterRanges,
+                                  const int& NumCandidates,
+                                  std::vector<std::vector<double> >& Candidates)
+{
+    std::uint64_t state = ParameterRanges.size();
+    double lowerVal;
+    double upperVal;
+
+    Candidates.clear();
+    for (int candidate=0; candidate<NumCandidates; ++candidate) {
+        std::vector<double> parameters;
+        for (const std::pair<double,double>& range : ParameterRanges) {
+            lowerVal = range.first;
+            upperVal = range.second;
+            if (candidate == 0) {
+                parameters.push_back(lowerVal + (upperVal-lowerVal)/2.0);
+            } else {
+                // Stay within the middle half of the range so the biomass stays valid
+                parameters.push_back(getRandom(state,lowerVal + (upperVal-lowerVal)/4.0,
+                                                     upperVal - (upperVal-lowerVal)/4.0));
+            }
+        }
+        Candidates.push_back(parameters);
+    }
+}
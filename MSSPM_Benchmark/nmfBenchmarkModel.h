@@ -0,0 +1,94 @@
+/**
+ * @file nmfBenchmarkModel.h
+ * @brief Definition for the synthetic models timed by MSSPM_Benchmark
+ *
+ * This file contains the definition for nmfBenchmarkModel. It generates
+ * a system of any size and any form combination with
+ * nmfSyntheticSystemGenerator, so the estimation hot path can be timed on
+ * the same inputs from one release to the next. The random numbers come
+ * from a fixed seed and are scaled by hand (not with a std distribution,
+ * whose output differs between standard libraries).
+ *
+ * @copyright
+ * Public Domain Notice\n
+ *
+ * National Oceanic And Atmospheric Administration\n\n
+ *
+ * This software is a "United States Government Work" under the terms of the
+ * United States Copyright Act.  It was written as part of the author's official
+ * duties as a United States Government employee/contractor and thus cannot be copyrighted.
+ * This software is freely available to the public for use. The National Oceanic
+ * And Atmospheric Administration and the U.S. Government have not placed any
+ * restriction on its use or reproduction.  Although all reasonable efforts have
+ * been taken to ensure the accuracy and reliability of the software and data,
+ * the National Oceanic And Atmospheric Administration and the U.S. Government
+ * do not and cannot warrant the performance or results that may be obtained
+ * by using this software or data. The National Oceanic And Atmospheric
+ * Administration and the U.S. Government disclaim all warranties, express
+ * or implied, including warranties of performance, merchantability or fitness
+ * for any particular purpose.\n\n
+ *
+ * Please cite the author(s) in any work or product based on this material.
+ */
+
+#pragma once
+
+#include "nmfStructsQt.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Size, forms and objective of one benchmarked model
+ */
+struct nmfBenchmarkCase {
+    int NumSpecies;
+    int RunLength;
+    std::string GrowthForm;
+    std::string HarvestForm;
+    std::string CompetitionForm;
+    std::string PredationForm;
+    std::string ObjectiveCriterion;
+    std::string ScalingAlgorithm;
+    /**
+     * @brief Fraction of the possible species pairs that interact
+     */
+    double Connectance;
+};
+
+/**
+ * @brief Builds the synthetic models timed by MSSPM_Benchmark
+ */
+class nmfBenchmarkModel
+{
+    static double getRandom(std::uint64_t& State,
+                            const double& Min,
+                            const double& Max);
+
+public:
+    /**
+     * @brief Number of guilds given to a model with NumSpecies species (about 5 species per guild)
+     */
+    static int getNumGuilds(const int& NumSpecies);
+    /**
+     * @brief Generates a synthetic system for a case with nmfSyntheticSystemGenerator
+     * @param Case : size, forms and objective of the model
+     * @param dataStruct : the model, filled in the same way nmfCoreModelLoader does for a model in the database
+     * @param ErrorMsg : why the model couldn't be generated
+     * @return Returns false if no well-posed system was found
+     */
+    static bool build(const nmfBenchmarkCase& Case,
+                      nmfStructsQt::ModelDataStruct& dataStruct,
+                      std::string& ErrorMsg);
+    /**
+     * @brief Makes parameter vectors spread over the parameter ranges, always the same ones
+     * @param ParameterRanges : lower and upper bound of every model parameter
+     * @param NumCandidates : number of parameter vectors to make
+     * @param Candidates : the parameter vectors; the first is the middle of the ranges
+     */
+    static void loadCandidates(const std::vector<std::pair<double,double> >& ParameterRanges,
+                               const int& NumCandidates,
+                               std::vector<std::vector<double> >& Candidates);
+};
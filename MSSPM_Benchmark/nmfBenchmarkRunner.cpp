@@ -0,0 +1,566 @@
+
+#include "nmfBenchmarkRunner.h"
+#include "nmfBenchmarkAllocations.h"
+#include "nmfEstimationResult.h"
+#include "nmfSyntheticSystemGenerator.h"
+#include "nmfCancellationToken.h"
+#include "NLopt_Batch.h"
+#include "NLopt_Estimator.h"
+#include "BeesAlgorithm.h"
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFuture>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThreadPool>
+#include <QtConcurrent>
+
+#include <atomic>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+namespace {
+
+// Number of parameter vectors each objective function batch cycles through
+const int NumCandidates = 16;
+
+typedef std::shared_ptr<const nmfStructsQt::ModelDataStruct> ModelPtr;
+typedef std::shared_ptr<const nmfEstimationResult>           EstimatesPtr;
+
+/**
+ * @brief State of one thread's objective function batch. The sink is volatile
+ * so the compiler can't drop the evaluations whose results aren't used.
+ */
+struct ObjectiveState {
+    std::unique_ptr<nmfGrowthForm>      GrowthForm;
+    std::unique_ptr<nmfHarvestForm>     HarvestForm;
+    std::unique_ptr<nmfCompetitionForm> CompetitionForm;
+    std::unique_ptr<nmfPredationForm>   PredationForm;
+    NLopt_SubRun                        SubRun;
+    std::atomic<int>                    NumObjFcnCalls{0};
+    std::vector<std::vector<double> >   FreeCandidates;
+    volatile double                     Sink;
+};
+
+struct BeesState {
+    std::unique_ptr<BeesAlgorithm> BeesAlg;
+    volatile double                Sink;
+};
+
+struct FormState {
+    nmfGrowthForm      GrowthForm;
+    nmfHarvestForm     HarvestForm;
+    nmfCompetitionForm CompetitionForm;
+    nmfPredationForm   PredationForm;
+    volatile double    Sink;
+
+    FormState(const nmfStructsQt::ModelDataStruct& dataStruct) :
+        GrowthForm(     dataStruct.GrowthForm),
+        HarvestForm(    dataStruct.HarvestForm),
+        CompetitionForm(dataStruct.CompetitionForm),
+        PredationForm(  dataStruct.PredationForm),
+        Sink(0) {}
+};
+
+void extractEstimates(const nmfStructsQt::ModelDataStruct& dataStruct,
+                      const std::vector<double>& Parameters,
+                      nmfEstimationResult& Estimates)
+{
+    NLopt_Estimator::extractParameters(dataStruct,Parameters.data(),
+                                       Estimates.EstInitBiomass,
+                                       Estimates.EstGrowthRates,
+                                       Estimates.EstCarryingCapacities,
+                                       Estimates.EstCatchability,
+                                       Estimates.EstCompetitionAlpha,
+                                       Estimates.EstCompetitionBetaSpecies,
+                                       Estimates.EstCompetitionBetaGuilds,
+                                       Estimates.EstCompetitionBetaGuildsGuilds,
+                                       Estimates.EstPredationRho,
+                                       Estimates.EstPredationHandling,
+                                       Estimates.EstPredationExponent,
+                                       Estimates.EstSurveyQ);
+}
+
+/**
+ * @brief Sets up the sub-run the way NLopt_Estimator::runSubRun does
+ */
+void initializeObjectiveState(const nmfStructsQt::ModelDataStruct& dataStruct,
+                              const std::vector<std::vector<double> >& Candidates,
+                              const std::vector<std::pair<double,double> >& ParameterRanges,
+                              ObjectiveState& State)
+{
+    NLopt_SubRun& subRun = State.SubRun;
+
+    State.GrowthForm      = std::make_unique<nmfGrowthForm>(     dataStruct.GrowthForm);
+    State.HarvestForm     = std::make_unique<nmfHarvestForm>(    dataStruct.HarvestForm);
+    State.CompetitionForm = std::make_unique<nmfCompetitionForm>(dataStruct.CompetitionForm);
+    State.PredationForm   = std::make_unique<nmfPredationForm>(  dataStruct.PredationForm);
+    NLopt_Estimator::initializeEvaluationContext(dataStruct,0,
+                                                 State.GrowthForm.get(),State.HarvestForm.get(),
+                                                 State.CompetitionForm.get(),State.PredationForm.get(),
+                                                 subRun.Context);
+    subRun.Mapping.initialize(ParameterRanges);
+    subRun.Context.Layout.initializePatterns(ParameterRanges);
+    NLopt_Estimator::verifyKernels(subRun.Context,Candidates[0]);
+    subRun.NumEvaluations = 0;
+    subRun.NumObjFcnCalls = &State.NumObjFcnCalls;
+    subRun.Cancellation   = std::make_shared<nmfCancellationToken>();
+    for (const std::vector<double>& candidate : Candidates) {
+        std::vector<double> freeParameters;
+        subRun.Mapping.pack(candidate,freeParameters);
+        State.FreeCandidates.push_back(freeParameters);
+    }
+}
+
+/**
+ * @brief Heap allocations made sizing a new workspace for a verified sub-run. The
+ * model form parameter copies are only allocated if the sub-run still needs them.
+ */
+long long countWorkspaceAllocations(const nmfStructsQt::ModelDataStruct& dataStruct,
+                                    const std::vector<std::vector<double> >& Candidates,
+                                    const std::vector<std::pair<double,double> >& ParameterRanges)
+{
+    long long numAllocations;
+    ObjectiveState state;
+    NLopt_Workspace workspace;
+
+    initializeObjectiveState(dataStruct,Candidates,ParameterRanges,state);
+    numAllocations = nmfBenchmarkAllocations::count();
+    workspace.prepare(state.SubRun.Context);
+
+    return nmfBenchmarkAllocations::count() - numAllocations;
+}
+
+}
+
+nmfBenchmarkRunner::nmfBenchmarkRunner(const int& MinTimeMs,
+                                       const int& NumThreads,
+                                       const std::string& Filter)
+{
+    m_MinTimeMs  = MinTimeMs;
+    m_NumThreads = NumThreads;
+    m_Filter     = Filter;
+}
+
+bool
+nmfBenchmarkRunner::isWanted(const std::string& Benchmark,
+                             const std::string& Key)
+{
+    if (! m_Filter.empty() && (Benchmark.find(m_Filter) == std::string::npos)) {
+        return false;
+    }
+
+    // Only run a benchmark once for the parts of the model it depends on
+    return m_Done.insert(Benchmark + "|" + Key).second;
+}
+
+void
+nmfBenchmarkRunner::run(const nmfBenchmarkCase& Case)
+{
+    nmfStructsQt::ModelDataStruct dataStruct;
+    std::vector<std::pair<double,double> > parameterRanges;
+    std::vector<std::vector<double> > candidates;
+    std::shared_ptr<nmfEstimationResult> estimates = std::make_shared<nmfEstimationResult>();
+    std::string errorMsg;
+
+    if (! nmfBenchmarkModel::build(Case,dataStruct,errorMsg)) {
+        std::cerr << errorMsg << std::endl;
+        return;
+    }
+    NLopt_Estimator::loadParameterRanges(parameterRanges,dataStruct);
+    nmfBenchmarkModel::loadCandidates(parameterRanges,NumCandidates,candidates);
+    extractEstimates(dataStruct,candidates[0],*estimates);
+
+    const int NumParameters = int(parameterRanges.size());
+    const bool isAggProd    = (Case.CompetitionForm == "AGG-PROD");
+    const int NumSpeciesOrGuilds = (isAggProd) ? dataStruct.NumGuilds : dataStruct.NumSpecies;
+    const std::string sizeKey  = std::to_string(Case.NumSpecies) + "x" + std::to_string(Case.RunLength) +
+                                 "@" + std::to_string(Case.Connectance);
+    const std::string formsKey = sizeKey  + "|" + Case.GrowthForm + "|" + Case.HarvestForm + "|" +
+                                 Case.CompetitionForm + "|" + Case.PredationForm;
+    const std::string caseKey  = formsKey + "|" + Case.ObjectiveCriterion + "|" + Case.ScalingAlgorithm;
+    ModelPtr model = std::make_shared<const nmfStructsQt::ModelDataStruct>(dataStruct);
+    std::shared_ptr<const std::vector<std::vector<double> > > parameters =
+            std::make_shared<const std::vector<std::vector<double> > >(candidates);
+
+    // The biomass the form evaluate calls are given, and the carrying capacities around each species
+    std::shared_ptr<const boost::numeric::ublas::matrix<double> > biomass =
+            std::make_shared<const boost::numeric::ublas::matrix<double> >(
+                (isAggProd) ? dataStruct.ObservedBiomassByGuilds : dataStruct.ObservedBiomassBySpecies);
+    double systemK = 0;
+    std::shared_ptr<std::vector<double> > guildK = std::make_shared<std::vector<double> >(NumSpeciesOrGuilds,0.0);
+    for (int i=0; i<NumSpeciesOrGuilds; ++i) {
+        systemK += estimates->EstCarryingCapacities[i];
+        for (int species : dataStruct.GuildSpecies[dataStruct.GuildNum[i]]) {
+            (*guildK)[i] += estimates->EstCarryingCapacities[species];
+        }
+    }
+
+    if (isWanted("NLopt_Estimator::objectiveFunction",caseKey)) {
+        measure("NLopt_Estimator::objectiveFunction",Case,dataStruct,NumParameters,
+                [model,parameters,parameterRanges]() -> nmfBenchmarkBatch {
+            std::shared_ptr<ObjectiveState> state = std::make_shared<ObjectiveState>();
+            initializeObjectiveState(*model,*parameters,parameterRanges,*state);
+            return [state]() -> long long {
+                double sum = 0;
+                for (const std::vector<double>& freeParameters : state->FreeCandidates) {
+                    sum += NLopt_Estimator::objectiveFunction(unsigned(freeParameters.size()),freeParameters.data(),
+                                                              nullptr,&state->SubRun);
+                }
+                state->Sink = sum;
+                return (long long)state->FreeCandidates.size();
+            };
+        },countWorkspaceAllocations(*model,*parameters,parameterRanges));
+    }
+
+    if (isWanted("BeesAlgorithm::evaluateObjectiveFunction",caseKey)) {
+        measure("BeesAlgorithm::evaluateObjectiveFunction",Case,dataStruct,NumParameters,
+                [model,parameters]() -> nmfBenchmarkBatch {
+            std::shared_ptr<BeesState> state = std::make_shared<BeesState>();
+            state->BeesAlg = std::make_unique<BeesAlgorithm>(*model,nmfConstantsMSSPM::VerboseOff);
+            return [state,parameters]() -> long long {
+                double sum = 0;
+                for (const std::vector<double>& candidate : *parameters) {
+                    sum += state->BeesAlg->evaluateObjectiveFunction(candidate);
+                }
+                state->Sink = sum;
+                return (long long)parameters->size();
+            };
+        });
+    }
+
+    // A bee's fitness when Bees_Estimator runs Bees_Engine, which calls this once per scout and forager
+    if (isWanted("NLopt_Estimator::evaluateObjective",caseKey)) {
+        measure("NLopt_Estimator::evaluateObjective",Case,dataStruct,NumParameters,
+                [model,parameters,parameterRanges]() -> nmfBenchmarkBatch {
+            std::shared_ptr<ObjectiveState> state = std::make_shared<ObjectiveState>();
+            initializeObjectiveState(*model,*parameters,parameterRanges,*state);
+            return [state,parameters]() -> long long {
+                double sum = 0;
+                for (const std::vector<double>& candidate : *parameters) {
+                    sum += NLopt_Estimator::evaluateObjective(state->SubRun.Context,candidate.data());
+                }
+                state->Sink = sum;
+                return (long long)parameters->size();
+            };
+        });
+    }
+
+    // The same candidates evaluated in lock-step, to compare with NLopt_Estimator::evaluateObjective
+    if (isWanted("NLopt_Batch::evaluate",caseKey)) {
+        measure("NLopt_Batch::evaluate",Case,dataStruct,NumParameters,
+                [model,parameters,parameterRanges,NumParameters]() -> nmfBenchmarkBatch {
+            const int numCandidates = int(parameters->size());
+            std::shared_ptr<ObjectiveState> state = std::make_shared<ObjectiveState>();
+            std::shared_ptr<std::vector<double> > candidates = std::make_shared<std::vector<double> >(NumParameters*numCandidates);
+            std::shared_ptr<std::vector<double> > fitness    = std::make_shared<std::vector<double> >(numCandidates);
+            initializeObjectiveState(*model,*parameters,parameterRanges,*state);
+            for (int k=0; k<numCandidates; ++k) {
+                for (int p=0; p<NumParameters; ++p) {
+                    (*candidates)[p*numCandidates+k] = (*parameters)[k][p];
+                }
+            }
+            return [state,candidates,fitness,NumParameters,numCandidates]() -> long long {
+                double sum = 0;
+                NLopt_Batch::evaluate(state->SubRun.Context,candidates->data(),NumParameters,numCandidates,fitness->data());
+                for (const double& value : *fitness) {
+                    sum += value;
+                }
+                state->Sink = sum;
+                return (long long)numCandidates;
+            };
+        });
+    }
+
+    if (isWanted("NLopt_Estimator::extractParameters",formsKey)) {
+        measure("NLopt_Estimator::extractParameters",Case,dataStruct,NumParameters,
+                [model,parameters]() -> nmfBenchmarkBatch {
+            std::shared_ptr<nmfEstimationResult> extracted = std::make_shared<nmfEstimationResult>();
+            return [model,parameters,extracted]() -> long long {
+                for (const std::vector<double>& candidate : *parameters) {
+                    extractEstimates(*model,candidate,*extracted);
+                }
+                return (long long)parameters->size();
+            };
+        });
+    }
+
+    if (isWanted("NLopt_Estimator::rescaleMinMax",sizeKey)) {
+        measure("NLopt_Estimator::rescaleMinMax",Case,dataStruct,NumParameters,
+                [biomass]() -> nmfBenchmarkBatch {
+            std::shared_ptr<boost::numeric::ublas::matrix<double> > rescaled =
+                    std::make_shared<boost::numeric::ublas::matrix<double> >(biomass->size1(),biomass->size2());
+            return [biomass,rescaled]() -> long long {
+                for (int i=0; i<NumCandidates; ++i) {
+                    NLopt_Estimator::rescaleMinMax(*biomass,*rescaled);
+                }
+                return NumCandidates;
+            };
+        });
+    }
+
+    if (isWanted("NLopt_Estimator::rescaleMean",sizeKey)) {
+        measure("NLopt_Estimator::rescaleMean",Case,dataStruct,NumParameters,
+                [biomass]() -> nmfBenchmarkBatch {
+            std::shared_ptr<boost::numeric::ublas::matrix<double> > rescaled =
+                    std::make_shared<boost::numeric::ublas::matrix<double> >(biomass->size1(),biomass->size2());
+            return [biomass,rescaled]() -> long long {
+                for (int i=0; i<NumCandidates; ++i) {
+                    NLopt_Estimator::rescaleMean(*biomass,*rescaled);
+                }
+                return NumCandidates;
+            };
+        });
+    }
+
+    // Each form evaluate batch is one pass over every species and year of the observed biomass
+    const int RunLength = Case.RunLength;
+    const long long NumFormEvaluations = (long long)RunLength*NumSpeciesOrGuilds;
+    EstimatesPtr est = estimates;
+
+    if (isWanted("nmfGrowthForm::evaluate",sizeKey + "|" + Case.GrowthForm)) {
+        measure("nmfGrowthForm::evaluate",Case,dataStruct,NumParameters,
+                [model,est,biomass,RunLength,NumSpeciesOrGuilds,NumFormEvaluations]() -> nmfBenchmarkBatch {
+            std::shared_ptr<FormState> state = std::make_shared<FormState>(*model);
+            return [state,est,biomass,RunLength,NumSpeciesOrGuilds,NumFormEvaluations]() -> long long {
+                double sum = 0;
+                for (int time=0; time<RunLength; ++time) {
+                    for (int species=0; species<NumSpeciesOrGuilds; ++species) {
+                        sum += state->GrowthForm.evaluate(species,(*biomass)(time,species),
+                                                          est->EstGrowthRates,est->EstCarryingCapacities);
+                    }
+                }
+                state->Sink = sum;
+                return NumFormEvaluations;
+            };
+        });
+    }
+
+    if (isWanted("nmfHarvestForm::evaluate",sizeKey + "|" + Case.HarvestForm)) {
+        measure("nmfHarvestForm::evaluate",Case,dataStruct,NumParameters,
+                [model,est,biomass,RunLength,NumSpeciesOrGuilds,NumFormEvaluations]() -> nmfBenchmarkBatch {
+            std::shared_ptr<FormState> state = std::make_shared<FormState>(*model);
+            return [state,model,est,biomass,RunLength,NumSpeciesOrGuilds,NumFormEvaluations]() -> long long {
+                double sum = 0;
+                for (int time=0; time<RunLength; ++time) {
+                    for (int species=0; species<NumSpeciesOrGuilds; ++species) {
+                        sum += state->HarvestForm.evaluate(time,species,
+                                                           model->Catch,model->Effort,model->Exploitation,
+                                                           (*biomass)(time,species),est->EstCatchability);
+                    }
+                }
+                state->Sink = sum;
+                return NumFormEvaluations;
+            };
+        });
+    }
+
+    if (isWanted("nmfCompetitionForm::evaluate",sizeKey + "|" + Case.CompetitionForm)) {
+        measure("nmfCompetitionForm::evaluate",Case,dataStruct,NumParameters,
+                [model,est,biomass,guildK,systemK,RunLength,NumSpeciesOrGuilds,NumFormEvaluations]() -> nmfBenchmarkBatch {
+            std::shared_ptr<FormState> state = std::make_shared<FormState>(*model);
+            return [state,model,est,biomass,guildK,systemK,RunLength,NumSpeciesOrGuilds,NumFormEvaluations]() -> long long {
+                double sum = 0;
+                for (int time=0; time<RunLength; ++time) {
+                    for (int species=0; species<NumSpeciesOrGuilds; ++species) {
+                        sum += state->CompetitionForm.evaluate(time,species,(*biomass)(time,species),
+                                                               systemK,est->EstGrowthRates,(*guildK)[species],
+                                                               est->EstCompetitionAlpha,
+                                                               est->EstCompetitionBetaSpecies,
+                                                               est->EstCompetitionBetaGuilds,
+                                                               est->EstCompetitionBetaGuildsGuilds,
+                                                               *biomass,model->ObservedBiomassByGuilds);
+                    }
+                }
+                state->Sink = sum;
+                return NumFormEvaluations;
+            };
+        });
+    }
+
+    if (isWanted("nmfPredationForm::evaluate",sizeKey + "|" + Case.PredationForm)) {
+        measure("nmfPredationForm::evaluate",Case,dataStruct,NumParameters,
+                [model,est,biomass,RunLength,NumSpeciesOrGuilds,NumFormEvaluations]() -> nmfBenchmarkBatch {
+            std::shared_ptr<FormState> state = std::make_shared<FormState>(*model);
+            return [state,est,biomass,RunLength,NumSpeciesOrGuilds,NumFormEvaluations]() -> long long {
+                double sum = 0;
+                for (int time=0; time<RunLength; ++time) {
+                    for (int species=0; species<NumSpeciesOrGuilds; ++species) {
+                        sum += state->PredationForm.evaluate(time,species,
+                                                             est->EstPredationRho,est->EstPredationHandling,
+                                                             est->EstPredationExponent,
+                                                             *biomass,(*biomass)(time,species));
+                    }
+                }
+                state->Sink = sum;
+                return NumFormEvaluations;
+            };
+        });
+    }
+}
+
+void
+nmfBenchmarkRunner::measure(const std::string& Benchmark,
+                            const nmfBenchmarkCase& Case,
+                            const nmfStructsQt::ModelDataStruct& dataStruct,
+                            const int& NumParameters,
+                            const nmfBenchmarkFactory& MakeBatch,
+                            const long long& WorkspaceAllocations)
+{
+    long long numEvaluations = 0;
+    long long numAllocations;
+    long long elapsedNs;
+    const long long minTimeNs = 1000000LL*m_MinTimeMs;
+    nmfBenchmarkResult result;
+    QElapsedTimer timer;
+    nmfBenchmarkBatch batch = MakeBatch();
+
+    // The first batch sizes the thread local workspaces, so it isn't timed
+    batch();
+
+    numAllocations = nmfBenchmarkAllocations::count();
+    timer.start();
+    do {
+        numEvaluations += batch();
+        elapsedNs = timer.nsecsElapsed();
+    } while (elapsedNs < minTimeNs);
+    numAllocations = nmfBenchmarkAllocations::count() - numAllocations;
+
+    result.Benchmark                = Benchmark;
+    result.Case                     = Case;
+    result.NumGuilds                = dataStruct.NumGuilds;
+    result.NumParameters            = NumParameters;
+    result.NumEvaluations           = numEvaluations;
+    result.NsPerEvaluation          = double(elapsedNs)/numEvaluations;
+    result.AllocationsPerEvaluation = double(numAllocations)/numEvaluations;
+    result.WorkspaceAllocations     = WorkspaceAllocations;
+    if (m_NumThreads > 1) {
+        result.EvaluationsPerSecondPerCore = measureThroughput(MakeBatch)/m_NumThreads;
+    } else {
+        result.EvaluationsPerSecondPerCore = 1.0e9/result.NsPerEvaluation;
+    }
+
+    m_Results.push_back(result);
+    printResult(result);
+}
+
+double
+nmfBenchmarkRunner::measureThroughput(const nmfBenchmarkFactory& MakeBatch)
+{
+    double evaluationsPerSecond = 0;
+    const long long minTimeNs = 1000000LL*m_MinTimeMs;
+    std::atomic<int>  numReady(0);
+    std::atomic<bool> isStarted(false);
+    std::vector<QFuture<double> > futures;
+    QThreadPool threadPool;
+
+    threadPool.setMaxThreadCount(m_NumThreads);
+    for (int thread=0; thread<m_NumThreads; ++thread) {
+        futures.push_back(QtConcurrent::run(&threadPool,[&]() -> double {
+            long long numEvaluations = 0;
+            long long elapsedNs;
+            QElapsedTimer timer;
+            nmfBenchmarkBatch batch = MakeBatch();
+            batch();
+
+            // Start every thread together so they compete for the machine the whole time
+            ++numReady;
+            while (! isStarted) {
+                std::this_thread::yield();
+            }
+            timer.start();
+            do {
+                numEvaluations += batch();
+                elapsedNs = timer.nsecsElapsed();
+            } while (elapsedNs < minTimeNs);
+
+            return 1.0e9*numEvaluations/elapsedNs;
+        }));
+    }
+    while (numReady < m_NumThreads) {
+        std::this_thread::yield();
+    }
+    isStarted = true;
+
+    for (QFuture<double>& future : futures) {
+        evaluationsPerSecond += future.result();
+    }
+
+    return evaluationsPerSecond;
+}
+
+void
+nmfBenchmarkRunner::printResult(const nmfBenchmarkResult& Result)
+{
+    const nmfBenchmarkCase& Case = Result.Case;
+
+    std::cout << std::left  << std::setw(42) << Result.Benchmark
+              << std::right << std::setw(4)  << Case.NumSpecies
+              << std::setw(5) << Case.RunLength << "  "
+              << std::left  << std::setw(60)
+              << (Case.GrowthForm + "/" + Case.HarvestForm + "/" + Case.CompetitionForm + "/" +
+                  Case.PredationForm + "/" + Case.ObjectiveCriterion + "/" + Case.ScalingAlgorithm)
+              << std::right << std::fixed
+              << std::setw(14) << std::setprecision(1) << Result.NsPerEvaluation << " ns"
+              << std::setw(10) << std::setprecision(2) << Result.AllocationsPerEvaluation << " allocs"
+              << std::setw(14) << std::setprecision(0) << Result.EvaluationsPerSecondPerCore << " evals/s/core";
+    if (Result.WorkspaceAllocations >= 0) {
+        std::cout << std::setw(6) << Result.WorkspaceAllocations << " workspace allocs";
+    }
+    std::cout << std::endl;
+}
+
+const std::vector<nmfBenchmarkResult>&
+nmfBenchmarkRunner::getResults() const
+{
+    return m_Results;
+}
+
+bool
+nmfBenchmarkRunner::writeJson(const std::string& Filename) const
+{
+    QJsonObject root;
+    QJsonArray  results;
+    QFile file(QString::fromStdString(Filename));
+
+    for (const nmfBenchmarkResult& result : m_Results) {
+        QJsonObject item;
+        item["benchmark"]                  = QString::fromStdString(result.Benchmark);
+        item["species"]                    = result.Case.NumSpecies;
+        item["guilds"]                     = result.NumGuilds;
+        item["years"]                      = result.Case.RunLength;
+        item["connectance"]                = result.Case.Connectance;
+        item["parameters"]                 = result.NumParameters;
+        item["growth_form"]                = QString::fromStdString(result.Case.GrowthForm);
+        item["harvest_form"]               = QString::fromStdString(result.Case.HarvestForm);
+        item["competition_form"]           = QString::fromStdString(result.Case.CompetitionForm);
+        item["predation_form"]             = QString::fromStdString(result.Case.PredationForm);
+        item["objective_criterion"]        = QString::fromStdString(result.Case.ObjectiveCriterion);
+        item["scaling"]                    = QString::fromStdString(result.Case.ScalingAlgorithm);
+        item["evaluations"]                = double(result.NumEvaluations);
+        item["ns_per_evaluation"]          = result.NsPerEvaluation;
+        item["allocations_per_evaluation"] = result.AllocationsPerEvaluation;
+        item["evals_per_second_per_core"]  = result.EvaluationsPerSecondPerCore;
+        if (result.WorkspaceAllocations >= 0) {
+            item["workspace_allocations"]  = double(result.WorkspaceAllocations);
+        }
+        results.append(item);
+    }
+    root["date"]        = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    root["qt_version"]  = QString(qVersion());
+    root["min_time_ms"] = m_MinTimeMs;
+    root["threads"]     = m_NumThreads;
+    root["results"]     = results;
+
+    if (! file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson());
+
+    return true;
+}
@@ -0,0 +1,118 @@
+/**
+ * @file nmfBenchmarkRunner.h
+ * @brief Definition for the timing loop of MSSPM_Benchmark
+ *
+ * This file contains the definition for nmfBenchmarkRunner. For each synthetic
+ * model the runner times the NLopt objective function, the Bees objective
+ * function, parameter extraction, biomass rescaling and the model form
+ * evaluate calls. Each benchmark is run on one thread for the time per
+ * evaluation and the allocations per evaluation, then on every thread at
+ * once for the evaluations per second per core, which shows how well the
+ * hot path scales when sub-runs share the machine.
+ *
+ * @copyright
+ * Public Domain Notice\n
+ *
+ * National Oceanic And Atmospheric Administration\n\n
+ *
+ * This software is a "United States Government Work" under the terms of the
+ * United States Copyright Act.  It was written as part of the author's official
+ * duties as a United States Government employee/contractor and thus cannot be copyrighted.
+ * This software is freely available to the public for use. The National Oceanic
+ * And Atmospheric Administration and the U.S. Government have not placed any
+ * restriction on its use or reproduction.  Although all reasonable efforts have
+ * been taken to ensure the accuracy and reliability of the software and data,
+ * the National Oceanic And Atmospheric Administration and the U.S. Government
+ * do not and cannot warrant the performance or results that may be obtained
+ * by using this software or data. The National Oceanic And Atmospheric
+ * Administration and the U.S. Government disclaim all warranties, express
+ * or implied, including warranties of performance, merchantability or fitness
+ * for any particular purpose.\n\n
+ *
+ * Please cite the author(s) in any work or product based on this material.
+ */
+
+#pragma once
+
+#include "nmfBenchmarkModel.h"
+
+#include <functional>
+#include <set>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Timing of one benchmark on one model
+ */
+struct nmfBenchmarkResult {
+    std::string      Benchmark;
+    nmfBenchmarkCase Case;
+    int              NumGuilds;
+    int              NumParameters;
+    long long        NumEvaluations;
+    double           NsPerEvaluation;
+    double           AllocationsPerEvaluation;
+    double           EvaluationsPerSecondPerCore;
+    long long        WorkspaceAllocations; // -1 if the benchmark doesn't use an NLopt_Workspace
+};
+
+/**
+ * @brief Runs a batch of evaluations and returns how many it ran
+ */
+typedef std::function<long long()> nmfBenchmarkBatch;
+/**
+ * @brief Makes a batch with state of its own, so batches may run on several threads at once
+ */
+typedef std::function<nmfBenchmarkBatch()> nmfBenchmarkFactory;
+
+/**
+ * @brief Times the estimation hot path on synthetic models
+ */
+class nmfBenchmarkRunner
+{
+    int                   m_MinTimeMs;
+    int                   m_NumThreads;
+    std::string           m_Filter;
+    std::set<std::string> m_Done;
+    std::vector<nmfBenchmarkResult> m_Results;
+
+    bool isWanted(const std::string& Benchmark,
+                  const std::string& Key);
+    void measure(const std::string& Benchmark,
+                 const nmfBenchmarkCase& Case,
+                 const nmfStructsQt::ModelDataStruct& dataStruct,
+                 const int& NumParameters,
+                 const nmfBenchmarkFactory& MakeBatch,
+                 const long long& WorkspaceAllocations = -1);
+    double measureThroughput(const nmfBenchmarkFactory& MakeBatch);
+    void printResult(const nmfBenchmarkResult& Result);
+
+public:
+    /**
+     * @brief Class constructor
+     * @param MinTimeMs : minimum time spent timing each benchmark on each pass
+     * @param NumThreads : number of threads for the evaluations per second per core pass
+     * @param Filter : only run the benchmarks whose names contain this; empty to run them all
+     */
+    nmfBenchmarkRunner(const int& MinTimeMs,
+                       const int& NumThreads,
+                       const std::string& Filter);
+    virtual ~nmfBenchmarkRunner() {}
+
+    /**
+     * @brief Runs every benchmark on a model. Benchmarks that don't depend on all of the
+     * model's forms (e.g., a growth form's evaluate) are only run once per model size and form.
+     * @param Case : the model to run the benchmarks on
+     */
+    void run(const nmfBenchmarkCase& Case);
+    /**
+     * @brief The results of every benchmark run so far
+     */
+    const std::vector<nmfBenchmarkResult>& getResults() const;
+    /**
+     * @brief Writes the results to a JSON file so they can be compared between releases
+     * @param Filename : name of the JSON file
+     * @return Returns false if the file couldn't be written
+     */
+    bool writeJson(const std::string& Filename) const;
+};
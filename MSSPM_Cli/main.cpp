@@ -0,0 +1,176 @@
+
+#include "nmfCliRunner.h"
+#include "nmfInstrumentation.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+
+#include <csignal>
+#include <iostream>
+
+namespace {
+
+nmfCliRunner* g_Runner = nullptr;
+
+void stopRun(int)
+{
+    if (g_Runner) {
+        g_Runner->cancel();
+    }
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("msspm-cli");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+                "Runs an MSSPM parameter estimation without the GUI and writes the estimated "
+                "parameters and biomass of every run to CSV files.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("project","MSSPM project file (.prj)");
+    QCommandLineOption modelOption(      {"m","model"},    "Name of the model to estimate (required).","name");
+    QCommandLineOption hostOption(       "host",           "Database host.","host","localhost");
+    QCommandLineOption userOption(       "user",           "Database user.","user","root");
+    QCommandLineOption passwordOption(   "password",       "Database password. Defaults to $MSSPM_DB_PASSWORD.","password");
+    QCommandLineOption algorithmOption(  {"a","algorithm"},"Bees or NLopt. Defaults to the model's saved algorithm.","algorithm");
+    QCommandLineOption ensembleOption(   {"e","ensemble"}, "Multi-run (ensemble) file to run. Its lines may use NLopt or the Bees Algorithm. "
+                                                           "Relative paths are relative to the project's outputData directory.","file");
+    QCommandLineOption estimateOption(   "estimate",       "Comma separated parameters to estimate. Defaults to all of them.","list");
+    QCommandLineOption deterministicOption("deterministic","Use fixed seeds so runs are repeatable.");
+    QCommandLineOption timeoutOption(    "timeout",        "Stop the run after this many seconds.","seconds","0");
+    QCommandLineOption outputOption(     {"o","output"},   "Output directory. Defaults to the project's outputData directory.","dir");
+    QCommandLineOption mohnsRhoOption(   "mohns-rho",      "Instead of estimating the model once, run a retrospective analysis with this "
+                                                           "many peels and write Mohn's Rho to <model>_MohnsRho.csv.","peels");
+    QCommandLineOption forecastOption(   "forecast",       "After estimating, run this forecast from each run's estimates and write "
+                                                           "<model>_Forecast_<forecast>.csv.","forecast");
+    QCommandLineOption bundleOption(     "bundle",         "Before running, load this database file (as written by File > Export Database) "
+                                                           "into the project's database, replacing the tables it contains.","file");
+    QCommandLineOption diagnosticOption( "diagnostic",     "After estimating, vary each species' initial biomass, growth rate, carrying capacity, "
+                                                           "catchability and survey Q by up to this percent on either side of each run's "
+                                                           "estimate and write the fitness to <model>_Diagnostic.csv. "
+                                                           "Not available with --ensemble.","percent");
+    QCommandLineOption pointsOption(     "diagnostic-points","Number of diagnostic points on either side of the estimate.","points","10");
+    QCommandLineOption saveOption(       "save",           "Also save the estimates to the project database's Output tables, "
+                                                           "as the GUI does. Not available with --ensemble.");
+    parser.addOptions({modelOption,hostOption,userOption,passwordOption,algorithmOption,ensembleOption,
+                       estimateOption,deterministicOption,timeoutOption,outputOption,
+                       mohnsRhoOption,forecastOption,bundleOption,diagnosticOption,pointsOption,saveOption});
+#ifdef MSSPM_INSTRUMENTATION
+    QCommandLineOption traceOption(      "trace",          "Also write a Chrome trace of the run's phases to this file.","file");
+    parser.addOption(traceOption);
+#endif
+    parser.process(app);
+
+    if ((parser.positionalArguments().size() != 1) || ! parser.isSet(modelOption)) {
+        std::cerr << "Error: A project file and a model name are required.\n" << std::endl;
+        parser.showHelp(nmfCliRunner::LoadError);
+    }
+
+    nmfCliOptions options;
+    options.ProjectFile     = parser.positionalArguments()[0].toStdString();
+    options.BundleFile      = parser.value(bundleOption).toStdString();
+    options.ModelName       = parser.value(modelOption).toStdString();
+    options.Host            = parser.value(hostOption).toStdString();
+    options.User            = parser.value(userOption).toStdString();
+    options.Password        = parser.isSet(passwordOption) ? parser.value(passwordOption).toStdString() :
+                                                             qEnvironmentVariable("MSSPM_DB_PASSWORD").toStdString();
+    options.EnsembleFile    = parser.value(ensembleOption).toStdString();
+    options.OutputDir       = parser.value(outputOption).toStdString();
+    options.isDeterministic = parser.isSet(deterministicOption);
+    options.TimeoutSeconds  = parser.value(timeoutOption).toInt();
+    options.MohnsRhoPeels   = 0;
+    options.ForecastName    = parser.value(forecastOption).toStdString();
+    options.DiagnosticPctVariation = 0;
+    options.DiagnosticNumPoints    = 0;
+    options.isSavedToDatabase = parser.isSet(saveOption);
+
+    if (parser.isSet(mohnsRhoOption)) {
+        bool ok;
+        options.MohnsRhoPeels = parser.value(mohnsRhoOption).toInt(&ok);
+        if (! ok || (options.MohnsRhoPeels < 1)) {
+            std::cerr << "Error: The number of Mohn's Rho peels must be a positive integer." << std::endl;
+            return nmfCliRunner::LoadError;
+        }
+        if (parser.isSet(ensembleOption) || parser.isSet(forecastOption) ||
+            parser.isSet(diagnosticOption) || options.isSavedToDatabase) {
+            std::cerr << "Error: --mohns-rho can't be used with --ensemble, --forecast, --diagnostic or --save." << std::endl;
+            return nmfCliRunner::LoadError;
+        }
+    }
+    if (parser.isSet(diagnosticOption)) {
+        bool ok;
+        bool okPoints;
+        options.DiagnosticPctVariation = parser.value(diagnosticOption).toInt(&ok);
+        options.DiagnosticNumPoints    = parser.value(pointsOption).toInt(&okPoints);
+        if (! ok || ! okPoints || (options.DiagnosticPctVariation < 1) || (options.DiagnosticNumPoints < 1)) {
+            std::cerr << "Error: The diagnostic percent and number of points must be positive integers." << std::endl;
+            return nmfCliRunner::LoadError;
+        }
+        // The profiles are calculated with the model's objective criterion and scaling,
+        // which an ensemble's lines may not share
+        if (parser.isSet(ensembleOption)) {
+            std::cerr << "Error: --diagnostic can't be used with --ensemble." << std::endl;
+            return nmfCliRunner::LoadError;
+        }
+    }
+    if (options.isSavedToDatabase && parser.isSet(ensembleOption)) {
+        std::cerr << "Error: --save can't be used with --ensemble." << std::endl;
+        return nmfCliRunner::LoadError;
+    }
+
+    QString algorithm = parser.value(algorithmOption);
+    if (algorithm.compare("Bees",Qt::CaseInsensitive) == 0) {
+        options.Algorithm = "Bees Algorithm";
+    } else if (algorithm.compare("NLopt",Qt::CaseInsensitive) == 0) {
+        options.Algorithm = "NLopt Algorithm";
+    } else if (! algorithm.isEmpty()) {
+        std::cerr << "Error: Unknown algorithm: " << algorithm.toStdString() << std::endl;
+        return nmfCliRunner::LoadError;
+    }
+
+    if (! parser.isSet(estimateOption)) {
+        for (const std::string& name : nmfConstantsMSSPM::EstimateCheckboxNames) {
+            options.EstimatedParameters.push_back(name);
+        }
+    }
+    for (const QString& name : parser.value(estimateOption).split(",",Qt::SkipEmptyParts)) {
+        bool found = false;
+        for (const std::string& validName : nmfConstantsMSSPM::EstimateCheckboxNames) {
+            found = found || (name.trimmed().toStdString() == validName);
+        }
+        if (! found) {
+            std::cerr << "Error: Unknown parameter: " << name.toStdString() << std::endl;
+            return nmfCliRunner::LoadError;
+        }
+        options.EstimatedParameters.push_back(name.trimmed().toStdString());
+    }
+
+    nmfLogger* logger = new nmfLogger();
+    logger->initLogger("MSSPM");
+
+    nmfCliRunner runner(logger,options);
+    g_Runner = &runner;
+    std::signal(SIGINT, stopRun);
+    std::signal(SIGTERM,stopRun);
+
+#ifdef MSSPM_INSTRUMENTATION
+    int runId = nmfInstrumentation::instance().beginRun(options.ModelName);
+#endif
+    int exitCode = runner.run();
+#ifdef MSSPM_INSTRUMENTATION
+    std::cout << nmfInstrumentation::instance().getSummary(runId) << std::endl;
+    if (parser.isSet(traceOption) &&
+        ! nmfInstrumentation::instance().writeChromeTrace(runId,parser.value(traceOption).toStdString())) {
+        std::cerr << "Error: Couldn't write: " << parser.value(traceOption).toStdString() << std::endl;
+    }
+#endif
+
+    g_Runner = nullptr;
+    delete logger;
+
+    return exitCode;
+}
@@ -0,0 +1,466 @@
+
+#include "nmfCliRunner.h"
+#include "nmfProgressTelemetry.h"
+#include "nmfUtilsQt.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QProcess>
+#include <QProcessEnvironment>
+#include <QTextStream>
+
+#include <iomanip>
+
+nmfCliRunner::nmfCliRunner(nmfLogger* logger,
+                           const nmfCliOptions& Options)
+{
+    m_Logger    = logger;
+    m_Options   = Options;
+    m_StartYear = 0;
+    m_CancellationToken = std::make_shared<nmfCancellationToken>();
+}
+
+void
+nmfCliRunner::cancel()
+{
+    m_CancellationToken->cancel();
+}
+
+bool
+nmfCliRunner::loadProject()
+{
+    QString fileName = QString::fromStdString(m_Options.ProjectFile);
+
+    // If the file doesn't have an extension, add .prj
+    if (QFileInfo(fileName).suffix().isEmpty()) {
+        fileName += ".prj";
+    }
+
+    QFile file(fileName);
+    if (! file.open(QIODevice::ReadOnly)) {
+        m_Logger->logMsg(nmfConstants::Error,"nmfCliRunner::loadProject: Cannot open file for reading: "+fileName.toStdString());
+        return false;
+    }
+    QTextStream in(&file);
+    m_Logger->logMsg(nmfConstants::Normal,"Reading Project File: " + fileName.toStdString());
+
+    // Skip initial comments
+    QString line = in.readLine();
+    while (line.trimmed().startsWith("#")) {
+        line = in.readLine();
+    }
+    m_ProjectDir      = line.trimmed().toStdString();
+    m_ProjectDatabase = in.readLine().trimmed().toStdString();
+    file.close();
+
+    if (m_ProjectDir.empty() || m_ProjectDatabase.empty()) {
+        m_Logger->logMsg(nmfConstants::Error,"nmfCliRunner::loadProject: Missing project directory or database in: "+fileName.toStdString());
+        return false;
+    }
+
+    return true;
+}
+
+bool
+nmfCliRunner::importBundle()
+{
+    QString fileName = QString::fromStdString(m_Options.BundleFile);
+    QString database = QString::fromStdString(m_ProjectDatabase);
+    QStringList connection = {"--host="+QString::fromStdString(m_Options.Host),
+                              "--user="+QString::fromStdString(m_Options.User)};
+    QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+    QProcess process;
+
+    if (! QFileInfo(fileName).isFile()) {
+        m_Logger->logMsg(nmfConstants::Error,"nmfCliRunner::importBundle: Cannot open file for reading: "+fileName.toStdString());
+        return false;
+    }
+    if (database.contains("`")) {
+        m_Logger->logMsg(nmfConstants::Error,"nmfCliRunner::importBundle: Invalid database name: "+m_ProjectDatabase);
+        return false;
+    }
+
+    // The export is a mysqldump file, so it's loaded the same way, with the mysql client.
+    // The password is passed in the environment so it doesn't show up in the process list.
+    environment.insert("MYSQL_PWD",QString::fromStdString(m_Options.Password));
+    process.setProcessEnvironment(environment);
+    auto runMySql = [this,&process](const QStringList& Arguments) {
+        process.start("mysql",Arguments);
+        if (! process.waitForFinished(-1) ||
+            (process.exitStatus() != QProcess::NormalExit) || (process.exitCode() != 0)) {
+            m_Logger->logMsg(nmfConstants::Error,"nmfCliRunner::importBundle: mysql failed: " +
+                             QString(process.readAllStandardError()).toStdString());
+            return false;
+        }
+        return true;
+    };
+
+    m_Logger->logMsg(nmfConstants::Normal,"Loading " + fileName.toStdString() + " into database: " + m_ProjectDatabase);
+    if (! runMySql(connection + QStringList({"-e","CREATE DATABASE IF NOT EXISTS `"+database+"`"}))) {
+        return false;
+    }
+    process.setStandardInputFile(fileName);
+    return runMySql(connection + QStringList({database}));
+}
+
+void
+nmfCliRunner::writeParameters(std::ofstream& ParameterFile,
+                              const int& RunNumber,
+                              const nmfEstimationResult& Result)
+{
+    const std::vector<std::string>& Names = (Result.isAggProd) ? m_GuildNames : m_SpeciesNames;
+
+    auto write1D = [&](const std::string& Parameter,
+                       const std::vector<double>& Values) {
+        for (unsigned i=0; i<Values.size() && i<Names.size(); ++i) {
+            ParameterFile << RunNumber << "," << Result.Fitness << "," << Parameter << ","
+                          << Names[i] << ",," << Values[i] << "\n";
+        }
+    };
+    auto write2D = [&](const std::string& Parameter,
+                       const boost::numeric::ublas::matrix<double>& Values,
+                       const std::vector<std::string>& RowNames,
+                       const std::vector<std::string>& ColNames) {
+        for (unsigned row=0; row<Values.size1() && row<RowNames.size(); ++row) {
+            for (unsigned col=0; col<Values.size2() && col<ColNames.size(); ++col) {
+                ParameterFile << RunNumber << "," << Result.Fitness << "," << Parameter << ","
+                              << RowNames[row] << "," << ColNames[col] << "," << Values(row,col) << "\n";
+            }
+        }
+    };
+
+    write1D("InitBiomass",      Result.EstInitBiomass);
+    write1D("GrowthRate",       Result.EstGrowthRates);
+    write1D("CarryingCapacity", Result.EstCarryingCapacities);
+    write1D("Catchability",     Result.EstCatchability);
+    write1D("PredationExponent",Result.EstPredationExponent);
+    write1D("SurveyQ",          Result.EstSurveyQ);
+    write2D("CompetitionAlpha",           Result.EstCompetitionAlpha,           Names,          Names);
+    write2D("CompetitionBetaSpecies",     Result.EstCompetitionBetaSpecies,     m_SpeciesNames, m_SpeciesNames);
+    write2D("CompetitionBetaGuilds",      Result.EstCompetitionBetaGuilds,      m_SpeciesNames, m_GuildNames);
+    write2D("CompetitionBetaGuildsGuilds",Result.EstCompetitionBetaGuildsGuilds,m_GuildNames,   m_GuildNames);
+    write2D("PredationRho",               Result.EstPredationRho,               Names,          Names);
+    write2D("PredationHandling",          Result.EstPredationHandling,          Names,          Names);
+    ParameterFile.flush();
+}
+
+void
+nmfCliRunner::writeBiomass(std::ofstream& BiomassFile,
+                           const int& RunNumber,
+                           const int& FirstYear,
+                           const bool& isAggProd,
+                           const boost::numeric::ublas::matrix<double>& EstBiomass)
+{
+    const std::vector<std::string>& Names = (isAggProd) ? m_GuildNames : m_SpeciesNames;
+
+    for (unsigned time=0; time<EstBiomass.size1(); ++time) {
+        for (unsigned i=0; i<EstBiomass.size2() && i<Names.size(); ++i) {
+            BiomassFile << RunNumber << "," << FirstYear+int(time) << "," << Names[i] << ","
+                        << EstBiomass(time,i) << "\n";
+        }
+    }
+    BiomassFile.flush();
+}
+
+void
+nmfCliRunner::writeMohnsRho(std::ofstream& MohnsRhoFile,
+                            const std::string& Statistic,
+                            const bool& isAggProd,
+                            const std::vector<double>& Values)
+{
+    const std::vector<std::string>& Names = (isAggProd) ? m_GuildNames : m_SpeciesNames;
+
+    // The last value is the one for the whole model
+    for (unsigned i=0; i<Values.size(); ++i) {
+        MohnsRhoFile << Statistic << "," << ((i < Names.size()) ? Names[i] : "Model") << ","
+                     << Values[i] << "\n";
+    }
+}
+
+bool
+nmfCliRunner::calculateBiomass(const nmfCoreModel& Model,
+                               nmfEstimationResult& Result)
+{
+    if ((Result.EstBiomassSpecies.size1() == 0) &&
+        ! nmfCoreSimulator::calculateBiomass(Model.dataStruct,Result,
+                                             Result.EstBiomassSpecies,Result.EstBiomassGuilds)) {
+        m_Logger->logMsg(nmfConstants::Warning,"nmfCliRunner: Couldn't calculate the biomass of run " +
+                         std::to_string(Result.RunNumber));
+        return false;
+    }
+    return true;
+}
+
+int
+nmfCliRunner::runMohnsRho(const nmfCoreEngine& Engine,
+                          const nmfCoreModel& Model,
+                          const std::string& FilePrefix)
+{
+    bool isAggProd = (Model.dataStruct.CompetitionForm == "AGG-PROD");
+    std::ofstream MohnsRhoFile;
+
+    if (m_Options.TimeoutSeconds > 0) {
+        m_CancellationToken->setDeadline(std::chrono::seconds(m_Options.TimeoutSeconds));
+    }
+
+    m_Logger->logMsg(nmfConstants::Normal,"Running a retrospective analysis with " +
+                     std::to_string(m_Options.MohnsRhoPeels) + " peels");
+    nmfCoreStatisticsResult Result = Engine.runRetrospectiveAnalysis(Model,m_Options.MohnsRhoPeels,
+                                                                      m_CancellationToken);
+    nmfProgressTelemetry::instance().discard();
+    if (! Result.isValid) {
+        m_Logger->logMsg(nmfConstants::Error,"nmfCliRunner: "+Result.ErrorMsg);
+        return RunError;
+    }
+
+    MohnsRhoFile.open(FilePrefix+"_MohnsRho.csv");
+    if (! MohnsRhoFile) {
+        m_Logger->logMsg(nmfConstants::Error,"nmfCliRunner: Cannot write output file: "+FilePrefix+"_MohnsRho.csv");
+        return LoadError;
+    }
+    MohnsRhoFile << std::setprecision(12) << "Statistic,SpeciesOrGuild,Value\n";
+    writeMohnsRho(MohnsRhoFile,"GrowthRate",      isAggProd,Result.Stats.mohnsRhoGrowthRate);
+    writeMohnsRho(MohnsRhoFile,"CarryingCapacity",isAggProd,Result.Stats.mohnsRhoCarryingCapacity);
+    writeMohnsRho(MohnsRhoFile,"EstimatedBiomass",isAggProd,Result.Stats.mohnsRhoEstimatedBiomass);
+    MohnsRhoFile.close();
+    m_Logger->logMsg(nmfConstants::Normal,"Wrote: "+FilePrefix+"_MohnsRho.csv");
+
+    return Success;
+}
+
+int
+nmfCliRunner::runDiagnostics(const nmfCoreModel& Model,
+                             const std::vector<std::unique_ptr<nmfEstimationResult> >& Results,
+                             const std::string& FilePrefix)
+{
+    std::string fileName = FilePrefix + "_Diagnostic.csv";
+    std::string errorMsg;
+    std::vector<nmfCoreProfilePoint> Points;
+    std::ofstream DiagnosticFile;
+
+    DiagnosticFile.open(fileName);
+    if (! DiagnosticFile) {
+        m_Logger->logMsg(nmfConstants::Error,"nmfCliRunner: Cannot write output file: "+fileName);
+        return LoadError;
+    }
+    DiagnosticFile << std::setprecision(12) << "Run,Parameter,SpeciesOrGuild,Offset,Value,Fitness\n";
+
+    for (const std::unique_ptr<nmfEstimationResult>& Result : Results) {
+        const std::vector<std::string>& Names = (Result->isAggProd) ? m_GuildNames : m_SpeciesNames;
+        if (! nmfCoreDiagnostics::calculateParameterProfiles(Model.dataStruct,*Result,
+                                                             m_Options.DiagnosticPctVariation,
+                                                             m_Options.DiagnosticNumPoints,
+                                                             Points,errorMsg)) {
+            m_Logger->logMsg(nmfConstants::Error,errorMsg);
+            return RunError;
+        }
+        for (const nmfCoreProfilePoint& Point : Points) {
+            if (Point.SpeciesOrGuild < int(Names.size())) {
+                DiagnosticFile << Result->RunNumber << "," << Point.Parameter << ","
+                               << Names[Point.SpeciesOrGuild] << "," << Point.Offset << ","
+                               << Point.Value << "," << Point.Fitness << "\n";
+            }
+        }
+    }
+    DiagnosticFile.close();
+    m_Logger->logMsg(nmfConstants::Normal,"Wrote: "+fileName);
+
+    return Success;
+}
+
+int
+nmfCliRunner::runForecast(const nmfCoreEngine& Engine,
+                          const nmfCoreModel& Model,
+                          const std::vector<std::unique_ptr<nmfEstimationResult> >& Results,
+                          const std::string& FilePrefix)
+{
+    bool isAggProd = (Model.dataStruct.CompetitionForm == "AGG-PROD");
+    std::string fileName = FilePrefix + "_Forecast_" + m_Options.ForecastName + ".csv";
+    std::vector<double> EstInitBiomass;
+    boost::numeric::ublas::matrix<double> ForecastBiomassSpecies;
+    boost::numeric::ublas::matrix<double> ForecastBiomassGuilds;
+    std::ofstream ForecastFile;
+    nmfCoreModel ForecastModel;
+
+    if (! Engine.loadForecast(Model,m_Options.ForecastName,ForecastModel)) {
+        return LoadError;
+    }
+    ForecastFile.open(fileName);
+    if (! ForecastFile) {
+        m_Logger->logMsg(nmfConstants::Error,"nmfCliRunner: Cannot write output file: "+fileName);
+        return LoadError;
+    }
+    ForecastFile << std::setprecision(12) << "Run,Year,SpeciesOrGuild,Value\n";
+
+    // Each run's forecast starts from the biomass it estimated for the model's last year
+    for (const std::unique_ptr<nmfEstimationResult>& Result : Results) {
+        int LastTime = int(Result->EstBiomassSpecies.size1()) - 1;
+        if (LastTime < 0) {
+            continue;
+        }
+        EstInitBiomass.clear();
+        for (unsigned i=0; i<Result->EstBiomassSpecies.size2(); ++i) {
+            EstInitBiomass.push_back(Result->EstBiomassSpecies(LastTime,i));
+        }
+        Result->EstInitBiomass.swap(EstInitBiomass);
+        bool isSimulated = nmfCoreSimulator::calculateBiomass(ForecastModel.dataStruct,*Result,
+                                                              ForecastBiomassSpecies,ForecastBiomassGuilds);
+        Result->EstInitBiomass.swap(EstInitBiomass);
+        if (! isSimulated) {
+            m_Logger->logMsg(nmfConstants::Warning,"nmfCliRunner: Couldn't run the forecast of run " +
+                             std::to_string(Result->RunNumber));
+            continue;
+        }
+        writeBiomass(ForecastFile,Result->RunNumber,m_StartYear+LastTime,isAggProd,ForecastBiomassSpecies);
+    }
+    ForecastFile.close();
+    m_Logger->logMsg(nmfConstants::Normal,"Wrote: "+fileName);
+
+    return Success;
+}
+
+int
+nmfCliRunner::run()
+{
+    // The estimator waits once it is this many results ahead of the writer
+    const std::size_t ResultQueueCapacity = 16;
+
+    int TotalIndividualRuns = 0;
+    int exitCode = Success;
+    bool isAMultiRun = ! m_Options.EnsembleFile.empty();
+    std::vector<QString> MultiRunLines = {};
+    nmfCoreDatabaseSettings settings;
+    nmfCoreModel model;
+    std::unique_ptr<nmfEstimationResult> Result;
+    std::vector<std::unique_ptr<nmfEstimationResult> > RunResults;
+    std::ofstream ParameterFile;
+    std::ofstream BiomassFile;
+
+    if (! loadProject()) {
+        return LoadError;
+    }
+    if (! m_Options.BundleFile.empty() && ! importBundle()) {
+        return LoadError;
+    }
+
+    settings.Host            = m_Options.Host;
+    settings.User            = m_Options.User;
+    settings.Password        = m_Options.Password;
+    settings.ProjectDatabase = m_ProjectDatabase;
+    nmfCoreEngine engine(m_Logger,settings);
+    m_Logger->logMsg(nmfConstants::Normal,"Loading database: "+m_ProjectDatabase);
+    if (! engine.loadModel(m_Options.ModelName,m_Options.EstimatedParameters,model)) {
+        return LoadError;
+    }
+    nmfStructsQt::ModelDataStruct& dataStruct = model.dataStruct;
+    m_SpeciesNames = model.SpeciesNames;
+    m_GuildNames   = model.GuildNames;
+    m_StartYear    = model.StartYear;
+    if (! m_Options.Algorithm.empty()) {
+        dataStruct.EstimationAlgorithm = m_Options.Algorithm;
+    }
+    dataStruct.showDiagnosticChart = false;
+    dataStruct.useFixedSeed        = m_Options.isDeterministic;
+
+    QString outputDir = QString::fromStdString(m_Options.OutputDir);
+    if (outputDir.isEmpty()) {
+        outputDir = QDir(QString::fromStdString(m_ProjectDir)).filePath("outputData");
+    }
+    if (! QDir().mkpath(outputDir)) {
+        m_Logger->logMsg(nmfConstants::Error,"nmfCliRunner: Cannot create output directory: "+outputDir.toStdString());
+        return LoadError;
+    }
+    std::string filePrefix = QDir(outputDir).filePath(QString::fromStdString(m_Options.ModelName)).toStdString();
+
+    if (m_Options.MohnsRhoPeels > 0) {
+        return runMohnsRho(engine,model,filePrefix);
+    }
+
+    if (isAMultiRun) {
+        // A relative ensemble file is looked for where the GUI saves them
+        dataStruct.MultiRunSetupFilename = QDir(QDir(QString::fromStdString(m_ProjectDir)).filePath("outputData")).filePath(
+                    QString::fromStdString(m_Options.EnsembleFile)).toStdString();
+        if (! nmfUtilsQt::loadMultiRunData(dataStruct,MultiRunLines,TotalIndividualRuns)) {
+            m_Logger->logMsg(nmfConstants::Error,"nmfCliRunner: Couldn't open: "+dataStruct.MultiRunSetupFilename);
+            return LoadError;
+        }
+    } else {
+        // Otherwise the estimators would look for multi-run lines
+        dataStruct.NLoptNumberOfRuns = 1;
+    }
+
+    ParameterFile.open(filePrefix+"_EstimatedParameters.csv");
+    BiomassFile.open(  filePrefix+"_EstimatedBiomass.csv");
+    if (! ParameterFile || ! BiomassFile) {
+        m_Logger->logMsg(nmfConstants::Error,"nmfCliRunner: Cannot write output files: "+filePrefix+"_Estimated*.csv");
+        return LoadError;
+    }
+    ParameterFile << std::setprecision(12) << "Run,Fitness,Parameter,Row,Column,Value\n";
+    BiomassFile   << std::setprecision(12) << "Run,Year,SpeciesOrGuild,Value\n";
+
+    if (m_Options.TimeoutSeconds > 0) {
+        m_CancellationToken->setDeadline(std::chrono::seconds(m_Options.TimeoutSeconds));
+    }
+
+    // The estimator runs on its own thread while this one writes out each result as it arrives
+    std::shared_ptr<nmfEstimationResultQueue> ResultQueue =
+            std::make_shared<nmfEstimationResultQueue>(ResultQueueCapacity);
+    QFuture<void> future = engine.estimateAsync(dataStruct,MultiRunLines,TotalIndividualRuns,
+                                                m_Options.isDeterministic,m_CancellationToken,ResultQueue);
+    while (ResultQueue->pop(Result)) {
+        // A multi-run reports each of its sub-runs and a single run reports its one result
+        if ((Result->Type != nmfEstimationResult::SubRunCompleted) &&
+            (Result->Type != nmfEstimationResult::RunCompleted)) {
+            continue;
+        }
+        if (Result->Type == nmfEstimationResult::RunCompleted) {
+            Result->RunNumber = 0;
+        }
+        writeParameters(ParameterFile,Result->RunNumber,*Result);
+        if (calculateBiomass(model,*Result)) {
+            writeBiomass(BiomassFile,Result->RunNumber,m_StartYear,Result->isAggProd,Result->EstBiomassSpecies);
+        }
+        if (Result->Type == nmfEstimationResult::SubRunCompleted) {
+            m_Logger->logMsg(nmfConstants::Normal,
+                             "Run " + std::to_string(Result->RunNumber+1) + " of " +
+                             std::to_string(Result->NumRuns) + " completed with fitness: " +
+                             std::to_string(Result->Fitness));
+        } else {
+            m_Logger->logMsg(nmfConstants::Normal,Result->BestFitness);
+        }
+        RunResults.push_back(std::move(Result));
+    }
+    future.waitForFinished();
+    nmfProgressTelemetry::instance().discard();
+
+    ParameterFile.close();
+    BiomassFile.close();
+
+    if (m_CancellationToken->isCancelled()) {
+        m_Logger->logMsg(nmfConstants::Warning,"nmfCliRunner: Run was stopped before it finished");
+        return RunError;
+    }
+    if (RunResults.empty()) {
+        m_Logger->logMsg(nmfConstants::Error,"nmfCliRunner: The estimator returned no results");
+        return RunError;
+    }
+    m_Logger->logMsg(nmfConstants::Normal,"Wrote: "+filePrefix+"_EstimatedParameters.csv");
+    m_Logger->logMsg(nmfConstants::Normal,"Wrote: "+filePrefix+"_EstimatedBiomass.csv");
+
+    if (m_Options.DiagnosticPctVariation > 0) {
+        exitCode = runDiagnostics(model,RunResults,filePrefix);
+    }
+    if (! m_Options.ForecastName.empty() && (exitCode == Success)) {
+        exitCode = runForecast(engine,model,RunResults,filePrefix);
+    }
+    // Only a single run is saved, since the Output tables hold one set of estimates per algorithm
+    if (m_Options.isSavedToDatabase && (exitCode == Success)) {
+        if (! engine.saveEstimates(model,*RunResults[0])) {
+            return RunError;
+        }
+        m_Logger->logMsg(nmfConstants::Normal,"Saved the estimates to: "+m_ProjectDatabase);
+    }
+
+    return exitCode;
+}
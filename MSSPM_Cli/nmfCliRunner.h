@@ -0,0 +1,172 @@
+/**
+ * @file nmfCliRunner.h
+ * @brief Class definition for the msspm-cli estimation runner
+ *
+ * This file contains the class definition for nmfCliRunner. The runner
+ * loads a project and model with the MSSPM_Core engine, runs the Bees or
+ * NLopt estimator on one of the engine's worker threads and writes the
+ * estimated parameters and biomass of every run to CSV files as the
+ * results arrive on the estimator's result queue.
+ *
+ * @copyright
+ * Public Domain Notice\n
+ *
+ * National Oceanic And Atmospheric Administration\n\n
+ *
+ * This software is a "United States Government Work" under the terms of the
+ * United States Copyright Act.  It was written as part of the author's official
+ * duties as a United States Government employee/contractor and thus cannot be copyrighted.
+ * This software is freely available to the public for use. The National Oceanic
+ * And Atmospheric Administration and the U.S. Government have not placed any
+ * restriction on its use or reproduction.  Although all reasonable efforts have
+ * been taken to ensure the accuracy and reliability of the software and data,
+ * the National Oceanic And Atmospheric Administration and the U.S. Government
+ * do not and cannot warrant the performance or results that may be obtained
+ * by using this software or data. The National Oceanic And Atmospheric
+ * Administration and the U.S. Government disclaim all warranties, express
+ * or implied, including warranties of performance, merchantability or fitness
+ * for any particular purpose.\n\n
+ *
+ * Please cite the author(s) in any work or product based on this material.
+ */
+
+#pragma once
+
+#include "nmfCancellationToken.h"
+#include "nmfCoreDiagnostics.h"
+#include "nmfCoreEngine.h"
+#include "nmfEstimationResult.h"
+
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <QString>
+
+/**
+ * @brief Settings given on the msspm-cli command line
+ */
+struct nmfCliOptions {
+    std::string ProjectFile;
+    /**
+     * @brief Database file written by File > Export Database to load into the project's
+     * database before the run; empty to use the database as it is
+     */
+    std::string BundleFile;
+    std::string ModelName;
+    std::string Host;
+    std::string User;
+    std::string Password;
+    /**
+     * @brief "Bees Algorithm" or "NLopt Algorithm"; empty to use the model's saved algorithm
+     */
+    std::string Algorithm;
+    /**
+     * @brief Multi-run (ensemble) file; empty for a single run
+     */
+    std::string EnsembleFile;
+    std::string OutputDir;
+    std::vector<std::string> EstimatedParameters;
+    bool isDeterministic;
+    /**
+     * @brief Number of peels of a retrospective (Mohn's Rho) analysis; 0 to estimate the model
+     */
+    int MohnsRhoPeels;
+    /**
+     * @brief Forecast to run from each run's estimates; empty for none
+     */
+    std::string ForecastName;
+    /**
+     * @brief How far (in percent) each parameter profile of the diagnostic reaches on
+     * either side of the estimate; 0 for no diagnostic
+     */
+    int DiagnosticPctVariation;
+    /**
+     * @brief Number of diagnostic points on either side of the estimate
+     */
+    int DiagnosticNumPoints;
+    /**
+     * @brief Also save the estimates to the project database's Output tables
+     */
+    bool isSavedToDatabase;
+    /**
+     * @brief Seconds after which the run is cancelled; 0 for no limit
+     */
+    int TimeoutSeconds;
+};
+
+/**
+ * @brief Runs one msspm-cli estimation from start to finish without any widgets
+ */
+class nmfCliRunner
+{
+    nmfLogger*    m_Logger;
+    nmfCliOptions m_Options;
+    std::string   m_ProjectDir;
+    std::string   m_ProjectDatabase;
+    std::vector<std::string> m_SpeciesNames;
+    std::vector<std::string> m_GuildNames;
+    int           m_StartYear;
+    std::shared_ptr<nmfCancellationToken> m_CancellationToken;
+
+    bool calculateBiomass(const nmfCoreModel& Model,
+                          nmfEstimationResult& Result);
+    bool importBundle();
+    bool loadProject();
+    int  runDiagnostics(const nmfCoreModel& Model,
+                        const std::vector<std::unique_ptr<nmfEstimationResult> >& Results,
+                        const std::string& FilePrefix);
+    int  runForecast(const nmfCoreEngine& Engine,
+                     const nmfCoreModel& Model,
+                     const std::vector<std::unique_ptr<nmfEstimationResult> >& Results,
+                     const std::string& FilePrefix);
+    int  runMohnsRho(const nmfCoreEngine& Engine,
+                     const nmfCoreModel& Model,
+                     const std::string& FilePrefix);
+    void writeBiomass(std::ofstream& BiomassFile,
+                      const int& RunNumber,
+                      const int& FirstYear,
+                      const bool& isAggProd,
+                      const boost::numeric::ublas::matrix<double>& EstBiomass);
+    void writeMohnsRho(std::ofstream& MohnsRhoFile,
+                       const std::string& Statistic,
+                       const bool& isAggProd,
+                       const std::vector<double>& Values);
+    void writeParameters(std::ofstream& ParameterFile,
+                         const int& RunNumber,
+                         const nmfEstimationResult& Result);
+
+public:
+    /**
+     * @brief Exit codes returned by run()
+     */
+    enum ExitCode {
+        Success         = 0,
+        ConnectionError = 1,
+        LoadError       = 2,
+        RunError        = 3
+    };
+
+    /**
+     * @brief Class constructor
+     * @param logger : pointer to the application logger
+     * @param Options : the command line settings
+     */
+    nmfCliRunner(nmfLogger* logger,
+                 const nmfCliOptions& Options);
+    virtual ~nmfCliRunner() {}
+
+    /**
+     * @brief Asks a running estimation to stop. Only touches an atomic flag, so it
+     * may be called from a signal handler.
+     */
+    void cancel();
+    /**
+     * @brief Loads the exported database if one was given, connects, loads the model, runs
+     * the estimation (or the Mohn's Rho analysis) and writes the results, then runs the
+     * diagnostic and the forecast and saves to the database if asked to
+     * @return One of the ExitCode values
+     */
+    int run();
+};
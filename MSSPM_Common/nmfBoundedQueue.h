@@ -0,0 +1,133 @@
+/**
+ * @file nmfBoundedQueue.h
+ * @brief Definition of the bounded queue used to hand results from the estimators to the GUI
+ *
+ * This file contains the nmfBoundedQueue class template. Producers block only when
+ * the queue is full, which throttles them to the consumer's pace without any fixed
+ * sleeps. The consumer never blocks.
+ *
+ * @copyright
+ * Public Domain Notice\n
+ *
+ * National Oceanic And Atmospheric Administration\n\n
+ *
+ * This software is a "United States Government Work" under the terms of the
+ * United States Copyright Act.  It was written as part of the author's official
+ * duties as a United States Government employee/contractor and thus cannot be copyrighted.
+ * This software is freely available to the public for use. The National Oceanic
+ * And Atmospheric Administration and the U.S. Government have not placed any
+ * restriction on its use or reproduction.  Although all reasonable efforts have
+ * been taken to ensure the accuracy and reliability of the software and data,
+ * the National Oceanic And Atmospheric Administration and the U.S. Government
+ * do not and cannot warrant the performance or results that may be obtained
+ * by using this software or data. The National Oceanic And Atmospheric
+ * Administration and the U.S. Government disclaim all warranties, express
+ * or implied, including warranties of performance, merchantability or fitness
+ * for any particular purpose.\n\n
+ *
+ * Please cite the author(s) in any work or product based on this material.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+/**
+ * @brief Thread safe first-in first-out queue with a fixed capacity
+ */
+template<class T>
+class nmfBoundedQueue {
+
+    std::size_t             m_Capacity;
+    bool                    m_isClosed;
+    std::deque<T>           m_Items;
+    mutable std::mutex      m_Mutex;
+    std::condition_variable m_NotFull;
+    std::condition_variable m_NotEmpty;
+
+public:
+    /**
+     * @brief Class constructor
+     * @param Capacity : number of items that can wait in the queue before push() blocks
+     */
+    explicit nmfBoundedQueue(const std::size_t& Capacity) :
+        m_Capacity((Capacity > 0) ? Capacity : 1),
+        m_isClosed(false) {}
+    nmfBoundedQueue(const nmfBoundedQueue&) = delete;
+    nmfBoundedQueue& operator=(const nmfBoundedQueue&) = delete;
+
+    /**
+     * @brief Appends an item, waiting for room if the queue is full
+     * @param Item : item to append
+     * @return Returns false (and drops the item) if the queue has been closed
+     */
+    bool push(T Item) {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_NotFull.wait(lock,[this] { return m_isClosed || (m_Items.size() < m_Capacity); });
+        if (m_isClosed) {
+            return false;
+        }
+        m_Items.push_back(std::move(Item));
+        lock.unlock();
+        m_NotEmpty.notify_one();
+        return true;
+    }
+    /**
+     * @brief Removes the oldest item, waiting for one if the queue is empty
+     * @param Item : set to the oldest item if there is one
+     * @return Returns false once the queue has been closed and emptied
+     */
+    bool pop(T& Item) {
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_NotEmpty.wait(lock,[this] { return m_isClosed || (! m_Items.empty()); });
+            if (m_Items.empty()) {
+                return false;
+            }
+            Item = std::move(m_Items.front());
+            m_Items.pop_front();
+        }
+        m_NotFull.notify_one();
+        return true;
+    }
+    /**
+     * @brief Removes the oldest item without waiting
+     * @param Item : set to the oldest item if there is one
+     * @return Returns false if the queue was empty
+     */
+    bool tryPop(T& Item) {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            if (m_Items.empty()) {
+                return false;
+            }
+            Item = std::move(m_Items.front());
+            m_Items.pop_front();
+        }
+        m_NotFull.notify_one();
+        return true;
+    }
+    /**
+     * @brief Wakes up all waiting producers and consumers and makes later pushes
+     * fail. Items already in the queue can still be popped.
+     */
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_isClosed = true;
+        }
+        m_NotFull.notify_all();
+        m_NotEmpty.notify_all();
+    }
+    bool isClosed() const {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        return m_isClosed;
+    }
+    std::size_t size() const {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        return m_Items.size();
+    }
+};
@@ -0,0 +1,101 @@
+/**
+ * @file nmfCancellationToken.h
+ * @brief Definition of the token used to stop an estimation run
+ *
+ * This file contains the nmfCancellationToken class. One token is created for each
+ * estimation run and shared by the GUI, the estimator and every worker thread. The
+ * Stop button cancels it, and the workers poll it between objective function
+ * evaluations. Neither side touches the file system.
+ *
+ * @copyright
+ * Public Domain Notice\n
+ *
+ * National Oceanic And Atmospheric Administration\n\n
+ *
+ * This software is a "United States Government Work" under the terms of the
+ * United States Copyright Act.  It was written as part of the author's official
+ * duties as a United States Government employee/contractor and thus cannot be copyrighted.
+ * This software is freely available to the public for use. The National Oceanic
+ * And Atmospheric Administration and the U.S. Government have not placed any
+ * restriction on its use or reproduction.  Although all reasonable efforts have
+ * been taken to ensure the accuracy and reliability of the software and data,
+ * the National Oceanic And Atmospheric Administration and the U.S. Government
+ * do not and cannot warrant the performance or results that may be obtained
+ * by using this software or data. The National Oceanic And Atmospheric
+ * Administration and the U.S. Government disclaim all warranties, express
+ * or implied, including warranties of performance, merchantability or fitness
+ * for any particular purpose.\n\n
+ *
+ * Please cite the author(s) in any work or product based on this material.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+
+/**
+ * @brief Thread safe stop flag with an optional deadline
+ *
+ * isCancelled() is cheap enough to call on every objective function evaluation: it's
+ * a relaxed atomic load, plus a steady clock read only while a deadline is set.
+ */
+class nmfCancellationToken {
+
+    typedef std::chrono::steady_clock Clock;
+
+    static const Clock::rep NoDeadline = Clock::duration::max().count();
+
+    mutable std::atomic<bool> m_isCancelled;
+    std::atomic<Clock::rep>   m_Deadline;
+    std::atomic<bool>         m_isFinished;
+
+public:
+    nmfCancellationToken() : m_isCancelled(false), m_Deadline(NoDeadline), m_isFinished(false) {}
+    nmfCancellationToken(const nmfCancellationToken&) = delete;
+    nmfCancellationToken& operator=(const nmfCancellationToken&) = delete;
+
+    /**
+     * @brief Asks every thread polling the token to stop
+     */
+    void cancel() {
+        m_isCancelled.store(true,std::memory_order_relaxed);
+    }
+    /**
+     * @brief Cancels the token automatically once the timeout has elapsed
+     * @param Timeout : time from now after which isCancelled() returns true
+     */
+    void setDeadline(const Clock::duration& Timeout) {
+        m_Deadline.store((Clock::now()+Timeout).time_since_epoch().count(),std::memory_order_relaxed);
+    }
+    void clearDeadline() {
+        m_Deadline.store(NoDeadline,std::memory_order_relaxed);
+    }
+    /**
+     * @brief Returns true if the token was cancelled or its deadline has passed
+     */
+    bool isCancelled() const {
+        if (m_isCancelled.load(std::memory_order_relaxed)) {
+            return true;
+        }
+        Clock::rep deadline = m_Deadline.load(std::memory_order_relaxed);
+        if ((deadline != NoDeadline) && (Clock::now().time_since_epoch().count() >= deadline)) {
+            // Latch it so later polls don't need the clock
+            m_isCancelled.store(true,std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+    /**
+     * @brief Called by the estimator once all of its worker threads are done
+     */
+    void finish() {
+        m_isFinished.store(true,std::memory_order_release);
+    }
+    /**
+     * @brief Returns true once the estimator has called finish()
+     */
+    bool isFinished() const {
+        return m_isFinished.load(std::memory_order_acquire);
+    }
+};
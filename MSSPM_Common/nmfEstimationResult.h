@@ -0,0 +1,156 @@
+/**
+ * @file nmfEstimationResult.h
+ * @brief Definition of the result records the estimators pass to the GUI
+ *
+ * This file contains the nmfEstimationResult structure. An estimator fills in one
+ * record for every repetition, sub-run and run it finishes and pushes it onto the
+ * run's nmfEstimationResultQueue. The record owns copies of the estimated
+ * parameters, so the estimator can go on to its next sub-run while the GUI is
+ * still processing the last one. When several estimators run the members of an
+ * ensemble together, an nmfEstimationEnsemble numbers the members in the order
+ * they reach the queue.
+ *
+ * @copyright
+ * Public Domain Notice\n
+ *
+ * National Oceanic And Atmospheric Administration\n\n
+ *
+ * This software is a "United States Government Work" under the terms of the
+ * United States Copyright Act.  It was written as part of the author's official
+ * duties as a United States Government employee/contractor and thus cannot be copyrighted.
+ * This software is freely available to the public for use. The National Oceanic
+ * And Atmospheric Administration and the U.S. Government have not placed any
+ * restriction on its use or reproduction.  Although all reasonable efforts have
+ * been taken to ensure the accuracy and reliability of the software and data,
+ * the National Oceanic And Atmospheric Administration and the U.S. Government
+ * do not and cannot warrant the performance or results that may be obtained
+ * by using this software or data. The National Oceanic And Atmospheric
+ * Administration and the U.S. Government disclaim all warranties, express
+ * or implied, including warranties of performance, merchantability or fitness
+ * for any particular purpose.\n\n
+ *
+ * Please cite the author(s) in any work or product based on this material.
+ */
+
+#pragma once
+
+#include "nmfBoundedQueue.h"
+
+#include <boost/numeric/ublas/matrix.hpp>
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief One estimator event and, for completed runs and sub-runs, its estimated parameters
+ * and biomass. Results are move-only since a sub-run's biomass can be large.
+ */
+struct nmfEstimationResult {
+    enum ResultType {
+        RepetitionCompleted,
+        SubRunCompleted,
+        RunCompleted,
+        AllSubRunsCompleted
+    };
+
+    nmfEstimationResult() = default;
+    nmfEstimationResult(const nmfEstimationResult&) = delete;
+    nmfEstimationResult& operator=(const nmfEstimationResult&) = delete;
+    nmfEstimationResult(nmfEstimationResult&&) = default;
+    nmfEstimationResult& operator=(nmfEstimationResult&&) = default;
+
+    ResultType  Type                = RunCompleted;
+    int         RunNumber           = 0;
+    /**
+     * @brief Repetition number (RepetitionCompleted only)
+     */
+    int         SubRunNumber        = 0;
+    /**
+     * @brief Number of runs in the multi-run, or repetitions per run for RepetitionCompleted
+     */
+    int         NumRuns             = 0;
+    bool        showDiagnosticChart = false;
+    bool        isAggProd           = false;
+    /**
+     * @brief Number of years after the first, i.e., the biomass has RunLength+1 rows
+     */
+    int         RunLength           = 0;
+    /**
+     * @brief Number of objective function evaluations the sub-run made
+     */
+    int         NumEvaluations      = 0;
+    double      Fitness             = 0;
+    std::string BestFitness;
+    std::string EstimationAlgorithm;
+    std::string MinimizerAlgorithm;
+    std::string ObjectiveCriterion;
+    std::string ScalingAlgorithm;
+    std::string MultiRunSpeciesFilename;
+    std::string MultiRunModelFilename;
+    std::vector<double> EstInitBiomass;
+    std::vector<double> EstGrowthRates;
+    std::vector<double> EstCarryingCapacities;
+    std::vector<double> EstCatchability;
+    std::vector<double> EstPredationExponent;
+    std::vector<double> EstSurveyQ;
+    boost::numeric::ublas::matrix<double> EstCompetitionAlpha;
+    boost::numeric::ublas::matrix<double> EstCompetitionBetaSpecies;
+    boost::numeric::ublas::matrix<double> EstCompetitionBetaGuilds;
+    boost::numeric::ublas::matrix<double> EstCompetitionBetaGuildsGuilds;
+    boost::numeric::ublas::matrix<double> EstPredationRho;
+    boost::numeric::ublas::matrix<double> EstPredationHandling;
+    /**
+     * @brief Biomass at the estimated parameters by species (or by guild if running
+     * AGG-PROD). Empty if the estimator didn't calculate it.
+     */
+    boost::numeric::ublas::matrix<double> EstBiomassSpecies;
+    boost::numeric::ublas::matrix<double> EstBiomassGuilds;
+};
+
+/**
+ * @brief Queue of finished results. The consumer takes ownership of each result it pops.
+ */
+typedef nmfBoundedQueue<std::unique_ptr<nmfEstimationResult> > nmfEstimationResultQueue;
+
+/**
+ * @brief Numbers the members (i.e., sub-runs) of an ensemble whose estimators share a
+ * result queue. A member's number is the number of members pushed before it, so the
+ * reader sees 0, 1, 2, ... however the estimators' sub-runs interleave.
+ */
+class nmfEstimationEnsemble {
+
+    std::mutex m_Mutex;
+    int        m_NumMembers;
+
+public:
+    nmfEstimationEnsemble() : m_NumMembers(0) {}
+    nmfEstimationEnsemble(const nmfEstimationEnsemble&) = delete;
+    nmfEstimationEnsemble& operator=(const nmfEstimationEnsemble&) = delete;
+
+    /**
+     * @brief Numbers a member and pushes it, waiting for room if the queue is full.
+     * The next member waits until this one is on the queue.
+     * @param Queue : the ensemble's result queue
+     * @param Result : the member's SubRunCompleted result
+     * @return Returns false (and drops the result) if the queue has been closed
+     */
+    bool push(nmfEstimationResultQueue& Queue,
+              std::unique_ptr<nmfEstimationResult> Result) {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        Result->RunNumber = m_NumMembers;
+        if (! Queue.push(std::move(Result))) {
+            return false;
+        }
+        ++m_NumMembers;
+        return true;
+    }
+    /**
+     * @brief Number of members pushed so far
+     */
+    int getNumMembers() {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        return m_NumMembers;
+    }
+};
@@ -0,0 +1,462 @@
+/**
+ * @file nmfInstrumentation.h
+ * @brief Definition of the per-phase timers and counters of the estimation hot path
+ *
+ * This file contains the nmfInstrumentationRecord, nmfInstrumentation and
+ * nmfInstrumentationScope classes and the NMF_INSTRUMENT_* macros. Every
+ * thread times its phases (parameter extraction, the model form terms,
+ * scaling, fitness, progress I/O, etc.) into a record of its own, so timing a
+ * scope never locks. The records are aggregated per run into a text summary
+ * and may be exported as a Chrome trace (chrome://tracing or Perfetto).
+ *
+ * The macros expand to nothing unless MSSPM_INSTRUMENTATION is defined (e.g.,
+ * qmake CONFIG+=instrumentation), so a release build pays nothing for them.
+ * The registry is a header-only singleton, so the libraries share it only
+ * where the loader merges inline statics (macOS and Linux, not Windows DLLs).
+ *
+ * @copyright
+ * Public Domain Notice\n
+ *
+ * National Oceanic And Atmospheric Administration\n\n
+ *
+ * This software is a "United States Government Work" under the terms of the
+ * United States Copyright Act.  It was written as part of the author's official
+ * duties as a United States Government employee/contractor and thus cannot be copyrighted.
+ * This software is freely available to the public for use. The National Oceanic
+ * And Atmospheric Administration and the U.S. Government have not placed any
+ * restriction on its use or reproduction.  Although all reasonable efforts have
+ * been taken to ensure the accuracy and reliability of the software and data,
+ * the National Oceanic And Atmospheric Administration and the U.S. Government
+ * do not and cannot warrant the performance or results that may be obtained
+ * by using this software or data. The National Oceanic And Atmospheric
+ * Administration and the U.S. Government disclaim all warranties, express
+ * or implied, including warranties of performance, merchantability or fitness
+ * for any particular purpose.\n\n
+ *
+ * Please cite the author(s) in any work or product based on this material.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief The timed phases. The model form terms and the guild aggregation are timed
+ * once per year of every evaluation, so they're aggregated but not traced.
+ */
+enum nmfInstrumentationPhase {
+    nmfPhaseObjectiveFunction,
+    nmfPhaseParameterExtraction,
+    nmfPhaseGrowth,
+    nmfPhaseHarvest,
+    nmfPhaseCompetition,
+    nmfPhasePredation,
+    nmfPhaseGuildAggregation,
+    nmfPhaseScaling,
+    nmfPhaseFitness,
+    nmfPhaseProgressIO,
+    nmfPhaseDatabaseWrite,
+    nmfPhaseChartRefresh,
+    nmfNumInstrumentationPhases
+};
+
+/**
+ * @brief The counted events
+ */
+enum nmfInstrumentationCounter {
+    nmfCounterEvaluations,
+    nmfCounterAbandonedEvaluations,
+    nmfCounterInvalidEvaluations,
+    nmfCounterProgressSamples,
+    nmfNumInstrumentationCounters
+};
+
+/**
+ * @brief Aggregated timing of one phase
+ */
+struct nmfInstrumentationPhaseStats {
+    long long Count;
+    long long TotalNs;
+    long long MinNs;
+    long long MaxNs;
+
+    nmfInstrumentationPhaseStats() :
+        Count(0), TotalNs(0), MinNs(std::numeric_limits<long long>::max()), MaxNs(0) {}
+
+    void add(const long long& DurationNs) {
+        ++Count;
+        TotalNs += DurationNs;
+        MinNs    = std::min(MinNs,DurationNs);
+        MaxNs    = std::max(MaxNs,DurationNs);
+    }
+    void merge(const nmfInstrumentationPhaseStats& Stats) {
+        Count   += Stats.Count;
+        TotalNs += Stats.TotalNs;
+        MinNs    = std::min(MinNs,Stats.MinNs);
+        MaxNs    = std::max(MaxNs,Stats.MaxNs);
+    }
+};
+
+/**
+ * @brief One traced scope
+ */
+struct nmfInstrumentationEvent {
+    nmfInstrumentationPhase Phase;
+    long long               StartNs;
+    long long               DurationNs;
+};
+
+/**
+ * @brief Timings and counts of one thread during one run. Only its own thread writes to it.
+ */
+class nmfInstrumentationRecord {
+
+public:
+    /**
+     * @brief Traced scopes kept per record; later ones are only aggregated
+     */
+    static const std::size_t MaxEvents = 1 << 17;
+
+    int RunId;
+    int ThreadNum;
+    std::array<nmfInstrumentationPhaseStats,nmfNumInstrumentationPhases> Phases;
+    std::array<long long,nmfNumInstrumentationCounters>                  Counters;
+    std::vector<nmfInstrumentationEvent>                                 Events;
+    long long NumDroppedEvents;
+
+    nmfInstrumentationRecord(const int& runId, const int& threadNum) :
+        RunId(runId), ThreadNum(threadNum), NumDroppedEvents(0) {
+        Counters.fill(0);
+    }
+
+    static bool isTraced(const nmfInstrumentationPhase& Phase) {
+        return (Phase != nmfPhaseGrowth)      && (Phase != nmfPhaseHarvest)   &&
+               (Phase != nmfPhaseCompetition) && (Phase != nmfPhasePredation) &&
+               (Phase != nmfPhaseGuildAggregation);
+    }
+
+    void add(const nmfInstrumentationPhase& Phase,
+             const long long& StartNs,
+             const long long& DurationNs) {
+        Phases[Phase].add(DurationNs);
+        if (isTraced(Phase)) {
+            if (Events.size() < MaxEvents) {
+                Events.push_back(nmfInstrumentationEvent{Phase,StartNs,DurationNs});
+            } else {
+                ++NumDroppedEvents;
+            }
+        }
+    }
+};
+
+/**
+ * @brief Process wide registry of instrumentation records. Each thread opens a record
+ * the first time it times a scope in a run; timing into an open record doesn't lock.
+ */
+class nmfInstrumentation {
+
+    typedef std::chrono::steady_clock Clock;
+
+    std::mutex                                             m_Mutex;
+    std::vector<std::unique_ptr<nmfInstrumentationRecord>> m_Records;
+    std::map<int,std::string>                              m_RunLabels; // by run id; clear() keeps only the current run's
+    std::atomic<int>                                       m_RunId;
+    int                                                    m_NumThreads;
+    Clock::time_point                                      m_Epoch;
+
+    nmfInstrumentation() : m_RunId(0), m_NumThreads(0), m_Epoch(Clock::now()) {}
+
+    static std::string escape(const std::string& Value) {
+        std::string escaped;
+        for (const char& c : Value) {
+            if ((c == '"') || (c == '\\')) {
+                escaped += '\\';
+            }
+            escaped += (static_cast<unsigned char>(c) < 0x20) ? ' ' : c;
+        }
+        return escaped;
+    }
+
+    // The caller must hold m_Mutex
+    std::string getRunLabel(const int& RunId) const {
+        std::map<int,std::string>::const_iterator label = m_RunLabels.find(RunId);
+        return (label != m_RunLabels.end()) ? label->second : "";
+    }
+
+    static const char* getPhaseName(const int& Phase) {
+        static const char* Names[nmfNumInstrumentationPhases] = {
+            "Objective Function","Parameter Extraction","Growth","Harvest",
+            "Competition","Predation","Guild Aggregation","Scaling","Fitness",
+            "Progress I/O","Database Write","Chart Refresh"};
+        return Names[Phase];
+    }
+
+    static const char* getCounterName(const int& Counter) {
+        static const char* Names[nmfNumInstrumentationCounters] = {
+            "Evaluations","Abandoned Evaluations","Invalid Evaluations","Progress Samples"};
+        return Names[Counter];
+    }
+
+public:
+    nmfInstrumentation(const nmfInstrumentation&) = delete;
+    nmfInstrumentation& operator=(const nmfInstrumentation&) = delete;
+
+    static nmfInstrumentation& instance() {
+        static nmfInstrumentation instrumentation;
+        return instrumentation;
+    }
+
+    /**
+     * @brief Nanoseconds since the registry was created
+     */
+    long long now() const {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now()-m_Epoch).count();
+    }
+
+    /**
+     * @brief Starts a new run. Every scope timed from now on, on any thread, belongs to it.
+     * @param Label : name of the run shown in the summary and the trace
+     * @return Returns the run's id
+     */
+    int beginRun(const std::string& Label) {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        const int runId = m_RunId.load(std::memory_order_relaxed)+1;
+        m_RunLabels[runId] = Label;
+        m_RunId.store(runId,std::memory_order_release);
+        return runId;
+    }
+
+    /**
+     * @brief Id of the current run, or 0 if no run has begun
+     */
+    int getRunId() const {
+        return m_RunId.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief The calling thread's record for the current run
+     * @return Returns nullptr if no run has begun
+     */
+    nmfInstrumentationRecord* getThreadRecord() {
+        // The run id is kept apart from the record, since clear() may have deleted an old run's record
+        thread_local nmfInstrumentationRecord* record = nullptr;
+        thread_local int recordRunId = 0;
+        const int runId = m_RunId.load(std::memory_order_acquire);
+
+        if (runId == 0) {
+            return nullptr;
+        }
+        if (recordRunId != runId) {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            // Thread numbers only have to tell the threads apart in the trace
+            m_Records.push_back(std::make_unique<nmfInstrumentationRecord>(runId,++m_NumThreads));
+            record      = m_Records.back().get();
+            recordRunId = runId;
+        }
+        return record;
+    }
+
+    /**
+     * @brief Adds to a counter of the calling thread's record
+     */
+    void count(const nmfInstrumentationCounter& Counter, const long long& Amount) {
+        nmfInstrumentationRecord* record = getThreadRecord();
+        if (record != nullptr) {
+            record->Counters[Counter] += Amount;
+        }
+    }
+
+    /**
+     * @brief Merges the records of a run. Only call once the run's threads have finished.
+     * @param RunId : id of the run
+     * @param Phases : the run's phase timings summed over its threads
+     * @param Counters : the run's counters summed over its threads
+     * @return Returns the number of threads that timed a scope in the run
+     */
+    int aggregate(const int& RunId,
+                  std::array<nmfInstrumentationPhaseStats,nmfNumInstrumentationPhases>& Phases,
+                  std::array<long long,nmfNumInstrumentationCounters>& Counters) {
+        int numThreads = 0;
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        Phases   = std::array<nmfInstrumentationPhaseStats,nmfNumInstrumentationPhases>();
+        Counters.fill(0);
+        for (const std::unique_ptr<nmfInstrumentationRecord>& record : m_Records) {
+            if (record->RunId == RunId) {
+                ++numThreads;
+                for (int phase=0; phase<nmfNumInstrumentationPhases; ++phase) {
+                    Phases[phase].merge(record->Phases[phase]);
+                }
+                for (int counter=0; counter<nmfNumInstrumentationCounters; ++counter) {
+                    Counters[counter] += record->Counters[counter];
+                }
+            }
+        }
+        return numThreads;
+    }
+
+    /**
+     * @brief Describes a run's timings as a fixed width text table. The times of a phase
+     * are summed over threads, and the phases nest (the terms are part of the objective
+     * function), so the totals may add up to more than the run's elapsed time.
+     * @param RunId : id of the run
+     * @return Returns the summary, one line per timed phase and counter
+     */
+    std::string getSummary(const int& RunId) {
+        std::array<nmfInstrumentationPhaseStats,nmfNumInstrumentationPhases> phases;
+        std::array<long long,nmfNumInstrumentationCounters> counters;
+        std::ostringstream summary;
+        char line[128];
+
+        int numThreads = aggregate(RunId,phases,counters);
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            summary << "Instrumentation: " << getRunLabel(RunId)
+                    << " (" << numThreads << " thread" << ((numThreads == 1) ? "" : "s") << ")\n";
+        }
+        std::snprintf(line,sizeof(line),"%-22s %12s %12s %12s %12s\n","Phase","Calls","Total (ms)","Mean (us)","Max (us)");
+        summary << line;
+        for (int phase=0; phase<nmfNumInstrumentationPhases; ++phase) {
+            const nmfInstrumentationPhaseStats& stats = phases[phase];
+            if (stats.Count > 0) {
+                std::snprintf(line,sizeof(line),"%-22s %12lld %12.3f %12.3f %12.3f\n",getPhaseName(phase),
+                              stats.Count,stats.TotalNs/1.0e6,stats.TotalNs/1.0e3/stats.Count,stats.MaxNs/1.0e3);
+                summary << line;
+            }
+        }
+        for (int counter=0; counter<nmfNumInstrumentationCounters; ++counter) {
+            std::snprintf(line,sizeof(line),"%-22s %12lld\n",getCounterName(counter),counters[counter]);
+            summary << line;
+        }
+        return summary.str();
+    }
+
+    /**
+     * @brief Writes a run's traced scopes in the Chrome trace event format. Only call once
+     * the run's threads have finished.
+     * @param RunId : id of the run
+     * @param Filename : name of the JSON file
+     * @return Returns false if the file couldn't be written
+     */
+    bool writeChromeTrace(const int& RunId, const std::string& Filename) {
+        std::array<nmfInstrumentationPhaseStats,nmfNumInstrumentationPhases> phases;
+        std::array<long long,nmfNumInstrumentationCounters> counters;
+        std::ofstream file(Filename);
+        long long endNs = 0;
+        long long numDropped = 0;
+        bool isFirst = true;
+        char event[256];
+
+        if (! file) {
+            return false;
+        }
+        aggregate(RunId,phases,counters);
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        const std::string label = escape(getRunLabel(RunId));
+        auto separator = [&]() -> const char* {
+            const char* retv = (isFirst) ? "\n" : ",\n";
+            isFirst = false;
+            return retv;
+        };
+
+        file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        file << separator() << "{\"ph\":\"M\",\"pid\":1,\"name\":\"process_name\",\"args\":{\"name\":\"MSSPM " << label << "\"}}";
+        for (const std::unique_ptr<nmfInstrumentationRecord>& record : m_Records) {
+            if (record->RunId != RunId) {
+                continue;
+            }
+            std::snprintf(event,sizeof(event),
+                          "{\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"name\":\"thread_name\",\"args\":{\"name\":\"Thread %d\"}}",
+                          record->ThreadNum,record->ThreadNum);
+            file << separator() << event;
+            for (const nmfInstrumentationEvent& traced : record->Events) {
+                std::snprintf(event,sizeof(event),
+                              "{\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"cat\":\"MSSPM\",\"name\":\"%s\",\"ts\":%.3f,\"dur\":%.3f}",
+                              record->ThreadNum,getPhaseName(traced.Phase),traced.StartNs/1.0e3,traced.DurationNs/1.0e3);
+                file << separator() << event;
+                endNs = std::max(endNs,traced.StartNs+traced.DurationNs);
+            }
+            numDropped += record->NumDroppedEvents;
+        }
+        // The counters are shown as one sample at the end of the run
+        file << separator() << "{\"ph\":\"C\",\"pid\":1,\"name\":\"Counters\",\"ts\":" << endNs/1.0e3 << ",\"args\":{";
+        for (int counter=0; counter<nmfNumInstrumentationCounters; ++counter) {
+            file << ((counter == 0) ? "" : ",") << "\"" << getCounterName(counter) << "\":" << counters[counter];
+        }
+        file << ",\"Untraced Scopes\":" << numDropped << "}}\n]}\n";
+
+        return bool(file);
+    }
+
+    /**
+     * @brief Throws away the records and labels of every run but the current one
+     */
+    void clear() {
+        const int runId = m_RunId.load(std::memory_order_acquire);
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        for (std::map<int,std::string>::iterator label=m_RunLabels.begin(); label!=m_RunLabels.end(); ) {
+            label = (label->first != runId) ? m_RunLabels.erase(label) : std::next(label);
+        }
+        m_Records.erase(std::remove_if(m_Records.begin(),m_Records.end(),
+                                       [&](const std::unique_ptr<nmfInstrumentationRecord>& record) {
+                                           return record->RunId != runId;
+                                       }),
+                        m_Records.end());
+    }
+};
+
+/**
+ * @brief Times the rest of the enclosing scope into the calling thread's record
+ */
+class nmfInstrumentationScope {
+
+    nmfInstrumentationRecord* m_Record;
+    nmfInstrumentationPhase   m_Phase;
+    long long                 m_StartNs;
+
+public:
+    explicit nmfInstrumentationScope(const nmfInstrumentationPhase& Phase) :
+        m_Record(nmfInstrumentation::instance().getThreadRecord()),
+        m_Phase(Phase),
+        m_StartNs((m_Record != nullptr) ? nmfInstrumentation::instance().now() : 0) {}
+    nmfInstrumentationScope(const nmfInstrumentationScope&) = delete;
+    nmfInstrumentationScope& operator=(const nmfInstrumentationScope&) = delete;
+
+    ~nmfInstrumentationScope() {
+        if (m_Record != nullptr) {
+            m_Record->add(m_Phase,m_StartNs,nmfInstrumentation::instance().now()-m_StartNs);
+        }
+    }
+};
+
+#ifdef MSSPM_INSTRUMENTATION
+#define NMF_INSTRUMENT_CONCAT_(a,b) a##b
+#define NMF_INSTRUMENT_CONCAT(a,b)  NMF_INSTRUMENT_CONCAT_(a,b)
+/**
+ * @brief Times the rest of the enclosing scope as the given phase
+ */
+#define NMF_INSTRUMENT_SCOPE(Phase) \
+    nmfInstrumentationScope NMF_INSTRUMENT_CONCAT(nmfInstrumentScope_,__LINE__)(Phase)
+/**
+ * @brief Adds Amount to the given counter
+ */
+#define NMF_INSTRUMENT_COUNT(Counter,Amount) \
+    nmfInstrumentation::instance().count(Counter,Amount)
+#else
+#define NMF_INSTRUMENT_SCOPE(Phase)          ((void)0)
+#define NMF_INSTRUMENT_COUNT(Counter,Amount) ((void)0)
+#endif
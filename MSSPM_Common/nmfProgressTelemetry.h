@@ -0,0 +1,239 @@
+/**
+ * @file nmfProgressTelemetry.h
+ * @brief Definition of the in-memory progress samples published by the estimators
+ *
+ * This file contains the nmfProgressRing, nmfProgressChannel and nmfProgressTelemetry
+ * classes. Every estimator thread publishes (run, evaluations, fitness, time) samples
+ * into its own single-producer/single-consumer ring buffer, and the progress chart
+ * drains all of the rings on its timer. Publishing a sample never locks or allocates.
+ *
+ * @copyright
+ * Public Domain Notice\n
+ *
+ * National Oceanic And Atmospheric Administration\n\n
+ *
+ * This software is a "United States Government Work" under the terms of the
+ * United States Copyright Act.  It was written as part of the author's official
+ * duties as a United States Government employee/contractor and thus cannot be copyrighted.
+ * This software is freely available to the public for use. The National Oceanic
+ * And Atmospheric Administration and the U.S. Government have not placed any
+ * restriction on its use or reproduction.  Although all reasonable efforts have
+ * been taken to ensure the accuracy and reliability of the software and data,
+ * the National Oceanic And Atmospheric Administration and the U.S. Government
+ * do not and cannot warrant the performance or results that may be obtained
+ * by using this software or data. The National Oceanic And Atmospheric
+ * Administration and the U.S. Government disclaim all warranties, express
+ * or implied, including warranties of performance, merchantability or fitness
+ * for any particular purpose.\n\n
+ *
+ * Please cite the author(s) in any work or product based on this material.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief One point on the progress chart
+ */
+struct nmfProgressSample {
+    /**
+     * @brief Estimator run number (the N in the "Run N-M" chart label)
+     */
+    int    RunNum;
+    /**
+     * @brief Sub-run number (the M in the "Run N-M" chart label). Concurrent
+     * sub-runs of the same run, such as Bees repetitions, each have their own.
+     */
+    int    SubRunNum;
+    /**
+     * @brief Number of objective function evaluations so far
+     */
+    long   NumEvals;
+    /**
+     * @brief Fitness to plot (already negated for Model Efficiency)
+     */
+    double BestFitness;
+    /**
+     * @brief Seconds since the publishing channel was opened
+     */
+    double ElapsedSeconds;
+};
+
+/**
+ * @brief Fixed size single-producer/single-consumer ring buffer. push() may only be
+ * called from one thread and drain() from one other thread. Neither locks.
+ */
+template<class T, std::size_t Capacity>
+class nmfProgressRing {
+
+    static_assert((Capacity > 0) && ((Capacity & (Capacity-1)) == 0),
+                  "nmfProgressRing capacity must be a power of two");
+
+    static const std::size_t CacheLineSize = 64;
+
+    std::atomic<std::size_t> m_Head;
+    char                     m_HeadPad[CacheLineSize-sizeof(std::atomic<std::size_t>)];
+    std::size_t              m_TailCache; // producer's last look at m_Tail
+    char                     m_TailCachePad[CacheLineSize-sizeof(std::size_t)];
+    std::atomic<std::size_t> m_Tail;
+    char                     m_TailPad[CacheLineSize-sizeof(std::atomic<std::size_t>)];
+    std::atomic<long>        m_NumDropped;
+    std::array<T,Capacity>   m_Items;
+
+public:
+    nmfProgressRing() : m_Head(0), m_TailCache(0), m_Tail(0), m_NumDropped(0) {}
+    nmfProgressRing(const nmfProgressRing&) = delete;
+    nmfProgressRing& operator=(const nmfProgressRing&) = delete;
+
+    /**
+     * @brief Appends an item (producer thread only). The item is dropped if the
+     * consumer has fallen a full ring behind.
+     * @param Item : item to append
+     * @return Returns false if the ring was full and the item was dropped
+     */
+    bool push(const T& Item) {
+        const std::size_t head = m_Head.load(std::memory_order_relaxed);
+        if (head-m_TailCache == Capacity) {
+            m_TailCache = m_Tail.load(std::memory_order_acquire);
+            if (head-m_TailCache == Capacity) {
+                m_NumDropped.fetch_add(1,std::memory_order_relaxed);
+                return false;
+            }
+        }
+        m_Items[head & (Capacity-1)] = Item;
+        m_Head.store(head+1,std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Moves every item published so far to the end of Items (consumer thread only)
+     * @param Items : vector the items are appended to
+     * @return Returns the number of items appended
+     */
+    std::size_t drain(std::vector<T>& Items) {
+        const std::size_t tail = m_Tail.load(std::memory_order_relaxed);
+        const std::size_t head = m_Head.load(std::memory_order_acquire);
+        for (std::size_t i=tail; i!=head; ++i) {
+            Items.push_back(m_Items[i & (Capacity-1)]);
+        }
+        m_Tail.store(head,std::memory_order_release);
+        return head-tail;
+    }
+
+    /**
+     * @brief Number of items dropped because the ring was full
+     */
+    long getNumDropped() const {
+        return m_NumDropped.load(std::memory_order_relaxed);
+    }
+};
+
+/**
+ * @brief Progress ring owned by a single publishing thread (e.g., one NLopt sub-run)
+ */
+class nmfProgressChannel {
+
+    nmfProgressRing<nmfProgressSample,1024> m_Ring;
+    std::chrono::steady_clock::time_point  m_StartTime;
+    std::atomic<bool>                      m_isClosed;
+
+public:
+    nmfProgressChannel() : m_StartTime(std::chrono::steady_clock::now()), m_isClosed(false) {}
+
+    /**
+     * @brief Publishes a sample (publishing thread only)
+     * @param RunNum : estimator run number
+     * @param NumEvals : number of objective function evaluations so far
+     * @param BestFitness : fitness to plot
+     * @param SubRunNum : sub-run number, so concurrent sub-runs are plotted as separate series
+     */
+    void publish(const int& RunNum, const long& NumEvals, const double& BestFitness,
+                 const int& SubRunNum = 1) {
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now()-m_StartTime;
+        m_Ring.push(nmfProgressSample{RunNum,SubRunNum,NumEvals,BestFitness,elapsed.count()});
+    }
+    /**
+     * @brief Marks the channel as finished. It's released once its last samples are drained.
+     */
+    void close() {
+        m_isClosed.store(true,std::memory_order_release);
+    }
+    bool isClosed() const {
+        return m_isClosed.load(std::memory_order_acquire);
+    }
+    std::size_t drain(std::vector<nmfProgressSample>& Samples) {
+        return m_Ring.drain(Samples);
+    }
+    long getNumDropped() const {
+        return m_Ring.getNumDropped();
+    }
+};
+
+/**
+ * @brief Process wide registry of progress channels. Opening and draining take a
+ * mutex on the channel list; publishing into an open channel doesn't.
+ */
+class nmfProgressTelemetry {
+
+    std::mutex                                       m_Mutex;
+    std::vector<std::shared_ptr<nmfProgressChannel>> m_Channels;
+
+    nmfProgressTelemetry() = default;
+
+public:
+    nmfProgressTelemetry(const nmfProgressTelemetry&) = delete;
+    nmfProgressTelemetry& operator=(const nmfProgressTelemetry&) = delete;
+
+    static nmfProgressTelemetry& instance() {
+        static nmfProgressTelemetry telemetry;
+        return telemetry;
+    }
+
+    /**
+     * @brief Opens a channel for the calling producer
+     * @return Returns the new channel. Call close() on it when the producer finishes.
+     */
+    std::shared_ptr<nmfProgressChannel> openChannel() {
+        std::shared_ptr<nmfProgressChannel> channel = std::make_shared<nmfProgressChannel>();
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Channels.push_back(channel);
+        return channel;
+    }
+
+    /**
+     * @brief Appends the samples published since the last call to Samples and releases
+     * channels that are closed and empty (consumer thread only)
+     * @param Samples : vector the new samples are appended to
+     * @return Returns the number of samples appended
+     */
+    std::size_t drain(std::vector<nmfProgressSample>& Samples) {
+        std::size_t numDrained = 0;
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        for (unsigned i=0; i<m_Channels.size(); ) {
+            // Check before draining so samples published just before close() aren't lost
+            bool isClosed = m_Channels[i]->isClosed();
+            numDrained += m_Channels[i]->drain(Samples);
+            if (isClosed) {
+                m_Channels.erase(m_Channels.begin()+i);
+            } else {
+                ++i;
+            }
+        }
+        return numDrained;
+    }
+
+    /**
+     * @brief Throws away everything published so far (e.g., when the chart is cleared)
+     */
+    void discard() {
+        std::vector<nmfProgressSample> unused;
+        drain(unused);
+    }
+};
@@ -0,0 +1,155 @@
+/**
+ * @file nmfRandom.h
+ * @brief Definition of the counter-based random number streams
+ *
+ * This file contains the nmfRandom class. A draw is a pure function of a 64 bit
+ * seed and a (run, repetition, stream, draw) counter, computed with the Philox4x32-10
+ * block cipher (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3"). So
+ * any thread may draw any number without drawing the ones before it, and a run
+ * that's split over threads gets exactly the numbers it would get on one thread.
+ * Every stochastic part of an estimation or forecast keys its draws this way; with
+ * the Deterministic box checked the seed is fixed and the results are bit
+ * identical from one run to the next.
+ *
+ * @copyright
+ * Public Domain Notice\n
+ *
+ * National Oceanic And Atmospheric Administration\n\n
+ *
+ * This software is a "United States Government Work" under the terms of the
+ * United States Copyright Act.  It was written as part of the author's official
+ * duties as a United States Government employee/contractor and thus cannot be copyrighted.
+ * This software is freely available to the public for use. The National Oceanic
+ * And Atmospheric Administration and the U.S. Government have not placed any
+ * restriction on its use or reproduction.  Although all reasonable efforts have
+ * been taken to ensure the accuracy and reliability of the software and data,
+ * the National Oceanic And Atmospheric Administration and the U.S. Government
+ * do not and cannot warrant the performance or results that may be obtained
+ * by using this software or data. The National Oceanic And Atmospheric
+ * Administration and the U.S. Government disclaim all warranties, express
+ * or implied, including warranties of performance, merchantability or fitness
+ * for any particular purpose.\n\n
+ *
+ * Please cite the author(s) in any work or product based on this material.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <random>
+
+/**
+ * @brief A stream of random numbers keyed by (seed, run, repetition, stream)
+ *
+ * The stream's draws are numbered from 0. Successive blocks of the Philox output
+ * give four 32 bit or two 64 bit numbers each; a uniform double uses 64 bits.
+ */
+class nmfRandom {
+
+    std::uint32_t m_Key[2];
+    std::uint32_t m_Counter[4];
+    std::uint32_t m_Block[4];
+    int           m_NumUsed;
+
+    static void mulhilo(const std::uint32_t& a, const std::uint32_t& b,
+                        std::uint32_t& hi, std::uint32_t& lo) {
+        std::uint64_t product = std::uint64_t(a) * b;
+        hi = std::uint32_t(product >> 32);
+        lo = std::uint32_t(product);
+    }
+
+    void generateBlock() {
+        std::uint32_t k0 = m_Key[0];
+        std::uint32_t k1 = m_Key[1];
+        std::uint32_t hi0, lo0, hi1, lo1;
+
+        for (int i=0; i<4; ++i) {
+            m_Block[i] = m_Counter[i];
+        }
+        for (int round=0; round<10; ++round) {
+            mulhilo(0xD2511F53u,m_Block[0],hi0,lo0);
+            mulhilo(0xCD9E8D57u,m_Block[2],hi1,lo1);
+            m_Block[0] = hi1 ^ m_Block[1] ^ k0;
+            m_Block[1] = lo1;
+            m_Block[2] = hi0 ^ m_Block[3] ^ k1;
+            m_Block[3] = lo0;
+            k0 += 0x9E3779B9u;
+            k1 += 0xBB67AE85u;
+        }
+        m_NumUsed = 0;
+        ++m_Counter[3];
+    }
+
+public:
+    /**
+     * @brief Creates the stream
+     * @param Seed : the seed
+     * @param Run : run number (e.g., the multi-run line or Monte Carlo run)
+     * @param Repetition : repetition or sub-run number within the run
+     * @param Stream : stream within the repetition (e.g., a bee, or a generation's bee)
+     */
+    nmfRandom(const std::uint64_t& Seed,
+              const std::uint32_t& Run = 0,
+              const std::uint32_t& Repetition = 0,
+              const std::uint32_t& Stream = 0) {
+        m_Key[0]     = std::uint32_t(Seed);
+        m_Key[1]     = std::uint32_t(Seed >> 32);
+        m_Counter[0] = Run;
+        m_Counter[1] = Repetition;
+        m_Counter[2] = Stream;
+        m_Counter[3] = 0;
+        m_NumUsed    = 4;
+    }
+
+    /**
+     * @brief Gets the seed of a run. Deterministic runs all use the same seed: their
+     * runs, repetitions and streams are told apart by their counters, so they don't
+     * need seeds of their own. Other runs get one from the system's nondeterministic source.
+     * @param isSetToDeterministic : true if the Deterministic box is checked
+     */
+    static std::uint64_t getSeed(const bool& isSetToDeterministic) {
+        if (isSetToDeterministic) {
+            return 1;
+        }
+        std::random_device rd;
+        return (std::uint64_t(rd()) << 32) | rd();
+    }
+
+    /**
+     * @brief Gets the next 32 random bits
+     */
+    std::uint32_t getNext32() {
+        if (m_NumUsed == 4) {
+            generateBlock();
+        }
+        return m_Block[m_NumUsed++];
+    }
+
+    /**
+     * @brief Gets the next 64 random bits
+     */
+    std::uint64_t getNext64() {
+        std::uint64_t hi = getNext32();
+        return (hi << 32) | getNext32();
+    }
+
+    /**
+     * @brief Gets the next number drawn uniformly from [Min,Max)
+     */
+    double getUniform(const double& Min, const double& Max) {
+        return Min + (Max-Min) * double(getNext64() >> 11) / 9007199254740992.0; // 2^53
+    }
+
+    /**
+     * @brief Gets a number drawn uniformly from [Min,Max) by the first draw of a stream
+     */
+    static double getUniform(const std::uint64_t& Seed,
+                             const std::uint32_t& Run,
+                             const std::uint32_t& Repetition,
+                             const std::uint32_t& Stream,
+                             const double& Min,
+                             const double& Max) {
+        nmfRandom Random(Seed,Run,Repetition,Stream);
+        return Random.getUniform(Min,Max);
+    }
+};
@@ -0,0 +1,100 @@
+#-------------------------------------------------
+#
+# MSSPM_Core: model loading, estimation, simulation and
+# statistics without any widgets
+#
+#-------------------------------------------------
+
+# widgets is only needed by the shared library headers
+QT      -= gui
+QT      += widgets sql concurrent
+
+TARGET = MSSPM_Core
+TEMPLATE = lib
+CONFIG += c++14
+
+DEFINES += MSSPM_CORE_LIBRARY
+
+# The following define makes your compiler emit warnings if you use
+# any feature of Qt which as been marked as deprecated (the exact warnings
+# depend on your compiler). Please consult the documentation of the
+# deprecated API in order to know how to port your code away from it.
+DEFINES += QT_DEPRECATED_WARNINGS
+
+# Build with qmake CONFIG+=instrumentation to time the estimation phases (see nmfInstrumentation.h)
+CONFIG(instrumentation): DEFINES += MSSPM_INSTRUMENTATION
+
+SOURCES += \
+    nmfCoreDiagnostics.cpp \
+    nmfCoreEngine.cpp \
+    nmfCoreEnsembleDispatcher.cpp \
+    nmfCoreModelLoader.cpp \
+    nmfCoreResultWriter.cpp \
+    nmfCoreSimulator.cpp \
+    nmfCoreStatistics.cpp
+
+HEADERS += \
+    nmfCoreDiagnostics.h \
+    nmfCoreEngine.h \
+    nmfCoreEnsembleDispatcher.h \
+    nmfCoreModelLoader.h \
+    nmfCoreResultWriter.h \
+    nmfCoreSimulator.h \
+    nmfCoreStatistics.h
+
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
+
+INCLUDEPATH += /Users/hiro/Downloads/boost_1_76_0
+win32:CONFIG(release, debug|release): LIBS += -L$$PWD/../../../../../../usr/local/lib/release/ -lnlopt.0.11.0
+else:win32:CONFIG(debug, debug|release): LIBS += -L$$PWD/../../../../../../usr/local/lib/debug/ -lnlopt.0.11.0
+else:unix: LIBS += -L$$PWD/../../../../../../usr/local/lib/ -lnlopt.0.11.0
+
+INCLUDEPATH += $$PWD/../../../../../../usr/local/include
+DEPENDPATH += $$PWD/../../../../../../usr/local/include
+
+win32:CONFIG(release, debug|release): LIBS += -L$$PWD/../../../builds/build-nmfUtilities-Desktop_Qt_5_15_2_clang_64bit-Release/release/ -lnmfUtilities.1.0.0
+else:win32:CONFIG(debug, debug|release): LIBS += -L$$PWD/../../../builds/build-nmfUtilities-Desktop_Qt_5_15_2_clang_64bit-Release/debug/ -lnmfUtilities.1.0.0
+else:unix: LIBS += -L$$PWD/../../../builds/build-nmfUtilities-Desktop_Qt_5_15_2_clang_64bit-Release/ -lnmfUtilities.1.0.0
+
+INCLUDEPATH += $$PWD/../../nmfSharedUtilities/nmfUtilities
+DEPENDPATH += $$PWD/../../nmfSharedUtilities/nmfUtilities
+
+win32:CONFIG(release, debug|release): LIBS += -L$$PWD/../../../builds/build-nmfDatabase-Desktop_Qt_5_15_2_clang_64bit-Release/release/ -lnmfDatabase.1.0.0
+else:win32:CONFIG(debug, debug|release): LIBS += -L$$PWD/../../../builds/build-nmfDatabase-Desktop_Qt_5_15_2_clang_64bit-Release/debug/ -lnmfDatabase.1.0.0
+else:unix: LIBS += -L$$PWD/../../../builds/build-nmfDatabase-Desktop_Qt_5_15_2_clang_64bit-Release/ -lnmfDatabase.1.0.0
+
+INCLUDEPATH += $$PWD/../../nmfSharedUtilities/nmfDatabase
+DEPENDPATH += $$PWD/../../nmfSharedUtilities/nmfDatabase
+
+win32:CONFIG(release, debug|release): LIBS += -L$$PWD/../../../builds/build-BeesAlgorithm-Desktop_Qt_5_15_2_clang_64bit-Release/release/ -lBeesAlgorithm.1.0.0
+else:win32:CONFIG(debug, debug|release): LIBS += -L$$PWD/../../../builds/build-BeesAlgorithm-Desktop_Qt_5_15_2_clang_64bit-Release/debug/ -lBeesAlgorithm.1.0.0
+else:unix: LIBS += -L$$PWD/../../../builds/build-BeesAlgorithm-Desktop_Qt_5_15_2_clang_64bit-Release/ -lBeesAlgorithm.1.0.0
+
+INCLUDEPATH += $$PWD/../../nmfSharedUtilities/BeesAlgorithm
+DEPENDPATH += $$PWD/../../nmfSharedUtilities/BeesAlgorithm
+
+win32:CONFIG(release, debug|release): LIBS += -L$$PWD/../../../builds/build-nmfModels-Desktop_Qt_5_15_2_clang_64bit-Release/release/ -lnmfModels.1.0.0
+else:win32:CONFIG(debug, debug|release): LIBS += -L$$PWD/../../../builds/build-nmfModels-Desktop_Qt_5_15_2_clang_64bit-Release/debug/ -lnmfModels.1.0.0
+else:unix: LIBS += -L$$PWD/../../../builds/build-nmfModels-Desktop_Qt_5_15_2_clang_64bit-Release/ -lnmfModels.1.0.0
+
+INCLUDEPATH += $$PWD/../../nmfSharedUtilities/nmfModels
+DEPENDPATH += $$PWD/../../nmfSharedUtilities/nmfModels
+
+win32:CONFIG(release, debug|release): LIBS += -L$$PWD/../../../builds/build-MSSPM_ParameterEstimationNLoptAlgorithm-Desktop_Qt_5_15_2_clang_64bit-Release/release/ -lMSSPM_ParameterEstimationNLoptAlgorithm.1.0.0
+else:win32:CONFIG(debug, debug|release): LIBS += -L$$PWD/../../../builds/build-MSSPM_ParameterEstimationNLoptAlgorithm-Desktop_Qt_5_15_2_clang_64bit-Release/debug/ -lMSSPM_ParameterEstimationNLoptAlgorithm.1.0.0
+else:unix: LIBS += -L$$PWD/../../../builds/build-MSSPM_ParameterEstimationNLoptAlgorithm-Desktop_Qt_5_15_2_clang_64bit-Release/ -lMSSPM_ParameterEstimationNLoptAlgorithm.1.0.0
+
+INCLUDEPATH += $$PWD/../MSSPM_ParameterEstimationNLoptAlgorithm
+DEPENDPATH += $$PWD/../MSSPM_ParameterEstimationNLoptAlgorithm
+
+win32:CONFIG(release, debug|release): LIBS += -L$$PWD/../../../builds/build-MSSPM_ParameterEstimationBeesAlgorithm-Desktop_Qt_5_15_2_clang_64bit-Release/release/ -lMSSPM_ParameterEstimationBeesAlgorithm.1.0.0
+else:win32:CONFIG(debug, debug|release): LIBS += -L$$PWD/../../../builds/build-MSSPM_ParameterEstimationBeesAlgorithm-Desktop_Qt_5_15_2_clang_64bit-Release/debug/ -lMSSPM_ParameterEstimationBeesAlgorithm.1.0.0
+else:unix: LIBS += -L$$PWD/../../../builds/build-MSSPM_ParameterEstimationBeesAlgorithm-Desktop_Qt_5_15_2_clang_64bit-Release/ -lMSSPM_ParameterEstimationBeesAlgorithm.1.0.0
+
+INCLUDEPATH += $$PWD/../MSSPM_ParameterEstimationBeesAlgorithm
+DEPENDPATH += $$PWD/../MSSPM_ParameterEstimationBeesAlgorithm
+
+INCLUDEPATH += $$PWD/../MSSPM_Common
+DEPENDPATH += $$PWD/../MSSPM_Common
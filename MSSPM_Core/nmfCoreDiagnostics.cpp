@@ -0,0 +1,144 @@
+
+#include "nmfCoreDiagnostics.h"
+#include "NLopt_Batch.h"
+#include "NLopt_Estimator.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+bool
+nmfCoreDiagnostics::packEstimates(const NLopt_ParameterLayout& Layout,
+                                  const nmfEstimationResult& Estimates,
+                                  std::vector<double>& Parameters,
+                                  std::string& ErrorMsg)
+{
+    bool isValid = true;
+
+    // The inverse of NLopt_Estimator::extractParameters
+    auto packVector = [&](const NLopt_ParameterBlock& Block,
+                          const std::vector<double>& Values) {
+        if (! Block.isPresent()) {
+            return;
+        }
+        if (int(Values.size()) != Block.size()) {
+            isValid = false;
+            return;
+        }
+        std::copy(Values.begin(),Values.end(),Parameters.begin()+Block.Offset);
+    };
+    auto packMatrix = [&](const NLopt_ParameterBlock& Block,
+                          const boost::numeric::ublas::matrix<double>& Values) {
+        if (! Block.isPresent()) {
+            return;
+        }
+        if ((int(Values.size1()) != Block.Rows) || (int(Values.size2()) != Block.Cols)) {
+            isValid = false;
+            return;
+        }
+        for (int i=0; i<Block.Rows; ++i) {
+            for (int j=0; j<Block.Cols; ++j) {
+                Parameters[Block.Offset+i*Block.Cols+j] = Values(i,j);
+            }
+        }
+    };
+
+    Parameters.assign(Layout.NumParameters,0.0);
+    packVector(Layout.InitBiomass,                Estimates.EstInitBiomass);
+    packVector(Layout.GrowthRate,                 Estimates.EstGrowthRates);
+    packVector(Layout.CarryingCapacity,           Estimates.EstCarryingCapacities);
+    packVector(Layout.Catchability,               Estimates.EstCatchability);
+    packMatrix(Layout.CompetitionAlpha,           Estimates.EstCompetitionAlpha);
+    packMatrix(Layout.CompetitionBetaSpecies,     Estimates.EstCompetitionBetaSpecies);
+    packMatrix(Layout.CompetitionBetaGuilds,      Estimates.EstCompetitionBetaGuilds);
+    packMatrix(Layout.CompetitionBetaGuildsGuilds,Estimates.EstCompetitionBetaGuildsGuilds);
+    packMatrix(Layout.PredationRho,               Estimates.EstPredationRho);
+    packMatrix(Layout.PredationHandling,          Estimates.EstPredationHandling);
+    packVector(Layout.PredationExponent,          Estimates.EstPredationExponent);
+    packVector(Layout.SurveyQ,                    Estimates.EstSurveyQ);
+
+    if (! isValid) {
+        ErrorMsg = "nmfCoreDiagnostics: The estimates don't match the model's size";
+    }
+    return isValid;
+}
+
+bool
+nmfCoreDiagnostics::calculateParameterProfiles(
+        const nmfStructsQt::ModelDataStruct& dataStruct,
+        const nmfEstimationResult&           Estimates,
+        const int&                           PctVariation,
+        const int&                           NumPoints,
+        std::vector<nmfCoreProfilePoint>&    Points,
+        std::string&                         ErrorMsg)
+{
+    const int NumCandidates = 2*NumPoints+1;
+    double estimate;
+    double startVal;
+    double inc;
+    nmfCoreProfilePoint Point;
+    NLopt_EvaluationContext Context;
+    std::vector<double> Parameters;
+    std::vector<double> Candidates;
+    std::vector<double> Fitness(NumCandidates);
+    std::vector<std::pair<double,double> > ParameterRanges;
+    std::unique_ptr<nmfGrowthForm>      GrowthForm      = std::make_unique<nmfGrowthForm>(     dataStruct.GrowthForm);
+    std::unique_ptr<nmfHarvestForm>     HarvestForm     = std::make_unique<nmfHarvestForm>(    dataStruct.HarvestForm);
+    std::unique_ptr<nmfCompetitionForm> CompetitionForm = std::make_unique<nmfCompetitionForm>(dataStruct.CompetitionForm);
+    std::unique_ptr<nmfPredationForm>   PredationForm   = std::make_unique<nmfPredationForm>(  dataStruct.PredationForm);
+
+    Points.clear();
+    if ((PctVariation <= 0) || (NumPoints <= 0)) {
+        ErrorMsg = "nmfCoreDiagnostics: The percent variation and number of points must be positive";
+        return false;
+    }
+
+    NLopt_Estimator::initializeEvaluationContext(dataStruct,0,
+                                                 GrowthForm.get(),HarvestForm.get(),
+                                                 CompetitionForm.get(),PredationForm.get(),
+                                                 Context);
+    NLopt_Estimator::loadParameterRanges(ParameterRanges,dataStruct);
+    Context.Layout.initializePatterns(ParameterRanges);
+    if (! packEstimates(Context.Layout,Estimates,Parameters,ErrorMsg)) {
+        return false;
+    }
+    NLopt_Estimator::verifyKernels(Context,Parameters);
+
+    const std::vector<std::pair<std::string,NLopt_ParameterBlock> > Profiles = {
+        {"InitBiomass",      Context.Layout.InitBiomass},
+        {"GrowthRate",       Context.Layout.GrowthRate},
+        {"CarryingCapacity", Context.Layout.CarryingCapacity},
+        {"Catchability",     Context.Layout.Catchability},
+        {"SurveyQ",          Context.Layout.SurveyQ}
+    };
+
+    // Every candidate starts as the estimates, then each profile only varies its one parameter
+    Candidates.resize(Parameters.size()*NumCandidates);
+    for (unsigned p=0; p<Parameters.size(); ++p) {
+        std::fill(Candidates.begin()+p*NumCandidates,Candidates.begin()+(p+1)*NumCandidates,Parameters[p]);
+    }
+    for (const std::pair<std::string,NLopt_ParameterBlock>& Profile : Profiles) {
+        const NLopt_ParameterBlock& Block = Profile.second;
+        for (int i=0; i<Block.size(); ++i) {
+            double* candidates = &Candidates[(Block.Offset+i)*NumCandidates];
+            estimate = Parameters[Block.Offset+i];
+            startVal = estimate * (1.0-PctVariation/100.0);
+            inc      = (estimate - startVal)/NumPoints;
+            for (int k=0; k<NumCandidates; ++k) {
+                candidates[k] = startVal + k*inc;
+            }
+            NLopt_Batch::evaluate(Context,Candidates.data(),int(Parameters.size()),NumCandidates,Fitness.data());
+            for (int k=0; k<NumCandidates; ++k) {
+                Point.Parameter      = Profile.first;
+                Point.SpeciesOrGuild = i;
+                Point.Offset         = candidates[k] - estimate;
+                Point.Value          = candidates[k];
+                Point.Fitness        = Fitness[k];
+                Points.push_back(Point);
+            }
+            std::fill(candidates,candidates+NumCandidates,estimate);
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,90 @@
+/**
+ * @file nmfCoreDiagnostics.h
+ * @brief Definition for the parameter profile diagnostic of the MSSPM core library
+ *
+ * This file contains the definition for nmfCoreDiagnostics. It calculates the
+ * same single parameter profiles as the Diagnostics tab: each estimated vector
+ * parameter is varied by up to a given percent on either side of its estimate,
+ * one species (or guild) at a time, and the model's fitness is calculated at
+ * every point. It only reads its arguments, so it may be run on any thread.
+ *
+ * @copyright
+ * Public Domain Notice\n
+ *
+ * National Oceanic And Atmospheric Administration\n\n
+ *
+ * This software is a "United States Government Work" under the terms of the
+ * United States Copyright Act.  It was written as part of the author's official
+ * duties as a United States Government employee/contractor and thus cannot be copyrighted.
+ * This software is freely available to the public for use. The National Oceanic
+ * And Atmospheric Administration and the U.S. Government have not placed any
+ * restriction on its use or reproduction.  Although all reasonable efforts have
+ * been taken to ensure the accuracy and reliability of the software and data,
+ * the National Oceanic And Atmospheric Administration and the U.S. Government
+ * do not and cannot warrant the performance or results that may be obtained
+ * by using this software or data. The National Oceanic And Atmospheric
+ * Administration and the U.S. Government disclaim all warranties, express
+ * or implied, including warranties of performance, merchantability or fitness
+ * for any particular purpose.\n\n
+ *
+ * Please cite the author(s) in any work or product based on this material.
+ */
+
+#pragma once
+
+#include "nmfEstimationResult.h"
+#include "nmfStructsQt.h"
+#include "NLopt_ParameterLayout.h"
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief The fitness of one point of a parameter profile
+ */
+struct nmfCoreProfilePoint {
+    /**
+     * @brief InitBiomass, GrowthRate, CarryingCapacity, Catchability or SurveyQ
+     */
+    std::string Parameter;
+    int         SpeciesOrGuild;
+    /**
+     * @brief Difference between the point's value and the estimate
+     */
+    double      Offset;
+    double      Value;
+    double      Fitness;
+};
+
+/**
+ * @brief Calculates the parameter profiles of a run's estimates
+ */
+class nmfCoreDiagnostics
+{
+    static bool packEstimates(const NLopt_ParameterLayout& Layout,
+                              const nmfEstimationResult& Estimates,
+                              std::vector<double>& Parameters,
+                              std::string& ErrorMsg);
+
+public:
+    /**
+     * @brief Calculates the profile of every vector parameter the model uses (initial
+     * biomass, growth rate, carrying capacity, catchability and survey Q). The fitness
+     * is NLopt's objective function with the model's objective criterion and scaling,
+     * whichever algorithm made the estimates.
+     * @param dataStruct : the model the estimates are for (as filled by nmfCoreModelLoader)
+     * @param Estimates : the run's estimated parameters
+     * @param PctVariation : how far (in percent of the estimate) each profile reaches on either side
+     * @param NumPoints : number of points on either side of the estimate
+     * @param Points : the 2*NumPoints+1 points of each profile, parameter by parameter and species by species
+     * @param ErrorMsg : why the profiles couldn't be calculated
+     * @return Returns false if the estimates don't match the model
+     */
+    static bool calculateParameterProfiles(
+            const nmfStructsQt::ModelDataStruct& dataStruct,
+            const nmfEstimationResult&           Estimates,
+            const int&                           PctVariation,
+            const int&                           NumPoints,
+            std::vector<nmfCoreProfilePoint>&    Points,
+            std::string&                         ErrorMsg);
+};
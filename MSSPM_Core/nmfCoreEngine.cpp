@@ -0,0 +1,368 @@
+
+#include "nmfCoreEngine.h"
+#include "nmfCoreEnsembleDispatcher.h"
+#include "nmfCoreResultWriter.h"
+#include "Bees_Estimator.h"
+#include "NLopt_Estimator.h"
+
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent>
+
+#include <algorithm>
+
+std::atomic<int> nmfCoreEngine::m_ConnectionCounter(0);
+
+nmfCoreEngine::nmfCoreEngine(nmfLogger* logger,
+                             const nmfCoreDatabaseSettings& Settings)
+{
+    m_Logger   = logger;
+    m_Settings = Settings;
+}
+
+template <class Function>
+bool
+nmfCoreEngine::withDatabase(Function function) const
+{
+    bool isOK = false;
+
+    // Qt connections may only be used by the thread that made them, so every call
+    // makes its own and removes it again once the loader is done with it.
+    QString connectionName = "nmfCoreEngine_" + QString::number(++m_ConnectionCounter);
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QMYSQL",connectionName);
+        db.setHostName(QString::fromStdString(m_Settings.Host));
+        db.setUserName(QString::fromStdString(m_Settings.User));
+        db.setPassword(QString::fromStdString(m_Settings.Password));
+        if (db.open()) {
+            nmfDatabase database;
+            database.nmfSetConnectionByName(connectionName);
+            database.nmfSetDatabase(m_Settings.ProjectDatabase);
+            isOK = function(database);
+            db.close();
+        } else {
+            nmfCoreModelLoader::logMsg(m_Logger,nmfConstants::Error,
+                                       "nmfCoreEngine: " + db.lastError().text().toStdString());
+        }
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+
+    return isOK;
+}
+
+template <class Loader>
+bool
+nmfCoreEngine::withLoader(const std::string& SystemName,
+                          Loader load) const
+{
+    return withDatabase([this,&SystemName,&load](nmfDatabase& database) {
+        nmfCoreModelLoader loader(&database,m_Logger,SystemName);
+        return load(loader);
+    });
+}
+
+bool
+nmfCoreEngine::loadModel(const std::string& SystemName,
+                         const std::vector<std::string>& EstimatedParameters,
+                         nmfCoreModel& Model) const
+{
+    nmfStructsQt::EstimateRunBox runBox;
+
+    Model = nmfCoreModel();
+    Model.SystemName = SystemName;
+    for (const std::string& Parameter : EstimatedParameters) {
+        runBox.parameter = Parameter;
+        runBox.state     = std::make_pair(true,true);
+        Model.dataStruct.EstimateRunBoxes.push_back(runBox);
+    }
+
+    Model.isLoaded = withLoader(SystemName,[&Model](nmfCoreModelLoader& loader) {
+        if (! loader.loadParameters(Model.dataStruct)) {
+            return false;
+        }
+        Model.SpeciesNames = loader.getSpeciesNames();
+        Model.GuildNames   = loader.getGuildNames();
+        Model.StartYear    = loader.getStartYear();
+        return true;
+    });
+
+    return Model.isLoaded;
+}
+
+QFuture<nmfCoreModel>
+nmfCoreEngine::loadModelAsync(const std::string& SystemName,
+                              const std::vector<std::string>& EstimatedParameters) const
+{
+    return QtConcurrent::run([this,SystemName,EstimatedParameters]() {
+        nmfCoreModel Model;
+        loadModel(SystemName,EstimatedParameters,Model);
+        return Model;
+    });
+}
+
+bool
+nmfCoreEngine::loadForecast(const nmfCoreModel& Model,
+                            const std::string& ForecastName,
+                            nmfCoreModel& ForecastModel) const
+{
+    ForecastModel = Model;
+    ForecastModel.isLoaded = Model.isLoaded && withLoader(Model.SystemName,[&ForecastName,&ForecastModel](nmfCoreModelLoader& loader) {
+        return loader.loadForecast(ForecastName,ForecastModel.dataStruct);
+    });
+
+    return ForecastModel.isLoaded;
+}
+
+bool
+nmfCoreEngine::saveEstimates(const nmfCoreModel& Model,
+                             const nmfEstimationResult& Estimates) const
+{
+    if (! Model.isLoaded) {
+        return false;
+    }
+
+    return withDatabase([this,&Model,&Estimates](nmfDatabase& database) {
+        nmfCoreResultWriter writer(&database,m_Logger);
+        return writer.saveEstimates(Model.dataStruct,Model.SpeciesNames,Model.GuildNames,Estimates);
+    });
+}
+
+void
+nmfCoreEngine::estimate(nmfStructsQt::ModelDataStruct dataStruct,
+                        std::vector<QString> MultiRunLines,
+                        int TotalIndividualRuns,
+                        bool isDeterministic,
+                        std::shared_ptr<nmfCancellationToken> CancellationToken,
+                        std::shared_ptr<nmfEstimationResultQueue> ResultQueue,
+                        QThreadPool* ThreadPool) const
+{
+    int RunNumber = 0;
+    bool isAMultiRun = ! MultiRunLines.empty();
+
+    // Without a queue nobody could read the results or learn that the run is over
+    if (! ResultQueue) {
+        nmfCoreModelLoader::logMsg(m_Logger,nmfConstants::Error,
+                                   "nmfCoreEngine::estimate: No result queue was given");
+        return;
+    }
+    if (! CancellationToken) {
+        CancellationToken = std::make_shared<nmfCancellationToken>();
+    }
+
+    // An ensemble's NLopt and Bees lines are run together, whatever the model's own algorithm
+    if (isAMultiRun) {
+        nmfCoreEnsembleDispatcher dispatcher;
+        dispatcher.setCancellationToken(CancellationToken);
+        dispatcher.setResultQueue(ResultQueue);
+        dispatcher.setThreadPool(ThreadPool);
+        dispatcher.estimateParameters(dataStruct,MultiRunLines,TotalIndividualRuns,isDeterministic);
+    } else if (dataStruct.EstimationAlgorithm == "NLopt Algorithm") {
+        std::pair<bool,bool> boolPair = std::make_pair(isAMultiRun,isDeterministic);
+        NLopt_Estimator estimator;
+        estimator.setCancellationToken(CancellationToken);
+        estimator.setResultQueue(ResultQueue);
+        estimator.setThreadPool(ThreadPool);
+        estimator.estimateParameters(dataStruct,RunNumber,boolPair,MultiRunLines,TotalIndividualRuns);
+    } else if (dataStruct.EstimationAlgorithm == "Bees Algorithm") {
+        // The Bees repetitions are seeded by their number when the run is deterministic.
+        // (Bees_Engine draws from the nmfRandom streams keyed by the fixed seed, line and repetition.)
+        nmfStructsQt::ModelDataStruct beeStruct = dataStruct;
+        beeStruct.useFixedSeed = beeStruct.useFixedSeed || isDeterministic;
+        Bees_Estimator estimator;
+        estimator.setCancellationToken(CancellationToken);
+        estimator.setResultQueue(ResultQueue);
+        estimator.setThreadPool(ThreadPool);
+        estimator.estimateParameters(beeStruct,RunNumber,MultiRunLines,TotalIndividualRuns);
+    } else {
+        nmfCoreModelLoader::logMsg(m_Logger,nmfConstants::Error,
+                                   "nmfCoreEngine: Unsupported estimation algorithm: "+dataStruct.EstimationAlgorithm);
+    }
+
+    // Lets the reader know nothing else is coming
+    ResultQueue->close();
+}
+
+QFuture<void>
+nmfCoreEngine::estimateAsync(const nmfStructsQt::ModelDataStruct& dataStruct,
+                             const std::vector<QString>& MultiRunLines,
+                             const int& TotalIndividualRuns,
+                             const bool& isDeterministic,
+                             std::shared_ptr<nmfCancellationToken> CancellationToken,
+                             std::shared_ptr<nmfEstimationResultQueue> ResultQueue) const
+{
+    return QtConcurrent::run([=]() {
+        estimate(dataStruct,MultiRunLines,TotalIndividualRuns,isDeterministic,
+                 CancellationToken,ResultQueue);
+    });
+}
+
+void
+nmfCoreEngine::peelTimeSeries(const int& NumYears,
+                              boost::numeric::ublas::matrix<double>& TimeSeries)
+{
+    // Only time series that were loaded are peeled
+    if (int(TimeSeries.size1()) > NumYears) {
+        TimeSeries.resize(TimeSeries.size1()-NumYears,TimeSeries.size2(),true);
+    }
+}
+
+void
+nmfCoreEngine::sumGuildBiomass(const nmfStructsQt::ModelDataStruct& dataStruct,
+                               boost::numeric::ublas::matrix<double>& GuildBiomass)
+{
+    const boost::numeric::ublas::matrix<double>& SpeciesBiomass = dataStruct.ObservedBiomassBySpecies;
+
+    nmfUtils::initialize(GuildBiomass,SpeciesBiomass.size1(),dataStruct.NumGuilds);
+    for (unsigned time=0; time<SpeciesBiomass.size1(); ++time) {
+        for (int species=0; species<int(SpeciesBiomass.size2()) && species<int(dataStruct.GuildNum.size()); ++species) {
+            GuildBiomass(time,dataStruct.GuildNum[species]) += SpeciesBiomass(time,species);
+        }
+    }
+}
+
+nmfCoreStatisticsResult
+nmfCoreEngine::calculateSummaryStatistics(
+        const nmfCoreModel& Model,
+        const boost::numeric::ublas::matrix<double>& EstimatedBiomass)
+{
+    bool isAggProd = (Model.dataStruct.CompetitionForm == "AGG-PROD");
+    nmfCoreStatisticsInput Input;
+
+    Input.NumSpeciesOrGuilds = (isAggProd) ? Model.dataStruct.NumGuilds : Model.dataStruct.NumSpecies;
+    Input.RunLength          = Model.dataStruct.RunLength;
+    Input.NumberOfParameters = Model.dataStruct.TotalNumberParameters;
+    Input.EstimatedBiomass   = EstimatedBiomass;
+    if (isAggProd) {
+        sumGuildBiomass(Model.dataStruct,Input.ObservedBiomass);
+    } else {
+        Input.ObservedBiomass = Model.dataStruct.ObservedBiomassBySpecies;
+    }
+
+    return nmfCoreStatistics::calculateSummaryStatistics(Input);
+}
+
+nmfCoreStatisticsResult
+nmfCoreEngine::runRetrospectiveAnalysis(
+        const nmfCoreModel& Model,
+        const int& NumPeels,
+        std::shared_ptr<nmfCancellationToken> CancellationToken) const
+{
+    // Each peel only ever has its one run waiting on its queue
+    const std::size_t ResultQueueCapacity = 4;
+
+    bool isAggProd = (Model.dataStruct.CompetitionForm == "AGG-PROD");
+    int NumSpeciesOrGuilds = (isAggProd) ? Model.dataStruct.NumGuilds : Model.dataStruct.NumSpecies;
+    nmfCoreStatisticsResult Result;
+    std::vector<nmfStructsQt::ModelDataStruct> PeelStructs;
+    std::vector<std::shared_ptr<nmfEstimationResultQueue> > ResultQueues;
+    std::vector<QFuture<void> > Futures;
+    std::unique_ptr<nmfEstimationResult> PeelResult;
+    std::vector<std::unique_ptr<nmfEstimationResult> > PeelEstimates(NumPeels+1);
+    boost::numeric::ublas::matrix<double> EstBiomassGuilds;
+    boost::numeric::ublas::matrix<double> UnpeeledBiomass;
+    nmfCoreStatisticsInput Input;
+
+    if (! Model.isLoaded || (NumPeels < 1) || (NumPeels >= Model.dataStruct.RunLength)) {
+        Result.ErrorMsg = "nmfCoreEngine::runRetrospectiveAnalysis: Invalid model or number of peels: " +
+                          std::to_string(NumPeels);
+        return Result;
+    }
+
+    // The peels are cut from the loaded model in memory rather than reloaded from the
+    // database, so each is an independent single run that may be estimated at the same time.
+    for (int peel=0; peel<=NumPeels; ++peel) {
+        nmfStructsQt::ModelDataStruct PeelStruct = Model.dataStruct;
+        PeelStruct.isMohnsRho          = false;
+        PeelStruct.showDiagnosticChart = false;
+        PeelStruct.NLoptNumberOfRuns   = 1;
+        PeelStruct.RunLength          -= peel;
+        peelTimeSeries(peel,PeelStruct.Catch);
+        peelTimeSeries(peel,PeelStruct.Effort);
+        peelTimeSeries(peel,PeelStruct.Exploitation);
+        peelTimeSeries(peel,PeelStruct.ObservedBiomassBySpecies);
+        peelTimeSeries(peel,PeelStruct.ObservedBiomassByGuilds);
+        PeelStructs.push_back(PeelStruct);
+        ResultQueues.push_back(std::make_shared<nmfEstimationResultQueue>(ResultQueueCapacity));
+    }
+
+    // The peels get their own pool so that they can't be starved by the
+    // caller's worker thread waiting for them in the global pool. Their
+    // estimators run their sub-runs on it too rather than each starting a
+    // pool as big as the machine; a peel waiting on a sub-run the pool hasn't
+    // started yet runs it itself.
+    QThreadPool ThreadPool;
+    ThreadPool.setMaxThreadCount(std::max(1,QThread::idealThreadCount()));
+    for (int peel=0; peel<=NumPeels; ++peel) {
+        Futures.push_back(QtConcurrent::run(&ThreadPool,[this,peel,&PeelStructs,&ResultQueues,&ThreadPool,CancellationToken]() {
+            estimate(PeelStructs[peel],{},0,PeelStructs[peel].useFixedSeed,CancellationToken,ResultQueues[peel],&ThreadPool);
+        }));
+    }
+
+    // The last result of a run is its best one
+    for (int peel=0; peel<=NumPeels; ++peel) {
+        while (ResultQueues[peel]->pop(PeelResult)) {
+            if (PeelResult->Type == nmfEstimationResult::RunCompleted) {
+                PeelEstimates[peel] = std::move(PeelResult);
+            }
+        }
+        Futures[peel].waitForFinished();
+    }
+    ThreadPool.waitForDone();
+
+    if (CancellationToken && CancellationToken->isCancelled()) {
+        Result.ErrorMsg = "nmfCoreEngine::runRetrospectiveAnalysis: Analysis was stopped before it finished";
+        return Result;
+    }
+
+    Input.NumSpeciesOrGuilds = NumSpeciesOrGuilds;
+    Input.RunLength          = Model.dataStruct.RunLength;
+    Input.NumberOfParameters = Model.dataStruct.TotalNumberParameters;
+    Input.isMohnsRho         = true;
+    Input.NumPeels           = NumPeels;
+    for (int peel=0; peel<=NumPeels; ++peel) {
+        if (! PeelEstimates[peel]) {
+            Result.ErrorMsg = "nmfCoreEngine::runRetrospectiveAnalysis: No estimate for peel " + std::to_string(peel);
+            return Result;
+        }
+        nmfEstimationResult& Estimates = *PeelEstimates[peel];
+        if (Estimates.EstBiomassSpecies.size1() == 0) {
+            if (! nmfCoreSimulator::calculateBiomass(PeelStructs[peel],Estimates,
+                                                     Estimates.EstBiomassSpecies,EstBiomassGuilds)) {
+                Result.ErrorMsg = "nmfCoreEngine::runRetrospectiveAnalysis: Couldn't simulate peel " + std::to_string(peel);
+                return Result;
+            }
+        }
+        Input.EstGrowthRate.insert(Input.EstGrowthRate.end(),
+                                   Estimates.EstGrowthRates.begin(),Estimates.EstGrowthRates.end());
+        Input.EstCarryingCapacity.insert(Input.EstCarryingCapacity.end(),
+                                         Estimates.EstCarryingCapacities.begin(),Estimates.EstCarryingCapacities.end());
+        std::vector<double> PeelBiomass;
+        for (int species=0; species<NumSpeciesOrGuilds; ++species) {
+            for (int time=0; time<=PeelStructs[peel].RunLength; ++time) {
+                PeelBiomass.push_back(Estimates.EstBiomassSpecies(time,species));
+            }
+        }
+        Input.EstBiomassByPeel.push_back(PeelBiomass);
+    }
+    Input.EstimatedBiomass = PeelEstimates[0]->EstBiomassSpecies;
+    if (isAggProd) {
+        sumGuildBiomass(Model.dataStruct,Input.ObservedBiomass);
+    } else {
+        Input.ObservedBiomass = Model.dataStruct.ObservedBiomassBySpecies;
+    }
+
+    return nmfCoreStatistics::calculateSummaryStatistics(Input);
+}
+
+QFuture<nmfCoreStatisticsResult>
+nmfCoreEngine::runRetrospectiveAnalysisAsync(
+        const nmfCoreModel& Model,
+        const int& NumPeels,
+        std::shared_ptr<nmfCancellationToken> CancellationToken) const
+{
+    return QtConcurrent::run([this,Model,NumPeels,CancellationToken]() {
+        return runRetrospectiveAnalysis(Model,NumPeels,CancellationToken);
+    });
+}
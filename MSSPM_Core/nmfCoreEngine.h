@@ -0,0 +1,204 @@
+/**
+ * @file nmfCoreEngine.h
+ * @brief Definition for the entry point of the MSSPM core library
+ *
+ * This file contains the definition for nmfCoreEngine. The engine loads
+ * models and forecasts from a project database, estimates their parameters
+ * and runs retrospective (Mohn's Rho) analyses without any widgets. Every
+ * call opens its own database connection and works on its own copy of the
+ * model, so an engine may be used from many threads at once. Each blocking
+ * call has an Async version that returns a QFuture.
+ *
+ * @copyright
+ * Public Domain Notice\n
+ *
+ * National Oceanic And Atmospheric Administration\n\n
+ *
+ * This software is a "United States Government Work" under the terms of the
+ * United States Copyright Act.  It was written as part of the author's official
+ * duties as a United States Government employee/contractor and thus cannot be copyrighted.
+ * This software is freely available to the public for use. The National Oceanic
+ * And Atmospheric Administration and the U.S. Government have not placed any
+ * restriction on its use or reproduction.  Although all reasonable efforts have
+ * been taken to ensure the accuracy and reliability of the software and data,
+ * the National Oceanic And Atmospheric Administration and the U.S. Government
+ * do not and cannot warrant the performance or results that may be obtained
+ * by using this software or data. The National Oceanic And Atmospheric
+ * Administration and the U.S. Government disclaim all warranties, express
+ * or implied, including warranties of performance, merchantability or fitness
+ * for any particular purpose.\n\n
+ *
+ * Please cite the author(s) in any work or product based on this material.
+ */
+
+#pragma once
+
+#include "nmfCancellationToken.h"
+#include "nmfCoreModelLoader.h"
+#include "nmfCoreSimulator.h"
+#include "nmfCoreStatistics.h"
+#include "nmfEstimationResult.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <QFuture>
+#include <QString>
+#include <QThreadPool>
+
+/**
+ * @brief Where the engine finds the project database
+ */
+struct nmfCoreDatabaseSettings {
+    std::string Host;
+    std::string User;
+    std::string Password;
+    std::string ProjectDatabase;
+};
+
+/**
+ * @brief A model loaded by the engine. Copies are independent of each other.
+ */
+struct nmfCoreModel {
+    bool isLoaded;
+    std::string SystemName;
+    int StartYear;
+    std::vector<std::string> SpeciesNames;
+    std::vector<std::string> GuildNames;
+    nmfStructsQt::ModelDataStruct dataStruct;
+
+    nmfCoreModel() : isLoaded(false), StartYear(0) {}
+};
+
+/**
+ * @brief Loads, estimates and analyzes MSSPM models without any widgets
+ */
+class nmfCoreEngine
+{
+    nmfLogger*              m_Logger;
+    nmfCoreDatabaseSettings m_Settings;
+    static std::atomic<int> m_ConnectionCounter;
+
+    template <class Function>
+    bool withDatabase(Function function) const;
+    template <class Loader>
+    bool withLoader(const std::string& SystemName,
+                    Loader load) const;
+    static void peelTimeSeries(const int& NumYears,
+                               boost::numeric::ublas::matrix<double>& TimeSeries);
+    static void sumGuildBiomass(const nmfStructsQt::ModelDataStruct& dataStruct,
+                                boost::numeric::ublas::matrix<double>& GuildBiomass);
+
+public:
+    /**
+     * @brief Class constructor
+     * @param logger : pointer to the application logger; it may be shared with other engines
+     * @param Settings : where to find the project database
+     */
+    nmfCoreEngine(nmfLogger* logger,
+                  const nmfCoreDatabaseSettings& Settings);
+    virtual ~nmfCoreEngine() {}
+
+    /**
+     * @brief Loads a model's forms, settings, parameter ranges and time series
+     * @param SystemName : name of the model (i.e., the SystemName in the Systems table)
+     * @param EstimatedParameters : names of the parameters to estimate (from nmfConstantsMSSPM::EstimateCheckboxNames)
+     * @param Model : the loaded model
+     * @return Returns false if the database or the model can't be loaded
+     */
+    bool loadModel(const std::string& SystemName,
+                   const std::vector<std::string>& EstimatedParameters,
+                   nmfCoreModel& Model) const;
+    /**
+     * @brief Loads a model on a worker thread
+     * @param SystemName : name of the model
+     * @param EstimatedParameters : names of the parameters to estimate
+     * @return Future holding the model; its isLoaded is false if it couldn't be loaded
+     */
+    QFuture<nmfCoreModel> loadModelAsync(const std::string& SystemName,
+                                         const std::vector<std::string>& EstimatedParameters) const;
+    /**
+     * @brief Makes a copy of a model with a forecast's run length and harvest. To run the
+     * forecast, simulate the copy with the estimated parameters and with the initial
+     * biomass set to the model's estimated biomass of its last year.
+     * @param Model : the model the forecast was made from
+     * @param ForecastName : name of the forecast (i.e., the ForecastName in the Forecasts table)
+     * @param ForecastModel : the model to forecast with
+     * @return Returns false if the forecast can't be loaded
+     */
+    bool loadForecast(const nmfCoreModel& Model,
+                      const std::string& ForecastName,
+                      nmfCoreModel& ForecastModel) const;
+    /**
+     * @brief Estimates a model's parameters with the model's estimation algorithm (or with
+     * each line's own algorithm for a multi-run, see nmfCoreEnsembleDispatcher). The results
+     * are pushed onto the result queue, which is closed once the estimation is done.
+     * @param dataStruct : the model to estimate; it's copied so the caller's is left alone
+     * @param MultiRunLines : lines of a multi-run (ensemble) file; empty for a single run
+     * @param TotalIndividualRuns : number of runs in the multi-run
+     * @param isDeterministic : use fixed seeds so runs are repeatable
+     * @param CancellationToken : token to stop the estimation early
+     * @param ResultQueue : queue the results are pushed onto; it's closed when the estimation is done
+     * @param ThreadPool : pool the estimators run their sub-runs on (not owned); nullptr
+     * lets each estimator use a pool of its own
+     */
+    void estimate(nmfStructsQt::ModelDataStruct dataStruct,
+                  std::vector<QString> MultiRunLines,
+                  int TotalIndividualRuns,
+                  bool isDeterministic,
+                  std::shared_ptr<nmfCancellationToken> CancellationToken,
+                  std::shared_ptr<nmfEstimationResultQueue> ResultQueue,
+                  QThreadPool* ThreadPool = nullptr) const;
+    /**
+     * @brief Estimates a model's parameters on a worker thread. The caller reads the
+     * results from the result queue as they arrive.
+     * @return Future that finishes after the result queue is closed
+     */
+    QFuture<void> estimateAsync(const nmfStructsQt::ModelDataStruct& dataStruct,
+                                const std::vector<QString>& MultiRunLines,
+                                const int& TotalIndividualRuns,
+                                const bool& isDeterministic,
+                                std::shared_ptr<nmfCancellationToken> CancellationToken,
+                                std::shared_ptr<nmfEstimationResultQueue> ResultQueue) const;
+    /**
+     * @brief Saves a run's estimates and biomass to the project database's Output tables,
+     * replacing those saved for the model's algorithm settings (see nmfCoreResultWriter)
+     * @param Model : the model that was estimated
+     * @param Estimates : the run's estimates, with its biomass already calculated (see nmfCoreSimulator)
+     * @return Returns false if the database can't be opened or the tables can't be written
+     */
+    bool saveEstimates(const nmfCoreModel& Model,
+                       const nmfEstimationResult& Estimates) const;
+    /**
+     * @brief Runs a retrospective analysis. The model is estimated again with 0 to
+     * NumPeels of its last years peeled off, the peels running at the same time,
+     * and Mohn's Rho is calculated from the estimates of all of the peels.
+     * @param Model : the model to analyze
+     * @param NumPeels : number of peels, not counting the unpeeled model
+     * @param CancellationToken : token to stop the analysis early
+     * @return The Mohn's Rho statistics, or why they couldn't be calculated
+     */
+    nmfCoreStatisticsResult runRetrospectiveAnalysis(
+            const nmfCoreModel& Model,
+            const int& NumPeels,
+            std::shared_ptr<nmfCancellationToken> CancellationToken) const;
+    /**
+     * @brief Runs a retrospective analysis on a worker thread
+     * @return Future holding the Mohn's Rho statistics
+     */
+    QFuture<nmfCoreStatisticsResult> runRetrospectiveAnalysisAsync(
+            const nmfCoreModel& Model,
+            const int& NumPeels,
+            std::shared_ptr<nmfCancellationToken> CancellationToken) const;
+    /**
+     * @brief Calculates the model fit statistics of a model and the biomass estimated for it
+     * @param Model : the model that was estimated
+     * @param EstimatedBiomass : biomass estimated by species (or by guild if running AGG-PROD)
+     * @return The statistics, or why they couldn't be calculated
+     */
+    static nmfCoreStatisticsResult calculateSummaryStatistics(
+            const nmfCoreModel& Model,
+            const boost::numeric::ublas::matrix<double>& EstimatedBiomass);
+};
@@ -0,0 +1,96 @@
+
+#include "nmfCoreEnsembleDispatcher.h"
+#include "Bees_Estimator.h"
+#include "NLopt_Estimator.h"
+
+#include <QFuture>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent>
+
+nmfCoreEnsembleDispatcher::nmfCoreEnsembleDispatcher()
+{
+    m_CancellationToken = std::make_shared<nmfCancellationToken>();
+    m_ThreadPool        = nullptr;
+}
+
+void
+nmfCoreEnsembleDispatcher::setCancellationToken(std::shared_ptr<nmfCancellationToken> CancellationToken)
+{
+    m_CancellationToken = CancellationToken;
+}
+
+void
+nmfCoreEnsembleDispatcher::setResultQueue(std::shared_ptr<nmfEstimationResultQueue> ResultQueue)
+{
+    m_ResultQueue = ResultQueue;
+}
+
+void
+nmfCoreEnsembleDispatcher::setThreadPool(QThreadPool* ThreadPool)
+{
+    m_ThreadPool = ThreadPool;
+}
+
+void
+nmfCoreEnsembleDispatcher::estimateParameters(nmfStructsQt::ModelDataStruct dataStruct,
+                                              std::vector<QString> MultiRunLines,
+                                              int TotalIndividualRuns,
+                                              bool isDeterministic)
+{
+    int NLoptRunNumber = 0;
+    int BeesRunNumber  = 0;
+    std::pair<bool,bool> boolPair = std::make_pair(true,isDeterministic);
+    std::vector<QString> BeesMultiRunLines = MultiRunLines;
+    nmfStructsQt::ModelDataStruct NLoptStruct = dataStruct;
+    nmfStructsQt::ModelDataStruct BeeStruct   = dataStruct;
+    std::shared_ptr<nmfEstimationEnsemble> Ensemble = std::make_shared<nmfEstimationEnsemble>();
+    NLopt_Estimator NLoptEstimator;
+    Bees_Estimator  BeesEstimator;
+    QThreadPool  OwnThreadPool;
+    QThreadPool* ThreadPool = m_ThreadPool;
+
+    // The Bees repetitions are seeded by their number when the run is deterministic.
+    // (Bees_Engine draws from the nmfRandom streams keyed by the fixed seed, line and repetition.)
+    BeeStruct.useFixedSeed = BeeStruct.useFixedSeed || isDeterministic;
+
+    // Both estimators share the pool. Whichever one waits on a task the pool hasn't
+    // started yet runs it itself, so neither can starve the other.
+    if (ThreadPool == nullptr) {
+        OwnThreadPool.setMaxThreadCount(QThread::idealThreadCount());
+        ThreadPool = &OwnThreadPool;
+    }
+    NLoptEstimator.setCancellationToken(m_CancellationToken);
+    NLoptEstimator.setResultQueue(m_ResultQueue);
+    NLoptEstimator.setEnsemble(Ensemble);
+    NLoptEstimator.setThreadPool(ThreadPool);
+    BeesEstimator.setCancellationToken(m_CancellationToken);
+    BeesEstimator.setResultQueue(m_ResultQueue);
+    BeesEstimator.setEnsemble(Ensemble);
+    BeesEstimator.setThreadPool(ThreadPool);
+    connect(&NLoptEstimator, &NLopt_Estimator::ResultsAvailable,
+            this,            &nmfCoreEnsembleDispatcher::ResultsAvailable, Qt::DirectConnection);
+    connect(&BeesEstimator,  &Bees_Estimator::ResultsAvailable,
+            this,            &nmfCoreEnsembleDispatcher::ResultsAvailable, Qt::DirectConnection);
+    connect(&BeesEstimator,  &Bees_Estimator::ErrorFound,
+            this,            &nmfCoreEnsembleDispatcher::ErrorFound,       Qt::DirectConnection);
+
+    // The Bees lines are run on the pool while the NLopt lines are run here
+    QFuture<void> BeesFuture = QtConcurrent::run(ThreadPool,[&]() {
+        BeesEstimator.estimateParameters(BeeStruct,BeesRunNumber,BeesMultiRunLines,TotalIndividualRuns);
+    });
+    NLoptEstimator.estimateParameters(NLoptStruct,NLoptRunNumber,boolPair,MultiRunLines,TotalIndividualRuns);
+    BeesFuture.waitForFinished();
+
+    if (Ensemble->getNumMembers() > 0) {
+        std::unique_ptr<nmfEstimationResult> Result = std::make_unique<nmfEstimationResult>();
+        Result->Type                    = nmfEstimationResult::AllSubRunsCompleted;
+        Result->MultiRunSpeciesFilename = dataStruct.MultiRunSpeciesFilename;
+        Result->MultiRunModelFilename   = dataStruct.MultiRunModelFilename;
+        if (m_ResultQueue && m_ResultQueue->push(std::move(Result))) {
+            emit ResultsAvailable();
+        }
+    }
+
+    m_CancellationToken->finish();
+}
@@ -0,0 +1,105 @@
+/**
+ * @file nmfCoreEnsembleDispatcher.h
+ * @brief Definition for the multi-run (ensemble) dispatcher of the MSSPM core library
+ *
+ * This file contains the definition for nmfCoreEnsembleDispatcher. A multi-run
+ * file may list NLopt and Bees Algorithm lines in any order. The dispatcher runs
+ * the NLopt and the Bees estimators at the same time on one worker pool, each
+ * skipping the other's lines, and both push their sub-runs onto the same result
+ * queue as members of the same ensemble as soon as each one is done.
+ *
+ * @copyright
+ * Public Domain Notice\n
+ *
+ * National Oceanic And Atmospheric Administration\n\n
+ *
+ * This software is a "United States Government Work" under the terms of the
+ * United States Copyright Act.  It was written as part of the author's official
+ * duties as a United States Government employee/contractor and thus cannot be copyrighted.
+ * This software is freely available to the public for use. The National Oceanic
+ * And Atmospheric Administration and the U.S. Government have not placed any
+ * restriction on its use or reproduction.  Although all reasonable efforts have
+ * been taken to ensure the accuracy and reliability of the software and data,
+ * the National Oceanic And Atmospheric Administration and the U.S. Government
+ * do not and cannot warrant the performance or results that may be obtained
+ * by using this software or data. The National Oceanic And Atmospheric
+ * Administration and the U.S. Government disclaim all warranties, express
+ * or implied, including warranties of performance, merchantability or fitness
+ * for any particular purpose.\n\n
+ *
+ * Please cite the author(s) in any work or product based on this material.
+ */
+
+#pragma once
+
+#include "nmfCancellationToken.h"
+#include "nmfEstimationResult.h"
+#include "nmfStructsQt.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+
+/**
+ * @brief Runs every line of a multi-run, whatever its estimation algorithm
+ */
+class nmfCoreEnsembleDispatcher : public QObject
+{
+
+    Q_OBJECT
+
+    std::shared_ptr<nmfCancellationToken>     m_CancellationToken;
+    std::shared_ptr<nmfEstimationResultQueue> m_ResultQueue;
+    QThreadPool*                              m_ThreadPool;
+
+signals:
+    /**
+     * @brief Signal emitted when one of the estimators finds an error
+     * @param errorMsg : the error message
+     */
+    void ErrorFound(std::string errorMsg);
+    /**
+     * @brief Signal emitted after a result has been pushed onto the result queue
+     */
+    void ResultsAvailable();
+
+public:
+    /**
+     * @brief Class constructor
+     */
+    nmfCoreEnsembleDispatcher();
+   ~nmfCoreEnsembleDispatcher() {}
+
+    /**
+     * @brief Sets the token that stops every member of the multi-run. The dispatcher
+     * calls finish() on it once both estimators are done.
+     * @param CancellationToken : the run's cancellation token
+     */
+    void setCancellationToken(std::shared_ptr<nmfCancellationToken> CancellationToken);
+    /**
+     * @brief Sets the queue both estimators push their results onto
+     * @param ResultQueue : the run's result queue
+     */
+    void setResultQueue(std::shared_ptr<nmfEstimationResultQueue> ResultQueue);
+    /**
+     * @brief Sets the pool both estimators share; nullptr gives the multi-run a pool of its own
+     * @param ThreadPool : the pool (not owned)
+     */
+    void setThreadPool(QThreadPool* ThreadPool);
+    /**
+     * @brief Runs all of the lines of a multi-run. The members are numbered in the
+     * order they finish, and an AllSubRunsCompleted result follows the last of them.
+     * @param dataStruct : the model; each estimator reloads its own copy for every line
+     * @param MultiRunLines : lines of the multi-run file
+     * @param TotalIndividualRuns : number of runs in the multi-run
+     * @param isDeterministic : use fixed seeds so runs are repeatable
+     */
+    void estimateParameters(nmfStructsQt::ModelDataStruct dataStruct,
+                            std::vector<QString> MultiRunLines,
+                            int TotalIndividualRuns,
+                            bool isDeterministic);
+};
@@ -0,0 +1,612 @@
+
+#include "nmfCoreModelLoader.h"
+
+std::mutex nmfCoreModelLoader::m_LoggerMutex;
+
+nmfCoreModelLoader::nmfCoreModelLoader(nmfDatabase*       databasePtr,
+                                       nmfLogger*         logger,
+                                       const std::string& SystemName)
+{
+    m_DatabasePtr = databasePtr;
+    m_Logger      = logger;
+    m_SystemName  = SystemName;
+    m_StartYear   = 0;
+}
+
+const std::vector<std::string>&
+nmfCoreModelLoader::getGuildNames() const
+{
+    return m_GuildNames;
+}
+
+const std::vector<std::string>&
+nmfCoreModelLoader::getSpeciesNames() const
+{
+    return m_SpeciesNames;
+}
+
+int
+nmfCoreModelLoader::getStartYear() const
+{
+    return m_StartYear;
+}
+
+void
+nmfCoreModelLoader::logMsg(const int& Level,
+                           const std::string& Msg)
+{
+    logMsg(m_Logger,Level,Msg);
+}
+
+void
+nmfCoreModelLoader::logMsg(nmfLogger* Logger,
+                           const int& Level,
+                           const std::string& Msg)
+{
+    // Loaders on other threads may share the logger
+    std::lock_guard<std::mutex> lock(m_LoggerMutex);
+    Logger->logMsg(Level,Msg);
+}
+
+void
+nmfCoreModelLoader::checkGuildRanges(const int& NumGuilds,
+                                     const nmfStructsQt::ModelDataStruct& dataStruct)
+{
+    bool isMissingGrowthData = true;
+    bool isMissingKData = true;
+
+    for (int i=0; i<NumGuilds; ++i) {
+        if ((dataStruct.GrowthRateMin[i] != 0) || (dataStruct.GrowthRateMax[i] != 0)) {
+            isMissingGrowthData = false;
+        }
+        if ((dataStruct.CarryingCapacityMin[i] != 0) || (dataStruct.CarryingCapacityMax[i] != 0)) {
+            isMissingKData = false;
+        }
+    }
+
+    if (isMissingGrowthData) {
+        logMsg(nmfConstants::Warning,"nmfCoreModelLoader: Missing Guild Growth Rate range data");
+    }
+    if (isMissingKData) {
+        logMsg(nmfConstants::Warning,"nmfCoreModelLoader: Missing Guild Carrying Capacity range data");
+    }
+}
+
+bool
+nmfCoreModelLoader::loadTimeSeries(const std::string& Table,
+                                   const std::string& ForecastName,
+                                   const int& NumSpecies,
+                                   const int& RunLength,
+                                   boost::numeric::ublas::matrix<double>& TimeSeries)
+{
+    int m;
+    int NumRecords;
+    int NumYears = RunLength+1;
+    std::vector<std::string> fields;
+    std::map<std::string, std::vector<std::string> > dataMap;
+    std::string queryStr;
+
+    if (ForecastName.empty()) {
+        fields     = {"MohnsRhoLabel","SystemName","SpeName","Year","Value"};
+        queryStr   = "SELECT MohnsRhoLabel,SystemName,SpeName,Year,Value FROM " + Table;
+        queryStr  += " WHERE MohnsRhoLabel = '' AND SystemName = '" + m_SystemName + "'";
+        queryStr  += " ORDER BY SpeName,Year";
+    } else {
+        fields     = {"ForecastName","SpeName","Year","Value"};
+        queryStr   = "SELECT ForecastName,SpeName,Year,Value FROM Forecast" + Table;
+        queryStr  += " WHERE ForecastName = '" + ForecastName + "'";
+        queryStr  += " ORDER BY SpeName,Year";
+    }
+    dataMap    = m_DatabasePtr->nmfQueryDatabase(queryStr, fields);
+    NumRecords = dataMap["SpeName"].size();
+    if (NumRecords != NumSpecies*NumYears) {
+        logMsg(nmfConstants::Error,
+               "nmfCoreModelLoader::loadTimeSeries: Incorrect number of records found in table: " +
+               Table + ". Found " + std::to_string(NumRecords) + " expecting " +
+               std::to_string(NumSpecies*NumYears) + ".");
+        return false;
+    }
+
+    m = 0;
+    nmfUtils::initialize(TimeSeries,NumYears,NumSpecies);
+    for (int species=0; species<NumSpecies; ++species) {
+        for (int time=0; time<NumYears; ++time) {
+            TimeSeries(time,species) = std::stod(dataMap["Value"][m++]);
+        }
+    }
+
+    return true;
+}
+
+bool
+nmfCoreModelLoader::loadInteraction(const nmfStructsQt::ModelDataStruct& dataStruct,
+                                    const int& NumSpeciesOrGuilds,
+                                    const std::string& Parameter,
+                                    const std::string& InitTable,
+                                    const std::string& MinTable,
+                                    const std::string& MaxTable,
+                                    std::vector<double>& MinData,
+                                    std::vector<double>& MaxData,
+                                    int& NumInteractionParameters)
+{
+    int NumRecords;
+    bool isChecked = nmfUtils::isEstimateParameterChecked(dataStruct,Parameter);
+    std::vector<std::string> fields;
+    std::vector<std::string> tables = {InitTable,MinTable,MaxTable};
+    std::map<std::string, std::vector<std::string> > dataMap[3];
+    std::string queryStr;
+
+    NumInteractionParameters = 0;
+    fields = {"SystemName","SpeName","Value"};
+
+    for (int i=0; i<3; ++i) {
+        queryStr   = "SELECT SystemName,SpeName,Value FROM " + tables[i];
+        queryStr  += " WHERE SystemName = '" + m_SystemName + "'";
+        dataMap[i] = m_DatabasePtr->nmfQueryDatabase(queryStr, fields);
+        NumRecords = dataMap[i]["Value"].size();
+        if (NumRecords != NumSpeciesOrGuilds) {
+            logMsg(nmfConstants::Error,
+                   "nmfCoreModelLoader::loadInteraction: Incorrect number of records found in table: " +
+                   tables[i] + ". Found " + std::to_string(NumRecords) + " expecting " +
+                   std::to_string(NumSpeciesOrGuilds) + ".");
+            return false;
+        }
+    }
+
+    // Parameters that aren't being estimated are held at their initial values
+    for (int row=0; row<NumSpeciesOrGuilds; ++row) {
+        if (isChecked) {
+            MinData.push_back(std::stod(dataMap[1]["Value"][row]));
+            MaxData.push_back(std::stod(dataMap[2]["Value"][row]));
+        } else {
+            MinData.push_back(std::stod(dataMap[0]["Value"][row]));
+            MaxData.push_back(std::stod(dataMap[0]["Value"][row]));
+        }
+        ++NumInteractionParameters;
+    }
+
+    return true;
+}
+
+bool
+nmfCoreModelLoader::loadInteraction(const nmfStructsQt::ModelDataStruct& dataStruct,
+                                    const int& NumRows,
+                                    const int& NumCols,
+                                    const std::string& Parameter,
+                                    const std::vector<std::string>& Fields,
+                                    const std::string& InitTable,
+                                    const std::string& MinTable,
+                                    const std::string& MaxTable,
+                                    std::vector<std::vector<double> >& MinData,
+                                    std::vector<std::vector<double> >& MaxData,
+                                    int& NumInteractionParameters)
+{
+    int m;
+    int NumRecords;
+    bool isChecked = nmfUtils::isEstimateParameterChecked(dataStruct,Parameter);
+    std::vector<std::string> fields = Fields;
+    std::vector<std::string> tables = {InitTable,MinTable,MaxTable};
+    std::map<std::string, std::vector<std::string> > dataMap[3];
+    std::string queryStr;
+    std::vector<double> MinRow;
+    std::vector<double> MaxRow;
+
+    NumInteractionParameters = 0;
+
+    for (int i=0; i<3; ++i) {
+        queryStr = "SELECT ";
+        for (unsigned j=0; j<fields.size(); ++j) {
+            queryStr += (j == 0) ? fields[j] : ","+fields[j];
+        }
+        queryStr  += " FROM " + tables[i] + " WHERE SystemName = '" + m_SystemName + "'";
+        dataMap[i] = m_DatabasePtr->nmfQueryDatabase(queryStr, fields);
+        NumRecords = dataMap[i]["Value"].size();
+        if (NumRecords != NumRows*NumCols) {
+            logMsg(nmfConstants::Error,
+                   "nmfCoreModelLoader::loadInteraction: Incorrect number of records found in table: " +
+                   tables[i] + ". Found " + std::to_string(NumRecords) + " expecting " +
+                   std::to_string(NumRows*NumCols) + ".");
+            return false;
+        }
+    }
+
+    // Parameters that aren't being estimated are held at their initial values
+    m = 0;
+    for (int row=0; row<NumRows; ++row) {
+        MinRow.clear();
+        MaxRow.clear();
+        for (int col=0; col<NumCols; ++col) {
+            if (isChecked) {
+                MinRow.push_back(std::stod(dataMap[1]["Value"][m]));
+                MaxRow.push_back(std::stod(dataMap[2]["Value"][m]));
+            } else {
+                MinRow.push_back(std::stod(dataMap[0]["Value"][m]));
+                MaxRow.push_back(std::stod(dataMap[0]["Value"][m]));
+            }
+            ++NumInteractionParameters;
+            ++m;
+        }
+        MinData.push_back(MinRow);
+        MaxData.push_back(MaxRow);
+    }
+
+    return true;
+}
+
+bool
+nmfCoreModelLoader::loadParameters(nmfStructsQt::ModelDataStruct& dataStruct)
+{
+    bool loadOK = true;
+    bool isSurveyQ;
+    int RunLength;
+    int NumSpecies;
+    int NumGuilds;
+    int GuildNum;
+    int NumCompetitionParameters = 0;
+    int NumPredationParameters   = 0;
+    int NumHandlingParameters    = 0;
+    int NumExponentParameters    = 0;
+    int NumBetaSpeciesParameters = 0;
+    int NumBetaGuildsParameters  = 0;
+    int NumSpeciesOrGuilds;
+    std::vector<std::string> fields;
+    std::map<std::string, std::vector<std::string> > dataMap;
+    std::string queryStr;
+    std::string guildName;
+    std::string obsBiomassType;
+    std::map<std::string,double> initialGuildBiomass;
+    std::map<std::string,double> initialGuildBiomassMin;
+    std::map<std::string,double> initialGuildBiomassMax;
+    std::map<std::string,int> GuildMap;
+
+    m_SpeciesNames.clear();
+    m_GuildNames.clear();
+    dataStruct.isMohnsRho = false;
+    dataStruct.GuildSpecies.clear();
+    dataStruct.GuildNum.clear();
+    dataStruct.ObservedBiomassBySpecies.clear();
+    dataStruct.ObservedBiomassByGuilds.clear();
+    dataStruct.Catch.clear();
+    dataStruct.Effort.clear();
+    dataStruct.Exploitation.clear();
+    dataStruct.CompetitionMin.clear();
+    dataStruct.CompetitionMax.clear();
+    dataStruct.CompetitionBetaSpeciesMin.clear();
+    dataStruct.CompetitionBetaSpeciesMax.clear();
+    dataStruct.CompetitionBetaGuildsMin.clear();
+    dataStruct.CompetitionBetaGuildsMax.clear();
+    dataStruct.CompetitionBetaGuildsGuildsMin.clear();
+    dataStruct.CompetitionBetaGuildsGuildsMax.clear();
+    dataStruct.PredationRhoMin.clear();
+    dataStruct.PredationRhoMax.clear();
+    dataStruct.PredationHandlingMin.clear();
+    dataStruct.PredationHandlingMax.clear();
+    dataStruct.PredationExponentMin.clear();
+    dataStruct.PredationExponentMax.clear();
+
+    fields     = {"ObsBiomassType","GrowthForm","HarvestForm","WithinGuildCompetitionForm","PredationForm",
+                  "StartYear","RunLength","Algorithm","Minimizer","ObjectiveCriterion",
+                  "BeesNumTotal","BeesNumElite","BeesNumOther","BeesNumEliteSites",
+                  "BeesNumBestSites","BeesNumRepetitions","BeesMaxGenerations","BeesNeighborhoodSize",
+                  "Scaling","GAGenerations","GAConvergence",
+                  "NLoptUseStopVal","NLoptUseStopAfterTime","NLoptUseStopAfterIter",
+                  "NLoptStopVal","NLoptStopAfterTime","NLoptStopAfterIter","NLoptNumberOfRuns"};
+    queryStr   = "SELECT ObsBiomassType,GrowthForm,HarvestForm,WithinGuildCompetitionForm,PredationForm,";
+    queryStr  += "StartYear,RunLength,Algorithm,Minimizer,ObjectiveCriterion,";
+    queryStr  += "BeesNumTotal,BeesNumElite,BeesNumOther,BeesNumEliteSites,BeesNumBestSites,BeesNumRepetitions,";
+    queryStr  += "BeesMaxGenerations,BeesNeighborhoodSize,Scaling,GAGenerations,GAConvergence,";
+    queryStr  += "NLoptUseStopVal,NLoptUseStopAfterTime,NLoptUseStopAfterIter,";
+    queryStr  += "NLoptStopVal,NLoptStopAfterTime,NLoptStopAfterIter,NLoptNumberOfRuns ";
+    queryStr  += "FROM Systems WHERE SystemName = '" + m_SystemName + "'";
+    dataMap    = m_DatabasePtr->nmfQueryDatabase(queryStr, fields);
+    if (dataMap["RunLength"].empty()) {
+        logMsg(nmfConstants::Error,"nmfCoreModelLoader: No model found named: " + m_SystemName);
+        return false;
+    }
+
+    obsBiomassType                   = dataMap["ObsBiomassType"][0];
+    m_StartYear                      = std::stoi(dataMap["StartYear"][0]);
+    RunLength                        = std::stoi(dataMap["RunLength"][0]);
+    dataStruct.RunLength             = RunLength;
+    dataStruct.GrowthForm            = dataMap["GrowthForm"][0];
+    dataStruct.HarvestForm           = dataMap["HarvestForm"][0];
+    dataStruct.CompetitionForm       = dataMap["WithinGuildCompetitionForm"][0];
+    dataStruct.PredationForm         = dataMap["PredationForm"][0];
+    dataStruct.EstimationAlgorithm   = dataMap["Algorithm"][0];
+    dataStruct.BeesNumTotal          = std::stoi(dataMap["BeesNumTotal"][0]);
+    dataStruct.BeesNumElite          = std::stoi(dataMap["BeesNumElite"][0]);
+    dataStruct.BeesNumOther          = std::stoi(dataMap["BeesNumOther"][0]);
+    dataStruct.BeesNumEliteSites     = std::stoi(dataMap["BeesNumEliteSites"][0]);
+    dataStruct.BeesNumBestSites      = std::stoi(dataMap["BeesNumBestSites"][0]);
+    dataStruct.BeesNumRepetitions    = std::stoi(dataMap["BeesNumRepetitions"][0]);
+    dataStruct.BeesMaxGenerations    = std::stoi(dataMap["BeesMaxGenerations"][0]);
+    dataStruct.BeesNeighborhoodSize  = std::stof(dataMap["BeesNeighborhoodSize"][0]);
+    dataStruct.ScalingAlgorithm      = dataMap["Scaling"][0];
+    dataStruct.GAGenerations         = std::stoi(dataMap["GAGenerations"][0]);
+    dataStruct.GAConvergence         = std::stoi(dataMap["GAConvergence"][0]);
+    dataStruct.MinimizerAlgorithm    = dataMap["Minimizer"][0];
+    dataStruct.ObjectiveCriterion    = dataMap["ObjectiveCriterion"][0];
+    dataStruct.NLoptUseStopVal       = std::stoi(dataMap["NLoptUseStopVal"][0]);
+    dataStruct.NLoptUseStopAfterTime = std::stoi(dataMap["NLoptUseStopAfterTime"][0]);
+    dataStruct.NLoptUseStopAfterIter = std::stoi(dataMap["NLoptUseStopAfterIter"][0]);
+    dataStruct.NLoptStopVal          = std::stod(dataMap["NLoptStopVal"][0]);
+    dataStruct.NLoptStopAfterTime    = std::stoi(dataMap["NLoptStopAfterTime"][0]);
+    dataStruct.NLoptStopAfterIter    = std::stoi(dataMap["NLoptStopAfterIter"][0]);
+    dataStruct.NLoptNumberOfRuns     = std::stoi(dataMap["NLoptNumberOfRuns"][0]);
+
+    if (dataStruct.GrowthForm == "Null") {
+        logMsg(nmfConstants::Error,"nmfCoreModelLoader: Please enter a non-null growth form.");
+        return false;
+    }
+
+    bool isAlpha    = (dataStruct.CompetitionForm == "NO_K");
+    bool isRho      = (dataStruct.PredationForm   != "Null");
+    bool isHandling = (dataStruct.PredationForm   == "Type II") || (dataStruct.PredationForm == "Type III");
+    bool isExponent = (dataStruct.PredationForm   == "Type III");
+    bool isMSPROD   = (dataStruct.CompetitionForm == "MS-PROD");
+    bool isAGGPROD  = (dataStruct.CompetitionForm == "AGG-PROD");
+    isSurveyQ       = (obsBiomassType == "Relative");
+
+    // Get Guild information
+    fields    = {"GuildName","GuildK"};
+    queryStr  = "SELECT GuildName,GuildK from Guilds ORDER by GuildName";
+    dataMap   = m_DatabasePtr->nmfQueryDatabase(queryStr, fields);
+    NumGuilds = dataMap["GuildName"].size();
+    dataStruct.NumGuilds = NumGuilds;
+    for (int i=0; i<NumGuilds; ++i) {
+        guildName = dataMap["GuildName"][i];
+        m_GuildNames.push_back(guildName);
+        GuildMap[guildName] = i;
+    }
+
+    if (isAGGPROD) {
+        fields     = {"GuildName","GrowthRateMin","GrowthRateMax","GuildK","GuildKMin",
+                      "GuildKMax","CatchabilityMin","CatchabilityMax"};
+        queryStr   = "SELECT GuildName,GrowthRateMin,GrowthRateMax,GuildK,GuildKMin,";
+        queryStr  += "GuildKMax,CatchabilityMin,CatchabilityMax from Guilds ORDER BY GuildName";
+        dataMap    = m_DatabasePtr->nmfQueryDatabase(queryStr, fields);
+        nmfUtils::initialize(dataStruct.InitBiomass,        NumGuilds);
+        nmfUtils::initialize(dataStruct.InitBiomassMin,     NumGuilds);
+        nmfUtils::initialize(dataStruct.InitBiomassMax,     NumGuilds);
+        nmfUtils::initialize(dataStruct.GrowthRateMin,      NumGuilds);
+        nmfUtils::initialize(dataStruct.GrowthRateMax,      NumGuilds);
+        nmfUtils::initialize(dataStruct.CarryingCapacity,   NumGuilds);
+        nmfUtils::initialize(dataStruct.CarryingCapacityMin,NumGuilds);
+        nmfUtils::initialize(dataStruct.CarryingCapacityMax,NumGuilds);
+        nmfUtils::initialize(dataStruct.CatchabilityMin,    NumGuilds);
+        nmfUtils::initialize(dataStruct.CatchabilityMax,    NumGuilds);
+        for (int guild=0; guild<NumGuilds; ++guild) {
+            dataStruct.GrowthRateMin[guild]       = std::stod(dataMap["GrowthRateMin"][guild]);
+            dataStruct.GrowthRateMax[guild]       = std::stod(dataMap["GrowthRateMax"][guild]);
+            dataStruct.CarryingCapacity[guild]    = std::stod(dataMap["GuildK"][guild]);
+            dataStruct.CarryingCapacityMin[guild] = std::stod(dataMap["GuildKMin"][guild]);
+            dataStruct.CarryingCapacityMax[guild] = std::stod(dataMap["GuildKMax"][guild]);
+            dataStruct.CatchabilityMin[guild]     = std::stod(dataMap["CatchabilityMin"][guild]);
+            dataStruct.CatchabilityMax[guild]     = std::stod(dataMap["CatchabilityMax"][guild]);
+            GuildNum = GuildMap[dataMap["GuildName"][guild]];
+            dataStruct.GuildSpecies[GuildNum].push_back(guild);
+            dataStruct.GuildNum.push_back(GuildNum);
+        }
+        fields     = {"SpeName","GuildName","InitBiomass","InitBiomassMin","InitBiomassMax"};
+        queryStr   = "SELECT SpeName,GuildName,InitBiomass,InitBiomassMin,InitBiomassMax from Species ORDER BY SpeName";
+        dataMap    = m_DatabasePtr->nmfQueryDatabase(queryStr, fields);
+        NumSpecies = dataMap["SpeName"].size();
+        for (int species=0; species<NumSpecies; ++species) {
+            guildName = dataMap["GuildName"][species];
+            m_SpeciesNames.push_back(dataMap["SpeName"][species]);
+            initialGuildBiomass[guildName]    += std::stod(dataMap["InitBiomass"][species]);
+            initialGuildBiomassMin[guildName] += std::stod(dataMap["InitBiomassMin"][species]);
+            initialGuildBiomassMax[guildName] += std::stod(dataMap["InitBiomassMax"][species]);
+        }
+        dataStruct.NumSpecies = NumSpecies;
+        checkGuildRanges(NumGuilds,dataStruct);
+    } else {
+        fields     = {"SpeName","GuildName","InitBiomass","InitBiomassMin","InitBiomassMax","GrowthRate","GrowthRateMin","GrowthRateMax",
+                      "SpeciesK","SpeciesKMin","SpeciesKMax","Catchability","CatchabilityMin","CatchabilityMax","SurveyQ","SurveyQMin","SurveyQMax"};
+        queryStr   = "SELECT SpeName,GuildName,InitBiomass,InitBiomassMin,InitBiomassMax,GrowthRate,GrowthRateMin,GrowthRateMax,";
+        queryStr  += "SpeciesK,SpeciesKMin,SpeciesKMax,Catchability,CatchabilityMin,CatchabilityMax,SurveyQ,SurveyQMin,SurveyQMax from Species ORDER BY SpeName";
+        dataMap    = m_DatabasePtr->nmfQueryDatabase(queryStr, fields);
+        NumSpecies = dataMap["SpeName"].size();
+        dataStruct.NumSpecies = NumSpecies;
+        nmfUtils::initialize(dataStruct.InitBiomass,        NumSpecies);
+        nmfUtils::initialize(dataStruct.InitBiomassMin,     NumSpecies);
+        nmfUtils::initialize(dataStruct.InitBiomassMax,     NumSpecies);
+        nmfUtils::initialize(dataStruct.GrowthRate,         NumSpecies);
+        nmfUtils::initialize(dataStruct.GrowthRateMin,      NumSpecies);
+        nmfUtils::initialize(dataStruct.GrowthRateMax,      NumSpecies);
+        nmfUtils::initialize(dataStruct.CarryingCapacity,   NumSpecies);
+        nmfUtils::initialize(dataStruct.CarryingCapacityMin,NumSpecies);
+        nmfUtils::initialize(dataStruct.CarryingCapacityMax,NumSpecies);
+        nmfUtils::initialize(dataStruct.Catchability,       NumSpecies);
+        nmfUtils::initialize(dataStruct.CatchabilityMin,    NumSpecies);
+        nmfUtils::initialize(dataStruct.CatchabilityMax,    NumSpecies);
+        nmfUtils::initialize(dataStruct.SurveyQ,            NumSpecies);
+        nmfUtils::initialize(dataStruct.SurveyQMin,         NumSpecies);
+        nmfUtils::initialize(dataStruct.SurveyQMax,         NumSpecies);
+        for (int species=0; species<NumSpecies; ++species) {
+            m_SpeciesNames.push_back(dataMap["SpeName"][species]);
+            dataStruct.InitBiomass[species]         = std::stod(dataMap["InitBiomass"][species]);
+            dataStruct.InitBiomassMin[species]      = std::stod(dataMap["InitBiomassMin"][species]);
+            dataStruct.InitBiomassMax[species]      = std::stod(dataMap["InitBiomassMax"][species]);
+            dataStruct.GrowthRate[species]          = std::stod(dataMap["GrowthRate"][species]);
+            dataStruct.GrowthRateMin[species]       = std::stod(dataMap["GrowthRateMin"][species]);
+            dataStruct.GrowthRateMax[species]       = std::stod(dataMap["GrowthRateMax"][species]);
+            dataStruct.CarryingCapacity[species]    = std::stod(dataMap["SpeciesK"][species]);
+            dataStruct.CarryingCapacityMin[species] = std::stod(dataMap["SpeciesKMin"][species]);
+            dataStruct.CarryingCapacityMax[species] = std::stod(dataMap["SpeciesKMax"][species]);
+            dataStruct.Catchability[species]        = std::stod(dataMap["Catchability"][species]);
+            dataStruct.CatchabilityMin[species]     = std::stod(dataMap["CatchabilityMin"][species]);
+            dataStruct.CatchabilityMax[species]     = std::stod(dataMap["CatchabilityMax"][species]);
+            if (isSurveyQ) {
+                dataStruct.SurveyQ[species]         = std::stod(dataMap["SurveyQ"][species]);
+                dataStruct.SurveyQMin[species]      = std::stod(dataMap["SurveyQMin"][species]);
+                dataStruct.SurveyQMax[species]      = std::stod(dataMap["SurveyQMax"][species]);
+            } else {
+                dataStruct.SurveyQ[species]         = 1.0;
+                dataStruct.SurveyQMin[species]      = 1.0;
+                dataStruct.SurveyQMax[species]      = 1.0;
+            }
+            guildName = dataMap["GuildName"][species];
+            GuildNum  = GuildMap[guildName];
+            initialGuildBiomass[guildName]    += std::stod(dataMap["InitBiomass"][species]);
+            initialGuildBiomassMin[guildName] += std::stod(dataMap["InitBiomassMin"][species]);
+            initialGuildBiomassMax[guildName] += std::stod(dataMap["InitBiomassMax"][species]);
+            dataStruct.GuildSpecies[GuildNum].push_back(species);
+            dataStruct.GuildNum.push_back(GuildNum);
+        }
+    }
+
+    NumSpeciesOrGuilds = (isAGGPROD) ? NumGuilds : NumSpecies;
+
+    // Load Interaction coefficients
+    if (isAlpha) {
+        loadOK = loadInteraction(dataStruct, NumSpeciesOrGuilds, NumSpeciesOrGuilds,
+                                 "CompetitionAlpha", {"SystemName","SpeciesA","SpeciesB","Value"},
+                                 "CompetitionAlpha","CompetitionAlphaMin","CompetitionAlphaMax",
+                                 dataStruct.CompetitionMin, dataStruct.CompetitionMax,
+                                 NumCompetitionParameters);
+        if (! loadOK) return false;
+    }
+    if (isRho) {
+        loadOK = loadInteraction(dataStruct, NumSpeciesOrGuilds, NumSpeciesOrGuilds,
+                                 "PredationRho", {"SystemName","SpeciesA","SpeciesB","Value"},
+                                 "PredationRho","PredationRhoMin","PredationRhoMax",
+                                 dataStruct.PredationRhoMin, dataStruct.PredationRhoMax,
+                                 NumPredationParameters);
+        if (! loadOK) return false;
+    }
+    if (isHandling) {
+        loadOK = loadInteraction(dataStruct, NumSpeciesOrGuilds, NumSpeciesOrGuilds,
+                                 "PredationHandling", {"SystemName","SpeciesA","SpeciesB","Value"},
+                                 "PredationHandling","PredationHandlingMin","PredationHandlingMax",
+                                 dataStruct.PredationHandlingMin, dataStruct.PredationHandlingMax,
+                                 NumHandlingParameters);
+        if (! loadOK) return false;
+    }
+    if (isExponent) {
+        loadOK = loadInteraction(dataStruct, NumSpeciesOrGuilds, "PredationExponent",
+                                 "PredationExponent","PredationExponentMin","PredationExponentMax",
+                                 dataStruct.PredationExponentMin, dataStruct.PredationExponentMax,
+                                 NumExponentParameters);
+        if (! loadOK) return false;
+    }
+    if (isMSPROD) {
+        loadOK = loadInteraction(dataStruct, NumSpecies, NumSpecies,
+                                 "CompetitionBetaSpeciesSpecies", {"SystemName","SpeciesA","SpeciesB","Value"},
+                                 "CompetitionBetaSpecies","CompetitionBetaSpeciesMin","CompetitionBetaSpeciesMax",
+                                 dataStruct.CompetitionBetaSpeciesMin, dataStruct.CompetitionBetaSpeciesMax,
+                                 NumBetaSpeciesParameters);
+        if (! loadOK) return false;
+        loadOK = loadInteraction(dataStruct, NumSpecies, NumGuilds,
+                                 "CompetitionBetaGuildSpecies", {"SystemName","SpeName","Guild","Value"},
+                                 "CompetitionBetaGuilds","CompetitionBetaGuildsMin","CompetitionBetaGuildsMax",
+                                 dataStruct.CompetitionBetaGuildsMin, dataStruct.CompetitionBetaGuildsMax,
+                                 NumBetaGuildsParameters);
+        if (! loadOK) return false;
+    } else if (isAGGPROD) {
+        loadOK = loadInteraction(dataStruct, NumGuilds, NumGuilds,
+                                 "CompetitionBetaGuildGuild", {"SystemName","GuildA","GuildB","Value"},
+                                 "CompetitionBetaGuildsGuilds","CompetitionBetaGuildsGuildsMin","CompetitionBetaGuildsGuildsMax",
+                                 dataStruct.CompetitionBetaGuildsGuildsMin, dataStruct.CompetitionBetaGuildsGuildsMax,
+                                 NumBetaGuildsParameters);
+        if (! loadOK) return false;
+    }
+
+    // Calculate total number of parameters
+    dataStruct.TotalNumberParameters = 0;
+    if (dataStruct.GrowthForm == "Linear") {
+        dataStruct.TotalNumberParameters += NumSpecies; // Just r for each Species
+    } else if (dataStruct.GrowthForm == "Logistic") {
+        dataStruct.TotalNumberParameters += NumSpecies; // Just r
+        dataStruct.TotalNumberParameters += NumSpecies; // Just K
+    }
+    dataStruct.TotalNumberParameters += NumSpecies; // Add on for estimating InitBiomass parameter
+    if (dataStruct.HarvestForm == "Effort (qE)") {
+        dataStruct.TotalNumberParameters += NumSpecies;
+    }
+    if (isRho) {
+        dataStruct.TotalNumberParameters += NumPredationParameters;
+    }
+    if (isHandling) {
+        dataStruct.TotalNumberParameters += NumHandlingParameters;
+    }
+    if (isExponent) {
+        dataStruct.TotalNumberParameters += NumExponentParameters;
+    }
+    if (isAlpha) {
+        dataStruct.TotalNumberParameters += NumCompetitionParameters;
+    } else if (isMSPROD) {
+        dataStruct.TotalNumberParameters += NumBetaSpeciesParameters;
+        dataStruct.TotalNumberParameters += NumBetaGuildsParameters;
+    } else if (isAGGPROD) {
+        dataStruct.TotalNumberParameters += NumBetaGuildsParameters;
+    }
+    // SurveyQ is always estimated (see nmfMainWindow::loadParameters)
+    dataStruct.TotalNumberParameters += NumSpecies;
+
+    dataStruct.Benchmark = dataStruct.GrowthForm;
+    if (isAlpha || isRho) {
+        dataStruct.Benchmark = "LogisticMultiSpecies";
+    }
+
+    if (dataStruct.HarvestForm == "Catch") {
+        loadOK = loadTimeSeries("HarvestCatch","",NumSpecies,RunLength,dataStruct.Catch);
+    } else if (dataStruct.HarvestForm == "Effort (qE)") {
+        loadOK = loadTimeSeries("HarvestEffort","",NumSpecies,RunLength,dataStruct.Effort);
+    } else if (dataStruct.HarvestForm == "Exploitation (F)") {
+        loadOK = loadTimeSeries("HarvestExploitation","",NumSpecies,RunLength,dataStruct.Exploitation);
+    }
+    if (! loadOK) return false;
+
+    loadOK = loadTimeSeries((isSurveyQ) ? "BiomassRelative" : "BiomassAbsolute","",
+                            NumSpecies,RunLength,dataStruct.ObservedBiomassBySpecies);
+    if (! loadOK) return false;
+
+    // Only the first year of the observed biomass by guild is used
+    nmfUtils::initialize(dataStruct.ObservedBiomassByGuilds,RunLength+1,NumGuilds);
+    for (int i=0; i<NumGuilds; ++i) {
+       dataStruct.ObservedBiomassByGuilds(0,i) = initialGuildBiomass[m_GuildNames[i]];
+       if (isAGGPROD) {
+           dataStruct.InitBiomassMin[i] = initialGuildBiomassMin[m_GuildNames[i]];
+           dataStruct.InitBiomassMax[i] = initialGuildBiomassMax[m_GuildNames[i]];
+       }
+    }
+
+    return true;
+}
+
+bool
+nmfCoreModelLoader::loadForecast(const std::string& ForecastName,
+                                 nmfStructsQt::ModelDataStruct& dataStruct)
+{
+    bool loadOK = true;
+    int RunLength;
+    std::vector<std::string> fields;
+    std::map<std::string, std::vector<std::string> > dataMap;
+    std::string queryStr;
+
+    fields    = {"ForecastName","RunLength","HarvestForm"};
+    queryStr  = "SELECT ForecastName,RunLength,HarvestForm FROM Forecasts";
+    queryStr += " WHERE ForecastName = '" + ForecastName + "'";
+    dataMap   = m_DatabasePtr->nmfQueryDatabase(queryStr, fields);
+    if (dataMap["ForecastName"].empty()) {
+        logMsg(nmfConstants::Error,"nmfCoreModelLoader: No forecast found named: " + ForecastName);
+        return false;
+    }
+    RunLength              = std::stoi(dataMap["RunLength"][0]);
+    dataStruct.RunLength   = RunLength;
+    dataStruct.HarvestForm = dataMap["HarvestForm"][0];
+    dataStruct.Catch.clear();
+    dataStruct.Effort.clear();
+    dataStruct.Exploitation.clear();
+
+    if (dataStruct.HarvestForm == "Catch") {
+        loadOK = loadTimeSeries("HarvestCatch",ForecastName,dataStruct.NumSpecies,RunLength,dataStruct.Catch);
+    } else if (dataStruct.HarvestForm == "Effort (qE)") {
+        loadOK = loadTimeSeries("HarvestEffort",ForecastName,dataStruct.NumSpecies,RunLength,dataStruct.Effort);
+    } else if (dataStruct.HarvestForm == "Exploitation (F)") {
+        loadOK = loadTimeSeries("HarvestExploitation",ForecastName,dataStruct.NumSpecies,RunLength,dataStruct.Exploitation);
+    }
+
+    return loadOK;
+}
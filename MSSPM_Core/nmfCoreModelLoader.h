@@ -0,0 +1,141 @@
+/**
+ * @file nmfCoreModelLoader.h
+ * @brief Class definition for the headless model loader of the MSSPM core library
+ *
+ * This file contains the class definition for nmfCoreModelLoader. The class
+ * fills a ModelDataStruct from a project database the same way
+ * nmfMainWindow::loadParameters does, but it takes the parameters to estimate
+ * as an argument instead of reading the Estimation tab's check boxes, and it
+ * reports problems through the logger instead of message boxes. A loader only
+ * touches the database connection it was given, so loaders on different
+ * threads may run at the same time as long as each has its own connection.
+ *
+ * @copyright
+ * Public Domain Notice\n
+ *
+ * National Oceanic And Atmospheric Administration\n\n
+ *
+ * This software is a "United States Government Work" under the terms of the
+ * United States Copyright Act.  It was written as part of the author's official
+ * duties as a United States Government employee/contractor and thus cannot be copyrighted.
+ * This software is freely available to the public for use. The National Oceanic
+ * And Atmospheric Administration and the U.S. Government have not placed any
+ * restriction on its use or reproduction.  Although all reasonable efforts have
+ * been taken to ensure the accuracy and reliability of the software and data,
+ * the National Oceanic And Atmospheric Administration and the U.S. Government
+ * do not and cannot warrant the performance or results that may be obtained
+ * by using this software or data. The National Oceanic And Atmospheric
+ * Administration and the U.S. Government disclaim all warranties, express
+ * or implied, including warranties of performance, merchantability or fitness
+ * for any particular purpose.\n\n
+ *
+ * Please cite the author(s) in any work or product based on this material.
+ */
+
+#pragma once
+
+#include "nmfDatabase.h"
+#include "nmfLogger.h"
+#include "nmfConstantsMSSPM.h"
+#include "nmfStructsQt.h"
+#include "nmfUtils.h"
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Loads a model's parameter ranges and time series from the database without any widgets
+ */
+class nmfCoreModelLoader
+{
+    nmfDatabase*             m_DatabasePtr;
+    nmfLogger*               m_Logger;
+    std::string              m_SystemName;
+    int                      m_StartYear;
+    std::vector<std::string> m_SpeciesNames;
+    std::vector<std::string> m_GuildNames;
+    static std::mutex        m_LoggerMutex;
+
+    void checkGuildRanges(const int& NumGuilds,
+                          const nmfStructsQt::ModelDataStruct& dataStruct);
+    bool loadInteraction(const nmfStructsQt::ModelDataStruct& dataStruct,
+                         const int& NumSpeciesOrGuilds,
+                         const std::string& Parameter,
+                         const std::string& InitTable,
+                         const std::string& MinTable,
+                         const std::string& MaxTable,
+                         std::vector<double>& MinData,
+                         std::vector<double>& MaxData,
+                         int& NumInteractionParameters);
+    bool loadInteraction(const nmfStructsQt::ModelDataStruct& dataStruct,
+                         const int& NumRows,
+                         const int& NumCols,
+                         const std::string& Parameter,
+                         const std::vector<std::string>& Fields,
+                         const std::string& InitTable,
+                         const std::string& MinTable,
+                         const std::string& MaxTable,
+                         std::vector<std::vector<double> >& MinData,
+                         std::vector<std::vector<double> >& MaxData,
+                         int& NumInteractionParameters);
+    bool loadTimeSeries(const std::string& Table,
+                        const std::string& ForecastName,
+                        const int& NumSpecies,
+                        const int& RunLength,
+                        boost::numeric::ublas::matrix<double>& TimeSeries);
+    void logMsg(const int& Level,
+                const std::string& Msg);
+
+public:
+    /**
+     * @brief Class constructor
+     * @param databasePtr : pointer to a database connection with the project database selected
+     * @param logger : pointer to the application logger
+     * @param SystemName : name of the model (i.e., the SystemName in the Systems table)
+     */
+    nmfCoreModelLoader(nmfDatabase*       databasePtr,
+                       nmfLogger*         logger,
+                       const std::string& SystemName);
+    virtual ~nmfCoreModelLoader() {}
+
+    /**
+     * @brief Returns the guild names in the order used by the loaded model
+     * @return Vector of guild names
+     */
+    const std::vector<std::string>& getGuildNames() const;
+    /**
+     * @brief Returns the species names in the order used by the loaded model
+     * @return Vector of species names
+     */
+    const std::vector<std::string>& getSpeciesNames() const;
+    /**
+     * @brief Returns the first year of the model's time series
+     * @return The model's start year
+     */
+    int getStartYear() const;
+    /**
+     * @brief Replaces the model's run length and harvest time series with those of a forecast
+     * @param ForecastName : name of the forecast (i.e., the ForecastName in the Forecasts table)
+     * @param dataStruct : structure already filled by loadParameters
+     * @return Returns false if the forecast or its harvest data can't be found
+     */
+    bool loadForecast(const std::string& ForecastName,
+                      nmfStructsQt::ModelDataStruct& dataStruct);
+    /**
+     * @brief Loads the model's forms, algorithm settings, parameter ranges and time series
+     * @param dataStruct : structure to fill; its EstimateRunBoxes must already hold the parameters to estimate
+     * @return Returns false if the model is incomplete or inconsistent
+     */
+    bool loadParameters(nmfStructsQt::ModelDataStruct& dataStruct);
+    /**
+     * @brief Logs a message through a logger that may be shared by other threads
+     * @param Logger : the logger to write to
+     * @param Level : nmfConstants::Normal, Warning or Error
+     * @param Msg : the message to log
+     */
+    static void logMsg(nmfLogger* Logger,
+                       const int& Level,
+                       const std::string& Msg);
+};
@@ -0,0 +1,178 @@
+
+#include "nmfCoreResultWriter.h"
+#include "nmfCoreModelLoader.h"
+#include "nmfUtilsQt.h"
+
+#include <cmath>
+#include <sstream>
+
+nmfCoreResultWriter::nmfCoreResultWriter(nmfDatabase* databasePtr,
+                                         nmfLogger*   logger)
+{
+    m_DatabasePtr = databasePtr;
+    m_Logger      = logger;
+    m_isAggProd   = "0";
+}
+
+std::string
+nmfCoreResultWriter::keyValues() const
+{
+    return "'','" + m_Algorithm + "','" + m_Minimizer + "','" + m_ObjectiveCriterion +
+           "','" + m_Scaling + "'," + m_isAggProd;
+}
+
+std::string
+nmfCoreResultWriter::keyConditions() const
+{
+    return " WHERE MohnsRhoLabel = '' AND Algorithm = '" + m_Algorithm +
+           "' AND Minimizer = '" + m_Minimizer +
+           "' AND ObjectiveCriterion = '" + m_ObjectiveCriterion +
+           "' AND Scaling = '" + m_Scaling +
+           "' AND isAggProd = " + m_isAggProd;
+}
+
+bool
+nmfCoreResultWriter::update(const std::string& Cmd)
+{
+    std::string errorMsg = m_DatabasePtr->nmfUpdateDatabase(Cmd);
+
+    if (nmfUtilsQt::isAnError(errorMsg)) {
+        nmfCoreModelLoader::logMsg(m_Logger,nmfConstants::Error,"nmfCoreResultWriter: " + errorMsg);
+        nmfCoreModelLoader::logMsg(m_Logger,nmfConstants::Error,"cmd: " + Cmd);
+        return false;
+    }
+    return true;
+}
+
+bool
+nmfCoreResultWriter::writeVector(const std::string& Table,
+                                 const std::vector<std::string>& Names,
+                                 const std::vector<double>& Values)
+{
+    double value;
+    std::string cmd;
+
+    if (! update("DELETE FROM " + Table + keyConditions())) {
+        return false;
+    }
+
+    // As in the GUI, a parameter that isn't estimated is saved as 0
+    cmd = "REPLACE INTO " + Table +
+          " (MohnsRhoLabel,Algorithm,Minimizer,ObjectiveCriterion,Scaling,isAggProd,SpeName,Value) VALUES ";
+    for (unsigned i=0; i<Names.size(); ++i) {
+        value = (i < Values.size()) ? Values[i] : 0;
+        cmd += "(" + keyValues() + ",'" + Names[i] + "'," + std::to_string(value) + "),";
+    }
+    cmd = cmd.substr(0,cmd.size()-1);
+
+    return update(cmd);
+}
+
+bool
+nmfCoreResultWriter::writeMatrix(const std::string& Table,
+                                 const std::string& RowField,
+                                 const std::string& ColField,
+                                 const std::vector<std::string>& RowNames,
+                                 const std::vector<std::string>& ColNames,
+                                 const boost::numeric::ublas::matrix<double>& Values)
+{
+    double value;
+    std::string cmd;
+
+    // Matrices of interactions that aren't in the model are left alone
+    if (Values.size1() == 0) {
+        return true;
+    }
+    if (! update("DELETE FROM " + Table + keyConditions())) {
+        return false;
+    }
+
+    cmd = "REPLACE INTO " + Table +
+          " (MohnsRhoLabel,Algorithm,Minimizer,ObjectiveCriterion,Scaling,isAggProd," +
+          RowField + "," + ColField + ",Value) VALUES ";
+    for (unsigned row=0; row<RowNames.size() && row<Values.size1(); ++row) {
+        for (unsigned col=0; col<ColNames.size() && col<Values.size2(); ++col) {
+            value = Values(row,col);
+            if (std::isnan(std::fabs(value))) {
+                value = 0;
+            }
+            std::ostringstream val;
+            val << value;
+            cmd += "(" + keyValues() + ",'" + RowNames[row] + "','" + ColNames[col] + "'," + val.str() + "),";
+        }
+    }
+    cmd = cmd.substr(0,cmd.size()-1);
+
+    return update(cmd);
+}
+
+bool
+nmfCoreResultWriter::writeBiomass(const std::vector<std::string>& Names,
+                                  const boost::numeric::ublas::matrix<double>& EstBiomass)
+{
+    double value;
+    std::string cmd;
+
+    if (! update("DELETE FROM OutputBiomass" + keyConditions())) {
+        return false;
+    }
+
+    // The years are numbered from 0, as in the GUI, and invalid biomass is saved as -1
+    cmd = "REPLACE INTO OutputBiomass"
+          " (MohnsRhoLabel,Algorithm,Minimizer,ObjectiveCriterion,Scaling,isAggProd,SpeName,Year,Value) VALUES ";
+    for (unsigned species=0; species<Names.size() && species<EstBiomass.size2(); ++species) {
+        for (unsigned time=0; time<EstBiomass.size1(); ++time) {
+            value = EstBiomass(time,species);
+            if (std::isnan(value)) {
+                value = -1;
+            }
+            cmd += "(" + keyValues() + ",'" + Names[species] + "'," + std::to_string(time) +
+                   "," + QString::number(value,'f',6).toStdString() + "),";
+        }
+    }
+    cmd = cmd.substr(0,cmd.size()-1);
+
+    return update(cmd);
+}
+
+bool
+nmfCoreResultWriter::saveEstimates(const nmfStructsQt::ModelDataStruct& dataStruct,
+                                   const std::vector<std::string>& SpeciesNames,
+                                   const std::vector<std::string>& GuildNames,
+                                   const nmfEstimationResult& Estimates)
+{
+    bool isAggProd = (dataStruct.CompetitionForm == "AGG-PROD");
+    const std::vector<std::string>& Names = (isAggProd) ? GuildNames : SpeciesNames;
+
+    if (Estimates.EstBiomassSpecies.size1() == 0) {
+        nmfCoreModelLoader::logMsg(m_Logger,nmfConstants::Error,
+                                   "nmfCoreResultWriter: The estimates have no biomass to save");
+        return false;
+    }
+
+    m_Algorithm          = dataStruct.EstimationAlgorithm;
+    m_Minimizer          = dataStruct.MinimizerAlgorithm;
+    m_ObjectiveCriterion = dataStruct.ObjectiveCriterion;
+    m_Scaling            = dataStruct.ScalingAlgorithm;
+    m_isAggProd          = (isAggProd) ? "1" : "0";
+
+    return writeVector("OutputInitBiomass",      Names,Estimates.EstInitBiomass)        &&
+           writeVector("OutputGrowthRate",       Names,Estimates.EstGrowthRates)        &&
+           writeVector("OutputCarryingCapacity", Names,Estimates.EstCarryingCapacities) &&
+           writeVector("OutputCatchability",     Names,Estimates.EstCatchability)       &&
+           writeVector("OutputPredationExponent",Names,Estimates.EstPredationExponent)  &&
+           writeVector("OutputSurveyQ",          Names,Estimates.EstSurveyQ)            &&
+           writeMatrix("OutputCompetitionAlpha",           "SpeciesA","SpeciesB",Names,       Names,
+                       Estimates.EstCompetitionAlpha)            &&
+           writeMatrix("OutputCompetitionBetaSpecies",     "SpeciesA","SpeciesB",Names,       Names,
+                       Estimates.EstCompetitionBetaSpecies)      &&
+           writeMatrix("OutputCompetitionBetaGuilds",      "SpeName", "Guild",   Names,       GuildNames,
+                       Estimates.EstCompetitionBetaGuilds)       &&
+           writeMatrix("OutputCompetitionBetaGuildsGuilds","GuildA",  "GuildB",  GuildNames,  GuildNames,
+                       Estimates.EstCompetitionBetaGuildsGuilds) &&
+           writeMatrix("OutputPredationRho",               "SpeciesA","SpeciesB",Names,       Names,
+                       Estimates.EstPredationRho)                &&
+           writeMatrix("OutputPredationHandling",          "SpeciesA","SpeciesB",Names,       Names,
+                       Estimates.EstPredationHandling)           &&
+           writeBiomass(Names,Estimates.EstBiomassSpecies);
+}
@@ -0,0 +1,98 @@
+/**
+ * @file nmfCoreResultWriter.h
+ * @brief Class definition for the headless result writer of the MSSPM core library
+ *
+ * This file contains the class definition for nmfCoreResultWriter. The class
+ * writes a run's estimated parameters and biomass to the project database's
+ * Output tables the same way nmfMainWindow::updateOutputTables and
+ * nmfMainWindow::updateOutputBiomassTable do, but it reports problems through
+ * the logger instead of message boxes. As with nmfCoreModelLoader, a writer only
+ * touches the database connection it was given.
+ *
+ * @copyright
+ * Public Domain Notice\n
+ *
+ * National Oceanic And Atmospheric Administration\n\n
+ *
+ * This software is a "United States Government Work" under the terms of the
+ * United States Copyright Act.  It was written as part of the author's official
+ * duties as a United States Government employee/contractor and thus cannot be copyrighted.
+ * This software is freely available to the public for use. The National Oceanic
+ * And Atmospheric Administration and the U.S. Government have not placed any
+ * restriction on its use or reproduction.  Although all reasonable efforts have
+ * been taken to ensure the accuracy and reliability of the software and data,
+ * the National Oceanic And Atmospheric Administration and the U.S. Government
+ * do not and cannot warrant the performance or results that may be obtained
+ * by using this software or data. The National Oceanic And Atmospheric
+ * Administration and the U.S. Government disclaim all warranties, express
+ * or implied, including warranties of performance, merchantability or fitness
+ * for any particular purpose.\n\n
+ *
+ * Please cite the author(s) in any work or product based on this material.
+ */
+
+#pragma once
+
+#include "nmfDatabase.h"
+#include "nmfLogger.h"
+#include "nmfEstimationResult.h"
+#include "nmfStructsQt.h"
+
+#include <string>
+#include <vector>
+
+#include <boost/numeric/ublas/matrix.hpp>
+
+/**
+ * @brief Saves a run's estimates to the database without any widgets
+ */
+class nmfCoreResultWriter
+{
+    nmfDatabase* m_DatabasePtr;
+    nmfLogger*   m_Logger;
+    std::string  m_Algorithm;
+    std::string  m_Minimizer;
+    std::string  m_ObjectiveCriterion;
+    std::string  m_Scaling;
+    std::string  m_isAggProd;
+
+    std::string keyValues() const;
+    std::string keyConditions() const;
+    bool update(const std::string& Cmd);
+    bool writeVector(const std::string& Table,
+                     const std::vector<std::string>& Names,
+                     const std::vector<double>& Values);
+    bool writeMatrix(const std::string& Table,
+                     const std::string& RowField,
+                     const std::string& ColField,
+                     const std::vector<std::string>& RowNames,
+                     const std::vector<std::string>& ColNames,
+                     const boost::numeric::ublas::matrix<double>& Values);
+    bool writeBiomass(const std::vector<std::string>& Names,
+                      const boost::numeric::ublas::matrix<double>& EstBiomass);
+
+public:
+    /**
+     * @brief Class constructor
+     * @param databasePtr : pointer to a database connection with the project database selected
+     * @param logger : pointer to the application logger
+     */
+    nmfCoreResultWriter(nmfDatabase* databasePtr,
+                        nmfLogger*   logger);
+    virtual ~nmfCoreResultWriter() {}
+
+    /**
+     * @brief Replaces the model's estimated parameters and biomass in the Output tables. The rows
+     * are keyed by the model's algorithm, minimizer, objective criterion and scaling, and have no
+     * Mohn's Rho label. The MSY tables aren't written; the GUI calculates them when it shows a run.
+     * @param dataStruct : the model that was estimated
+     * @param SpeciesNames : species names in the order used by the model
+     * @param GuildNames : guild names in the order used by the model
+     * @param Estimates : the run's estimates, with its biomass already calculated
+     * @return Returns false if any of the tables couldn't be written
+     */
+    bool saveEstimates(const nmfStructsQt::ModelDataStruct& dataStruct,
+                       const std::vector<std::string>& SpeciesNames,
+                       const std::vector<std::string>& GuildNames,
+                       const nmfEstimationResult& Estimates);
+};
@@ -0,0 +1,140 @@
+
+#include "nmfCoreSimulator.h"
+#include "nmfCompetitionForm.h"
+#include "nmfGrowthForm.h"
+#include "nmfHarvestForm.h"
+#include "nmfPredationForm.h"
+#include "nmfUtils.h"
+
+#include <cmath>
+#include <map>
+#include <memory>
+
+bool
+nmfCoreSimulator::calculateBiomass(
+        const nmfStructsQt::ModelDataStruct&   dataStruct,
+        const nmfEstimationResult&             Estimates,
+        boost::numeric::ublas::matrix<double>& EstBiomassSpecies,
+        boost::numeric::ublas::matrix<double>& EstBiomassGuilds)
+{
+    int timeMinus1;
+    int guildNum;
+    int RunLength = dataStruct.RunLength;
+    int NumGuilds = dataStruct.NumGuilds;
+    bool isAggProd = (dataStruct.CompetitionForm == "AGG-PROD");
+    int NumSpeciesOrGuilds = (isAggProd) ? NumGuilds : dataStruct.NumSpecies;
+    double GuildCarryingCapacity;
+    double SystemCarryingCapacity = 0;
+    double EstBiomassVal;
+    double growthTerm;
+    double harvestTerm;
+    double competitionTerm;
+    double predationTerm;
+    // Copies, since the map's operator[] isn't const
+    std::vector<int> GuildNum = dataStruct.GuildNum;
+    std::map<int,std::vector<int> > GuildSpecies = dataStruct.GuildSpecies;
+    const std::vector<double>& EstCarryingCapacities = Estimates.EstCarryingCapacities;
+
+    if ((int(Estimates.EstInitBiomass.size())        != NumSpeciesOrGuilds) ||
+        (int(Estimates.EstGrowthRates.size())        != NumSpeciesOrGuilds) ||
+        (int(Estimates.EstCarryingCapacities.size()) != NumSpeciesOrGuilds)) {
+        return false;
+    }
+
+    // Each call has its own form objects so simulations may run in parallel
+    std::unique_ptr<nmfGrowthForm>      growthForm(     new nmfGrowthForm(dataStruct.GrowthForm));
+    std::unique_ptr<nmfHarvestForm>     harvestForm(    new nmfHarvestForm(dataStruct.HarvestForm));
+    std::unique_ptr<nmfCompetitionForm> competitionForm(new nmfCompetitionForm(dataStruct.CompetitionForm));
+    std::unique_ptr<nmfPredationForm>   predationForm(  new nmfPredationForm(dataStruct.PredationForm));
+
+    // Even though this is EstInitBiomass, if initial biomass wasn't estimated, it
+    // should be the initial biomass.
+    nmfUtils::initialize(EstBiomassSpecies,RunLength+1,NumSpeciesOrGuilds);
+    for (int species=0; species<NumSpeciesOrGuilds; ++species) {
+        EstBiomassSpecies(0,species) = Estimates.EstInitBiomass[species];
+    }
+
+    // Only the first year of the observed biomass by guild is used
+    nmfUtils::initialize(EstBiomassGuilds,RunLength+1,NumGuilds);
+    if (dataStruct.ObservedBiomassByGuilds.size1() > 0) {
+        for (int guild=0; guild<NumGuilds; ++guild) {
+            EstBiomassGuilds(0,guild) = dataStruct.ObservedBiomassByGuilds(0,guild);
+        }
+    }
+
+    // Calculate System Carrying Capacity
+    if (isAggProd) {
+        for (int i=0; i<NumGuilds; ++i) {
+            SystemCarryingCapacity += EstCarryingCapacities[i];
+        }
+    } else {
+        for (int i=0; i<NumGuilds; ++i) {
+            for (unsigned j=0; j<GuildSpecies[i].size(); ++j) {
+                SystemCarryingCapacity += EstCarryingCapacities[GuildSpecies[i][j]];
+            }
+        }
+    }
+
+    for (int time=1; time<=RunLength; ++time) {
+        timeMinus1 = time-1;
+        for (int species=0; species<NumSpeciesOrGuilds; ++species) {
+            // Find the guild carrying capacity for guild: guildNum
+            GuildCarryingCapacity = 0;
+            if (isAggProd) {
+                GuildCarryingCapacity = EstCarryingCapacities[species];
+            } else {
+                guildNum = GuildNum[species];
+                for (unsigned j=0; j<GuildSpecies[guildNum].size(); ++j) {
+                    GuildCarryingCapacity += EstCarryingCapacities[GuildSpecies[guildNum][j]];
+                }
+            }
+
+            EstBiomassVal = EstBiomassSpecies(timeMinus1,species);
+
+            growthTerm      = growthForm->evaluate(species,EstBiomassVal,
+                                                   Estimates.EstGrowthRates,EstCarryingCapacities);
+            harvestTerm     = harvestForm->evaluate(timeMinus1,species,
+                                                    dataStruct.Catch,dataStruct.Effort,
+                                                    dataStruct.Exploitation,
+                                                    EstBiomassVal,
+                                                    Estimates.EstCatchability);
+            competitionTerm = competitionForm->evaluate(timeMinus1,
+                                                        species,
+                                                        EstBiomassVal,
+                                                        SystemCarryingCapacity,
+                                                        Estimates.EstGrowthRates,
+                                                        GuildCarryingCapacity,
+                                                        Estimates.EstCompetitionAlpha,
+                                                        Estimates.EstCompetitionBetaSpecies,
+                                                        Estimates.EstCompetitionBetaGuilds,
+                                                        Estimates.EstCompetitionBetaGuildsGuilds,
+                                                        EstBiomassSpecies,
+                                                        EstBiomassGuilds);
+            predationTerm   = predationForm->evaluate(timeMinus1,species,
+                                                      Estimates.EstPredationRho,
+                                                      Estimates.EstPredationHandling,
+                                                      Estimates.EstPredationExponent,
+                                                      EstBiomassSpecies,EstBiomassVal);
+
+            EstBiomassVal += growthTerm - harvestTerm - competitionTerm - predationTerm;
+
+            if (std::isnan(std::fabs(EstBiomassVal)) || (EstBiomassVal < 0)) {
+                EstBiomassVal = 0;
+            }
+            EstBiomassSpecies(time,species) = EstBiomassVal;
+        }
+
+        // Update the guild biomass for the next time step
+        for (int i=0; i<NumGuilds; ++i) {
+            if (isAggProd) {
+                EstBiomassGuilds(time,i) = EstBiomassSpecies(time,i);
+            } else {
+                for (unsigned j=0; j<GuildSpecies[i].size(); ++j) {
+                    EstBiomassGuilds(time,i) += EstBiomassSpecies(time,GuildSpecies[i][j]);
+                }
+            }
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,59 @@
+/**
+ * @file nmfCoreSimulator.h
+ * @brief Definition for the biomass simulation of the MSSPM core library
+ *
+ * This file contains the definition for nmfCoreSimulator. The simulator runs
+ * a model forward in time from a set of estimated parameters. It only reads
+ * its arguments and creates its own model form objects, so any number of
+ * threads may run simulations at the same time.
+ *
+ * @copyright
+ * Public Domain Notice\n
+ *
+ * National Oceanic And Atmospheric Administration\n\n
+ *
+ * This software is a "United States Government Work" under the terms of the
+ * United States Copyright Act.  It was written as part of the author's official
+ * duties as a United States Government employee/contractor and thus cannot be copyrighted.
+ * This software is freely available to the public for use. The National Oceanic
+ * And Atmospheric Administration and the U.S. Government have not placed any
+ * restriction on its use or reproduction.  Although all reasonable efforts have
+ * been taken to ensure the accuracy and reliability of the software and data,
+ * the National Oceanic And Atmospheric Administration and the U.S. Government
+ * do not and cannot warrant the performance or results that may be obtained
+ * by using this software or data. The National Oceanic And Atmospheric
+ * Administration and the U.S. Government disclaim all warranties, express
+ * or implied, including warranties of performance, merchantability or fitness
+ * for any particular purpose.\n\n
+ *
+ * Please cite the author(s) in any work or product based on this material.
+ */
+
+#pragma once
+
+#include "nmfEstimationResult.h"
+#include "nmfStructsQt.h"
+
+#include <boost/numeric/ublas/matrix.hpp>
+
+/**
+ * @brief Calculates the biomass produced by a model and a set of estimated parameters
+ */
+class nmfCoreSimulator
+{
+public:
+    /**
+     * @brief Runs the model forward from the estimated initial biomass. Forecasts are
+     * run the same way, with the forecast's run length and harvest in the data struct.
+     * @param dataStruct : model forms, run length, harvest time series and guild map (as filled by nmfCoreModelLoader)
+     * @param Estimates : the estimated parameters to simulate with
+     * @param EstBiomassSpecies : estimated biomass by species (or by guild if running AGG-PROD)
+     * @param EstBiomassGuilds : estimated biomass by guild
+     * @return Returns false if the estimates don't match the model's size
+     */
+    static bool calculateBiomass(
+            const nmfStructsQt::ModelDataStruct&   dataStruct,
+            const nmfEstimationResult&             Estimates,
+            boost::numeric::ublas::matrix<double>& EstBiomassSpecies,
+            boost::numeric::ublas::matrix<double>& EstBiomassGuilds);
+};
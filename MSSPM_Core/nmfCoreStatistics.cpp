@@ -0,0 +1,148 @@
+
+#include "nmfCoreStatistics.h"
+#include "nmfConstants.h"
+
+void
+nmfCoreStatistics::appendModelValues(const int& NumSpeciesOrGuilds,
+                                     const bool& isSum,
+                                     std::vector<double>& Stat)
+{
+    double total = 0;
+
+    for (int species=0; species<NumSpeciesOrGuilds; ++species) {
+        if (Stat[species] != nmfConstants::NoValueDouble) {
+            total += Stat[species];
+        }
+    }
+    Stat.push_back((isSum) ? total : total/NumSpeciesOrGuilds);
+}
+
+nmfCoreStatisticsResult
+nmfCoreStatistics::calculateSummaryStatistics(const nmfCoreStatisticsInput& Input)
+{
+    bool ok;
+    double val;
+    double meanVal;
+    const int& NumSpeciesOrGuilds = Input.NumSpeciesOrGuilds;
+    const int& RunLength          = Input.RunLength;
+    std::vector<double> meanObserved;
+    std::vector<double> meanEstimated;
+    std::vector<double> observed;
+    std::vector<double> estimated;
+    nmfCoreStatisticsResult Result;
+    StatStruct& statStruct = Result.Stats;
+
+    if ((int(Input.ObservedBiomass.size1())  <= RunLength) || (int(Input.ObservedBiomass.size2())  < NumSpeciesOrGuilds) ||
+        (int(Input.EstimatedBiomass.size1()) <= RunLength) || (int(Input.EstimatedBiomass.size2()) < NumSpeciesOrGuilds)) {
+        Result.ErrorMsg = "calculateSummaryStatistics: Observed or estimated biomass is smaller than the model.";
+        return Result;
+    }
+
+    // Flatten the observed and estimated biomass and find their means
+    for (int species=0; species<NumSpeciesOrGuilds; ++species) {
+        meanVal = 0;
+        for (int time=0; time<=RunLength; ++time) {
+            val = Input.ObservedBiomass(time,species);
+            observed.push_back(val);
+            meanVal += val;
+        }
+        meanObserved.push_back(meanVal/(RunLength+1));
+        meanVal = 0;
+        for (int time=0; time<=RunLength; ++time) {
+            val = Input.EstimatedBiomass(time,species);
+            estimated.push_back(val);
+            meanVal += val;
+        }
+        meanEstimated.push_back(meanVal/(RunLength+1));
+    }
+
+    // Calculate SSresiduals
+    nmfUtilsStatistics::calculateSSResiduals(NumSpeciesOrGuilds,RunLength,observed,estimated,statStruct.SSresiduals);
+
+    // Calculate SSdeviations
+    ok = nmfUtilsStatistics::calculateSSDeviations(NumSpeciesOrGuilds,RunLength,estimated,meanObserved,statStruct.SSdeviations);
+    if (! ok) {
+        Result.ErrorMsg = "[Error 1] calculateSummaryStatistics: Found SSdeviation of 0.";
+        return Result;
+    }
+
+    // Calculate SStotals
+    nmfUtilsStatistics::calculateSSTotals(NumSpeciesOrGuilds,statStruct.SSdeviations,statStruct.SSresiduals,statStruct.SStotals);
+
+    // Calculate rsquared (between 0.2 and 0.3 good....closer to 1.0 the better)
+    nmfUtilsStatistics::calculateRSquared(NumSpeciesOrGuilds,statStruct.SSdeviations,statStruct.SStotals,statStruct.rsquared);
+
+    // AIC - Akaike Information Criterion (for Least Squares in this case)
+    // AIC = n * ln(sigma^2) + 2K; K = number of parameters, n = number of observations (i.e., RunLength), sigma^2 = SSresiduals/n
+    nmfUtilsStatistics::calculateAIC(NumSpeciesOrGuilds,Input.NumberOfParameters,RunLength,statStruct.SSresiduals,statStruct.aic);
+
+    // Calculate r
+    ok = nmfUtilsStatistics::calculateR(NumSpeciesOrGuilds,RunLength,meanObserved,meanEstimated,observed,estimated,statStruct.correlationCoeff);
+    if (! ok) {
+        Result.ErrorMsg = "[Error 2] calculateSummaryStatistics: Divide by 0 error in r calculations.";
+        return Result;
+    }
+
+    // Calculate RMSE
+    ok = nmfUtilsStatistics::calculateRMSE(NumSpeciesOrGuilds,RunLength,observed,estimated,statStruct.rmse);
+    if (! ok) {
+        Result.ErrorMsg = "[Error 2] calculateSummaryStatistics: Found 0 RunLength in RMSE calculations.";
+        return Result;
+    }
+
+    // Calculate RI
+    ok = nmfUtilsStatistics::calculateRI(NumSpeciesOrGuilds,RunLength,observed,estimated,statStruct.ri);
+    if (! ok) {
+        Result.ErrorMsg = "[Error 3] calculateSummaryStatistics: Found 0 RunLength in RI calculations.";
+        return Result;
+    }
+
+    // Calculate AE
+    nmfUtilsStatistics::calculateAE(NumSpeciesOrGuilds,meanObserved,meanEstimated,statStruct.ae);
+
+    // Calculate AAE
+    nmfUtilsStatistics::calculateAAE(NumSpeciesOrGuilds,RunLength,observed,estimated,statStruct.aae);
+
+    // Calculate MEF
+    ok = nmfUtilsStatistics::calculateMEF(NumSpeciesOrGuilds,RunLength,meanObserved,observed,estimated,statStruct.mef);
+    if (! ok) {
+        Result.ErrorMsg = "[Error 4] calculateSummaryStatistics: Found 0 denominator in MEF calculations.";
+        return Result;
+    }
+
+    // Calculate Mohn's Rho
+    if (Input.isMohnsRho) {
+        // nmfUtilsStatistics takes its arguments by non-const reference
+        std::vector<double> EstGrowthRate = Input.EstGrowthRate;
+        std::vector<double> EstCarryingCapacity = Input.EstCarryingCapacity;
+        std::vector<std::vector<double> > EstBiomassByPeel = Input.EstBiomassByPeel;
+        nmfUtilsStatistics::calculateMohnsRhoForParameter(
+                    Input.NumPeels,NumSpeciesOrGuilds,RunLength,
+                    EstGrowthRate,statStruct.mohnsRhoGrowthRate);
+        nmfUtilsStatistics::calculateMohnsRhoForParameter(
+                    Input.NumPeels,NumSpeciesOrGuilds,RunLength,
+                    EstCarryingCapacity,statStruct.mohnsRhoCarryingCapacity);
+        nmfUtilsStatistics::calculateMohnsRhoForTimeSeries(
+                    Input.NumPeels,NumSpeciesOrGuilds,EstBiomassByPeel,
+                    statStruct.mohnsRhoEstimatedBiomass);
+        appendModelValues(NumSpeciesOrGuilds,false,statStruct.mohnsRhoGrowthRate);
+        appendModelValues(NumSpeciesOrGuilds,false,statStruct.mohnsRhoCarryingCapacity);
+        appendModelValues(NumSpeciesOrGuilds,false,statStruct.mohnsRhoEstimatedBiomass);
+    } else {
+        // The sums of squares are totaled for the model and the rest are averaged
+        appendModelValues(NumSpeciesOrGuilds,true, statStruct.SSresiduals);
+        appendModelValues(NumSpeciesOrGuilds,true, statStruct.SSdeviations);
+        appendModelValues(NumSpeciesOrGuilds,true, statStruct.SStotals);
+        appendModelValues(NumSpeciesOrGuilds,false,statStruct.rsquared);
+        appendModelValues(NumSpeciesOrGuilds,false,statStruct.correlationCoeff);
+        appendModelValues(NumSpeciesOrGuilds,false,statStruct.aic);
+        appendModelValues(NumSpeciesOrGuilds,false,statStruct.rmse);
+        appendModelValues(NumSpeciesOrGuilds,false,statStruct.ri);
+        appendModelValues(NumSpeciesOrGuilds,false,statStruct.ae);
+        appendModelValues(NumSpeciesOrGuilds,false,statStruct.aae);
+        appendModelValues(NumSpeciesOrGuilds,false,statStruct.mef);
+    }
+
+    Result.isValid = true;
+    return Result;
+}
@@ -0,0 +1,103 @@
+/**
+ * @file nmfCoreStatistics.h
+ * @brief Definition for the summary statistics of the MSSPM core library
+ *
+ * This file contains the definition for nmfCoreStatistics along with the
+ * structures it takes and returns. The statistics are calculated from the
+ * values in the input structure only, so they may be calculated on any
+ * thread, e.g. with QtConcurrent::run.
+ *
+ * @copyright
+ * Public Domain Notice\n
+ *
+ * National Oceanic And Atmospheric Administration\n\n
+ *
+ * This software is a "United States Government Work" under the terms of the
+ * United States Copyright Act.  It was written as part of the author's official
+ * duties as a United States Government employee/contractor and thus cannot be copyrighted.
+ * This software is freely available to the public for use. The National Oceanic
+ * And Atmospheric Administration and the U.S. Government have not placed any
+ * restriction on its use or reproduction.  Although all reasonable efforts have
+ * been taken to ensure the accuracy and reliability of the software and data,
+ * the National Oceanic And Atmospheric Administration and the U.S. Government
+ * do not and cannot warrant the performance or results that may be obtained
+ * by using this software or data. The National Oceanic And Atmospheric
+ * Administration and the U.S. Government disclaim all warranties, express
+ * or implied, including warranties of performance, merchantability or fitness
+ * for any particular purpose.\n\n
+ *
+ * Please cite the author(s) in any work or product based on this material.
+ */
+
+#pragma once
+
+#include "nmfUtilsStatistics.h"
+
+#include <string>
+#include <vector>
+
+#include <boost/numeric/ublas/matrix.hpp>
+
+/**
+ * @brief Everything the summary statistics are calculated from
+ */
+struct nmfCoreStatisticsInput {
+    int NumSpeciesOrGuilds;
+    int RunLength;
+    /**
+     * @brief Number of model parameters (the K in the AIC)
+     */
+    int NumberOfParameters;
+    boost::numeric::ublas::matrix<double> ObservedBiomass;
+    boost::numeric::ublas::matrix<double> EstimatedBiomass;
+    /**
+     * @brief Return the Mohn's Rho statistics, calculated from the peel fields below, instead of the model fit statistics
+     */
+    bool isMohnsRho;
+    int  NumPeels;
+    /**
+     * @brief Estimated growth rates of every peel, one peel after another
+     */
+    std::vector<double> EstGrowthRate;
+    /**
+     * @brief Estimated carrying capacities of every peel, one peel after another
+     */
+    std::vector<double> EstCarryingCapacity;
+    /**
+     * @brief Estimated biomass of every peel (species by species). Entry i has i years peeled off.
+     */
+    std::vector<std::vector<double> > EstBiomassByPeel;
+
+    nmfCoreStatisticsInput() : NumSpeciesOrGuilds(0), RunLength(0), NumberOfParameters(0),
+                               isMohnsRho(false), NumPeels(0) {}
+};
+
+/**
+ * @brief The summary statistics, or why they couldn't be calculated
+ */
+struct nmfCoreStatisticsResult {
+    bool        isValid;
+    std::string ErrorMsg;
+    StatStruct  Stats;
+
+    nmfCoreStatisticsResult() : isValid(false) {}
+};
+
+/**
+ * @brief Calculates the model fit and Mohn's Rho summary statistics
+ */
+class nmfCoreStatistics
+{
+    static void appendModelValues(const int& NumSpeciesOrGuilds,
+                                  const bool& isSum,
+                                  std::vector<double>& Stat);
+
+public:
+    /**
+     * @brief Calculates the summary statistics of one run. Each statistic has one value
+     * per species (or guild) followed by the value for the whole model.
+     * @param Input : the observed and estimated data to compare
+     * @return The statistics; isValid is false and ErrorMsg says why if they couldn't be calculated
+     */
+    static nmfCoreStatisticsResult calculateSummaryStatistics(const nmfCoreStatisticsInput& Input);
+};
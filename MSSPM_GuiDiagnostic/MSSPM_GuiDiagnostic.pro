@@ -80,3 +80,6 @@ else:unix: LIBS += -L$$PWD/../../../builds/build-MSSPM_ParameterEstimationNLoptA
 
 INCLUDEPATH += $$PWD/../MSSPM_ParameterEstimationNLoptAlgorithm
 DEPENDPATH += $$PWD/../MSSPM_ParameterEstimationNLoptAlgorithm
+
+INCLUDEPATH += $$PWD/../MSSPM_Common
+DEPENDPATH += $$PWD/../MSSPM_Common
@@ -323,6 +323,8 @@ nmfDiagnostic_Tab1::callback_RunPB()
     QStringList SpeciesOrGuildNames;
     std::vector<DiagnosticTuple> DiagnosticTupleVector;
     std::vector<DiagnosticTuple> ZScoreDiagnosticTupleVector;
+    std::vector<std::vector<std::pair<QString,double> > > candidateParameterData;
+    std::vector<double> fitnesses;
     DiagnosticTuple aDiagnosticTuple;
     std::string isAggProdStr;
     bool isAggProdBool;
@@ -412,17 +414,23 @@ nmfDiagnostic_Tab1::callback_RunPB()
             startVal     =  estParameter * (1.0-pctVariation/100.0);
             inc          = (estParameter - startVal)/numPoints;
             diagnosticParameterValue = startVal;
+            candidateParameterData.clear();
             for (int j=0; j<=totalNumPoints; ++j) {
-                try {
-                    parameterItem = std::make_pair(parameterName,diagnosticParameterValue);
-                    fitness = calculateFitness(i,{parameterItem});
-                } catch (...) {
-                    msg = "Please run an Estimation prior to running this Diagnostic.";
-                    m_Logger->logMsg(nmfConstants::Warning,msg.toStdString());
-                    QMessageBox::warning(m_Diagnostic_Tabs,tr("Warning"),"\n"+msg,QMessageBox::Ok);
-                    return;
-                }
-
+                parameterItem = std::make_pair(parameterName,diagnosticParameterValue);
+                candidateParameterData.push_back({parameterItem});
+                diagnosticParameterValue += inc;
+            }
+            try {
+                fitnesses = calculateFitness(i,candidateParameterData);
+            } catch (...) {
+                msg = "Please run an Estimation prior to running this Diagnostic.";
+                m_Logger->logMsg(nmfConstants::Warning,msg.toStdString());
+                QMessageBox::warning(m_Diagnostic_Tabs,tr("Warning"),"\n"+msg,QMessageBox::Ok);
+                return;
+            }
+            diagnosticParameterValue = startVal;
+            for (int j=0; j<=totalNumPoints; ++j) {
+                fitness = fitnesses[j];
                 if (fitness == -1) {
                     m_Diagnostic_Tabs->setCursor(Qt::ArrowCursor);
                     return;
@@ -449,10 +457,31 @@ nmfDiagnostic_Tab1::callback_RunPB()
     ZScoreDiagnosticTupleVector.clear();
     centerFitness = 0;
     int numSurfacePoints = (totalNumPoints+1)*(totalNumPoints+1);
-    std::vector<double> fitnesses;
     for (int SpeciesNum=0; SpeciesNum<NumSpeciesOrGuilds; ++SpeciesNum) {
-        fitnesses.clear();
         nmfUtilsQt::updateProgressDlg(m_Logger,progressDlg,"Calculating 2d parameter surfaces for: "+SpeciesOrGuildNames[SpeciesNum].toStdString(),pInc);
+
+        // Evaluate the whole surface at once
+        candidateParameterData.clear();
+        parameter1                =  surfaceParameter1[SpeciesNum];
+        parameter1StartVal        =  parameter1 * (1.0-pctVariation/100.0);
+        parameter1Inc             = (parameter1 - parameter1StartVal)/numPoints;
+        parameter1DiagnosticValue =  parameter1StartVal;
+        for (int j=0; j<=totalNumPoints; ++j) {
+            parameter2                =  surfaceParameter2[SpeciesNum];
+            parameter2StartVal        =  parameter2 * (1.0-pctVariation/100.0);
+            parameter2Inc             = (parameter2 - parameter2StartVal)/numPoints;
+            parameter2DiagnosticValue =  parameter2StartVal;
+            parameterItem1 = std::make_pair(surfaceParameter1Name,parameter1DiagnosticValue);
+            for (int k=0; k<=totalNumPoints; ++k) {
+                parameterItem2 = std::make_pair(surfaceParameter2Name,parameter2DiagnosticValue);
+                candidateParameterData.push_back({parameterItem1,parameterItem2});
+                parameter2DiagnosticValue += parameter2Inc;
+            }
+            parameter1DiagnosticValue += parameter1Inc;
+        }
+        fitnesses = calculateFitness(SpeciesNum,candidateParameterData);
+
+        m = 0;
         parameter1                =  surfaceParameter1[SpeciesNum];
         parameter1StartVal        =  parameter1 * (1.0-pctVariation/100.0);
         parameter1Inc             = (parameter1 - parameter1StartVal)/numPoints;
@@ -466,11 +495,8 @@ nmfDiagnostic_Tab1::callback_RunPB()
             parameter2PctVar          = -pctVariation;
             parameter2PctInc          = -2*parameter2PctVar/totalNumPoints;
             parameter2DiagnosticValue =  parameter2StartVal;
-            parameterItem1 = std::make_pair(surfaceParameter1Name,parameter1DiagnosticValue);
             for (int k=0; k<=totalNumPoints; ++k) {
-                parameterItem2 = std::make_pair(surfaceParameter2Name,parameter2DiagnosticValue);
-                fitness = calculateFitness(SpeciesNum,{parameterItem1,parameterItem2});
-                fitnesses.push_back(fitness);
+                fitness = fitnesses[m++];
                 if ((j == numPoints) && (k == numPoints)) {
                     centerFitness = fitness;
                 }
@@ -542,18 +568,18 @@ nmfDiagnostic_Tab1::callback_RunPB()
 
 
 
-double
+std::vector<double>
 nmfDiagnostic_Tab1::calculateFitness(const int& SpeciesOrGuildNum,
-                                     const std::vector<std::pair<QString,double> >& ParameterData)
+                                     const std::vector<std::vector<std::pair<QString,double> > >& CandidateParameterData)
 {
     bool isAggProd;
     int NumSpecies;
     int NumGuilds;
     int NumSpeciesOrGuilds;
     int offset = 0;
-    unsigned unused1 = 0;
-    double unused2[] = {0};
-    double retv = 0;
+    int NumParameters;
+    int NumCandidates = CandidateParameterData.size();
+    std::vector<double> retv(NumCandidates,-1);
     std::string Algorithm;
     std::string Minimizer;
     std::string ObjectiveCriterion;
@@ -568,6 +594,7 @@ nmfDiagnostic_Tab1::calculateFitness(const int& SpeciesOrGuildNum,
     std::vector<double> competitionParameters;
     std::vector<double> predationParameters;
     std::vector<double> surveyQParameters;
+    std::vector<double> candidates; // structure-of-arrays: parameter p of candidate k is at p*NumCandidates+k
 
     m_DatabasePtr->getAlgorithmIdentifiers(
                 m_Diagnostic_Tabs,m_Logger,m_ProjectSettingsConfig,
@@ -604,39 +631,61 @@ nmfDiagnostic_Tab1::calculateFitness(const int& SpeciesOrGuildNum,
     int predationOffset   = competitionOffset + competitionParameters.size();
     int surveyQOffset     = predationOffset   + predationParameters.size();
 
-    for (std::pair<QString,double> ParameterItem : ParameterData) {
-        offset = 0;
-        if (ParameterItem.first == "Initial Biomass (B₀)") {
-            offset = initBiomassOffset;
-        } else if (ParameterItem.first == "Growth Rate (r)") {
-            offset = growthOffset;
-        } else if (ParameterItem.first == "Carrying Capacity (K)") {
-            offset = growthOffset+NumSpeciesOrGuilds;
-        } else if (ParameterItem.first == "Catchability (q)") {
-            offset = harvestOffset;
-        } else if (ParameterItem.first == "SurveyQ") {
-            offset = surveyQOffset;
-        } else {
-            msg = "Error: Invalid parameter name: " + ParameterItem.first.toStdString();
-            m_Logger->logMsg(nmfConstants::Error,msg);
-            return -1;
+    NumParameters = parameters.size();
+    if (NumParameters == 0) {
+        return retv;
+    }
+    candidates.resize(NumParameters*NumCandidates);
+    for (int p=0; p<NumParameters; ++p) {
+        std::fill(candidates.begin()+p*NumCandidates,candidates.begin()+(p+1)*NumCandidates,parameters[p]);
+    }
+    for (int k=0; k<NumCandidates; ++k) {
+        for (std::pair<QString,double> ParameterItem : CandidateParameterData[k]) {
+            offset = 0;
+            if (ParameterItem.first == "Initial Biomass (B₀)") {
+                offset = initBiomassOffset;
+            } else if (ParameterItem.first == "Growth Rate (r)") {
+                offset = growthOffset;
+            } else if (ParameterItem.first == "Carrying Capacity (K)") {
+                offset = growthOffset+NumSpeciesOrGuilds;
+            } else if (ParameterItem.first == "Catchability (q)") {
+                offset = harvestOffset;
+            } else if (ParameterItem.first == "SurveyQ") {
+                offset = surveyQOffset;
+            } else {
+                msg = "Error: Invalid parameter name: " + ParameterItem.first.toStdString();
+                m_Logger->logMsg(nmfConstants::Error,msg);
+                return retv;
+            }
+            candidates[(offset+SpeciesOrGuildNum)*NumCandidates+k] = ParameterItem.second;
         }
-        parameters[offset+SpeciesOrGuildNum] = ParameterItem.second;
     }
 
     if (Algorithm == "Bees Algorithm") {
         std::unique_ptr<BeesAlgorithm> beesAlg = std::make_unique<BeesAlgorithm>(m_DataStruct,nmfConstantsMSSPM::VerboseOff);
-        retv = beesAlg->evaluateObjectiveFunction(parameters);
+        for (int k=0; k<NumCandidates; ++k) {
+            for (int p=0; p<NumParameters; ++p) {
+                parameters[p] = candidates[p*NumCandidates+k];
+            }
+            retv[k] = beesAlg->evaluateObjectiveFunction(parameters);
+        }
     } else if (Algorithm == "NLopt Algorithm") {
-        std::unique_ptr<NLopt_Estimator> nlopt_Estimator = std::make_unique<NLopt_Estimator>();
-        retv = nlopt_Estimator->objectiveFunction(unused1,&parameters[0],unused2,&m_DataStruct);
-        if (retv == -1) {
+        NLopt_EvaluationContext context;
+        std::unique_ptr<nmfGrowthForm>      growthForm      = std::make_unique<nmfGrowthForm>(     m_DataStruct.GrowthForm);
+        std::unique_ptr<nmfHarvestForm>     harvestForm     = std::make_unique<nmfHarvestForm>(    m_DataStruct.HarvestForm);
+        std::unique_ptr<nmfCompetitionForm> competitionForm = std::make_unique<nmfCompetitionForm>(m_DataStruct.CompetitionForm);
+        std::unique_ptr<nmfPredationForm>   predationForm   = std::make_unique<nmfPredationForm>(  m_DataStruct.PredationForm);
+        NLopt_Estimator::initializeEvaluationContext(m_DataStruct,0,
+                                                     growthForm.get(),harvestForm.get(),
+                                                     competitionForm.get(),predationForm.get(),
+                                                     context);
+        NLopt_Estimator::verifyKernels(context,parameters);
+        NLopt_Batch::evaluate(context,candidates.data(),NumParameters,NumCandidates,retv.data());
+        if (std::find(retv.begin(),retv.end(),-1) != retv.end()) {
             msg = "Please run an Estimation prior to running this Diagnostic.";
             m_Logger->logMsg(nmfConstants::Warning,msg);
             QMessageBox::warning(m_Diagnostic_Tabs,tr("Warning"),tr("\n"+QString::fromStdString(msg).toLatin1()),QMessageBox::Ok);
         }
-    } else {
-        retv = -1;
     }
     return retv;
 }
@@ -31,6 +31,7 @@
 
 #include <tuple>
 #include <BeesAlgorithm.h>
+#include "NLopt_Batch.h"
 #include "NLopt_Estimator.h"
 #include "nmfConstantsMSSPM.h"
 
@@ -73,8 +74,9 @@ private:
     std::map<QString,QString> m_OutputTableName;
     std::map<QString,QString> m_DiagnosticTableName;
 
-    double calculateFitness(const int& SpeciesOrGuildNum,
-                            const std::vector<std::pair<QString,double> >& ParameterData);
+    std::vector<double> calculateFitness(
+            const int& SpeciesOrGuildNum,
+            const std::vector<std::vector<std::pair<QString,double> > >& CandidateParameterData);
     bool isAggProd(std::string Algorithm,
                    std::string Minimizer,
                    std::string ObjectiveCriterion,
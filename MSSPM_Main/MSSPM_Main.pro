@@ -23,6 +23,10 @@ QMAKE_CFLAGS += -DATL_HAS_EIGEN
 # depend on your compiler). Please consult the documentation of the
 # deprecated API in order to know how to port your code away from it.
 DEFINES += QT_DEPRECATED_WARNINGS
+
+# Build with qmake CONFIG+=instrumentation to time the estimation phases (see nmfInstrumentation.h)
+CONFIG(instrumentation): DEFINES += MSSPM_INSTRUMENTATION
+
 QMAKE_CXXFLAGS += -std=c++0x
 
 
@@ -138,6 +142,16 @@ else:unix: LIBS += -L$$PWD/../../../builds/build-MSSPM_ParameterEstimationNLoptA
 INCLUDEPATH += $$PWD/../MSSPM_ParameterEstimationNLoptAlgorithm
 DEPENDPATH += $$PWD/../MSSPM_ParameterEstimationNLoptAlgorithm
 
+win32:CONFIG(release, debug|release): LIBS += -L$$PWD/../../../builds/build-MSSPM_Core-Desktop_Qt_5_15_2_clang_64bit-Release/release/ -lMSSPM_Core.1.0.0
+else:win32:CONFIG(debug, debug|release): LIBS += -L$$PWD/../../../builds/build-MSSPM_Core-Desktop_Qt_5_15_2_clang_64bit-Release/debug/ -lMSSPM_Core.1.0.0
+else:unix: LIBS += -L$$PWD/../../../builds/build-MSSPM_Core-Desktop_Qt_5_15_2_clang_64bit-Release/ -lMSSPM_Core.1.0.0
+
+INCLUDEPATH += $$PWD/../MSSPM_Core
+DEPENDPATH += $$PWD/../MSSPM_Core
+
+INCLUDEPATH += $$PWD/../MSSPM_Common
+DEPENDPATH += $$PWD/../MSSPM_Common
+
 win32:CONFIG(release, debug|release): LIBS += -L$$PWD/../../../builds/build-MSSPM_ParameterEstimationBeesAlgorithm-Desktop_Qt_5_15_2_clang_64bit-Release/release/ -lMSSPM_ParameterEstimationBeesAlgorithm.1.0.0
 else:win32:CONFIG(debug, debug|release): LIBS += -L$$PWD/../../../builds/build-MSSPM_ParameterEstimationBeesAlgorithm-Desktop_Qt_5_15_2_clang_64bit-Release/debug/ -lMSSPM_ParameterEstimationBeesAlgorithm.1.0.0
 else:unix: LIBS += -L$$PWD/../../../builds/build-MSSPM_ParameterEstimationBeesAlgorithm-Desktop_Qt_5_15_2_clang_64bit-Release/ -lMSSPM_ParameterEstimationBeesAlgorithm.1.0.0
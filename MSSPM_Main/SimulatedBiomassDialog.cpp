@@ -7,7 +7,8 @@ SimulatedBiomassDialog::SimulatedBiomassDialog(QWidget *parent,
                                                std::string projectDir,
                                                std::string projectSettingsConfig,
                                                nmfDatabase* database,
-                                               nmfLogger* logger) :
+                                               nmfLogger* logger,
+                                               const bool& isSetToDeterministic) :
     QDialog(parent)
 {
     QString msg;
@@ -17,6 +18,7 @@ SimulatedBiomassDialog::SimulatedBiomassDialog(QWidget *parent,
     m_ProjectSettingsConfig = projectSettingsConfig;
     m_Database = database;
     m_Logger   = logger;
+    m_isSetToDeterministic = isSetToDeterministic;
 
     InfoLBL    = new QLabel();
     ContinuePB = new QPushButton("Continue");
@@ -96,7 +98,8 @@ SimulatedBiomassDialog::callback_ContinuePB()
 
     QString inputDataPath = QDir(QString::fromStdString(m_ProjectDir)).filePath(QString::fromStdString(nmfConstantsMSSPM::InputDataDir));
     filenameWithPath = QDir(inputDataPath).filePath(filename);
-    bool ok = SimulatedData.createSimulatedBiomass(filenameWithPath,errorPct);
+    bool ok = SimulatedData.createSimulatedBiomass(filenameWithPath,errorPct,
+                                                   nmfRandom::getSeed(m_isSetToDeterministic));
     close();
 
     if (ok) {
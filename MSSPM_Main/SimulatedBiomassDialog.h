@@ -63,6 +63,7 @@ class SimulatedBiomassDialog : public QDialog
     std::string  m_ProjectSettingsConfig;
     nmfDatabase* m_Database;
     nmfLogger*   m_Logger;
+    bool         m_isSetToDeterministic;
 
 
 public:
@@ -73,12 +74,14 @@ public:
      * @param projectSettingsConfig : string representing the project settings config file
      * @param database : pointer to database object
      * @param logger : pointer to logger object)
+     * @param isSetToDeterministic : true if the Deterministic box is checked, so the same error is added every time
      */
     SimulatedBiomassDialog(QWidget* parent,
                            std::string projectDir,
                            std::string projectSettingsConfig,
                            nmfDatabase* database,
-                           nmfLogger* logger);
+                           nmfLogger* logger,
+                           const bool& isSetToDeterministic);
     virtual ~SimulatedBiomassDialog() {}
     QString getFilename();
     int getErrorPct();
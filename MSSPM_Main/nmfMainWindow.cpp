@@ -8,6 +8,7 @@
 
 #include <QLineSeries>
 #include <QProcess>
+#include <QFutureWatcher>
 #include <QtConcurrent>
 #include <QWhatsThis>
 
@@ -22,6 +23,7 @@ nmfMainWindow::nmfMainWindow(QWidget *parent) :
     m_UI->setupUi(this);
 
     m_Estimator_Bees   = nullptr;
+    m_EnsembleDispatcher = nullptr;
     m_RunOutputMsg.clear();
     m_NumMohnsRhoRanges = 0;
     m_SeedValue = -1;
@@ -32,6 +34,10 @@ nmfMainWindow::nmfMainWindow(QWidget *parent) :
     m_MShotNumCols = 3;
     m_isStartUpOK = true;
     m_isRunning = false;
+    m_isProgressInMemory = false;
+    m_isProgressChartStale = false;
+    m_ProgressChartRedrawIntervalMs = 1000;
+    m_CancellationToken = std::make_shared<nmfCancellationToken>();
     m_NumRuns = 0;
     m_AveBiomass.clear();
     m_OutputBiomassEnsemble.clear();
@@ -1308,6 +1314,7 @@ nmfMainWindow::getOutputCompetition(std::vector<double> &EstCompetition)
 void
 nmfMainWindow::menu_stopRun()
 {
+    m_CancellationToken->cancel();
     m_ProgressWidget->StopRun();
     Output_Controls_ptr->enableControls();
 
@@ -2181,7 +2188,8 @@ nmfMainWindow::menu_preferences()
 void
 nmfMainWindow::menu_createSimulatedBiomass()
 {
-    SimulatedBiomassDialog simDlg(this,m_ProjectDir,m_ProjectSettingsConfig,m_DatabasePtr,m_Logger);
+    SimulatedBiomassDialog simDlg(this,m_ProjectDir,m_ProjectSettingsConfig,m_DatabasePtr,m_Logger,
+                                  Estimation_Tab6_ptr->isSetToDeterministic());
     simDlg.exec();
 }
 
@@ -2247,6 +2255,18 @@ nmfMainWindow::isStopped(std::string& runName,
                          std::string& state)
 {
     std::string cmd;
+
+    // A user stop is seen through the run's token
+    if (m_CancellationToken->isCancelled()) {
+        state = "StoppedByUser";
+        return true;
+    }
+    // Otherwise there's nothing to read until the estimator has finished
+    if (! m_CancellationToken->isFinished()) {
+        state.clear();
+        return false;
+    }
+
     std::ifstream inputFile(stopRunFile);
     if (inputFile) {
         std::getline(inputFile,cmd);
@@ -2270,22 +2290,66 @@ nmfMainWindow::callback_ReadProgressChartDataFile()
 {
     bool validPointsOnly = m_ProgressWidget->readValidPointsOnly();
 
-    callback_ReadProgressChartDataFile(validPointsOnly,false);
+    readProgressChart(validPointsOnly,false,true);
 }
 
 void
 nmfMainWindow::callback_ReadProgressChartDataFile(bool validPointsOnly,
                                                   bool clearChart)
+{
+    readProgressChart(validPointsOnly,clearChart,false);
+}
+
+bool
+nmfMainWindow::drainProgressTelemetry()
+{
+    NMF_INSTRUMENT_SCOPE(nmfPhaseProgressIO);
+
+    m_ProgressSamples.clear();
+    if (nmfProgressTelemetry::instance().drain(m_ProgressSamples) == 0) {
+        return false;
+    }
+
+    // Only the new samples are appended, by this thread alone
+    std::ofstream outputFile(nmfConstantsMSSPM::MSSPMProgressChartFile,
+                             std::ios::out|std::ios::app);
+    for (const nmfProgressSample& sample : m_ProgressSamples) {
+        outputFile << "Run " << sample.RunNum << "-" << sample.SubRunNum << ", "
+                   << sample.NumEvals    << ", "
+                   << sample.BestFitness << ", "
+                   << -1 << "\n";
+    }
+    outputFile.close();
+
+    return true;
+}
+
+void
+nmfMainWindow::readProgressChart(bool validPointsOnly,
+                                 bool clearChart,
+                                 bool redrawOnlyIfNew)
 {
     QString outputMsg;
 
+    if (drainProgressTelemetry()) {
+        m_isProgressChartStale = true;
+    }
     if (clearChart) {
         m_ProgressWidget->clearChartOnly();
     }
-    m_ProgressWidget->readChartDataFile("MSSPM",
-                                        nmfConstantsMSSPM::MSSPMProgressChartFile,
-                                        nmfConstantsMSSPM::MSSPMProgressChartLabelFile,
-                                        validPointsOnly);
+    // An in-memory run's file only changes when samples are drained. Re-reading it takes
+    // time proportional to the run so far, so don't redraw it on every timer tick.
+    bool isRedrawDue = ! m_ProgressChartRedrawTimer.isValid() ||
+                       (m_ProgressChartRedrawTimer.elapsed() >= m_ProgressChartRedrawIntervalMs);
+    if (! redrawOnlyIfNew || ! m_isProgressInMemory || (m_isProgressChartStale && isRedrawDue)) {
+        NMF_INSTRUMENT_SCOPE(nmfPhaseChartRefresh);
+        m_ProgressChartRedrawTimer.start();
+        m_isProgressChartStale = false;
+        m_ProgressWidget->readChartDataFile("MSSPM",
+                                            nmfConstantsMSSPM::MSSPMProgressChartFile,
+                                            nmfConstantsMSSPM::MSSPMProgressChartLabelFile,
+                                            validPointsOnly);
+    }
     std::string runName = "";
     std::string stopRunFile = nmfConstantsMSSPM::MSSPMStopRunFile;
     std::string state = "";
@@ -2301,6 +2365,8 @@ nmfMainWindow::callback_ReadProgressChartDataFile(bool validPointsOnly,
         m_isRunning = false;
         m_ProgressWidget->stopTimer();
         // Read chart once more just in case you've missed the last point.
+        drainProgressTelemetry();
+        NMF_INSTRUMENT_SCOPE(nmfPhaseChartRefresh);
         m_ProgressWidget->readChartDataFile("MSSPM",
                                             nmfConstantsMSSPM::MSSPMProgressChartFile,
                                             nmfConstantsMSSPM::MSSPMProgressChartLabelFile,
@@ -3576,8 +3642,14 @@ nmfMainWindow::menu_saveAndShowCurrentRun()
 void
 nmfMainWindow::menu_saveAndShowCurrentRun(bool showDiagnosticChart)
 {
-    menu_saveCurrentRun();
-    menu_showCurrentRun();
+    {
+        NMF_INSTRUMENT_SCOPE(nmfPhaseDatabaseWrite);
+        menu_saveCurrentRun();
+    }
+    {
+        NMF_INSTRUMENT_SCOPE(nmfPhaseChartRefresh);
+        menu_showCurrentRun();
+    }
     if (showDiagnosticChart) {
         Output_Controls_ptr->setOutputType("Diagnostics");
 //        Output_Controls_ptr->callback_OutputParametersZScoreCB(Qt::Checked);
@@ -4090,7 +4162,8 @@ nmfMainWindow::loadUncertaintyData(const bool&          isMonteCarlo,
 
 
 bool
-nmfMainWindow::scaleTimeSeriesIfMonteCarlo(const bool& isMonteCarlo,
+nmfMainWindow::scaleTimeSeriesIfMonteCarlo(nmfRandom& Random,
+                                           const bool& isMonteCarlo,
                                            const std::vector<double>& Uncertainty,
                                            boost::numeric::ublas::matrix<double>& HarvestMatrix,
                                            std::vector<double>& RandomValues)
@@ -4103,7 +4176,7 @@ nmfMainWindow::scaleTimeSeriesIfMonteCarlo(const bool& isMonteCarlo,
 
     for (int i=0; i<NumSpecies; ++i) {
         if (isMonteCarlo) {
-            calculateMonteCarloValue(Uncertainty[i],0.0,RandomValue);
+            calculateMonteCarloValue(Random,Uncertainty[i],0.0,RandomValue);
         }
         RandomValues.push_back(RandomValue);
         for (int j=0; j<NumYears; ++j) {
@@ -4115,7 +4188,8 @@ nmfMainWindow::scaleTimeSeriesIfMonteCarlo(const bool& isMonteCarlo,
 }
 
 double
-nmfMainWindow::calculateMonteCarloValue(const double& uncertainty,
+nmfMainWindow::calculateMonteCarloValue(nmfRandom& Random,
+                                        const double& uncertainty,
                                         const double& dataValue,
                                         double& randomValue)
 {
@@ -4124,8 +4198,7 @@ nmfMainWindow::calculateMonteCarloValue(const double& uncertainty,
     randomValue = 0.0;
 
     if (uncertainty != 0.0) {
-        m_SeedValue = (m_SeedValue > 0) ? ++m_SeedValue : m_SeedValue;
-        randomValue = nmfUtils::getRandomNumber(m_SeedValue,-uncertainty,uncertainty);
+        randomValue = Random.getUniform(-uncertainty,uncertainty);
         retv = (1.0 + randomValue) * dataValue;
 //      retv = nmfUtils::getRandomNumber(m_SeedValue,dataValue*(1.0-uncertainty),dataValue*(1.0+uncertainty));
     }
@@ -4499,6 +4572,11 @@ nmfMainWindow::updateOutputBiomassTable(std::string& ForecastName,
     HarvestRandomValues.clear();
     SurveyQRandomValues.clear();
 
+    // Each Monte Carlo run draws from a random number stream of its own, keyed by
+    // the forecast's seed (if it's deterministic) and the run number
+    nmfRandom MonteCarloRandom((m_SeedValue > 0) ? std::uint64_t(m_SeedValue) : nmfRandom::getSeed(false),
+                               std::uint32_t(RunNum));
+
     // Find Guilds and Species
     if (! getGuilds(NumGuilds,GuildList)) {
         return false;
@@ -4568,7 +4646,7 @@ nmfMainWindow::updateOutputBiomassTable(std::string& ForecastName,
 
         if (TableNames[j] == InitBiomassTable) {
             for (int i=0; i<NumSpeciesOrGuilds; ++i) {
-                MonteCarloValue = calculateMonteCarloValue(InitBiomassUncertainty[i],
+                MonteCarloValue = calculateMonteCarloValue(MonteCarloRandom,InitBiomassUncertainty[i],
                                                            std::stod(dataMap["Value"][i]),
                                                            randomValue);
                 EstInitBiomass.push_back(MonteCarloValue);
@@ -4576,7 +4654,7 @@ nmfMainWindow::updateOutputBiomassTable(std::string& ForecastName,
             }
         } else if (TableNames[j] == GrowthRateTable) {
             for (int i=0; i<NumSpeciesOrGuilds; ++i) {
-                MonteCarloValue = calculateMonteCarloValue(GrowthRateUncertainty[i],
+                MonteCarloValue = calculateMonteCarloValue(MonteCarloRandom,GrowthRateUncertainty[i],
                                                            std::stod(dataMap["Value"][i]),
                                                            randomValue);
                 EstGrowthRates.push_back(MonteCarloValue);
@@ -4585,7 +4663,7 @@ nmfMainWindow::updateOutputBiomassTable(std::string& ForecastName,
         } else if (TableNames[j] == CarryingCapacityTable) {
             for (int i=0; i<NumSpeciesOrGuilds; ++i) {
                 if (isCarryingCapacity) {
-                    MonteCarloValue = calculateMonteCarloValue(CarryingCapacityUncertainty[i],
+                    MonteCarloValue = calculateMonteCarloValue(MonteCarloRandom,CarryingCapacityUncertainty[i],
                                                                std::stod(dataMap["Value"][i]),
                                                                randomValue);
                     EstCarryingCapacities.push_back(MonteCarloValue);
@@ -4597,7 +4675,7 @@ nmfMainWindow::updateOutputBiomassTable(std::string& ForecastName,
             }
         } else if (TableNames[j] == CatchabilityTable) {
             for (int i=0; i<NumSpeciesOrGuilds; ++i) {
-                MonteCarloValue = calculateMonteCarloValue(CatchabilityUncertainty[i],
+                MonteCarloValue = calculateMonteCarloValue(MonteCarloRandom,CatchabilityUncertainty[i],
                                                            std::stod(dataMap["Value"][i]),
                                                            randomValue);
 
@@ -4606,7 +4684,7 @@ nmfMainWindow::updateOutputBiomassTable(std::string& ForecastName,
             }
         } else if (TableNames[j] == "OutputPredationExponent") {
             for (int i=0; i<NumSpeciesOrGuilds; ++i) {
-                MonteCarloValue = calculateMonteCarloValue(ExponentUncertainty[i],
+                MonteCarloValue = calculateMonteCarloValue(MonteCarloRandom,ExponentUncertainty[i],
                                                            std::stod(dataMap["Value"][i]),
                                                            randomValue);
                 EstExponent.push_back(MonteCarloValue);
@@ -4614,7 +4692,7 @@ nmfMainWindow::updateOutputBiomassTable(std::string& ForecastName,
             }
         } else if (TableNames[j] == "OutputSurveyQ") {
             for (int i=0; i<NumSpeciesOrGuilds; ++i) {
-                MonteCarloValue = calculateMonteCarloValue(SurveyQUncertainty[i],
+                MonteCarloValue = calculateMonteCarloValue(MonteCarloRandom,SurveyQUncertainty[i],
                                                            std::stod(dataMap["Value"][i]),
                                                            randomValue);
                 EstSurveyQ.push_back(MonteCarloValue);
@@ -4670,25 +4748,25 @@ nmfMainWindow::updateOutputBiomassTable(std::string& ForecastName,
             for (int col=0; col<NumSpeciesOrGuilds; ++col) {
                 if (TableNames[i] == "OutputCompetitionAlpha") {
                     EstCompetitionAlpha(row,col) = calculateMonteCarloValue(
-                                CompetitionUncertainty[col],
+                                MonteCarloRandom,CompetitionUncertainty[col],
                                 std::stod(dataMap["Value"][m]),
                                 randomValue);
                     CompetitionAlphaRandomValues.push_back(randomValue);
                 } else if (TableNames[i] == "OutputCompetitionBetaSpecies") {
                     EstCompetitionBetaSpecies(row,col) = calculateMonteCarloValue(
-                                BetaSpeciesUncertainty[col],
+                                MonteCarloRandom,BetaSpeciesUncertainty[col],
                                 std::stod(dataMap["Value"][m]),
                                 randomValue);
                     CompetitionBetaSpeciesRandomValues.push_back(randomValue);
                 } else if (TableNames[i] == "OutputPredationRho") {
                     EstPredation(row,col) = calculateMonteCarloValue(
-                                PredationUncertainty[col],
+                                MonteCarloRandom,PredationUncertainty[col],
                                 std::stod(dataMap["Value"][m]),
                                 randomValue);
                     PredationRhoRandomValues.push_back(randomValue);
                 } else if (TableNames[i] == "OutputPredationHandling") {
                     EstHandling(row,col) = calculateMonteCarloValue(
-                                HandlingUncertainty[col],
+                                MonteCarloRandom,HandlingUncertainty[col],
                                 std::stod(dataMap["Value"][m]),
                                 randomValue);
                     PredationHandlingRandomValues.push_back(randomValue);
@@ -4728,7 +4806,7 @@ nmfMainWindow::updateOutputBiomassTable(std::string& ForecastName,
             for (int col=0; col<NumGuilds; ++col) {
                 if (TableNames[i] == "OutputCompetitionBetaGuilds") {
                     EstCompetitionBetaGuilds(row,col) = calculateMonteCarloValue(
-                            BetaGuildsUncertainty[row],
+                            MonteCarloRandom,BetaGuildsUncertainty[row],
                             std::stod(dataMap["Value"][m]),
                             randomValue);
                    CompetitionBetaGuildsRandomValues.push_back(randomValue);
@@ -4768,7 +4846,7 @@ nmfMainWindow::updateOutputBiomassTable(std::string& ForecastName,
             for (int col=0; col<NumGuilds; ++col) {
                 if (TableNames[i] == "OutputCompetitionBetaGuilds") {
                     EstCompetitionBetaGuildsGuilds(row,col) = calculateMonteCarloValue(
-                            BetaGuildsGuildsUncertainty[row],
+                            MonteCarloRandom,BetaGuildsGuildsUncertainty[row],
                             std::stod(dataMap["Value"][m]),
                             randomValue);
                    CompetitionBetaGuildsGuildsRandomValues.push_back(randomValue);
@@ -4797,7 +4875,7 @@ nmfMainWindow::updateOutputBiomassTable(std::string& ForecastName,
                 return false;
             }
         }
-        scaleTimeSeriesIfMonteCarlo(isMonteCarlo,HarvestUncertainty,Catch,HarvestRandomValues);
+        scaleTimeSeriesIfMonteCarlo(MonteCarloRandom,isMonteCarlo,HarvestUncertainty,Catch,HarvestRandomValues);
     } else if (HarvestForm == "Effort (qE)") {
         if (isAggProd) {
             if (! getTimeSeriesDataByGuild(ForecastName,"HarvestEffort",NumSpeciesOrGuilds,RunLength,Effort))
@@ -4808,7 +4886,7 @@ nmfMainWindow::updateOutputBiomassTable(std::string& ForecastName,
                                                    NumSpeciesOrGuilds,RunLength,Effort))
                 return false;
         }
-        scaleTimeSeriesIfMonteCarlo(isMonteCarlo,HarvestUncertainty,Effort,HarvestRandomValues);
+        scaleTimeSeriesIfMonteCarlo(MonteCarloRandom,isMonteCarlo,HarvestUncertainty,Effort,HarvestRandomValues);
     } else if (HarvestForm == "Exploitation (F)") {
         if (isAggProd) {
             if (! getTimeSeriesDataByGuild(ForecastName,"HarvestExploitation",NumSpeciesOrGuilds,RunLength,Exploitation))
@@ -4819,7 +4897,7 @@ nmfMainWindow::updateOutputBiomassTable(std::string& ForecastName,
                                                    NumSpeciesOrGuilds,RunLength,Exploitation))
                 return false;
         }
-        scaleTimeSeriesIfMonteCarlo(isMonteCarlo,HarvestUncertainty,Exploitation,HarvestRandomValues);
+        scaleTimeSeriesIfMonteCarlo(MonteCarloRandom,isMonteCarlo,HarvestUncertainty,Exploitation,HarvestRandomValues);
     } else {
         nmfUtils::initialize(HarvestRandomValues,NumSpeciesOrGuilds);
     }
@@ -6586,7 +6664,7 @@ nmfMainWindow::getObservedBiomassTableName(bool isPreEstimation)
 }
 
 bool
-nmfMainWindow::calculateSummaryStatisticsStruct(
+nmfMainWindow::getSummaryStatisticsInput(
         const bool&         isAggProd,
         const std::string&  Algorithm,
         const std::string&  Minimizer,
@@ -6597,38 +6675,12 @@ nmfMainWindow::calculateSummaryStatisticsStruct(
         const bool&         isMohnsRhoBool,
         const bool&         isAMultiRun,
         boost::numeric::ublas::matrix<double>& EstimatedBiomass,
-        StatStruct&         statStruct)
+        nmfCoreStatisticsInput& Input)
 {
-    bool ok;
-    int m;
-    double val;
-    std::vector<double> SSresiduals;
-    std::vector<double> SSdeviations;
-    std::vector<double> SStotals;
-    std::vector<double> rsquared;
-    std::vector<double> aic;
-    std::vector<double> rmse;
-    std::vector<double> ri;
-    std::vector<double> ae;
-    std::vector<double> aae;
-    std::vector<double> mef;
-    std::vector<double> mohnsRhoGrowthRate;
-    std::vector<double> mohnsRhoCarryingCapacity;
-    std::vector<double> mohnsRhoEstimatedBiomass;
-    std::vector<double> meanObserved;
-    std::vector<double> meanEstimated;
-    std::vector<double> observed;
-    std::vector<double> estimated;
-    std::vector<double> correlationCoeff;
-    std::vector<double> EstGrowthRate;
-    std::vector<double> EstCarryingCapacity;
     std::vector<std::string> fields;
     std::map<std::string, std::vector<std::string> > dataMap;
     std::string queryStr;
-    double meanVal;
-    int NumberOfParameters=0;
     std::vector<boost::numeric::ublas::matrix<double> > OutputBiomass;
-    boost::numeric::ublas::matrix<double> ObservedBiomass;
     std::vector<std::string> Algorithms;
     std::vector<std::string> Minimizers;
     std::vector<std::string> ObjectiveCriteria;
@@ -6637,7 +6689,12 @@ nmfMainWindow::calculateSummaryStatisticsStruct(
 
     m_Logger->logMsg(nmfConstants::Normal,"calculateSummaryStatistics from: "+m_ProjectSettingsConfig);
 
-    // Get NumParameters value used in AIC calculation below
+    Input = nmfCoreStatisticsInput();
+    Input.NumSpeciesOrGuilds = NumSpeciesOrGuilds;
+    Input.RunLength          = RunLength;
+    Input.isMohnsRho         = isMohnsRhoBool;
+
+    // Get NumParameters value used in AIC calculation
     fields    = {"NumberOfParameters"};
     queryStr  = "SELECT NumberOfParameters FROM Systems WHERE SystemName = '" + m_ProjectSettingsConfig + "'";
     dataMap = m_DatabasePtr->nmfQueryDatabase(queryStr, fields);
@@ -6645,47 +6702,30 @@ nmfMainWindow::calculateSummaryStatisticsStruct(
         m_Logger->logMsg(nmfConstants::Error,"[Error 26] nmfMainWindow: Couldn't find record in Systems");
         return false;
     }
-    NumberOfParameters = std::stoi(dataMap["NumberOfParameters"][0]);
+    Input.NumberOfParameters = std::stoi(dataMap["NumberOfParameters"][0]);
 
     // Load Observed (i.e., original) Biomass (need to check if should be loading Absolute or Relative)
     std::string ObsBiomassTableName = getObservedBiomassTableName(!nmfConstantsMSSPM::PreEstimation);
     if (isAggProd) {
-        if (! getTimeSeriesDataByGuild("",ObsBiomassTableName,NumSpeciesOrGuilds,RunLength,ObservedBiomass)) {
+        if (! getTimeSeriesDataByGuild("",ObsBiomassTableName,NumSpeciesOrGuilds,RunLength,Input.ObservedBiomass)) {
             return false;
         }
     } else {
         if (! m_DatabasePtr->getTimeSeriesData(this,m_Logger,m_ProjectSettingsConfig,
                                                m_MohnsRhoLabel,"",ObsBiomassTableName,
-                                               NumSpeciesOrGuilds,RunLength,ObservedBiomass)) {
+                                               NumSpeciesOrGuilds,RunLength,Input.ObservedBiomass)) {
             return false;
         }
     }
-    for (int species=0; species<NumSpeciesOrGuilds; ++species) {
-        for (int time=0; time<=RunLength; ++time) {
-            observed.push_back(ObservedBiomass(time,species));
-        }
-    }
-
-    // Calculate the meanObserved from the observed
-    m = 0;
-    for (int i=0;i<NumSpeciesOrGuilds;++i) {
-        meanVal = 0;
-        for (int j=0; j<=RunLength;++j) {
-            meanVal += observed[m++];
-        }
-        meanVal /= (RunLength+1);
-        meanObserved.push_back(meanVal);
-    }
 
     // Get estimated data
-    m = 0;
     int NumLines = 1;
     Algorithms.push_back(Algorithm);
     Minimizers.push_back(Minimizer);
     ObjectiveCriteria.push_back(ObjectiveCriterion);
     Scalings.push_back(Scaling);
     if (isAMultiRun) {
-        OutputBiomass.push_back(EstimatedBiomass);
+        Input.EstimatedBiomass = EstimatedBiomass;
     } else {
         if (! getOutputBiomass(NumLines,NumSpeciesOrGuilds,RunLength,
                                Algorithms,Minimizers,ObjectiveCriteria,Scalings,
@@ -6694,144 +6734,50 @@ nmfMainWindow::calculateSummaryStatisticsStruct(
             m_Logger->logMsg(nmfConstants::Error,"Returning from within calculateSummaryStatistics");
             return false;
         }
-    }
-    for (int species=0; species<NumSpeciesOrGuilds; ++species) {
-        meanVal = 0;
-        for (int time=0; time<=RunLength; ++time) {
-            val = OutputBiomass[0](time,species);
-            estimated.push_back(val);
-            meanVal += val;
-        }
-        meanVal /= (RunLength+1);
-        meanEstimated.push_back(meanVal);
+        Input.EstimatedBiomass = OutputBiomass[0];
     }
 
-    // Get Estimated Growth Rates and Carrying Capacities
-    getOutputGrowthRate(EstGrowthRate,isMohnsRhoBool);
-    getOutputCarryingCapacity(EstCarryingCapacity,isMohnsRhoBool);
-
-    // Calculate SSresiduals
-    nmfUtilsStatistics::calculateSSResiduals(NumSpeciesOrGuilds,RunLength,observed,estimated,SSresiduals);
-
-    // Calculate SSdeviations
-    ok = nmfUtilsStatistics::calculateSSDeviations(NumSpeciesOrGuilds,RunLength,estimated,meanObserved,SSdeviations);
-    if (! ok) {
-        m_Logger->logMsg(nmfConstants::Error,"[Error 1] calculateSummaryStatistics: Found SSdeviation of 0.");
-        return false;
+    // Get the estimates of every peel
+    if (isMohnsRhoBool) {
+        Input.NumPeels = Diagnostic_Tab2_ptr->getNumPeels();
+        getOutputGrowthRate(Input.EstGrowthRate,isMohnsRhoBool);
+        getOutputCarryingCapacity(Input.EstCarryingCapacity,isMohnsRhoBool);
+        if (! calculateSummaryStatisticsMohnsRhoBiomass(Input.EstBiomassByPeel)) {
+            return false;
+        }
     }
 
-    // Calculate SStotals
-    nmfUtilsStatistics::calculateSSTotals(NumSpeciesOrGuilds,SSdeviations,SSresiduals,SStotals);
-
-    // Calculate rsquared (between 0.2 and 0.3 good....closer to 1.0 the better)
-    nmfUtilsStatistics::calculateRSquared(NumSpeciesOrGuilds,SSdeviations,SStotals,rsquared);
-
-    // AIC - Akaike Information Criterion (for Least Squares in this case)
-    // AIC = n * ln(sigma^2) + 2K; K = number of parameters, n = number of observations (i.e., RunLength), sigma^2 = SSresiduals/n
-    nmfUtilsStatistics::calculateAIC(NumSpeciesOrGuilds,NumberOfParameters,RunLength,SSresiduals,aic);
-
-    // Calculate r
-    ok = nmfUtilsStatistics::calculateR(NumSpeciesOrGuilds,RunLength,meanObserved,meanEstimated,observed,estimated,correlationCoeff);
-    if (! ok) {
-        m_Logger->logMsg(nmfConstants::Error,"[Error 2] calculateSummaryStatistics: Divide by 0 error in r calculations.");
-        return false;
-    }
+    return true;
+}
 
-    // Calculate RMSE
-    ok = nmfUtilsStatistics::calculateRMSE(NumSpeciesOrGuilds,RunLength,observed,estimated,rmse);
-    if (! ok) {
-        m_Logger->logMsg(nmfConstants::Error,"[Error 2] calculateSummaryStatistics: Found 0 RunLength in RMSE calculations.");
-        return false;
-    }
+bool
+nmfMainWindow::calculateSummaryStatisticsStruct(
+        const bool&         isAggProd,
+        const std::string&  Algorithm,
+        const std::string&  Minimizer,
+        const std::string&  ObjectiveCriterion,
+        const std::string&  Scaling,
+        const int&          RunLength,
+        const int&          NumSpeciesOrGuilds,
+        const bool&         isMohnsRhoBool,
+        const bool&         isAMultiRun,
+        boost::numeric::ublas::matrix<double>& EstimatedBiomass,
+        StatStruct&         statStruct)
+{
+    nmfCoreStatisticsInput Input;
 
-    // Calculate RI
-    ok = nmfUtilsStatistics::calculateRI(NumSpeciesOrGuilds,RunLength,observed,estimated,ri);
-    if (! ok) {
-        m_Logger->logMsg(nmfConstants::Error,"[Error 3] calculateSummaryStatistics: Found 0 RunLength in RI calculations.");
+    if (! getSummaryStatisticsInput(isAggProd,Algorithm,Minimizer,ObjectiveCriterion,Scaling,
+                                    RunLength,NumSpeciesOrGuilds,isMohnsRhoBool,isAMultiRun,
+                                    EstimatedBiomass,Input)) {
         return false;
     }
 
-    // Calculate AE
-    nmfUtilsStatistics::calculateAE(NumSpeciesOrGuilds,meanObserved,meanEstimated,ae);
-
-    // Calculate AAE
-    nmfUtilsStatistics::calculateAAE(NumSpeciesOrGuilds,RunLength,observed,estimated,aae);
-
-    // Calculate MEF
-    ok = nmfUtilsStatistics::calculateMEF(NumSpeciesOrGuilds,RunLength,meanObserved,observed,estimated,mef);
-    if (! ok) {
-        m_Logger->logMsg(nmfConstants::Error,"[Error 4] calculateSummaryStatistics: Found 0 denominator in MEF calculations.");
+    nmfCoreStatisticsResult Result = nmfCoreStatistics::calculateSummaryStatistics(Input);
+    if (! Result.isValid) {
+        m_Logger->logMsg(nmfConstants::Error,Result.ErrorMsg);
         return false;
     }
-
-    // Calculate Mohn's Rho
-    if (isMohnsRhoBool) {
-        int NumPeels = Diagnostic_Tab2_ptr->getNumPeels();
-        nmfUtilsStatistics::calculateMohnsRhoForParameter(
-            NumPeels,NumSpeciesOrGuilds,RunLength,EstGrowthRate,mohnsRhoGrowthRate);
-        nmfUtilsStatistics::calculateMohnsRhoForParameter(
-            NumPeels,NumSpeciesOrGuilds,RunLength,EstCarryingCapacity,mohnsRhoCarryingCapacity);
-        calculateSummaryStatisticsMohnsRhoBiomass(mohnsRhoEstimatedBiomass);
-    }
-
-
-
-    // Set which model statistics are to be summed and which are to be averaged
-    QList<std::vector<double> > stats;
-    std::vector<std::string> aveOrSum;
-    double total;
-
-    if (isMohnsRhoBool) {
-        stats = {mohnsRhoGrowthRate,
-                 mohnsRhoCarryingCapacity,
-                 mohnsRhoEstimatedBiomass};
-        aveOrSum = {"ave","ave","ave"};
-    } else {
-        stats = {SSresiduals, SSdeviations,
-                 SStotals, rsquared,
-                 correlationCoeff, aic,
-                 rmse, ri, ae,
-                 aae, mef};
-        aveOrSum = {"sum","sum","sum","ave","ave","ave","ave",
-                    "ave","ave","ave","ave"};
-    }
-
-    for (int statNum=0; statNum<stats.size(); ++statNum) {
-        total = 0;
-        // Load the species stats
-        for (int species=0; species<NumSpeciesOrGuilds; ++species) {
-            val = stats[statNum][species];
-            if (val != nmfConstants::NoValueDouble) {
-                total += val;
-            }
-        }
-
-        // Load the model (i.e., last column) stats, either summed or averaged
-        if (aveOrSum[statNum] == "sum") {
-            stats[statNum].push_back(total);
-        } else if (aveOrSum[statNum] == "ave") {
-            stats[statNum].push_back(total/NumSpeciesOrGuilds);
-        }
-    }
-
-    // Load statistics structure
-    if (isMohnsRhoBool) {
-        statStruct.mohnsRhoGrowthRate       = stats[0];
-        statStruct.mohnsRhoCarryingCapacity = stats[1];
-        statStruct.mohnsRhoEstimatedBiomass = stats[2];
-    } else {
-        statStruct.SSresiduals      = stats[0];
-        statStruct.SSdeviations     = stats[1];
-        statStruct.SStotals         = stats[2];
-        statStruct.rsquared         = stats[3];
-        statStruct.correlationCoeff = stats[4];
-        statStruct.aic              = stats[5];
-        statStruct.rmse             = stats[6];
-        statStruct.ri               = stats[7];
-        statStruct.ae               = stats[8];
-        statStruct.aae              = stats[9];
-        statStruct.mef              = stats[10];
-    }
+    statStruct = Result.Stats;
 
     return true;
 }
@@ -6847,19 +6793,30 @@ nmfMainWindow::calculateSummaryStatistics(QStandardItemModel* smodel,
                                           const int&          NumSpeciesOrGuilds,
                                           const bool&         isMohnsRhoBool)
 {
-    StatStruct statStruct;
+    nmfCoreStatisticsInput Input;
     boost::numeric::ublas::matrix<double> EstimatedBiomass;
 
-    bool ok = calculateSummaryStatisticsStruct(isAggProd,Algorithm,Minimizer,ObjectiveCriterion,Scaling,
-                                     RunLength,NumSpeciesOrGuilds,isMohnsRhoBool,false,
-                                     EstimatedBiomass,statStruct);
-    if (ok) {
-std::cout << "statStruct: " << std::endl;
-for (int i=0; i<statStruct.mef.size(); ++i) {
- std::cout << statStruct.mef[i] << std::endl;
-}
-        loadSummaryStatisticsModel(NumSpeciesOrGuilds,smodel,isMohnsRhoBool,statStruct);
+    // The database is read here, but the statistics themselves are calculated on a
+    // worker thread and loaded into the model once they're ready. The watcher is
+    // parented to the model so nothing is loaded if the model goes away first.
+    if (! getSummaryStatisticsInput(isAggProd,Algorithm,Minimizer,ObjectiveCriterion,Scaling,
+                                    RunLength,NumSpeciesOrGuilds,isMohnsRhoBool,false,
+                                    EstimatedBiomass,Input)) {
+        return;
     }
+
+    QFutureWatcher<nmfCoreStatisticsResult>* watcher = new QFutureWatcher<nmfCoreStatisticsResult>(smodel);
+    connect(watcher, &QFutureWatcher<nmfCoreStatisticsResult>::finished,
+            [this,watcher,smodel,NumSpeciesOrGuilds,isMohnsRhoBool]() {
+        nmfCoreStatisticsResult Result = watcher->result();
+        if (Result.isValid) {
+            loadSummaryStatisticsModel(NumSpeciesOrGuilds,smodel,isMohnsRhoBool,Result.Stats);
+        } else {
+            m_Logger->logMsg(nmfConstants::Error,Result.ErrorMsg);
+        }
+        watcher->deleteLater();
+    });
+    watcher->setFuture(QtConcurrent::run(nmfCoreStatistics::calculateSummaryStatistics,Input));
 }
 
 void
@@ -9102,6 +9059,9 @@ nmfMainWindow::closeEvent(QCloseEvent *event)
     if (m_ProgressChartTimer != nullptr) {
         delete m_ProgressChartTimer;
     }
+    if (m_ResultQueue) {
+        m_ResultQueue->close();
+    }
     saveSettings();
 }
 
@@ -9308,12 +9268,16 @@ std::cout << "====================== isAMultiRun: " << isAMultiRun << std::endl;
     m_ProgressWidget->startTimer(100);
     m_ProgressWidget->startRun();
 
+#ifdef MSSPM_INSTRUMENTATION
+    // Time this run's phases on every thread, and drop the previous run's timings
+    nmfInstrumentation::instance().beginRun(m_ProjectName + ": " + Algorithm);
+    nmfInstrumentation::instance().clear();
+#endif
+
     m_RunNumNLopt = 0;
     m_RunNumBees  = 1;
     if (isAMultiRun) {
-// RSK fix this. Can't yet put Bees in MultiRun list...tbd
-//      runBeesAlgorithm(showDiagnosticsChart,MultiRunLines,TotalIndividualRuns);  // Run through all runs and do Bees,  skipping over non-Bees
-        runNLoptAlgorithm(showDiagnosticsChart,MultiRunLines,TotalIndividualRuns); // Run through all runs and do NLopt, skipping over non-NLopt
+        runEnsembleAlgorithms(showDiagnosticsChart,MultiRunLines,TotalIndividualRuns); // Run the Bees and NLopt lines together
     } else {
         if (Algorithm == "Bees Algorithm") {
             runBeesAlgorithm( showDiagnosticsChart,MultiRunLines,TotalIndividualRuns);
@@ -9560,21 +9524,33 @@ nmfMainWindow::runBeesAlgorithm(bool showDiagnosticChart,
 {
     m_ProgressWidget->clearChartData(nmfConstantsMSSPM::MSSPMProgressChartFile);
 
+    // The BeesAlgorithm library writes its progress to the progress chart file
+    m_isProgressInMemory = false;
+
     m_DataStruct.showDiagnosticChart = showDiagnosticChart;
+    m_DataStruct.useFixedSeed        = Estimation_Tab6_ptr->isSetToDeterministic() ||
+                                       isAMohnsRhoMultiRun();
 
     // Create the Bees Estimator object
     m_Estimator_Bees = new Bees_Estimator();
+    m_CancellationToken = std::make_shared<nmfCancellationToken>();
+    m_Estimator_Bees->setCancellationToken(m_CancellationToken);
+    createResultQueue();
+    m_Estimator_Bees->setResultQueue(m_ResultQueue);
 
     // Set up connections
+    disconnect(m_ProgressWidget, 0, 0, 0);
+    connect(m_ProgressWidget,  SIGNAL(StopTheRun()),
+            this,              SLOT(callback_StopTheRun()));
+    connect(m_ProgressWidget,  SIGNAL(StopTheTimer()),
+            this,              SLOT(callback_StopTheTimer()));
+    connect(m_ProgressWidget,  SIGNAL(RedrawValidPointsOnly(bool,bool)),
+            this,              SLOT(callback_ReadProgressChartDataFile(bool,bool)));
     disconnect(m_Estimator_Bees, 0, 0, 0);
-    connect(m_Estimator_Bees, SIGNAL(RunCompleted(std::string,bool)),
-            this,             SLOT(callback_RunCompleted(std::string,bool)));
-    connect(m_Estimator_Bees, SIGNAL(RepetitionRunCompleted(int,int,int)),
-            this,             SLOT(callback_RepetitionRunCompleted(int,int,int)));
+    connect(m_Estimator_Bees, SIGNAL(ResultsAvailable()),
+            this,             SLOT(callback_ResultsAvailable()));
     connect(m_Estimator_Bees, SIGNAL(ErrorFound(std::string)),
             this,             SLOT(callback_ErrorFound(std::string)));
-    connect(m_Estimator_Bees, SIGNAL(AllSubRunsCompleted(std::string,std::string)),
-            this,             SLOT(callback_AllSubRunsCompleted(std::string,std::string)));
 
 //    // Set up progress widget to show fitness vs generation
 //    m_ProgressWidget->startTimer(100);
@@ -9616,6 +9592,71 @@ nmfMainWindow::runBeesAlgorithm(bool showDiagnosticChart,
 } // end runBeesAlgorithm
 
 
+void
+nmfMainWindow::runEnsembleAlgorithms(bool showDiagnosticChart,
+                                     std::vector<QString>& MultiRunLines,
+                                     int& TotalIndividualRuns)
+{
+    bool isSetToDeterministic = Estimation_Tab6_ptr->isSetToDeterministic();
+
+    // Force isSetToDeterministic to be true if running Mohns Rho
+    m_DataStruct.useFixedSeed = isAMohnsRhoMultiRun();
+
+    Output_Controls_ptr->setAveraged(true);
+    m_DataStruct.showDiagnosticChart = showDiagnosticChart;
+
+    // Both estimators' sub-runs and repetitions publish their progress in memory
+    nmfProgressTelemetry::instance().discard();
+    m_isProgressInMemory = true;
+
+    // Create the dispatcher that runs the NLopt and Bees lines together
+    m_EnsembleDispatcher = new nmfCoreEnsembleDispatcher();
+    m_CancellationToken = std::make_shared<nmfCancellationToken>();
+    m_EnsembleDispatcher->setCancellationToken(m_CancellationToken);
+    createResultQueue();
+    m_EnsembleDispatcher->setResultQueue(m_ResultQueue);
+
+    // Set up connections
+    disconnect(m_ProgressWidget, 0, 0, 0);
+    connect(m_ProgressWidget,  SIGNAL(StopTheRun()),
+            this,              SLOT(callback_StopTheRun()));
+    connect(m_ProgressWidget,  SIGNAL(StopTheTimer()),
+            this,              SLOT(callback_StopTheTimer()));
+    connect(m_ProgressWidget,  SIGNAL(RedrawValidPointsOnly(bool,bool)),
+            this,              SLOT(callback_ReadProgressChartDataFile(bool,bool)));
+    disconnect(m_EnsembleDispatcher, 0, 0, 0);
+    connect(m_EnsembleDispatcher, SIGNAL(ResultsAvailable()),
+            this,                 SLOT(callback_ResultsAvailable()));
+    connect(m_EnsembleDispatcher, SIGNAL(ErrorFound(std::string)),
+            this,                 SLOT(callback_ErrorFound(std::string)));
+
+    // The chart's x axis has to fit NLopt's iterations and the Bees' generations
+    updateProgressChartAnnotation(0,(double)std::max(m_DataStruct.NLoptStopAfterIter,
+                                                     m_DataStruct.BeesMaxGenerations),5.0);
+
+    QFuture<void> future = QtConcurrent::run(
+                m_EnsembleDispatcher,
+                &nmfCoreEnsembleDispatcher::estimateParameters,
+                m_DataStruct,
+                MultiRunLines,
+                TotalIndividualRuns,
+                isSetToDeterministic);
+
+    m_ProgressWidget->hideLegend();
+    m_isRunning = true;
+
+    /****************************************************/
+    /* Any statements after this point will be executed */
+    /* before estimateParameters finishes.              */
+    /* So...beware.                                     */
+    /****************************************************/
+
+    // Show Progress Chart
+    m_UI->ProgressDockWidget->show();
+    m_UI->ProgressWidget->setMinimumHeight(250);
+}
+
+
 void
 nmfMainWindow::runNLoptAlgorithm(bool showDiagnosticChart,
                                  std::vector<QString>& MultiRunLines,
@@ -9633,26 +9674,30 @@ nmfMainWindow::runNLoptAlgorithm(bool showDiagnosticChart,
     Output_Controls_ptr->setAveraged(isAMultiRun);
     m_DataStruct.showDiagnosticChart = showDiagnosticChart;
 
+    // The NLopt sub-runs publish their progress in memory
+    nmfProgressTelemetry::instance().discard();
+    m_isProgressInMemory = true;
+
     // Create the NLopt Estimator object
     m_Estimator_NLopt = new NLopt_Estimator();
+    m_CancellationToken = std::make_shared<nmfCancellationToken>();
+    m_Estimator_NLopt->setCancellationToken(m_CancellationToken);
+    createResultQueue();
+    m_Estimator_NLopt->setResultQueue(m_ResultQueue);
 
     // Set up connections
     disconnect(m_ProgressWidget, 0, 0, 0);
     connect(m_ProgressWidget,  SIGNAL(StopTheRun()),
-            m_Estimator_NLopt, SLOT(callback_StopTheOptimizer()));
+            this,              SLOT(callback_StopTheRun()));
     connect(m_ProgressWidget,  SIGNAL(StopTheTimer()),
             this,              SLOT(callback_StopTheTimer()));
     connect(m_ProgressWidget,  SIGNAL(RedrawValidPointsOnly(bool,bool)),
             this,              SLOT(callback_ReadProgressChartDataFile(bool,bool)));
     disconnect(m_Estimator_NLopt, 0, 0, 0);
-    connect(m_Estimator_NLopt, SIGNAL(RunCompleted(std::string,bool)),
-            this,              SLOT(callback_RunCompleted(std::string,bool)));
-    connect(m_Estimator_NLopt, SIGNAL(SubRunCompleted(int,int,std::string,std::string,std::string,std::string,std::string,double)),
-            this,              SLOT(callback_SubRunCompleted(int,int,std::string,std::string,std::string,std::string,std::string,double)));
+    connect(m_Estimator_NLopt, SIGNAL(ResultsAvailable()),
+            this,              SLOT(callback_ResultsAvailable()));
 //    connect(m_Estimator_NLopt, SIGNAL(InitializeSubRuns(std::string,int)),
 //            this,              SLOT(callback_InitializeSubRuns(std::string,int)));
-    connect(m_Estimator_NLopt, SIGNAL(AllSubRunsCompleted(std::string,std::string)),
-            this,              SLOT(callback_AllSubRunsCompleted(std::string,std::string)));
 
 //    // Do some multi run setup
 //    if (isAMultiRun) {
@@ -9695,6 +9740,57 @@ nmfMainWindow::runNLoptAlgorithm(bool showDiagnosticChart,
     m_UI->ProgressWidget->setMinimumHeight(250);
 }
 
+void
+nmfMainWindow::callback_StopTheRun()
+{
+    m_CancellationToken->cancel();
+}
+
+void
+nmfMainWindow::createResultQueue()
+{
+    // The estimator waits once it is this many results ahead of the GUI
+    const std::size_t ResultQueueCapacity = 16;
+
+    if (m_ResultQueue) {
+        m_ResultQueue->close();
+    }
+    m_ResultQueue = std::make_shared<nmfEstimationResultQueue>(ResultQueueCapacity);
+}
+
+void
+nmfMainWindow::callback_ResultsAvailable()
+{
+    std::unique_ptr<nmfEstimationResult> Result;
+
+    if (! m_ResultQueue) {
+        return;
+    }
+
+    // A single drain may handle the results of several signals, in which
+    // case the later signals find the queue empty
+    while (m_ResultQueue->tryPop(Result)) {
+        switch (Result->Type) {
+            case nmfEstimationResult::RepetitionCompleted:
+                callback_RepetitionRunCompleted(Result->RunNumber,
+                                                Result->SubRunNumber,
+                                                Result->NumRuns);
+                break;
+            case nmfEstimationResult::SubRunCompleted:
+                processSubRunResult(*Result);
+                break;
+            case nmfEstimationResult::RunCompleted:
+                callback_RunCompleted(Result->BestFitness,
+                                      Result->showDiagnosticChart);
+                break;
+            case nmfEstimationResult::AllSubRunsCompleted:
+                callback_AllSubRunsCompleted(Result->MultiRunSpeciesFilename,
+                                             Result->MultiRunModelFilename);
+                break;
+        }
+    }
+}
+
 void
 nmfMainWindow::callback_StopTheTimer()
 {
@@ -9722,37 +9818,22 @@ nmfMainWindow::calculateSubRunBiomass(std::vector<double>& EstInitBiomass,
 {
     int RunLength;
     int InitialYear;
-    int timeMinus1;
-    int guildNum;
     int NumGuilds;
     int NumSpeciesOrGuilds;
-    double GuildCarryingCapacity;
-    double EstBiomassVal = 0;
-    double SystemCarryingCapacity = 0;
-    double growthTerm;
-    double harvestTerm;
-    double competitionTerm;
-    double predationTerm;
     std::string ForecastName = "";  // RSK - may need to refactor this later if going to re-use this method
     std::string GrowthForm;
     std::string HarvestForm;
     std::string CompetitionForm;
     std::string PredationForm;
-    nmfGrowthForm*      growthForm;
-    nmfHarvestForm*     harvestForm;
-    nmfCompetitionForm* competitionForm;
-    nmfPredationForm*   predationForm;
-    bool isAggProd      = (CompetitionForm == "AGG-PROD");
+    bool isAggProd;
     QStringList SpeciesList;
     QStringList GuildList;
-    std::vector<int>                GuildNum;
-    std::map<int,std::vector<int> > GuildSpecies;
+    nmfStructsQt::ModelDataStruct dataStruct;
+    nmfEstimationResult Estimates;
     boost::numeric::ublas::matrix<double> EstimatedBiomassByGuilds;
-//    QList<double> InitialBiomass;
-    boost::numeric::ublas::matrix<double> ObservedBiomassByGuilds;
-    boost::numeric::ublas::matrix<double> Catch;
-    boost::numeric::ublas::matrix<double> Effort;
-    boost::numeric::ublas::matrix<double> Exploitation;
+    boost::numeric::ublas::matrix<double>& Catch        = dataStruct.Catch;
+    boost::numeric::ublas::matrix<double>& Effort       = dataStruct.Effort;
+    boost::numeric::ublas::matrix<double>& Exploitation = dataStruct.Exploitation;
 std::cout << "Warning: nmfMainWindow::calculateSubRunBiomass possibly not using SurveyQ or Observed Biomass" << std::endl;
     //
     // continue here.....
@@ -9765,10 +9846,7 @@ std::cout << "Warning: nmfMainWindow::calculateSubRunBiomass possibly not using
                 RunLength,InitialYear,m_Logger,m_ProjectSettingsConfig)) {
         return false;
     }
-    growthForm      = new nmfGrowthForm(GrowthForm);
-    harvestForm     = new nmfHarvestForm(HarvestForm);
-    competitionForm = new nmfCompetitionForm(CompetitionForm);
-    predationForm   = new nmfPredationForm(PredationForm);
+    isAggProd = (CompetitionForm == "AGG-PROD");
 
     // Find Guilds and Species
     if (! getGuilds(NumGuilds,GuildList)) {
@@ -9787,33 +9865,12 @@ std::cout << "Warning: nmfMainWindow::calculateSubRunBiomass possibly not using
 //        return false;
 //    }
 
-    nmfUtils::initialize(EstBiomassSpecies,RunLength+1,NumSpeciesOrGuilds);
-
-    // Even though this is EstInitBiomass, if initial biomass wasn't estimated, it
-    // should be the initial biomass.
-    for (int j=0; j<int(EstInitBiomass.size()); ++j) {
-        EstBiomassSpecies(0,j) = EstInitBiomass[j];
-    }
-
     // Get guild map
-    nmfUtils::initialize(EstimatedBiomassByGuilds, RunLength+1,NumGuilds);
-    if (! m_DatabasePtr->getGuildData(m_Logger,NumGuilds,RunLength,GuildList,GuildSpecies,GuildNum,ObservedBiomassByGuilds)) {
+    if (! m_DatabasePtr->getGuildData(m_Logger,NumGuilds,RunLength,GuildList,
+                                      dataStruct.GuildSpecies,dataStruct.GuildNum,
+                                      dataStruct.ObservedBiomassByGuilds)) {
         return false;
     }
-    EstimatedBiomassByGuilds = ObservedBiomassByGuilds;
-
-    // Calculate System Carrying Capacity
-    if (isAggProd) {
-        for (int i=0; i<NumGuilds; ++i) {
-            SystemCarryingCapacity += EstCarryingCapacities[i];
-        }
-    } else {
-        for (int i=0; i<NumGuilds; ++i) {
-            for (unsigned j=0; j<GuildSpecies[i].size(); ++j) {
-                SystemCarryingCapacity += EstCarryingCapacities[GuildSpecies[i][j]];
-            }
-        }
-    }
 
     // Get Harvest data
     if (HarvestForm == "Catch") {
@@ -9873,72 +9930,33 @@ std::cout << "Warning: nmfMainWindow::calculateSubRunBiomass possibly not using
 //        nmfUtils::initialize(HarvestRandomValues,NumSpeciesOrGuilds);
     }
 
-    for (int time = 1; time <= RunLength; time++) {
-        timeMinus1 = time-1;
-        for (int species=0; species<NumSpeciesOrGuilds; ++species)
-        {
-            // Find the guild carrying capacity for guild: guildNum
-            GuildCarryingCapacity = 0;
-            if (isAggProd) {
-                GuildCarryingCapacity = EstCarryingCapacities[species];
-            } else {
-                guildNum = GuildNum[species];
-                for (unsigned j=0; j<GuildSpecies[guildNum].size(); ++j) {
-                    GuildCarryingCapacity += EstCarryingCapacities[GuildSpecies[guildNum][j]];
-                }
-            }
-
-            EstBiomassVal = EstBiomassSpecies(timeMinus1,species);
-
-            growthTerm      = growthForm->evaluate(species,EstBiomassVal,
-                                                   EstGrowthRates,EstCarryingCapacities);
-            harvestTerm     = harvestForm->evaluate(timeMinus1,species,Catch,Effort,
-                                                    Exploitation,
-                                                    EstBiomassVal,
-                                                    EstCatchabilityRates);
-            competitionTerm = competitionForm->evaluate(timeMinus1,
-                                                        species,
-                                                        EstBiomassVal,
-                                                        SystemCarryingCapacity,
-                                                        EstGrowthRates,
-                                                        GuildCarryingCapacity,
-                                                        EstCompetitionAlpha,
-                                                        EstCompetitionBetaSpecies,
-                                                        EstCompetitionBetaGuilds,
-                                                        EstCompetitionBetaGuildsGuilds,
-                                                        EstBiomassSpecies,
-                                                        EstimatedBiomassByGuilds);
-            predationTerm   = predationForm->evaluate(timeMinus1,species,
-                                                      EstPredation,EstHandling,EstExponent,
-                                                      EstBiomassSpecies,EstBiomassVal);
-
-            EstBiomassVal += growthTerm - harvestTerm - competitionTerm - predationTerm;
-
-
-            if ( std::isnan(std::fabs(EstBiomassVal)) ||
-                (EstBiomassVal < 0) )
-            {
-                EstBiomassVal = 0;
-            }
-            EstBiomassSpecies(time,species) = EstBiomassVal;
-
-            // update estBiomassGuilds for next time step
-            if (isAggProd) {
-                for (int i=0; i<NumGuilds; ++i) {
-                    EstimatedBiomassByGuilds(time,i) = EstBiomassSpecies(time,i);
-                }
-            } else {
-                for (int i=0; i<NumGuilds; ++i) {
-                    for (unsigned j=0; j<GuildSpecies[i].size(); ++j) {
-                        EstimatedBiomassByGuilds(time,i) += EstBiomassSpecies(time,GuildSpecies[i][j]);
-                    }
-                }
-            }
-
-        }
+    dataStruct.GrowthForm      = GrowthForm;
+    dataStruct.HarvestForm     = HarvestForm;
+    dataStruct.CompetitionForm = CompetitionForm;
+    dataStruct.PredationForm   = PredationForm;
+    dataStruct.RunLength       = RunLength;
+    dataStruct.NumGuilds       = NumGuilds;
+    dataStruct.NumSpecies      = NumSpeciesOrGuilds;
+
+    Estimates.EstInitBiomass                 = EstInitBiomass;
+    Estimates.EstGrowthRates                 = EstGrowthRates;
+    Estimates.EstCarryingCapacities          = EstCarryingCapacities;
+    Estimates.EstCatchability                = EstCatchabilityRates;
+    Estimates.EstPredationExponent           = EstExponent;
+    Estimates.EstSurveyQ                     = EstSurveyQ;
+    Estimates.EstCompetitionAlpha            = EstCompetitionAlpha;
+    Estimates.EstCompetitionBetaSpecies      = EstCompetitionBetaSpecies;
+    Estimates.EstCompetitionBetaGuilds       = EstCompetitionBetaGuilds;
+    Estimates.EstCompetitionBetaGuildsGuilds = EstCompetitionBetaGuildsGuilds;
+    Estimates.EstPredationRho                = EstPredation;
+    Estimates.EstPredationHandling           = EstHandling;
+
+    if (! nmfCoreSimulator::calculateBiomass(dataStruct,Estimates,
+                                             EstBiomassSpecies,EstimatedBiomassByGuilds)) {
+        m_Logger->logMsg(nmfConstants::Error,"nmfMainWindow::calculateSubRunBiomass: Estimates don't match the model's size");
+        return false;
     }
 
-
     return true;
 }
 
@@ -9984,15 +10002,15 @@ nmfMainWindow::callback_InitializeSubRuns(
 }
 
 void
-nmfMainWindow::callback_SubRunCompleted(int run,
-                                        int numRuns,
-                                        std::string EstimationAlgorithm,
-                                        std::string MinimizerAlgorithm,
-                                        std::string ObjectiveCriterion,
-                                        std::string ScalingAlgorithm,
-                                        std::string multiRunModelFilename,
-                                        double fitness)
+nmfMainWindow::processSubRunResult(nmfEstimationResult& Result)
 {
+    const int&         run                 = Result.RunNumber;
+    const int&         numRuns             = Result.NumRuns;
+    const std::string& EstimationAlgorithm = Result.EstimationAlgorithm;
+    const std::string& MinimizerAlgorithm  = Result.MinimizerAlgorithm;
+    const std::string& ObjectiveCriterion  = Result.ObjectiveCriterion;
+    const std::string& ScalingAlgorithm    = Result.ScalingAlgorithm;
+    const double&      fitness             = Result.Fitness;
     int RunLength;
     int InitialYear;
     std::string GrowthForm;
@@ -10000,62 +10018,40 @@ nmfMainWindow::callback_SubRunCompleted(int run,
     std::string CompetitionForm;
     std::string PredationForm;
     int NumSpecies;
-    std::vector<double> InitialBiomass;
-    std::vector<double> InitialGrowthRate;
-    std::vector<double> InitialSpeciesK;
-
+    bool isAggProd = Result.isAggProd;
     QStringList SpeciesList;
-    std::vector<double> EstInitBiomass;
-    std::vector<double> EstGrowthRates;
-    std::vector<double> EstCarryingCapacities;
-    std::vector<double> EstPredationExponent;
-    std::vector<double> EstCatchability;
-    std::vector<double> EstSurveyQ;
-    boost::numeric::ublas::matrix<double> EstCompetitionAlpha;
-    boost::numeric::ublas::matrix<double> EstCompetitionBetaSpecies;
-    boost::numeric::ublas::matrix<double> EstCompetitionBetaGuilds;
-    boost::numeric::ublas::matrix<double> EstCompetitionBetaGuildsGuilds;
-    boost::numeric::ublas::matrix<double> EstPredationRho;
-    boost::numeric::ublas::matrix<double> EstPredationHandling;
     boost::numeric::ublas::matrix<double> CalculatedBiomass;
 
-    if (! m_DatabasePtr->getSpeciesInitialData(NumSpecies,SpeciesList,InitialBiomass,
-                                               InitialGrowthRate,InitialSpeciesK,m_Logger)) {
-        return;
-    }
-
-    if (! m_DatabasePtr->getModelFormData(
-                GrowthForm,HarvestForm,CompetitionForm,PredationForm,
-                RunLength,InitialYear,m_Logger,m_ProjectSettingsConfig))
-        return;
-    bool isAggProd = (CompetitionForm == "AGG-PROD");
-
     getSpecies(NumSpecies,SpeciesList);
 
-    // Create outputbiomass
-    m_Estimator_NLopt->getEstInitBiomass(EstInitBiomass);
-    m_Estimator_NLopt->getEstGrowthRates(EstGrowthRates);
-    m_Estimator_NLopt->getEstCarryingCapacities(EstCarryingCapacities);
-    m_Estimator_NLopt->getEstCatchability(EstCatchability);
-    m_Estimator_NLopt->getEstSurveyQ(EstSurveyQ);
-    m_Estimator_NLopt->getEstCompetitionAlpha(EstCompetitionAlpha);
-    m_Estimator_NLopt->getEstCompetitionBetaSpecies(EstCompetitionBetaSpecies);
-    m_Estimator_NLopt->getEstCompetitionBetaGuilds(EstCompetitionBetaGuilds);
-    m_Estimator_NLopt->getEstCompetitionBetaGuildsGuilds(EstCompetitionBetaGuildsGuilds);
-    m_Estimator_NLopt->getEstPredation(EstPredationRho);
-    m_Estimator_NLopt->getEstHandling(EstPredationHandling);
-    m_Estimator_NLopt->getEstExponent(EstPredationExponent);
-
-    if (! calculateSubRunBiomass(EstInitBiomass,EstGrowthRates,
-                                 EstCarryingCapacities,EstCatchability,EstPredationExponent,EstSurveyQ,
-                                 EstCompetitionAlpha,EstCompetitionBetaSpecies,EstCompetitionBetaGuilds,
-                                 EstCompetitionBetaGuildsGuilds,EstPredationRho,
-                                 EstPredationHandling,CalculatedBiomass)) {
-        return;
+    // The result holds its own copy of the estimates, since the estimator may
+    // already be on a later sub run. If the estimator calculated the sub run's
+    // biomass, take it over; otherwise re-run the model with the estimates.
+    if (Result.EstBiomassSpecies.size1() > 0) {
+        RunLength = Result.RunLength;
+        CalculatedBiomass.swap(Result.EstBiomassSpecies);
+    } else {
+        if (! m_DatabasePtr->getModelFormData(
+                    GrowthForm,HarvestForm,CompetitionForm,PredationForm,
+                    RunLength,InitialYear,m_Logger,m_ProjectSettingsConfig))
+            return;
+        isAggProd = (CompetitionForm == "AGG-PROD");
+        if (! calculateSubRunBiomass(Result.EstInitBiomass,Result.EstGrowthRates,
+                                     Result.EstCarryingCapacities,Result.EstCatchability,
+                                     Result.EstPredationExponent,Result.EstSurveyQ,
+                                     Result.EstCompetitionAlpha,Result.EstCompetitionBetaSpecies,
+                                     Result.EstCompetitionBetaGuilds,Result.EstCompetitionBetaGuildsGuilds,
+                                     Result.EstPredationRho,Result.EstPredationHandling,
+                                     CalculatedBiomass)) {
+            return;
+        }
     }
 
-    updateBiomassEnsembleTable(run,EstimationAlgorithm,MinimizerAlgorithm,
-                               ObjectiveCriterion,ScalingAlgorithm,CalculatedBiomass);
+    {
+        NMF_INSTRUMENT_SCOPE(nmfPhaseDatabaseWrite);
+        updateBiomassEnsembleTable(run,EstimationAlgorithm,MinimizerAlgorithm,
+                                   ObjectiveCriterion,ScalingAlgorithm,CalculatedBiomass);
+    }
 
 
 
@@ -10117,18 +10113,18 @@ nmfMainWindow::callback_SubRunCompleted(int run,
     }
     m_AveragedData->loadEstData(fitness,
                                 statStruct.aic,
-                                EstInitBiomass,
-                                EstGrowthRates,
-                                EstCarryingCapacities,
-                                EstPredationExponent,
-                                EstCatchability,
-                                EstSurveyQ,
-                                EstCompetitionAlpha,
-                                EstCompetitionBetaSpecies,
-                                EstCompetitionBetaGuilds,
-                                EstCompetitionBetaGuildsGuilds,
-                                EstPredationRho,
-                                EstPredationHandling,
+                                Result.EstInitBiomass,
+                                Result.EstGrowthRates,
+                                Result.EstCarryingCapacities,
+                                Result.EstPredationExponent,
+                                Result.EstCatchability,
+                                Result.EstSurveyQ,
+                                Result.EstCompetitionAlpha,
+                                Result.EstCompetitionBetaSpecies,
+                                Result.EstCompetitionBetaGuilds,
+                                Result.EstCompetitionBetaGuildsGuilds,
+                                Result.EstPredationRho,
+                                Result.EstPredationHandling,
                                 CalculatedBiomass);
 
 
@@ -11042,6 +11038,22 @@ std::cout << "=====>>>>> run completed" << std::endl;
         callback_UpdateSummaryStatistics();
     }
 
+#ifdef MSSPM_INSTRUMENTATION
+    // The run's evaluations are done, so its timings are complete
+    int runId = nmfInstrumentation::instance().getRunId();
+    QString traceFile = QDir(QDir(QString::fromStdString(m_ProjectDir)).filePath(
+                                 QString::fromStdString(nmfConstantsMSSPM::OutputDataDir))).filePath("InstrumentationTrace.json");
+    QString instrumentationMsg = "<pre>" + QString::fromStdString(nmfInstrumentation::instance().getSummary(runId)).toHtmlEscaped();
+    if (nmfInstrumentation::instance().writeChromeTrace(runId,traceFile.toStdString())) {
+        instrumentationMsg += "Chrome trace: " + traceFile.toHtmlEscaped();
+    } else {
+        instrumentationMsg += "Couldn't write Chrome trace: " + traceFile.toHtmlEscaped();
+    }
+    instrumentationMsg += "</pre>";
+    m_RunOutputMsg += instrumentationMsg;
+    Estimation_Tab6_ptr->appendOutputTE(instrumentationMsg);
+#endif
+
     m_ProgressWidget->showLegend();
 
     Estimation_Tab1_ptr->checkIfRunFromModifySlider();
@@ -11316,7 +11328,7 @@ nmfMainWindow::runNextMohnsRhoEstimation()
 
 bool
 nmfMainWindow::calculateSummaryStatisticsMohnsRhoBiomass(
-        std::vector<double>& mohnsRhoEstimatedBiomass)
+        std::vector<std::vector<double> >& EstBiomass)
 {
     int NumPeels = Diagnostic_Tab2_ptr->getNumPeels();
     int RunLength;
@@ -11336,9 +11348,6 @@ nmfMainWindow::calculateSummaryStatisticsMohnsRhoBiomass(
     std::vector<std::string> fields;
     std::map<std::string, std::vector<std::string> > dataMap;
     QStringList SpeciesList;
-    std::vector<std::vector<double> > EstBiomass;
-
-    mohnsRhoEstimatedBiomass.clear();
 
     getSpecies(NumSpecies,SpeciesList);
 
@@ -11397,16 +11406,6 @@ nmfMainWindow::calculateSummaryStatisticsMohnsRhoBiomass(
         EstBiomass.push_back(tmpVec);
     }
 
-    std::vector<double> mohnsRhoValue;
-    nmfUtilsStatistics::calculateMohnsRhoForTimeSeries(
-                NumPeels,NumSpecies,EstBiomass,mohnsRhoValue);
-
-    // Display values
-    for (unsigned p=0; p<mohnsRhoValue.size(); ++p) {
-//std::cout << "Mohns Rho est biomass: " << p << ", " << mohnsRhoValue[p] << std::endl;
-        mohnsRhoEstimatedBiomass.push_back(mohnsRhoValue[p]);
-    }
-
     return true;
 }
 
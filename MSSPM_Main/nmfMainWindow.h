@@ -53,6 +53,14 @@
 
 #include "Bees_Estimator.h"
 #include "NLopt_Estimator.h"
+#include "nmfCancellationToken.h"
+#include "nmfCoreEnsembleDispatcher.h"
+#include "nmfCoreSimulator.h"
+#include "nmfCoreStatistics.h"
+#include "nmfEstimationResult.h"
+#include "nmfInstrumentation.h"
+#include "nmfProgressTelemetry.h"
+#include "nmfRandom.h"
 
 #include "nmfGrowthForm.h"
 #include "nmfCompetitionForm.h"
@@ -85,6 +93,7 @@
 #include "TableNamesDialog.h"
 
 #include <QtDataVisualization>
+#include <QElapsedTimer>
 #include <QImage>
 #include <QOpenGLWidget>
 #include <QPixmap>
@@ -163,6 +172,7 @@ private:
     int                                   m_DiagnosticsFontSize;
     int                                   m_DiagnosticsNumPoints;
     int                                   m_DiagnosticsVariation;
+    nmfCoreEnsembleDispatcher*            m_EnsembleDispatcher;
     Bees_Estimator*                       m_Estimator_Bees;
     NLopt_Estimator*                      m_Estimator_NLopt;
     int                                   m_ForecastFontSize;
@@ -212,6 +222,28 @@ private:
     QTableView*                           m_FishingMortalityTV;
     QTableView*                           m_HarvestScaleFactorTV;
     bool                                  m_isRunning;
+    /**
+     * @brief True if the running estimator publishes its progress through nmfProgressTelemetry
+     * (NLopt) instead of writing the progress chart file itself (Bees)
+     */
+    bool                                  m_isProgressInMemory;
+    std::vector<nmfProgressSample>        m_ProgressSamples;
+    /**
+     * @brief Time since the progress chart was last redrawn, and whether samples have been
+     * drained since. nmfProgressWidget can only re-read the whole chart file, so an in-memory
+     * run's chart is redrawn at most once per m_ProgressChartRedrawIntervalMs.
+     */
+    QElapsedTimer                         m_ProgressChartRedrawTimer;
+    bool                                  m_isProgressChartStale;
+    int                                   m_ProgressChartRedrawIntervalMs;
+    /**
+     * @brief Stops the current estimation run. A new token is created for every run.
+     */
+    std::shared_ptr<nmfCancellationToken> m_CancellationToken;
+    /**
+     * @brief Results pushed by the running estimator. A new queue is created for every run.
+     */
+    std::shared_ptr<nmfEstimationResultQueue> m_ResultQueue;
     QStringList                           m_finalList;
     QStringList                           m_orderedFinalList;
     boost::numeric::ublas::matrix<double> m_biomassMatrix;
@@ -283,6 +315,12 @@ private:
     int getTabIndex(QTabWidget* tabWidget, QString tabName);
     void calculateAverageBiomass();
     void displayAverageBiomass();
+    /**
+     * @brief Drains the progress samples published by the estimator threads and appends
+     * them to the progress chart file, which nmfProgressWidget reads
+     * @return Returns true if any new samples were found
+     */
+    bool drainProgressTelemetry();
     void clearOutputData(std::string algorithm,
                          std::string minimizer,
                          std::string objectiveCriterion,
@@ -331,6 +369,11 @@ private:
             const std::vector<double>& EstGrowthRates,
             const boost::numeric::ublas::matrix<double>& EstCompetitionAlpha,
             const boost::numeric::ublas::matrix<double>& EstPredationRho);
+    /**
+     * @brief Creates the result queue for a new estimation run, closing the previous
+     * run's queue so that an estimator still blocked on it returns
+     */
+    void createResultQueue();
     bool calculateSubRunBiomass(std::vector<double>& EstInitBiomass,
                                 std::vector<double>& EstGrowthRates,
                                 std::vector<double>& EstCarryingCapacities,
@@ -344,7 +387,8 @@ private:
                                 boost::numeric::ublas::matrix<double>& EstPredation,
                                 boost::numeric::ublas::matrix<double>& EstHandling,
                                 boost::numeric::ublas::matrix<double>& calculatedBiomass);
-    double calculateMonteCarloValue(const double& uncertainty,
+    double calculateMonteCarloValue(nmfRandom& Random,
+                                    const double& uncertainty,
                                     const double& value,
                                     double& randomValue);
     bool calculateMSYValues(
@@ -380,7 +424,7 @@ private:
             const bool&         isAMultiRun,
             boost::numeric::ublas::matrix<double>& EstimatedBiomass,
             StatStruct&         statStruct);
-    bool calculateSummaryStatisticsMohnsRhoBiomass(std::vector<double>& mohnsRhoEstimatedBiomass);
+    bool calculateSummaryStatisticsMohnsRhoBiomass(std::vector<std::vector<double> >& EstBiomass);
     void checkGuildRanges(
             const int& NumGuilds,
             const nmfStructsQt::ModelDataStruct& dataStruct);
@@ -551,6 +595,18 @@ private:
     bool getSpeciesWithGuilds(int& NumSpecies,
                               QStringList& SpeciesList,
                               QStringList& GuildList);
+    bool getSummaryStatisticsInput(
+            const bool&         isAggProd,
+            const std::string&  Algorithm,
+            const std::string&  Minimizer,
+            const std::string&  ObjectiveCriterion,
+            const std::string&  Scaling,
+            const int&          RunLength,
+            const int&          NumSpeciesOrGuilds,
+            const bool&         isMohnsRhoBool,
+            const bool&         isAMultiRun,
+            boost::numeric::ublas::matrix<double>& EstimatedBiomass,
+            nmfCoreStatisticsInput& Input);
     int  getStartYearOffset();
     bool getMSYData(bool isAveraged,
                     const int&     NumLines,
@@ -677,7 +733,20 @@ private:
                      const int&         MohnsRhoStartYear,
                      const int&         MohnsRhoRunLength,
                      const int&         InitialYear);
+    /**
+     * @brief Stores the biomass and statistics of a multi-run's completed sub run. The
+     * biomass is only calculated here if the estimator didn't provide it.
+     * @param Result : the sub run's result. Its biomass is taken over.
+     */
+    void processSubRunResult(nmfEstimationResult& Result);
     void queryUserPreviousDatabase();
+    /**
+     * @brief Redraws the progress chart and checks whether the run has stopped
+     * @param validPointsOnly : boolean signifying whether all points or only valid points should be displayed
+     * @param clearChart : boolean signifying if chart should be cleared before redrawing
+     * @param redrawOnlyIfNew : boolean signifying if an in-memory run's chart should only be re-read when it has new samples
+     */
+    void readProgressChart(bool validPointsOnly, bool clearChart, bool redrawOnlyIfNew);
     void readSettings(QString name);
     void readSettings();
     void readSettingsGuiOrientation(bool alsoResetPosition);
@@ -685,6 +754,9 @@ private:
     void runBeesAlgorithm(bool showDiagnosticsChart,
                           std::vector<QString>& MultiRunLines,
                           int& TotalIndividualRuns);
+    void runEnsembleAlgorithms(bool showDiagnosticChart,
+                               std::vector<QString>& MultiRunLines,
+                               int& TotalIndividualRuns);
     void runNextMohnsRhoEstimation();
     void runNLoptAlgorithm(bool showDiagnosticChart,
                            std::vector<QString>& MultiRunLines,
@@ -692,7 +764,8 @@ private:
     void saveRemoraDataFile(QString filename);
     bool saveScreenshot(QString &outputfile, QPixmap &pm);
     void saveSettings();
-    bool scaleTimeSeriesIfMonteCarlo(const bool& isMonteCarlo,
+    bool scaleTimeSeriesIfMonteCarlo(nmfRandom& Random,
+                                     const bool& isMonteCarlo,
                                      const std::vector<double>&             Uncertainty,
                                      boost::numeric::ublas::matrix<double>& HarvestMatrix,
                                      std::vector<double>&                   RandomValues);
@@ -1160,14 +1233,11 @@ public slots:
     void callback_RunCompleted(std::string outputMsg,
                                bool showDiagnosticChart);
 
-    void callback_SubRunCompleted(int run,
-                                  int numRuns,
-                                  std::string EstimationAlgorithm,
-                                  std::string MinimizerAlgorithm,
-                                  std::string ObjectiveCriterion,
-                                  std::string ScalingAlgorithm,
-                                  std::string multiRunModelFilename,
-                                  double fitness);
+    /**
+     * @brief Callback invoked when the estimator has pushed results onto the result queue.
+     * Drains the queue and handles the results in the order they were pushed.
+     */
+    void callback_ResultsAvailable();
     /**
      * @brief Callback invoked when user runs Estimations as part of a Retrospective Analysis Diagnostics run
      * @param ranges : year ranges for current run
@@ -1315,6 +1385,10 @@ public slots:
      * @brief Callback invoked to stop the progress widget's elapsed run timer
      */
     void callback_StopTheTimer();
+    /**
+     * @brief Callback invoked when the user stops the Estimation run
+     */
+    void callback_StopTheRun();
     /**
      * @brief Callback invoked when user loads a System from the Setup Page 4 GUI
      */
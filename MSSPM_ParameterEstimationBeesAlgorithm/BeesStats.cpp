@@ -1,21 +1,175 @@
 #include "BeesStats.h"
 
+#include <algorithm>
+
+BeesP2Quantile::BeesP2Quantile(const double& probability)
+{
+    m_probability = probability;
+    m_count       = 0;
+    for (int i=0; i<5; ++i) {
+        m_heights[i]          = 0;
+        m_positions[i]        = i+1;
+        m_desiredPositions[i] = i+1;
+    }
+    m_increments[0] = 0;
+    m_increments[1] = probability/2;
+    m_increments[2] = probability;
+    m_increments[3] = (1+probability)/2;
+    m_increments[4] = 1;
+}
+
+void
+BeesP2Quantile::initializeMarkers()
+{
+    // Called once the first five observations are in
+    std::sort(m_heights,m_heights+5);
+    for (int i=0; i<5; ++i) {
+        m_positions[i]        = i+1;
+        m_desiredPositions[i] = 1 + 4*m_increments[i];
+    }
+}
+
+double
+BeesP2Quantile::parabolic(const int& i, const double& d) const
+{
+    return m_heights[i] + d/(m_positions[i+1]-m_positions[i-1]) *
+           ((m_positions[i]-m_positions[i-1]+d)*(m_heights[i+1]-m_heights[i])/(m_positions[i+1]-m_positions[i]) +
+            (m_positions[i+1]-m_positions[i]-d)*(m_heights[i]-m_heights[i-1])/(m_positions[i]-m_positions[i-1]));
+}
+
+double
+BeesP2Quantile::linear(const int& i, const int& d) const
+{
+    return m_heights[i] + d*(m_heights[i+d]-m_heights[i])/(m_positions[i+d]-m_positions[i]);
+}
+
+void
+BeesP2Quantile::addData(const double& value)
+{
+    int k;
+    double d;
+    double height;
+
+    if (m_count < 5) {
+        m_heights[m_count++] = value;
+        if (m_count == 5) {
+            initializeMarkers();
+        }
+        return;
+    }
+    ++m_count;
+
+    // Find the cell the value falls in, extending the extremes if needed
+    if (value < m_heights[0]) {
+        m_heights[0] = value;
+        k = 0;
+    } else if (value >= m_heights[4]) {
+        m_heights[4] = value;
+        k = 3;
+    } else {
+        k = 0;
+        while (value >= m_heights[k+1]) {
+            ++k;
+        }
+    }
+    for (int i=k+1; i<5; ++i) {
+        m_positions[i] += 1;
+    }
+    for (int i=0; i<5; ++i) {
+        m_desiredPositions[i] += m_increments[i];
+    }
+
+    // Move the inner markers toward their desired positions
+    for (int i=1; i<4; ++i) {
+        d = m_desiredPositions[i] - m_positions[i];
+        if (((d >=  1) && (m_positions[i+1]-m_positions[i] >  1)) ||
+            ((d <= -1) && (m_positions[i-1]-m_positions[i] < -1))) {
+            d = (d > 0) ? 1 : -1;
+            height = parabolic(i,d);
+            if ((m_heights[i-1] < height) && (height < m_heights[i+1])) {
+                m_heights[i] = height;
+            } else {
+                m_heights[i] = linear(i,int(d));
+            }
+            m_positions[i] += d;
+        }
+    }
+}
+
+void
+BeesP2Quantile::merge(const BeesP2Quantile& other)
+{
+    if (other.m_count < 5) {
+        for (int i=0; i<other.m_count; ++i) {
+            addData(other.m_heights[i]);
+        }
+        return;
+    }
+    if (m_count < 5) {
+        BeesP2Quantile merged = other;
+        for (int i=0; i<m_count; ++i) {
+            merged.addData(m_heights[i]);
+        }
+        *this = merged;
+        return;
+    }
+
+    long   count   = m_count + other.m_count;
+    double weight  = double(m_count)/count;
+
+    m_heights[0] = std::min(m_heights[0],other.m_heights[0]);
+    m_heights[4] = std::max(m_heights[4],other.m_heights[4]);
+    for (int i=1; i<4; ++i) {
+        m_heights[i]    = weight*m_heights[i] + (1-weight)*other.m_heights[i];
+        m_positions[i] += other.m_positions[i];
+    }
+    m_positions[4] = count;
+    for (int i=0; i<5; ++i) {
+        m_desiredPositions[i] = 1 + (count-1)*m_increments[i];
+    }
+    m_count = count;
+}
+
+double
+BeesP2Quantile::getQuantile() const
+{
+    if (m_count == 0) {
+        return 0;
+    } else if (m_count < 5) {
+        // Interpolate between the sorted observations
+        double sorted[5];
+        std::copy(m_heights,m_heights+m_count,sorted);
+        std::sort(sorted,sorted+m_count);
+        double position = m_probability*(m_count-1);
+        int    lower    = int(position);
+        int    upper    = std::min(lower+1,int(m_count-1));
+        return sorted[lower] + (position-lower)*(sorted[upper]-sorted[lower]);
+    }
+
+    return m_heights[2];
+}
+
+double
+BeesP2Quantile::getProbability() const
+{
+    return m_probability;
+}
+
+
 BeesStats::BeesStats(const int &totParameters,
-                     const int &numRuns)
+                     const std::vector<double>& probabilities)
 {
-    m_sumFitness      = 0;
-    m_meanFitness     = 0;
-    m_totalParameters = totParameters;
-    m_numRuns         = numRuns;
-    m_sumData.clear();
-    m_fitnessData.clear();
-    m_stdDev.clear();
-    m_meanData.clear();
-    std::vector<double> newVec = {};
+    m_totalParameters   = totParameters;
+    m_numRuns           = 0;
+    m_meanFitness       = 0;
+    m_sumSquaresFitness = 0;
+    m_meanData.assign(m_totalParameters,0);
+    m_sumSquaresData.assign(m_totalParameters,0);
+    m_probabilities = probabilities;
 
-    for (int i=0; i<m_totalParameters; ++i) {
-        m_data.push_back(newVec);
-        m_sumData.push_back(0);
+    for (const double& probability : m_probabilities) {
+        m_fitnessQuantiles.push_back(BeesP2Quantile(probability));
+        m_quantileData.push_back(std::vector<BeesP2Quantile>(m_totalParameters,BeesP2Quantile(probability)));
     }
 }
 
@@ -23,31 +177,78 @@ void
 BeesStats::addData(const double& bestFitness,
                    const std::vector<double>& parameters)
 {
-    double param;
+    double delta;
 
     if ((unsigned)m_totalParameters != parameters.size()) {
         std::cout << "Error (1) BeesStats: Total number of parameters doesn't agree with size of parameters vector passed in." << std::endl;
         return;
     }
+
+    // Welford's update of the means and sums of squared differences from them
+    ++m_numRuns;
     for (int i=0; i<m_totalParameters; ++i) {
-        param = parameters[i];
-        m_data[i].push_back(param);
-        m_sumData[i] += param;
+        delta = parameters[i] - m_meanData[i];
+        m_meanData[i]       += delta/m_numRuns;
+        m_sumSquaresData[i] += delta*(parameters[i] - m_meanData[i]);
+    }
+    delta = bestFitness - m_meanFitness;
+    m_meanFitness       += delta/m_numRuns;
+    m_sumSquaresFitness += delta*(bestFitness - m_meanFitness);
+
+    for (unsigned j=0; j<m_probabilities.size(); ++j) {
+        m_fitnessQuantiles[j].addData(bestFitness);
+        for (int i=0; i<m_totalParameters; ++i) {
+            m_quantileData[j][i].addData(parameters[i]);
+        }
     }
-    m_fitnessData.push_back(bestFitness);
-    m_sumFitness += bestFitness;
 }
 
 void
-BeesStats::getMean(double& fitness, std::vector<double>& result)
+BeesStats::merge(const BeesStats& other)
 {
-    m_meanData.clear();
+    double delta;
+    long   numRuns;
+
+    if ((m_totalParameters != other.m_totalParameters) ||
+        (m_probabilities   != other.m_probabilities)) {
+        std::cout << "Error (2) BeesStats: Can't merge statistics of different parameters or quantiles." << std::endl;
+        return;
+    }
+    if (other.m_numRuns == 0) {
+        return;
+    }
+
+    // Chan et al.'s combination of the two sets of means and sums of squares
+    numRuns = m_numRuns + other.m_numRuns;
     for (int i=0; i<m_totalParameters; ++i) {
-        m_meanData.push_back(m_sumData[i]/m_numRuns);
+        delta = other.m_meanData[i] - m_meanData[i];
+        m_meanData[i]       += delta*other.m_numRuns/numRuns;
+        m_sumSquaresData[i] += other.m_sumSquaresData[i] + delta*delta*m_numRuns*other.m_numRuns/numRuns;
+    }
+    delta = other.m_meanFitness - m_meanFitness;
+    m_meanFitness       += delta*other.m_numRuns/numRuns;
+    m_sumSquaresFitness += other.m_sumSquaresFitness + delta*delta*m_numRuns*other.m_numRuns/numRuns;
+    m_numRuns = numRuns;
+
+    for (unsigned j=0; j<m_probabilities.size(); ++j) {
+        m_fitnessQuantiles[j].merge(other.m_fitnessQuantiles[j]);
+        for (int i=0; i<m_totalParameters; ++i) {
+            m_quantileData[j][i].merge(other.m_quantileData[j][i]);
+        }
     }
-    fitness = m_sumFitness/m_numRuns;
-    m_meanFitness = fitness;
-    result = m_meanData;
+}
+
+long
+BeesStats::getNumRuns() const
+{
+    return m_numRuns;
+}
+
+void
+BeesStats::getMean(double& fitness, std::vector<double>& result)
+{
+    fitness = m_meanFitness;
+    result  = m_meanData;
 }
 
 void
@@ -55,30 +256,37 @@ BeesStats::getStdDev(double& fitnessStdDev,
                      double& totStdDev,
                      std::vector<double>& stdDevParameters)
 {
-    double diff;
-    double stdDev=0;
-    double sumSquares=0;
+    // Divide by the number of runs actually loaded, which is less than the number
+    // requested if the user stopped the run
+    double numRuns = (m_numRuns > 0) ? double(m_numRuns) : 1.0;
 
     totStdDev = 0;
-    m_stdDev.clear();
+    stdDevParameters.clear();
     for (int j=0; j<m_totalParameters; ++j) {
-        sumSquares = 0;
-        for (int i=0; i<m_numRuns; ++i) {
-            diff = m_data[j][i] - m_meanData[j];
-            sumSquares += (diff * diff);
-        }
-        stdDev = sqrt(sumSquares/m_numRuns);
-        m_stdDev.push_back(stdDev);
-        totStdDev += stdDev;
+        stdDevParameters.push_back(sqrt(m_sumSquaresData[j]/numRuns));
+        totStdDev += stdDevParameters.back();
+    }
+    if (m_totalParameters > 0) {
+        totStdDev /= m_totalParameters;
+    }
+
+    fitnessStdDev = sqrt(m_sumSquaresFitness/numRuns);
+}
+
+bool
+BeesStats::getQuantile(const int& quantileNum,
+                       double& fitness,
+                       std::vector<double>& parameters)
+{
+    if ((quantileNum < 0) || (quantileNum >= int(m_probabilities.size()))) {
+        return false;
     }
-    totStdDev /= m_totalParameters;
-    stdDevParameters = m_stdDev;
 
-    // Calculate fitness std dev
-    sumSquares = 0;
-    for (int i=0; i<m_numRuns; ++i) {
-        diff = m_fitnessData[i] - m_meanFitness;
-        sumSquares += (diff * diff);
+    fitness = m_fitnessQuantiles[quantileNum].getQuantile();
+    parameters.clear();
+    for (int i=0; i<m_totalParameters; ++i) {
+        parameters.push_back(m_quantileData[quantileNum][i].getQuantile());
     }
-    fitnessStdDev = sqrt(sumSquares/m_numRuns);
+
+    return true;
 }
@@ -6,6 +6,13 @@
  * structure contains the variables necessary to run an Estimation using the
  * Bees Algorithm.
  *
+ * The statistics are accumulated online (Welford's algorithm), so the memory
+ * used depends on the number of parameters and not on the number of
+ * repetitions. Statistics accumulated separately (e.g., by parallel workers)
+ * may be merged (Chan et al.'s algorithm). Quantiles, if requested, are
+ * estimated with the P-squared algorithm (Jain and Chlamtac), which keeps five
+ * markers per quantile and parameter.
+ *
  * @copyright
  * Public Domain Notice\n
  *
@@ -35,6 +42,57 @@
 #include <vector>
 #include <iostream>
 
+/**
+ * @brief Streaming estimate of one quantile using the P-squared algorithm
+ *
+ * The first five observations are kept as they are. After that, five markers
+ * (the minimum, the p/2, p and (1+p)/2 quantiles and the maximum) are moved
+ * toward their desired positions as each observation arrives.
+ */
+class BeesP2Quantile
+{
+private:
+    double m_probability;
+    long   m_count;
+    double m_heights[5];
+    double m_positions[5];
+    double m_desiredPositions[5];
+    double m_increments[5];
+
+    double parabolic(const int& i, const double& d) const;
+    double linear(const int& i, const int& d) const;
+    void   initializeMarkers();
+
+public:
+    /**
+     * @brief Class constructor
+     * @param probability : the quantile to estimate (between 0 and 1)
+     */
+    BeesP2Quantile(const double& probability);
+   ~BeesP2Quantile() {}
+
+    /**
+     * @brief Adds an observation
+     * @param value : the observation
+     */
+    void addData(const double& value);
+    /**
+     * @brief Merges another estimate of the same quantile into this one. The extreme
+     * markers are merged exactly and the inner ones by weighting them by their counts,
+     * so the merged estimate is an approximation.
+     * @param other : estimate of the same quantile over other observations
+     */
+    void merge(const BeesP2Quantile& other);
+    /**
+     * @brief Gets the estimated quantile (0 if there are no observations)
+     */
+    double getQuantile() const;
+    /**
+     * @brief Gets the quantile being estimated
+     */
+    double getProbability() const;
+};
+
 /**
  * @brief Bees Statistics Class
  *
@@ -44,18 +102,24 @@
 class BeesStats
 {
 private:
-    int                               m_totalParameters;
-    int                               m_numRuns;
-    double                            m_sumFitness;
-    double                            m_meanFitness;
-    std::vector<double>               m_sumData;
-    std::vector<double>               m_fitnessData;
-    std::vector<double>               m_meanData;
-    std::vector<double>               m_stdDev;
-    std::vector<std::vector<double> > m_data;
+    int                                        m_totalParameters;
+    long                                       m_numRuns;
+    double                                     m_meanFitness;
+    double                                     m_sumSquaresFitness;
+    std::vector<double>                        m_meanData;
+    std::vector<double>                        m_sumSquaresData;
+    std::vector<double>                        m_probabilities;
+    std::vector<BeesP2Quantile>                m_fitnessQuantiles;
+    std::vector<std::vector<BeesP2Quantile> >  m_quantileData;
 
 public:
-    BeesStats(const int &totParameters, const int& numRuns);
+    /**
+     * @brief Class constructor
+     * @param totParameters : number of parameters of each bee
+     * @param probabilities : quantiles to estimate for the fitness and each parameter (e.g., {0.025,0.975}); none if empty
+     */
+    BeesStats(const int &totParameters,
+              const std::vector<double>& probabilities = {});
    ~BeesStats() {}
 
     /**
@@ -65,6 +129,15 @@ public:
      */
     void addData(const double& bestFitness,
                  const std::vector<double>& parameters);
+    /**
+     * @brief Merges statistics accumulated over other runs into these
+     * @param other : statistics with the same number of parameters and quantiles
+     */
+    void merge(const BeesStats& other);
+    /**
+     * @brief Gets the number of runs loaded
+     */
+    long getNumRuns() const;
     /**
      * @brief Finds the mean fitness value
      * @param fitness : the mean fitness value
@@ -81,6 +154,16 @@ public:
     void getStdDev(double& fitnessStdDev,
                    double& totStdDev,
                    std::vector<double>& stdDevParameters);
+    /**
+     * @brief Gets the estimate of one of the quantiles requested in the constructor
+     * @param quantileNum : index of the quantile in the constructor's probabilities
+     * @param fitness : the fitness quantile
+     * @param parameters : the quantile of each of the estimated parameters
+     * @return Returns false if there's no such quantile
+     */
+    bool getQuantile(const int& quantileNum,
+                     double& fitness,
+                     std::vector<double>& parameters);
 
 };
 
@@ -0,0 +1,232 @@
+
+#include "Bees_Engine.h"
+#include "nmfInstrumentation.h"
+
+#include <QFuture>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+
+
+Bees_Engine::Bees_Engine(const nmfStructsQt::ModelDataStruct& BeeStruct,
+                         std::shared_ptr<const Bees_RunContext> RunContext) :
+    m_NumBees(BeeStruct.BeesNumTotal),
+    m_NumSites(BeeStruct.BeesNumBestSites),
+    m_NumEliteSites(BeeStruct.BeesNumEliteSites),
+    m_NumEliteForagers(BeeStruct.BeesNumElite),
+    m_NumOtherForagers(BeeStruct.BeesNumOther),
+    m_MaxGenerations(BeeStruct.BeesMaxGenerations),
+    m_NeighborhoodFraction(BeeStruct.BeesNeighborhoodSize/200.0), // size is the % of the range covered
+    m_RunNum(0),
+    m_SubRunNum(1),
+    m_NumEvaluations(0),
+    m_Seed(0),
+    m_Run(0),
+    m_Repetition(0),
+    m_RunContext(RunContext),
+    m_ThreadPool(nullptr)
+{
+}
+
+void
+Bees_Engine::setThreadPool(QThreadPool* ThreadPool)
+{
+    m_ThreadPool = ThreadPool;
+}
+
+void
+Bees_Engine::setCancellationToken(std::shared_ptr<const nmfCancellationToken> Cancellation)
+{
+    m_Cancellation = Cancellation;
+}
+
+void
+Bees_Engine::setProgressChannel(std::shared_ptr<nmfProgressChannel> Progress,
+                                const int& RunNum,
+                                const int& SubRunNum)
+{
+    m_Progress  = Progress;
+    m_RunNum    = RunNum;
+    m_SubRunNum = SubRunNum;
+}
+
+long
+Bees_Engine::getNumEvaluations() const
+{
+    return m_NumEvaluations;
+}
+
+bool
+Bees_Engine::wasStoppedByUser() const
+{
+    return m_Cancellation && m_Cancellation->isCancelled();
+}
+
+void
+Bees_Engine::createBee(const NLopt_EvaluationContext& Context,
+                       const int& Generation,
+                       const int& BeeNum,
+                       const Bees_Bee* Site,
+                       Bees_Bee& Bee)
+{
+    double minVal;
+    double maxVal;
+    double halfWidth;
+    const std::vector<std::pair<double,double> >& parameterRanges = m_RunContext->getParameterRanges();
+    nmfRandom random(m_Seed,m_Run,m_Repetition,
+                     std::uint32_t(Generation)*std::uint32_t(m_NumBees) + std::uint32_t(BeeNum));
+
+    // A scout flies anywhere in the parameter space; a forager stays in its site's neighborhood
+    Bee.Parameters.resize(parameterRanges.size());
+    for (unsigned i=0; i<parameterRanges.size(); ++i) {
+        minVal = parameterRanges[i].first;
+        maxVal = parameterRanges[i].second;
+        if (Site != nullptr) {
+            halfWidth = m_NeighborhoodFraction*(maxVal-minVal);
+            minVal = std::max(minVal,Site->Parameters[i]-halfWidth);
+            maxVal = std::min(maxVal,Site->Parameters[i]+halfWidth);
+        }
+        Bee.Parameters[i] = random.getUniform(minVal,maxVal);
+    }
+
+    // A forager only matters if it's better than its site, so it may stop as soon as it can't be
+    Bee.Fitness = NLopt_Estimator::evaluateObjective(Context,Bee.Parameters.data(),
+                                                     (Site != nullptr) ? Site->Fitness :
+                                                                         std::numeric_limits<double>::infinity());
+}
+
+void
+Bees_Engine::evaluateGeneration(const int& Generation,
+                                const std::vector<const Bees_Bee*>& Sites,
+                                std::vector<Bees_Bee>& Bees)
+{
+    int numBees  = int(Sites.size());
+    int numTasks = (m_ThreadPool != nullptr) ? std::min(m_ThreadPool->maxThreadCount(),numBees) : 1;
+    std::atomic<int> nextBee(0);
+    std::vector<QFuture<void> > futures;
+
+    // Bee i's result only depends on its own stream, so it doesn't matter which task takes
+    // it. Each task borrows an evaluation context from the sub-run's for as long as it runs.
+    Bees.resize(numBees);
+    auto evaluateBees = [this,&Generation,&Sites,&Bees,&nextBee,numBees]() {
+        int beeNum;
+        std::unique_ptr<Bees_TaskContext> task = m_RunContext->acquireTaskContext();
+        while ((beeNum = nextBee.fetch_add(1)) < numBees) {
+            createBee(task->Context,Generation,beeNum,Sites[beeNum],Bees[beeNum]);
+        }
+        m_RunContext->releaseTaskContext(std::move(task));
+    };
+    for (int task=1; task<numTasks; ++task) {
+        futures.push_back(QtConcurrent::run(m_ThreadPool,evaluateBees));
+    }
+    evaluateBees();
+
+    // The waiting thread may be one of the pool's own (e.g., running a repetition), so
+    // let the pool start another thread while it sleeps rather than lose a core to it
+    if (! futures.empty()) {
+        m_ThreadPool->releaseThread();
+        for (QFuture<void>& future : futures) {
+            future.waitForFinished();
+        }
+        m_ThreadPool->reserveThread();
+    }
+
+    m_NumEvaluations += numBees;
+    NMF_INSTRUMENT_COUNT(nmfCounterEvaluations,numBees);
+}
+
+bool
+Bees_Engine::estimateParameters(const std::uint64_t& Seed,
+                                const int& Run,
+                                const int& Repetition,
+                                double& BestFitness,
+                                std::vector<double>& BestParameters,
+                                std::string& ErrorMsg)
+{
+    int beeNum;
+    int numRecruits;
+    int numForagers = m_NumEliteSites*m_NumEliteForagers +
+                      (m_NumSites-m_NumEliteSites)*m_NumOtherForagers;
+    double plotFitness;
+    std::vector<Bees_Bee> population;
+    std::vector<Bees_Bee> bees;
+    std::vector<const Bees_Bee*> sites;
+    auto isFitter = [](const Bees_Bee& a, const Bees_Bee& b) {
+        return a.Fitness < b.Fitness;
+    };
+
+    if ((m_NumBees < 1) || (m_NumSites < 1) || (m_NumSites > m_NumBees) ||
+        (m_NumEliteSites < 0) || (m_NumEliteSites > m_NumSites) ||
+        (m_NumEliteForagers < 0) || (m_NumOtherForagers < 0) ||
+        (numForagers > m_NumBees) ||
+        (m_MaxGenerations < 0) || (m_NeighborhoodFraction <= 0)) {
+        ErrorMsg = "Bees_Engine: Invalid Bees Algorithm settings. The number of best sites must be from 1 to "
+                   "the total number of bees, the number of elite sites at most the number of best sites, "
+                   "and the foragers recruited to the sites at most the total number of bees.";
+        return false;
+    }
+    m_NumEvaluations = 0;
+    m_Seed           = Seed;
+    m_Run            = std::uint32_t(Run);
+    m_Repetition     = std::uint32_t(Repetition);
+
+    // Generation 0 is all scouts
+    sites.assign(m_NumBees,nullptr);
+    evaluateGeneration(0,sites,bees);
+    population.swap(bees);
+    std::stable_sort(population.begin(),population.end(),isFitter);
+    BestFitness    = population[0].Fitness;
+    BestParameters = population[0].Parameters;
+
+    // Every generation keeps the best sites and adds the scouts to them, so there are
+    // always at least m_NumSites bees to choose the next generation's sites from
+    for (int generation=1; generation<=m_MaxGenerations; ++generation) {
+
+        if (wasStoppedByUser()) {
+            return false;
+        }
+
+        // Recruit foragers to the best sites, more of them to the elite ones, and
+        // send the rest of the colony scouting
+        sites.clear();
+        for (int site=0; site<m_NumSites; ++site) {
+            numRecruits = (site < m_NumEliteSites) ? m_NumEliteForagers : m_NumOtherForagers;
+            sites.insert(sites.end(),numRecruits,&population[site]);
+        }
+        sites.insert(sites.end(),m_NumBees-numForagers,nullptr);
+        evaluateGeneration(generation,sites,bees);
+
+        // Each site moves to its best forager if that's better than the site
+        beeNum = 0;
+        for (int site=0; site<m_NumSites; ++site) {
+            numRecruits = (site < m_NumEliteSites) ? m_NumEliteForagers : m_NumOtherForagers;
+            for (int recruit=0; recruit<numRecruits; ++recruit, ++beeNum) {
+                if (bees[beeNum].Fitness < population[site].Fitness) {
+                    population[site] = bees[beeNum];
+                }
+            }
+        }
+        population.resize(m_NumSites);
+        for (; beeNum<int(bees.size()); ++beeNum) {
+            population.push_back(std::move(bees[beeNum]));
+        }
+        std::stable_sort(population.begin(),population.end(),isFitter);
+
+        if (population[0].Fitness < BestFitness) {
+            BestFitness    = population[0].Fitness;
+            BestParameters = population[0].Parameters;
+        }
+
+        if (m_Progress) {
+            // Model Efficiency is minimized as its negative, so negate it again for the chart
+            plotFitness = (m_RunContext->getContext().ObjectiveCriterion == NLoptModelEfficiency) ? -BestFitness : BestFitness;
+            NMF_INSTRUMENT_SCOPE(nmfPhaseProgressIO);
+            NMF_INSTRUMENT_COUNT(nmfCounterProgressSamples,1);
+            m_Progress->publish(m_RunNum,generation,plotFitness,m_SubRunNum);
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,154 @@
+/**
+ * @file Bees_Engine.h
+ * @brief Class definition for the Bees_Engine generation loop
+ *
+ * This file contains the class definition for Bees_Engine, an optional parallel
+ * implementation of one repetition of the Bees Algorithm. It's used instead of the
+ * BeesAlgorithm library only when Bees_Estimator::setUseBeesEngine is set, as its
+ * search isn't the library's and its results differ from it. The bees of a generation
+ * (the foragers recruited to the elite and best sites and the scouts) don't depend
+ * on each other, so they're evaluated together on a thread pool. Each bee draws its
+ * parameters from an nmfRandom stream of its own, keyed by the seed, the run,
+ * the repetition, the generation and the bee's position in the generation, and
+ * the results are combined in bee order. A run's results therefore don't depend on the number
+ * of threads. The fitness is calculated with the NLopt evaluation context, so
+ * the Bees and NLopt estimators share the same model form kernels. The context is
+ * built once per sub-run (see Bees_RunContext) and shared by its repetitions.
+ *
+ * @copyright
+ * Public Domain Notice\n
+ *
+ * National Oceanic And Atmospheric Administration\n\n
+ *
+ * This software is a "United States Government Work" under the terms of the
+ * United States Copyright Act.  It was written as part of the author's official
+ * duties as a United States Government employee/contractor and thus cannot be copyrighted.
+ * This software is freely available to the public for use. The National Oceanic
+ * And Atmospheric Administration and the U.S. Government have not placed any
+ * restriction on its use or reproduction.  Although all reasonable efforts have
+ * been taken to ensure the accuracy and reliability of the software and data,
+ * the National Oceanic And Atmospheric Administration and the U.S. Government
+ * do not and cannot warrant the performance or results that may be obtained
+ * by using this software or data. The National Oceanic And Atmospheric
+ * Administration and the U.S. Government disclaim all warranties, express
+ * or implied, including warranties of performance, merchantability or fitness
+ * for any particular purpose.\n\n
+ *
+ * Please cite the author(s) in any work or product based on this material.
+ */
+
+#pragma once
+
+#include "Bees_RunContext.h"
+#include "nmfCancellationToken.h"
+#include "nmfProgressTelemetry.h"
+#include "nmfRandom.h"
+#include "nmfStructsQt.h"
+
+#include <QThreadPool>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief A bee: a point in parameter space and its fitness
+ */
+struct Bees_Bee {
+    std::vector<double> Parameters;
+    double Fitness;
+};
+
+/**
+ * @brief Runs one repetition of the Bees Algorithm, evaluating each generation's bees in parallel
+ */
+class Bees_Engine
+{
+private:
+    int    m_NumBees;
+    int    m_NumSites;
+    int    m_NumEliteSites;
+    int    m_NumEliteForagers;
+    int    m_NumOtherForagers;
+    int    m_MaxGenerations;
+    /**
+     * @brief Half width of a site's neighborhood, as a fraction of each parameter's range
+     */
+    double m_NeighborhoodFraction;
+    int    m_RunNum;
+    int    m_SubRunNum;
+    long   m_NumEvaluations;
+    std::uint64_t m_Seed;
+    std::uint32_t m_Run;
+    std::uint32_t m_Repetition;
+    std::shared_ptr<const Bees_RunContext>      m_RunContext;
+    QThreadPool*                                m_ThreadPool;
+    std::shared_ptr<const nmfCancellationToken> m_Cancellation;
+    std::shared_ptr<nmfProgressChannel>         m_Progress;
+
+    void createBee(const NLopt_EvaluationContext& Context,
+                   const int& Generation,
+                   const int& BeeNum,
+                   const Bees_Bee* Site,
+                   Bees_Bee& Bee);
+    void evaluateGeneration(const int& Generation,
+                            const std::vector<const Bees_Bee*>& Sites,
+                            std::vector<Bees_Bee>& Bees);
+    bool wasStoppedByUser() const;
+
+public:
+    /**
+     * @brief Class constructor. The colony has
+     * BeesNumTotal bees: BeesNumElite foragers for each of the BeesNumEliteSites elite sites,
+     * BeesNumOther for each of the other best sites, and scouts for the rest. A site's
+     * neighborhood spans BeesNeighborhoodSize percent of each parameter's range.
+     * @param BeeStruct : the Bees Algorithm settings
+     * @param RunContext : the sub-run's evaluation context, shared with its other repetitions
+     */
+    Bees_Engine(const nmfStructsQt::ModelDataStruct& BeeStruct,
+                std::shared_ptr<const Bees_RunContext> RunContext);
+   ~Bees_Engine() {}
+
+    /**
+     * @brief Sets the pool each generation's bees are evaluated on. Without one they're
+     * evaluated on the calling thread. The results are the same either way.
+     * @param ThreadPool : the pool (not owned)
+     */
+    void setThreadPool(QThreadPool* ThreadPool);
+    /**
+     * @brief Sets the token checked once per generation for a user stop
+     * @param Cancellation : the run's cancellation token
+     */
+    void setCancellationToken(std::shared_ptr<const nmfCancellationToken> Cancellation);
+    /**
+     * @brief Sets the channel the best fitness of each generation is published on
+     * @param Progress : the progress channel
+     * @param RunNum : run number shown on the progress chart
+     * @param SubRunNum : repetition number shown on the progress chart, so that
+     * concurrent repetitions are plotted as separate series
+     */
+    void setProgressChannel(std::shared_ptr<nmfProgressChannel> Progress,
+                            const int& RunNum,
+                            const int& SubRunNum);
+    /**
+     * @brief Runs one repetition of the Bees Algorithm
+     * @param Seed : seed of the run (see nmfRandom::getSeed)
+     * @param Run : run number, which keys the repetition's random number streams with the seed
+     * @param Repetition : repetition number, which keys them too
+     * @param BestFitness : fitness of the best bee found
+     * @param BestParameters : parameters of the best bee found, in NLopt_ParameterLayout order
+     * @param ErrorMsg : why the Bees Algorithm settings are invalid
+     * @return Returns false if the settings are invalid or the user stopped the run
+     */
+    bool estimateParameters(const std::uint64_t& Seed,
+                            const int& Run,
+                            const int& Repetition,
+                            double& BestFitness,
+                            std::vector<double>& BestParameters,
+                            std::string& ErrorMsg);
+    /**
+     * @brief Number of objective function evaluations made by the last estimateParameters
+     */
+    long getNumEvaluations() const;
+};
@@ -1,10 +1,19 @@
 
 
 #include "Bees_Estimator.h"
+#include "nmfInstrumentation.h"
 
+#include <QFuture>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <atomic>
+#include <mutex>
 
-Bees_Estimator::Bees_Estimator() {
 
+Bees_Estimator::Bees_Estimator() {
+    m_CancellationToken = std::make_shared<nmfCancellationToken>();
+    m_ThreadPool        = nullptr;
+    m_UseBeesEngine     = false;
 }
 
 
@@ -12,6 +21,122 @@ Bees_Estimator::~Bees_Estimator() {
 
 }
 
+void
+Bees_Estimator::setCancellationToken(std::shared_ptr<nmfCancellationToken> CancellationToken)
+{
+    m_CancellationToken = CancellationToken;
+}
+
+void
+Bees_Estimator::setResultQueue(std::shared_ptr<nmfEstimationResultQueue> ResultQueue)
+{
+    m_ResultQueue = ResultQueue;
+}
+
+void
+Bees_Estimator::setEnsemble(std::shared_ptr<nmfEstimationEnsemble> Ensemble)
+{
+    m_Ensemble = Ensemble;
+}
+
+void
+Bees_Estimator::setThreadPool(QThreadPool* ThreadPool)
+{
+    m_ThreadPool = ThreadPool;
+}
+
+void
+Bees_Estimator::setUseBeesEngine(const bool& UseBeesEngine)
+{
+    m_UseBeesEngine = UseBeesEngine;
+}
+
+void
+Bees_Estimator::pushResult(std::unique_ptr<nmfEstimationResult> Result)
+{
+    bool pushed;
+
+    if (! m_ResultQueue) {
+        return;
+    }
+    if (m_Ensemble && (Result->Type == nmfEstimationResult::SubRunCompleted)) {
+        pushed = m_Ensemble->push(*m_ResultQueue,std::move(Result));
+    } else {
+        pushed = m_ResultQueue->push(std::move(Result));
+    }
+    if (pushed) {
+        emit ResultsAvailable();
+    }
+}
+
+void
+Bees_Estimator::pushRunCompleted(const double& bestFitness,
+                                 const std::string& bestFitnessStr,
+                                 const nmfStructsQt::ModelDataStruct& beeStruct)
+{
+    std::unique_ptr<nmfEstimationResult> Result = std::make_unique<nmfEstimationResult>();
+    Result->Type                = nmfEstimationResult::RunCompleted;
+    Result->BestFitness         = bestFitnessStr;
+    Result->showDiagnosticChart = beeStruct.showDiagnosticChart;
+    Result->EstimationAlgorithm = beeStruct.EstimationAlgorithm;
+    Result->MinimizerAlgorithm  = beeStruct.MinimizerAlgorithm;
+    Result->ObjectiveCriterion  = beeStruct.ObjectiveCriterion;
+    Result->ScalingAlgorithm    = beeStruct.ScalingAlgorithm;
+    Result->Fitness             = bestFitness;
+    Result->isAggProd           = (beeStruct.CompetitionForm == "AGG-PROD");
+    Result->RunLength           = beeStruct.RunLength;
+    Result->EstInitBiomass                 = m_EstInitBiomass;
+    Result->EstGrowthRates                 = m_EstGrowthRates;
+    Result->EstCarryingCapacities          = m_EstCarryingCapacities;
+    Result->EstCatchability                = m_EstCatchability;
+    Result->EstPredationExponent           = m_EstExponent;
+    Result->EstSurveyQ                     = m_EstSurveyQ;
+    Result->EstCompetitionAlpha            = m_EstAlpha;
+    Result->EstCompetitionBetaSpecies      = m_EstBetaSpecies;
+    Result->EstCompetitionBetaGuilds       = m_EstBetaGuilds;
+    Result->EstCompetitionBetaGuildsGuilds = m_EstBetaGuildsGuilds;
+    Result->EstPredationRho                = m_EstPredation;
+    Result->EstPredationHandling           = m_EstHandling;
+    pushResult(std::move(Result));
+}
+
+void
+Bees_Estimator::pushSubRunCompleted(const int& RunNumber,
+                                    const int& TotalIndividualRuns,
+                                    const double& bestFitness,
+                                    const long& numEvaluations,
+                                    const nmfStructsQt::ModelDataStruct& beeStruct)
+{
+    // The result keeps its own copy of the estimates, since the next sub-run
+    // overwrites them before the GUI gets to this one
+    std::unique_ptr<nmfEstimationResult> Result = std::make_unique<nmfEstimationResult>();
+    Result->Type                  = nmfEstimationResult::SubRunCompleted;
+    Result->RunNumber             = RunNumber;
+    Result->NumRuns               = TotalIndividualRuns;
+    Result->EstimationAlgorithm   = beeStruct.EstimationAlgorithm;
+    Result->MinimizerAlgorithm    = beeStruct.MinimizerAlgorithm;
+    Result->ObjectiveCriterion    = beeStruct.ObjectiveCriterion;
+    Result->ScalingAlgorithm      = beeStruct.ScalingAlgorithm;
+    Result->MultiRunModelFilename = beeStruct.MultiRunModelFilename;
+    Result->Fitness               = bestFitness;
+    Result->NumEvaluations        = int(numEvaluations);
+    Result->isAggProd             = (beeStruct.CompetitionForm == "AGG-PROD");
+    Result->RunLength             = beeStruct.RunLength;
+    Result->EstInitBiomass                 = m_EstInitBiomass;
+    Result->EstGrowthRates                 = m_EstGrowthRates;
+    Result->EstCarryingCapacities          = m_EstCarryingCapacities;
+    Result->EstCatchability                = m_EstCatchability;
+    Result->EstPredationExponent           = m_EstExponent;
+    Result->EstSurveyQ                     = m_EstSurveyQ;
+    Result->EstCompetitionAlpha            = m_EstAlpha;
+    Result->EstCompetitionBetaSpecies      = m_EstBetaSpecies;
+    Result->EstCompetitionBetaGuilds       = m_EstBetaGuilds;
+    Result->EstCompetitionBetaGuildsGuilds = m_EstBetaGuildsGuilds;
+    Result->EstPredationRho                = m_EstPredation;
+    Result->EstPredationHandling           = m_EstHandling;
+    pushResult(std::move(Result));
+}
+
 void
 Bees_Estimator::printBee(std::string          msg,
                          double&              fitness,
@@ -36,7 +161,7 @@ Bees_Estimator::estimateParameters(nmfStructsQt::ModelDataStruct &beeStruct,
     bool foundOneBeesRun = false;
     bool ok=false;
     bool isAggProd   = (beeStruct.CompetitionForm == "AGG-PROD");
-    bool isAMultiRun = (beeStruct.NLoptNumberOfRuns > 1);
+    bool isAMultiRun = m_Ensemble || (beeStruct.NLoptNumberOfRuns > 1);
     int startPos = 0;
     int NumSpecies = beeStruct.NumSpecies;
     int NumGuilds  = beeStruct.NumGuilds;
@@ -45,26 +170,29 @@ Bees_Estimator::estimateParameters(nmfStructsQt::ModelDataStruct &beeStruct,
     int NumMultiRuns = 1;
     int numTotalParameters;
     int numEstParameters; // The parameters that don't have their min range equal to their max range.
-    int usecDelay = 300000;
     int NumSubRuns;
 //  int TotalIndividualRuns = 0;
     double totStdDev;
-    double bestFitness;
+    double bestFitness     = 99999;
     double fitnessStdDev   = 0;
     double MeanFitness     = 0;
-    double lastBestFitness = 99999;
-    std::string msg;
-    std::string errorMsg;
     std::string bestFitnessStr;
-    std::vector<double> lastBestParameters;
 
     QDateTime startTime = nmfUtilsQt::getCurrentTime();
 
     std::vector<double> EstParameters;
     std::vector<double> MeanEstParameters;
     std::vector<double> stdDevParameters;
+    std::uint64_t Seed;
+    std::vector<std::pair<double,double> > ParameterRanges;
+    std::vector<std::string> RepetitionErrors;
+    std::unique_ptr<Bees_RepetitionAggregator> Aggregator;
+    std::shared_ptr<const Bees_RunContext> RunContext;
     std::unique_ptr<BeesAlgorithm> beesAlg;
-    std::unique_ptr<BeesStats>     beesStats;
+    std::mutex PrintMutex;
+    std::atomic<long> NumEvaluations;
+    QThreadPool OwnThreadPool;
+    QThreadPool* ThreadPool = m_ThreadPool;
 //  std::vector<QString> MultiRunLines;
 
     m_InitialCarryingCapacities.clear();
@@ -102,6 +230,12 @@ std::cout << "Bees: isAMultiRun: " << isAMultiRun << std::endl;
         m_InitialCarryingCapacities.push_back(beeStruct.CarryingCapacity[i]);
     }
 
+    // Bees_Engine's repetitions, and each generation's bees, are evaluated on every core
+    if (m_UseBeesEngine && (ThreadPool == nullptr)) {
+        OwnThreadPool.setMaxThreadCount(QThread::idealThreadCount());
+        ThreadPool = &OwnThreadPool;
+    }
+
 
     for (int multiRun=0; multiRun<NumMultiRuns; ++multiRun) {
 
@@ -118,99 +252,194 @@ std::cout << "Skipping: " <<  MultiRunLines[multiRun].toStdString() << std::endl
         }
 
         foundOneBeesRun = true;
+        // Every repetition's random numbers are keyed by (seed, line, repetition), so a
+        // deterministic run is the same however its repetitions are scheduled
+        Seed = nmfRandom::getSeed(beeStruct.useFixedSeed);
+        ParameterRanges.clear();
+        NLopt_Estimator::loadParameterRanges(ParameterRanges,beeStruct);
         for (int run=0; run<NumSubRuns; ++run) {
 
-            for (int subRunNum=1; subRunNum<=NumRepetitions; ++subRunNum)
-            {
-std::cout << "subRunNum: " << subRunNum << std::endl;
-                // Initialize main class ptr
-                beesAlg   = std::make_unique<BeesAlgorithm>(beeStruct,nmfConstantsMSSPM::VerboseOn);
-                beesStats = std::make_unique<BeesStats>(beeStruct.TotalNumberParameters,NumRepetitions);
-                beesAlg->initializeParameterRangesAndPatchSizes(beeStruct);
-
-                errorMsg.clear();
-                ok = beesAlg->estimateParameters(
-                            bestFitness,EstParameters,
-                            RunNumber,subRunNum,errorMsg);
-                if (! errorMsg.empty()) {
-                    ok = false;
-                    emit ErrorFound(errorMsg);
-                    break;
+            // Each repetition reports its best bee to an aggregator. Bees_Engine's repetitions
+            // run concurrently. They share the sub-run's evaluation context, which is built and
+            // verified once, and each has its own engine, random number streams and progress channel.
+            Aggregator = std::make_unique<Bees_RepetitionAggregator>(int(ParameterRanges.size()));
+            if (m_UseBeesEngine) {
+                RunContext = std::make_shared<const Bees_RunContext>(beeStruct,(beeStruct.isMohnsRho) ? run : 0);
+            }
+            RepetitionErrors.assign(NumRepetitions,"");
+            NumEvaluations = 0;
+            auto runRepetition = [&](const int& subRunNum) {
+                // Don't start another repetition if the user has stopped the run
+                if (wasStoppedByUser()) {
+                    return;
+                }
+
+                bool repetitionOK;
+                double repetitionFitness;
+                std::vector<double> repetitionParameters;
+                if (m_UseBeesEngine) {
+                    std::shared_ptr<nmfProgressChannel> Progress = nmfProgressTelemetry::instance().openChannel();
+                    Bees_Engine beesEngine(beeStruct,RunContext);
+                    beesEngine.setThreadPool(ThreadPool);
+                    beesEngine.setCancellationToken(m_CancellationToken);
+                    beesEngine.setProgressChannel(Progress,RunNumber,subRunNum);
+                    repetitionOK = beesEngine.estimateParameters(
+                                Seed,multiRun,run*NumRepetitions+subRunNum,
+                                repetitionFitness,repetitionParameters,RepetitionErrors[subRunNum-1]);
+                    Progress->close();
+                    NumEvaluations += beesEngine.getNumEvaluations();
+                } else {
+                    int repetitionNum = subRunNum;
+                    beesAlg = std::make_unique<BeesAlgorithm>(beeStruct,nmfConstantsMSSPM::VerboseOn);
+                    beesAlg->initializeParameterRangesAndPatchSizes(beeStruct);
+                    repetitionOK = beesAlg->estimateParameters(
+                                repetitionFitness,repetitionParameters,
+                                RunNumber,repetitionNum,RepetitionErrors[subRunNum-1]);
+                    repetitionOK = repetitionOK && RepetitionErrors[subRunNum-1].empty();
                 }
-                if (ok) {
-                    msg = "Run " + std::to_string(subRunNum);
-                    printBee(msg,bestFitness,EstParameters);
-                    beesStats->addData(bestFitness,EstParameters);
-                    if (bestFitness < lastBestFitness) {
-                        lastBestFitness = bestFitness;
-                        lastBestParameters = EstParameters;
+                if (! repetitionOK) {
+                    return;
+                }
+
+                int numCompleted = Aggregator->addRepetition(subRunNum,repetitionFitness,repetitionParameters);
+                {
+                    std::lock_guard<std::mutex> lock(PrintMutex);
+                    printBee("Run " + std::to_string(subRunNum),repetitionFitness,repetitionParameters);
+                }
+
+                // The progress boxes count the repetitions completed so far, whatever order they
+                // finish in. An ensemble's boxes count its members instead.
+                if (m_Ensemble) {
+                    return;
+                }
+                std::unique_ptr<nmfEstimationResult> Result = std::make_unique<nmfEstimationResult>();
+                Result->Type         = nmfEstimationResult::RepetitionCompleted;
+                Result->RunNumber    = RunNumber;
+                Result->SubRunNumber = numCompleted;
+                Result->NumRuns      = NumRepetitions;
+                pushResult(std::move(Result));
+            };
+
+            // The library's repetitions run one at a time on this thread, as it isn't known
+            // to be reentrant, and stop at the first one that fails. Bees_Engine's first
+            // repetition runs on this thread. A thread that blocks waiting on the pool (this
+            // one, or a repetition waiting on its generation's bees) gives its place in the
+            // pool up while it waits, so the repetitions and their bees can share the pool
+            // without running it out of threads.
+            std::vector<QFuture<void> > futures;
+            if (! m_UseBeesEngine) {
+                for (int subRunNum=1; subRunNum<=NumRepetitions; ++subRunNum) {
+                    runRepetition(subRunNum);
+                    if (! RepetitionErrors[subRunNum-1].empty()) {
+                        break;
                     }
-                    emit RepetitionRunCompleted(RunNumber,subRunNum,NumRepetitions);
                 }
-                // Added a delay to give Qt enough time to finish drawing this run's curve.
-                QThread::usleep((unsigned long)(usecDelay));
+            } else {
+                for (int subRunNum=2; subRunNum<=NumRepetitions; ++subRunNum) {
+                    futures.push_back(QtConcurrent::run(ThreadPool,runRepetition,subRunNum));
+                }
+                if (NumRepetitions > 0) {
+                    runRepetition(1);
+                }
+            }
+            if (! futures.empty()) {
+                ThreadPool->releaseThread();
+                for (QFuture<void>& future : futures) {
+                    future.waitForFinished();
+                }
+                ThreadPool->reserveThread();
+            }
 
-                // Break out if user has stopped the run
-                if (wasStoppedByUser()) {
-                    std::cout << "Bees_Estimator StoppedByUser" << std::endl;
+            ok = Aggregator->getBest(bestFitness,EstParameters);
+            for (const std::string& repetitionError : RepetitionErrors) {
+                if (! repetitionError.empty()) {
                     ok = false;
+                    emit ErrorFound(repetitionError);
                     break;
                 }
             }
+            if (wasStoppedByUser()) {
+                std::cout << "Bees_Estimator StoppedByUser" << std::endl;
+                ok = false;
+            }
 
             if (ok) {
-                // Use the last best data and get some statistics
-                bestFitness   = lastBestFitness;
-                EstParameters = lastBestParameters;
-                beesStats->getMean(MeanFitness,MeanEstParameters);
-                beesStats->getStdDev(fitnessStdDev,totStdDev,stdDevParameters);
+                // Use the best bee of all the repetitions and get some statistics
+                Aggregator->getStatistics(MeanFitness,MeanEstParameters,
+                                          fitnessStdDev,totStdDev,stdDevParameters);
 
                 // Extract the parameters and place them into their respective data structures.
-                beesAlg->extractInitBiomass(EstParameters,startPos,
-                                            m_EstInitBiomass);
-                beesAlg->extractGrowthParameters(EstParameters,startPos,
-                                                 m_EstGrowthRates,
-                                                 m_EstCarryingCapacities,
-                                                 m_EstSystemCarryingCapacity);
-                beesAlg->extractHarvestParameters(EstParameters,startPos,m_EstCatchability);
-                beesAlg->extractCompetitionParameters(EstParameters,startPos,
-                                                      m_EstAlpha,
-                                                      m_EstBetaSpecies,
-                                                      m_EstBetaGuilds,
-                                                      m_EstBetaGuildsGuilds);
-
-                beesAlg->extractPredationParameters(EstParameters,startPos,m_EstPredation);
-                beesAlg->extractHandlingParameters(EstParameters,startPos,m_EstHandling);
-                beesAlg->extractExponentParameters(EstParameters,startPos,m_EstExponent);
-                beesAlg->extractSurveyQParameters(EstParameters,startPos,m_EstSurveyQ);
-                numEstParameters   = beesAlg->calculateActualNumEstParameters();
+                // The engine's parameters are laid out the way NLopt's are.
+                if (! m_UseBeesEngine) {
+                    NMF_INSTRUMENT_SCOPE(nmfPhaseParameterExtraction);
+                    startPos = 0;
+                    beesAlg->extractInitBiomass(EstParameters,startPos,
+                                                m_EstInitBiomass);
+                    beesAlg->extractGrowthParameters(EstParameters,startPos,
+                                                     m_EstGrowthRates,
+                                                     m_EstCarryingCapacities,
+                                                     m_EstSystemCarryingCapacity);
+                    beesAlg->extractHarvestParameters(EstParameters,startPos,m_EstCatchability);
+                    beesAlg->extractCompetitionParameters(EstParameters,startPos,
+                                                          m_EstAlpha,
+                                                          m_EstBetaSpecies,
+                                                          m_EstBetaGuilds,
+                                                          m_EstBetaGuildsGuilds);
+                    beesAlg->extractPredationParameters(EstParameters,startPos,m_EstPredation);
+                    beesAlg->extractHandlingParameters(EstParameters,startPos,m_EstHandling);
+                    beesAlg->extractExponentParameters(EstParameters,startPos,m_EstExponent);
+                    beesAlg->extractSurveyQParameters(EstParameters,startPos,m_EstSurveyQ);
+                    numEstParameters = beesAlg->calculateActualNumEstParameters();
+                } else {
+                    NMF_INSTRUMENT_SCOPE(nmfPhaseParameterExtraction);
+                    NLopt_Estimator::extractParameters(beeStruct,EstParameters.data(),
+                                                       m_EstInitBiomass,
+                                                       m_EstGrowthRates,
+                                                       m_EstCarryingCapacities,
+                                                       m_EstCatchability,
+                                                       m_EstAlpha,
+                                                       m_EstBetaSpecies,
+                                                       m_EstBetaGuilds,
+                                                       m_EstBetaGuildsGuilds,
+                                                       m_EstPredation,
+                                                       m_EstHandling,
+                                                       m_EstExponent,
+                                                       m_EstSurveyQ);
+                    m_EstSystemCarryingCapacity = 0;
+                    for (const double& carryingCapacity : m_EstCarryingCapacities) {
+                        m_EstSystemCarryingCapacity += carryingCapacity;
+                    }
+                    numEstParameters = 0;
+                    for (const std::pair<double,double>& range : ParameterRanges) {
+                        numEstParameters += (range.first != range.second) ? 1 : 0;
+                    }
+                }
                 numTotalParameters = EstParameters.size();
                 createOutputStr(numEstParameters,numTotalParameters,NumRepetitions,
                                 bestFitness,fitnessStdDev,beeStruct,bestFitnessStr);
-                emit RunCompleted(bestFitnessStr,beeStruct.showDiagnosticChart);
 
+                // Each of a multi-run's sub-runs is a member of its ensemble and is
+                // reported as soon as it's done, rather than once its line is done
+                if (isAMultiRun) {
+                    pushSubRunCompleted(RunNumber++,TotalIndividualRuns,
+                                        bestFitness,NumEvaluations,beeStruct);
+                }
             }
 
         } // end for run
 
-        if (isAMultiRun) {
-            emit SubRunCompleted(RunNumber++,
-                                 TotalIndividualRuns,
-                                 beeStruct.EstimationAlgorithm,
-                                 beeStruct.MinimizerAlgorithm,
-                                 beeStruct.ObjectiveCriterion,
-                                 beeStruct.ScalingAlgorithm,
-                                 beeStruct.MultiRunModelFilename,
-                                 bestFitness);
-        } else {
-            emit RunCompleted(bestFitnessStr,beeStruct.showDiagnosticChart);
+        if (! isAMultiRun) {
+            pushRunCompleted(bestFitness,bestFitnessStr,beeStruct);
         }
 
     } // end for multiRun
 
-    if (isAMultiRun && foundOneBeesRun) {
-        emit AllSubRunsCompleted(beeStruct.MultiRunSpeciesFilename,
-                                 beeStruct.MultiRunModelFilename);
+    if (isAMultiRun && foundOneBeesRun && ! m_Ensemble) {
+        std::unique_ptr<nmfEstimationResult> Result = std::make_unique<nmfEstimationResult>();
+        Result->Type                    = nmfEstimationResult::AllSubRunsCompleted;
+        Result->MultiRunSpeciesFilename = beeStruct.MultiRunSpeciesFilename;
+        Result->MultiRunModelFilename   = beeStruct.MultiRunModelFilename;
+        pushResult(std::move(Result));
     }
 
 
@@ -219,20 +448,16 @@ std::cout << "subRunNum: " << subRunNum << std::endl;
 
 
 //    stopRun(elapsedTimeStr,bestFitnessStr);
+    if (! m_Ensemble) {
+        m_CancellationToken->finish();
+    }
 }
 
 
 bool
 Bees_Estimator::wasStoppedByUser()
 {
-    std::string cmd;
-    std::ifstream inputFile(nmfConstantsMSSPM::MSSPMStopRunFile);
-    if (inputFile) {
-        std::getline(inputFile,cmd);
-    }
-    inputFile.close();
-
-    return (cmd == "StoppedByUser");
+    return m_CancellationToken->isCancelled();
 }
 
 void
@@ -30,7 +30,7 @@
 
 #pragma once
 
-#include "boost/random.hpp"
+#include <boost/numeric/ublas/matrix.hpp>
 
 #include <cmath>
 #include <fstream>
@@ -41,10 +41,14 @@
 #include "nmfConstantsMSSPM.h"
 #include "nmfUtils.h"
 #include "nmfUtilsQt.h"
-//#include "nmfRandom.h"
+#include "nmfRandom.h"
 
 #include "BeesAlgorithm.h"
+#include "Bees_Engine.h"
+#include "Bees_RepetitionAggregator.h"
 #include "BeesStats.h"
+#include "nmfCancellationToken.h"
+#include "nmfEstimationResult.h"
 
 #include <QDateTime>
 #include <QFile>
@@ -52,12 +56,9 @@
 #include <QString>
 #include <QTextStream>
 #include <QThread>
+#include <QThreadPool>
 #include <thread>
 
-typedef boost::uniform_real<> NumberDistribution;
-typedef boost::mt19937 RandomNumberGenerator;
-typedef boost::variate_generator<RandomNumberGenerator&,NumberDistribution> Generator;
-
 /**
  * @brief This class acts as an interface class to the Bees algorithm implementation.
  */
@@ -82,6 +83,11 @@ private:
     boost::numeric::ublas::matrix<double> m_EstBetaGuildsGuilds;
     boost::numeric::ublas::matrix<double> m_EstPredation;
     boost::numeric::ublas::matrix<double> m_EstHandling;
+    std::shared_ptr<nmfCancellationToken> m_CancellationToken;
+    std::shared_ptr<nmfEstimationResultQueue> m_ResultQueue;
+    std::shared_ptr<nmfEstimationEnsemble> m_Ensemble;
+    QThreadPool*                          m_ThreadPool;
+    bool                                  m_UseBeesEngine;
 
     void createOutputStr(const int&         numEstParameters,
                          const int&         numTotalParameters,
@@ -96,6 +102,15 @@ private:
     std::string convertValues2DToOutputStr(const std::string& label,
                                            const boost::numeric::ublas::matrix<double>& valuesMatrix);
     void outputProgressData(std::string msg);
+    void pushResult(std::unique_ptr<nmfEstimationResult> Result);
+    void pushRunCompleted(const double& bestFitness,
+                          const std::string& bestFitnessStr,
+                          const nmfStructsQt::ModelDataStruct& beeStruct);
+    void pushSubRunCompleted(const int& RunNumber,
+                             const int& TotalIndividualRuns,
+                             const double& bestFitness,
+                             const long& numEvaluations,
+                             const nmfStructsQt::ModelDataStruct& beeStruct);
     void printBee(std::string msg,
                   double &fitness,
                   std::vector<double> &parameters);
@@ -104,13 +119,6 @@ private:
     bool wasStoppedByUser();
 
 signals:
-    /**
-     * @brief Signal emitted at the end of a multi-run set of runs
-     * @param multiRunSpeciesFilename : name of Multi-Run Species File
-     * @param multiRunModelFilename : name of Multi-Run Model File
-     */
-    void AllSubRunsCompleted(std::string multiRunSpeciesFilename,
-                             std::string multiRunModelFilename);
     /**
      * @brief Signal emitted to update the calling program of an error in the Bees algorithm
      * @param errorMsg : string value the error message from the Bees algorithm
@@ -124,39 +132,9 @@ signals:
     void InitializeSubRuns(std::string multiRunModelFilename,
                            int totalIndividualRuns);
     /**
-     * @brief Signal emitted with the Run has completed
-     * @param bestFitness : string value representing the best fitness value
-     * @param showDiagnosticsChart : boolean signfying whether the
-     * diagnostic 3d chart should be displayed after the run completes
-     */
-    void RunCompleted(std::string bestFitness,
-                      bool showDiagnosticsChart);
-    /**
-     * @brief Signal emitted when NLopt Estimation sub run of a multi run has completed
-     * @param run : current run
-     * @param numRuns : total number of runs in multi run
-     * @param EstimationAlgorithm : name of estimation algorithm
-     * @param MinimizerAlgorithm : name of the minimizer algorithm
-     * @param ObjectiveCriterion : name of the objective criterion
-     * @param ScalingAlgorithm : name of the scaling algorithm
-     * @param multiRunModelFilename : name of file that will contain the model data from all of the multi runs
-     * @param fitness : fitness value of current run
-     */
-    void SubRunCompleted(int run,
-                         int numRuns,
-                         std::string EstimationAlgorithm,
-                         std::string MinimizerAlgorithm,
-                         std::string ObjectiveCriterion,
-                         std::string ScalingAlgorithm,
-                         std::string multiRunModelFilename,
-                         double fitness);
-    /**
-     * @brief Signal emitted when a repetition run is completed
-     * @param RunNum : the number of the parent run
-     * @param SubRun : the number of the child sub run
-     * @param NumSubRuns : number of sub runs in the parent run
-     */
-    void RepetitionRunCompleted(int RunNum, int SubRun, int NumSubRuns);
+     * @brief Signal emitted after a result has been pushed onto the result queue
+     */
+    void ResultsAvailable();
 //  void UpdateProgressData(int NumSpecies, int NumParams, QString elapsedTime);
 
 public:
@@ -166,6 +144,41 @@ public:
     Bees_Estimator();
    ~Bees_Estimator();
 
+    /**
+     * @brief Sets the token that stops this estimator's run. The caller keeps it and
+     * cancels it from any thread; the estimator calls finish() on it once it's done.
+     * @param CancellationToken : the run's cancellation token
+     */
+    void setCancellationToken(std::shared_ptr<nmfCancellationToken> CancellationToken);
+    /**
+     * @brief Sets the queue the estimator pushes its results onto. Pushing waits while the
+     * queue is full, so the estimator runs at most the queue's capacity ahead of the consumer.
+     * Without a queue no results are reported.
+     * @param ResultQueue : the run's result queue
+     */
+    void setResultQueue(std::shared_ptr<nmfEstimationResultQueue> ResultQueue);
+    /**
+     * @brief Makes the estimator one of several running the members of a multi-run
+     * together. Its sub-runs are numbered by the ensemble, their repetitions aren't
+     * reported, and pushing the AllSubRunsCompleted result and finishing the
+     * cancellation token are left to whoever runs the ensemble.
+     * @param Ensemble : the multi-run's member numbering
+     */
+    void setEnsemble(std::shared_ptr<nmfEstimationEnsemble> Ensemble);
+    /**
+     * @brief Runs the Bees_Engine repetitions and their bees on the given pool rather than
+     * on one of the estimator's own
+     * @param ThreadPool : the pool (not owned)
+     */
+    void setThreadPool(QThreadPool* ThreadPool);
+    /**
+     * @brief Runs the repetitions with Bees_Engine, which evaluates them and their bees in
+     * parallel, rather than with the BeesAlgorithm library, which runs them one at a time.
+     * The two don't search the same way, so their results differ. The default is the library.
+     * @param UseBeesEngine : true to use Bees_Engine
+     */
+    void setUseBeesEngine(const bool& UseBeesEngine);
+
     /**
      * @brief The main routine that runs the Bees Estimation algorithm
      * @param BeeStruct : data structure containing parameters needed for the Bees algorithm
@@ -0,0 +1,67 @@
+
+#include "Bees_RepetitionAggregator.h"
+
+
+Bees_RepetitionAggregator::Bees_RepetitionAggregator(const int& NumParameters)
+    : m_Stats(NumParameters)
+{
+    m_NumCompleted   = 0;
+    m_BestRepetition = 0;
+    m_BestFitness    = 0;
+    m_BestParameters.clear();
+}
+
+int
+Bees_RepetitionAggregator::addRepetition(const int& Repetition,
+                                         const double& Fitness,
+                                         const std::vector<double>& Parameters)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    m_Stats.addData(Fitness,Parameters);
+    if ((m_NumCompleted == 0) ||
+        (Fitness < m_BestFitness) ||
+        ((Fitness == m_BestFitness) && (Repetition < m_BestRepetition))) {
+        m_BestRepetition = Repetition;
+        m_BestFitness    = Fitness;
+        m_BestParameters = Parameters;
+    }
+
+    return ++m_NumCompleted;
+}
+
+bool
+Bees_RepetitionAggregator::getBest(double& Fitness,
+                                   std::vector<double>& Parameters) const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    if (m_NumCompleted == 0) {
+        return false;
+    }
+    Fitness    = m_BestFitness;
+    Parameters = m_BestParameters;
+
+    return true;
+}
+
+void
+Bees_RepetitionAggregator::getStatistics(double& MeanFitness,
+                                         std::vector<double>& MeanParameters,
+                                         double& FitnessStdDev,
+                                         double& TotStdDev,
+                                         std::vector<double>& StdDevParameters)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    m_Stats.getMean(MeanFitness,MeanParameters);
+    m_Stats.getStdDev(FitnessStdDev,TotStdDev,StdDevParameters);
+}
+
+int
+Bees_RepetitionAggregator::getNumCompleted() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    return m_NumCompleted;
+}
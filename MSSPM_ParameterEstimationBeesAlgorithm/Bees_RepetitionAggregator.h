@@ -0,0 +1,98 @@
+/**
+ * @file Bees_RepetitionAggregator.h
+ * @brief Class definition for the Bees_RepetitionAggregator
+ *
+ * This file contains the class definition for Bees_RepetitionAggregator, which
+ * collects the results of the repetitions of a Bees Algorithm run. The
+ * repetitions run concurrently and each reports its best bee as soon as it
+ * finishes, so the aggregator keeps the run's best bee and its statistics
+ * behind a mutex. When two repetitions find the same fitness the lower
+ * numbered one is kept, as if they had run one after another.
+ *
+ * @copyright
+ * Public Domain Notice\n
+ *
+ * National Oceanic And Atmospheric Administration\n\n
+ *
+ * This software is a "United States Government Work" under the terms of the
+ * United States Copyright Act.  It was written as part of the author's official
+ * duties as a United States Government employee/contractor and thus cannot be copyrighted.
+ * This software is freely available to the public for use. The National Oceanic
+ * And Atmospheric Administration and the U.S. Government have not placed any
+ * restriction on its use or reproduction.  Although all reasonable efforts have
+ * been taken to ensure the accuracy and reliability of the software and data,
+ * the National Oceanic And Atmospheric Administration and the U.S. Government
+ * do not and cannot warrant the performance or results that may be obtained
+ * by using this software or data. The National Oceanic And Atmospheric
+ * Administration and the U.S. Government disclaim all warranties, express
+ * or implied, including warranties of performance, merchantability or fitness
+ * for any particular purpose.\n\n
+ *
+ * Please cite the author(s) in any work or product based on this material.
+ */
+
+#pragma once
+
+#include "BeesStats.h"
+
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Thread-safe collector of the best bee and statistics of a run's repetitions
+ */
+class Bees_RepetitionAggregator
+{
+private:
+    mutable std::mutex  m_Mutex;
+    int                 m_NumCompleted;
+    int                 m_BestRepetition;
+    double              m_BestFitness;
+    std::vector<double> m_BestParameters;
+    BeesStats           m_Stats;
+
+public:
+    /**
+     * @brief Class constructor
+     * @param NumParameters : number of parameters of every repetition's bee
+     */
+    Bees_RepetitionAggregator(const int& NumParameters);
+   ~Bees_RepetitionAggregator() {}
+
+    /**
+     * @brief Adds a finished repetition's best bee (safe to call from any thread)
+     * @param Repetition : the repetition number
+     * @param Fitness : fitness of the repetition's best bee
+     * @param Parameters : parameters of the repetition's best bee
+     * @return Returns the number of repetitions completed so far, including this one
+     */
+    int addRepetition(const int& Repetition,
+                      const double& Fitness,
+                      const std::vector<double>& Parameters);
+    /**
+     * @brief Gets the best bee of the repetitions completed so far
+     * @param Fitness : fitness of the best bee
+     * @param Parameters : parameters of the best bee
+     * @return Returns false if no repetition has completed
+     */
+    bool getBest(double& Fitness,
+                 std::vector<double>& Parameters) const;
+    /**
+     * @brief Gets the mean and standard deviation of the completed repetitions' bees.
+     * They're taken over the repetitions that completed, not the ones requested.
+     * @param MeanFitness : mean fitness
+     * @param MeanParameters : mean of each parameter
+     * @param FitnessStdDev : fitness standard deviation
+     * @param TotStdDev : mean of the parameters' standard deviations
+     * @param StdDevParameters : standard deviation of each parameter
+     */
+    void getStatistics(double& MeanFitness,
+                       std::vector<double>& MeanParameters,
+                       double& FitnessStdDev,
+                       double& TotStdDev,
+                       std::vector<double>& StdDevParameters);
+    /**
+     * @brief Number of repetitions completed so far
+     */
+    int getNumCompleted() const;
+};
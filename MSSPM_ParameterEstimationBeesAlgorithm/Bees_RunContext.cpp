@@ -0,0 +1,83 @@
+
+#include "Bees_RunContext.h"
+
+
+Bees_RunContext::Bees_RunContext(const nmfStructsQt::ModelDataStruct& BeeStruct,
+                                 const int& MohnsRhoOffset) :
+    m_GrowthForm(BeeStruct.GrowthForm),
+    m_HarvestForm(BeeStruct.HarvestForm),
+    m_CompetitionForm(BeeStruct.CompetitionForm),
+    m_PredationForm(BeeStruct.PredationForm)
+{
+    std::vector<double> middle;
+
+    m_Verified = std::make_unique<Bees_TaskContext>();
+    m_Verified->GrowthForm      = std::make_unique<nmfGrowthForm>(     m_GrowthForm);
+    m_Verified->HarvestForm     = std::make_unique<nmfHarvestForm>(    m_HarvestForm);
+    m_Verified->CompetitionForm = std::make_unique<nmfCompetitionForm>(m_CompetitionForm);
+    m_Verified->PredationForm   = std::make_unique<nmfPredationForm>(  m_PredationForm);
+    NLopt_Estimator::initializeEvaluationContext(BeeStruct,MohnsRhoOffset,
+                                                 m_Verified->GrowthForm.get(),m_Verified->HarvestForm.get(),
+                                                 m_Verified->CompetitionForm.get(),m_Verified->PredationForm.get(),
+                                                 m_Verified->Context);
+    NLopt_Estimator::loadParameterRanges(m_ParameterRanges,BeeStruct);
+    m_Verified->Context.Layout.initializePatterns(m_ParameterRanges);
+
+    for (const std::pair<double,double>& range : m_ParameterRanges) {
+        middle.push_back(range.first + (range.second-range.first)/2.0);
+    }
+    NLopt_Estimator::verifyKernels(m_Verified->Context,middle);
+}
+
+std::unique_ptr<Bees_TaskContext>
+Bees_RunContext::createTaskContext() const
+{
+    std::unique_ptr<Bees_TaskContext> task = std::make_unique<Bees_TaskContext>();
+
+    task->GrowthForm      = std::make_unique<nmfGrowthForm>(     m_GrowthForm);
+    task->HarvestForm     = std::make_unique<nmfHarvestForm>(    m_HarvestForm);
+    task->CompetitionForm = std::make_unique<nmfCompetitionForm>(m_CompetitionForm);
+    task->PredationForm   = std::make_unique<nmfPredationForm>(  m_PredationForm);
+    task->Context                 = m_Verified->Context;
+    task->Context.GrowthForm      = task->GrowthForm.get();
+    task->Context.HarvestForm     = task->HarvestForm.get();
+    task->Context.CompetitionForm = task->CompetitionForm.get();
+    task->Context.PredationForm   = task->PredationForm.get();
+
+    return task;
+}
+
+const NLopt_EvaluationContext&
+Bees_RunContext::getContext() const
+{
+    return m_Verified->Context;
+}
+
+const std::vector<std::pair<double,double> >&
+Bees_RunContext::getParameterRanges() const
+{
+    return m_ParameterRanges;
+}
+
+std::unique_ptr<Bees_TaskContext>
+Bees_RunContext::acquireTaskContext() const
+{
+    std::unique_ptr<Bees_TaskContext> task;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (! m_FreeTaskContexts.empty()) {
+            task = std::move(m_FreeTaskContexts.back());
+            m_FreeTaskContexts.pop_back();
+        }
+    }
+
+    // Copying the verified context is left outside the lock, so tasks don't wait on each other's copies
+    return (task) ? std::move(task) : createTaskContext();
+}
+
+void
+Bees_RunContext::releaseTaskContext(std::unique_ptr<Bees_TaskContext> TaskContext) const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_FreeTaskContexts.push_back(std::move(TaskContext));
+}
@@ -0,0 +1,105 @@
+/**
+ * @file Bees_RunContext.h
+ * @brief Class definition for the Bees_RunContext
+ *
+ * This file contains the class definition for Bees_RunContext, which holds what
+ * the Bees_Engine repetitions of a sub-run share: the parameter ranges and the
+ * NLopt evaluation context for the model, built and verified once. The model form
+ * objects an evaluation context points at aren't safe to share between threads,
+ * so each evaluation task borrows a context of its own, a copy of the verified one
+ * with its own form objects. The copies are kept for the next task to borrow.
+ *
+ * @copyright
+ * Public Domain Notice\n
+ *
+ * National Oceanic And Atmospheric Administration\n\n
+ *
+ * This software is a "United States Government Work" under the terms of the
+ * United States Copyright Act.  It was written as part of the author's official
+ * duties as a United States Government employee/contractor and thus cannot be copyrighted.
+ * This software is freely available to the public for use. The National Oceanic
+ * And Atmospheric Administration and the U.S. Government have not placed any
+ * restriction on its use or reproduction.  Although all reasonable efforts have
+ * been taken to ensure the accuracy and reliability of the software and data,
+ * the National Oceanic And Atmospheric Administration and the U.S. Government
+ * do not and cannot warrant the performance or results that may be obtained
+ * by using this software or data. The National Oceanic And Atmospheric
+ * Administration and the U.S. Government disclaim all warranties, express
+ * or implied, including warranties of performance, merchantability or fitness
+ * for any particular purpose.\n\n
+ *
+ * Please cite the author(s) in any work or product based on this material.
+ */
+
+#pragma once
+
+#include "NLopt_Estimator.h"
+#include "nmfStructsQt.h"
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Model form objects and an evaluation context that points at them
+ */
+struct Bees_TaskContext {
+    std::unique_ptr<nmfGrowthForm>      GrowthForm;
+    std::unique_ptr<nmfHarvestForm>     HarvestForm;
+    std::unique_ptr<nmfCompetitionForm> CompetitionForm;
+    std::unique_ptr<nmfPredationForm>   PredationForm;
+    NLopt_EvaluationContext             Context;
+};
+
+/**
+ * @brief The evaluation context and parameter ranges shared by a sub-run's repetitions
+ */
+class Bees_RunContext
+{
+private:
+    std::string m_GrowthForm;
+    std::string m_HarvestForm;
+    std::string m_CompetitionForm;
+    std::string m_PredationForm;
+    std::vector<std::pair<double,double> > m_ParameterRanges;
+    std::unique_ptr<Bees_TaskContext>      m_Verified;
+    mutable std::mutex                     m_Mutex;
+    /**
+     * @brief Task contexts returned by the tasks that borrowed them
+     */
+    mutable std::vector<std::unique_ptr<Bees_TaskContext> > m_FreeTaskContexts;
+
+    std::unique_ptr<Bees_TaskContext> createTaskContext() const;
+
+public:
+    /**
+     * @brief Class constructor. Builds the evaluation context for the model and verifies
+     * its kernels on the middle of the parameter ranges.
+     * @param BeeStruct : the model
+     * @param MohnsRhoOffset : number of years peeled off of the end of the run
+     */
+    Bees_RunContext(const nmfStructsQt::ModelDataStruct& BeeStruct,
+                    const int& MohnsRhoOffset);
+   ~Bees_RunContext() {}
+
+    /**
+     * @brief The verified evaluation context; its form objects mustn't be used to evaluate
+     */
+    const NLopt_EvaluationContext& getContext() const;
+    /**
+     * @brief The range of each parameter, in NLopt_ParameterLayout order
+     */
+    const std::vector<std::pair<double,double> >& getParameterRanges() const;
+    /**
+     * @brief Lends an evaluation task a context of its own (safe to call from any thread)
+     * @return Returns a kept context, or a new copy of the verified one if none is free
+     */
+    std::unique_ptr<Bees_TaskContext> acquireTaskContext() const;
+    /**
+     * @brief Keeps a context the task is done with for the next task (safe to call from any thread)
+     * @param TaskContext : context returned by acquireTaskContext
+     */
+    void releaseTaskContext(std::unique_ptr<Bees_TaskContext> TaskContext) const;
+};
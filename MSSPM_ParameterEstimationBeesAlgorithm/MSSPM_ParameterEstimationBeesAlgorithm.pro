@@ -5,7 +5,7 @@
 #-------------------------------------------------
 
 QT       -= gui
-QT      += widgets charts
+QT      += widgets charts concurrent
 
 TARGET = MSSPM_ParameterEstimationBeesAlgorithm
 TEMPLATE = lib
@@ -14,6 +14,9 @@ CONFIG += c++14
 
 INCLUDEPATH += "/Users/satouhiroshiki/boost/boost_1_76_0/"
 
+INCLUDEPATH += $$PWD/../MSSPM_Common
+DEPENDPATH += $$PWD/../MSSPM_Common
+
 DEFINES += MSSPM_PARAMETERESTIMATIONBEESALGORITHM_LIBRARY
 
 # The following define makes your compiler emit warnings if you use
@@ -22,17 +25,26 @@ DEFINES += MSSPM_PARAMETERESTIMATIONBEESALGORITHM_LIBRARY
 # deprecated API in order to know how to port your code away from it.
 DEFINES += QT_DEPRECATED_WARNINGS
 
+# Build with qmake CONFIG+=instrumentation to time the estimation phases (see nmfInstrumentation.h)
+CONFIG(instrumentation): DEFINES += MSSPM_INSTRUMENTATION
+
 # You can also make your code fail to compile if you use deprecated APIs.
 # In order to do so, uncomment the following line.
 # You can also select to disable deprecated APIs only up to a certain version of Qt.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+    Bees_Engine.cpp \
     Bees_Estimator.cpp \
+    Bees_RepetitionAggregator.cpp \
+    Bees_RunContext.cpp \
     BeesStats.cpp
 
 HEADERS += \
+    Bees_Engine.h \
     Bees_Estimator.h \
+    Bees_RepetitionAggregator.h \
+    Bees_RunContext.h \
     BeesStats.h \
     mainpage.h
 
@@ -49,6 +61,20 @@ else:unix: LIBS += -L$$PWD/../../../../builds/build-BeesAlgorithm-Desktop_Qt_5_1
 INCLUDEPATH += $$PWD/../../nmfSharedUtilities/BeesAlgorithm
 DEPENDPATH += $$PWD/../../nmfSharedUtilities/BeesAlgorithm
 
+win32:CONFIG(release, debug|release): LIBS += -L$$PWD/../../../builds/build-MSSPM_ParameterEstimationNLoptAlgorithm-Desktop_Qt_5_15_2_clang_64bit-Release/release/ -lMSSPM_ParameterEstimationNLoptAlgorithm.1.0.0
+else:win32:CONFIG(debug, debug|release): LIBS += -L$$PWD/../../../builds/build-MSSPM_ParameterEstimationNLoptAlgorithm-Desktop_Qt_5_15_2_clang_64bit-Release/debug/ -lMSSPM_ParameterEstimationNLoptAlgorithm.1.0.0
+else:unix: LIBS += -L$$PWD/../../../builds/build-MSSPM_ParameterEstimationNLoptAlgorithm-Desktop_Qt_5_15_2_clang_64bit-Release/ -lMSSPM_ParameterEstimationNLoptAlgorithm.1.0.0
+
+INCLUDEPATH += $$PWD/../MSSPM_ParameterEstimationNLoptAlgorithm
+DEPENDPATH += $$PWD/../MSSPM_ParameterEstimationNLoptAlgorithm
+
+win32:CONFIG(release, debug|release): LIBS += -L$$PWD/../../../../../../usr/local/lib/release/ -lnlopt.0.11.0
+else:win32:CONFIG(debug, debug|release): LIBS += -L$$PWD/../../../../../../usr/local/lib/debug/ -lnlopt.0.11.0
+else:unix: LIBS += -L$$PWD/../../../../../../usr/local/lib/ -lnlopt.0.11.0
+
+INCLUDEPATH += $$PWD/../../../../../../usr/local/include
+DEPENDPATH += $$PWD/../../../../../../usr/local/include
+
 
 
 
@@ -5,7 +5,7 @@
 #-------------------------------------------------
 
 QT      -= gui
-QT      += widgets charts
+QT      += widgets charts concurrent
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
 TARGET = MSSPM_ParameterEstimationNLoptAlgorithm
@@ -22,16 +22,48 @@ DEFINES += MSSPM_PARAMETERESTIMATIONNLOPTALGORITHM_LIBRARY
 # deprecated API in order to know how to port your code away from it.
 DEFINES += QT_DEPRECATED_WARNINGS
 
+# Build with qmake CONFIG+=instrumentation to time the estimation phases (see nmfInstrumentation.h)
+CONFIG(instrumentation): DEFINES += MSSPM_INSTRUMENTATION
+
+# Build with qmake CONFIG+=avx2 (or CONFIG+=avx512) so the NLopt_Lanes loops of the batch
+# evaluator are compiled to AVX2 (or AVX-512) instructions. Without either they only get
+# the baseline SSE2. The library then needs a processor with that instruction set.
+CONFIG(avx512) {
+    msvc: QMAKE_CXXFLAGS += /arch:AVX512
+    else: QMAKE_CXXFLAGS += -mavx2 -mfma -mavx512f -mavx512dq -mprefer-vector-width=512
+} else: CONFIG(avx2) {
+    msvc: QMAKE_CXXFLAGS += /arch:AVX2
+    else: QMAKE_CXXFLAGS += -mavx2 -mfma
+}
+
 # You can also make your code fail to compile if you use deprecated APIs.
 # In order to do so, uncomment the following line.
 # You can also select to disable deprecated APIs only up to a certain version of Qt.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
-    NLopt_Estimator.cpp
+    NLopt_Batch.cpp \
+    NLopt_Estimator.cpp \
+    NLopt_Gradient.cpp \
+    NLopt_Kernels.cpp \
+    NLopt_ParameterLayout.cpp \
+    NLopt_ParameterMapping.cpp \
+    NLopt_Workspace.cpp
 
 HEADERS += \
+    NLopt_AutoDiff.h \
+    NLopt_Batch.h \
+    NLopt_EarlyAbandon.h \
     NLopt_Estimator.h \
+    NLopt_EvaluationContext.h \
+    NLopt_GenericKernel.h \
+    NLopt_Gradient.h \
+    NLopt_Kernels.h \
+    NLopt_Lanes.h \
+    NLopt_ParameterLayout.h \
+    NLopt_ParameterMapping.h \
+    NLopt_SubRun.h \
+    NLopt_Workspace.h \
     mainpage.h
 
 #unix {
@@ -44,6 +76,9 @@ else: unix:!android: target.path = /opt/$${TARGET}/bin
 
 INCLUDEPATH += /Users/hiro/Downloads/boost_1_76_0
 
+INCLUDEPATH += $$PWD/../MSSPM_Common
+DEPENDPATH += $$PWD/../MSSPM_Common
+
 
 #INCLUDEPATH += /usr/local/lib
 ##INCLUDEPATH += "/Users/satouhiroshiki/nlopt/build"
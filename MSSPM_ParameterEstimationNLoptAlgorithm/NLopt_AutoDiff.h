@@ -0,0 +1,169 @@
+/**
+ * @file NLopt_AutoDiff.h
+ * @brief Definition of the reverse mode automatic differentiation types
+ *
+ * This file contains the NLopt_Tape and NLopt_ADVar classes. An NLopt_ADVar is a
+ * double that records every operation it takes part in on the calling thread's
+ * active tape. Sweeping the tape backwards from the result gives the gradient of
+ * the result with respect to all of the inputs for roughly the cost of a few
+ * evaluations, regardless of the number of inputs.
+ *
+ * @copyright
+ * Public Domain Notice\n
+ *
+ * National Oceanic And Atmospheric Administration\n\n
+ *
+ * This software is a "United States Government Work" under the terms of the
+ * United States Copyright Act.  It was written as part of the author's official
+ * duties as a United States Government employee/contractor and thus cannot be copyrighted.
+ * This software is freely available to the public for use. The National Oceanic
+ * And Atmospheric Administration and the U.S. Government have not placed any
+ * restriction on its use or reproduction.  Although all reasonable efforts have
+ * been taken to ensure the accuracy and reliability of the software and data,
+ * the National Oceanic And Atmospheric Administration and the U.S. Government
+ * do not and cannot warrant the performance or results that may be obtained
+ * by using this software or data. The National Oceanic And Atmospheric
+ * Administration and the U.S. Government disclaim all warranties, express
+ * or implied, including warranties of performance, merchantability or fitness
+ * for any particular purpose.\n\n
+ *
+ * Please cite the author(s) in any work or product based on this material.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <vector>
+
+/**
+ * @brief Records the operations of an NLopt_ADVar computation and sweeps them backwards
+ */
+class NLopt_Tape
+{
+private:
+    struct Node {
+        int    Parent[2];
+        double Partial[2];
+    };
+    std::vector<Node>   m_Nodes;
+    std::vector<double> m_Adjoints;
+
+public:
+    /**
+     * @brief Removes all recorded operations (storage is kept for the next recording)
+     */
+    void clear() {
+        m_Nodes.clear();
+    }
+    /**
+     * @brief Records a node whose partial derivatives with respect to its parents are given.
+     * A parent index of -1 means the parent is a constant.
+     * @return Returns the index of the new node
+     */
+    int push(const int& Parent0, const double& Partial0,
+             const int& Parent1, const double& Partial1) {
+        m_Nodes.push_back({{Parent0,Parent1},{Partial0,Partial1}});
+        return int(m_Nodes.size())-1;
+    }
+    /**
+     * @brief Sweeps the tape backwards from the output node
+     * @param Output : index of the node to differentiate
+     * @param NumInputs : number of inputs (the first NumInputs nodes recorded)
+     * @param Gradient : the NumInputs derivatives of Output with respect to the inputs
+     */
+    void gradient(const int& Output, const int& NumInputs, double* Gradient) {
+        m_Adjoints.assign(m_Nodes.size(),0.0);
+        if (Output >= 0) {
+            m_Adjoints[Output] = 1.0;
+            for (int i=Output; i>=0; --i) {
+                const double& adjoint = m_Adjoints[i];
+                if (adjoint == 0.0) {
+                    continue;
+                }
+                const Node& node = m_Nodes[i];
+                if (node.Parent[0] >= 0) {
+                    m_Adjoints[node.Parent[0]] += node.Partial[0]*adjoint;
+                }
+                if (node.Parent[1] >= 0) {
+                    m_Adjoints[node.Parent[1]] += node.Partial[1]*adjoint;
+                }
+            }
+        }
+        for (int i=0; i<NumInputs; ++i) {
+            Gradient[i] = (i < int(m_Adjoints.size())) ? m_Adjoints[i] : 0.0;
+        }
+    }
+    /**
+     * @brief The tape NLopt_ADVar operations are recorded on for the calling thread
+     */
+    static NLopt_Tape& active() {
+        thread_local NLopt_Tape tape;
+        return tape;
+    }
+};
+
+/**
+ * @brief A double whose operations are recorded on the active NLopt_Tape
+ */
+struct NLopt_ADVar {
+    double Value;
+    int    Index; // -1 for constants
+
+    NLopt_ADVar(double value = 0.0) : Value(value), Index(-1) {}
+    NLopt_ADVar(double value, int index) : Value(value), Index(index) {}
+
+    /**
+     * @brief Creates a new input variable on the active tape
+     */
+    static NLopt_ADVar input(const double& value) {
+        return NLopt_ADVar(value,NLopt_Tape::active().push(-1,0,-1,0));
+    }
+    static NLopt_ADVar unary(const double& value, const NLopt_ADVar& a, const double& da) {
+        if (a.Index < 0) {
+            return NLopt_ADVar(value);
+        }
+        return NLopt_ADVar(value,NLopt_Tape::active().push(a.Index,da,-1,0));
+    }
+    static NLopt_ADVar binary(const double& value,
+                              const NLopt_ADVar& a, const double& da,
+                              const NLopt_ADVar& b, const double& db) {
+        if ((a.Index < 0) && (b.Index < 0)) {
+            return NLopt_ADVar(value);
+        }
+        return NLopt_ADVar(value,NLopt_Tape::active().push(a.Index,da,b.Index,db));
+    }
+
+    NLopt_ADVar& operator+=(const NLopt_ADVar& b);
+    NLopt_ADVar& operator-=(const NLopt_ADVar& b);
+    NLopt_ADVar& operator*=(const NLopt_ADVar& b);
+    NLopt_ADVar& operator/=(const NLopt_ADVar& b);
+};
+
+inline NLopt_ADVar operator+(const NLopt_ADVar& a, const NLopt_ADVar& b) {
+    return NLopt_ADVar::binary(a.Value+b.Value,a,1.0,b,1.0);
+}
+inline NLopt_ADVar operator-(const NLopt_ADVar& a, const NLopt_ADVar& b) {
+    return NLopt_ADVar::binary(a.Value-b.Value,a,1.0,b,-1.0);
+}
+inline NLopt_ADVar operator-(const NLopt_ADVar& a) {
+    return NLopt_ADVar::unary(-a.Value,a,-1.0);
+}
+inline NLopt_ADVar operator*(const NLopt_ADVar& a, const NLopt_ADVar& b) {
+    return NLopt_ADVar::binary(a.Value*b.Value,a,b.Value,b,a.Value);
+}
+inline NLopt_ADVar operator/(const NLopt_ADVar& a, const NLopt_ADVar& b) {
+    return NLopt_ADVar::binary(a.Value/b.Value,a,1.0/b.Value,b,-a.Value/(b.Value*b.Value));
+}
+inline NLopt_ADVar& NLopt_ADVar::operator+=(const NLopt_ADVar& b) { return *this = *this + b; }
+inline NLopt_ADVar& NLopt_ADVar::operator-=(const NLopt_ADVar& b) { return *this = *this - b; }
+inline NLopt_ADVar& NLopt_ADVar::operator*=(const NLopt_ADVar& b) { return *this = *this * b; }
+inline NLopt_ADVar& NLopt_ADVar::operator/=(const NLopt_ADVar& b) { return *this = *this / b; }
+
+inline bool operator<(const NLopt_ADVar& a, const NLopt_ADVar& b) { return a.Value < b.Value; }
+inline bool operator>(const NLopt_ADVar& a, const NLopt_ADVar& b) { return a.Value > b.Value; }
+
+/**
+ * @brief Value of a scalar used by the generic kernel, so the same code works for double and NLopt_ADVar
+ */
+inline double valueOf(const double& a)      { return a; }
+inline double valueOf(const NLopt_ADVar& a) { return a.Value; }
@@ -0,0 +1,54 @@
+#include "NLopt_Batch.h"
+#include "NLopt_Estimator.h"
+#include "NLopt_GenericKernel.h"
+
+#include <algorithm>
+#include <vector>
+
+
+void
+NLopt_Batch::evaluate(const NLopt_EvaluationContext& Context,
+                      const double*                  Parameters,
+                      const int&                     NumParameters,
+                      const int&                     NumCandidates,
+                      double*                        Fitness)
+{
+    if (! Context.isGenericKernelVerified) {
+        thread_local std::vector<double> Candidate;
+        Candidate.resize(NumParameters);
+        for (int k=0; k<NumCandidates; ++k) {
+            for (int p=0; p<NumParameters; ++p) {
+                Candidate[p] = Parameters[p*NumCandidates+k];
+            }
+            Fitness[k] = NLopt_Estimator::evaluateObjective(Context,Candidate.data());
+        }
+        return;
+    }
+
+    typedef NLopt_Lanes<NumLanes> Lanes;
+    int numInChunk;
+    Lanes fitness;
+    NLopt_LaneMask<NumLanes> isValid;
+    thread_local std::vector<Lanes> LaneParameters;
+    thread_local NLopt_GenericWorkspace<Lanes> Workspace;
+
+    LaneParameters.resize(NumParameters);
+    for (int first=0; first<NumCandidates; first+=NumLanes) {
+        numInChunk = std::min(int(NumLanes),NumCandidates-first);
+
+        // Pad a partial last chunk with copies of its last candidate so the
+        // unused lanes can't produce spurious divisions by zero
+        for (int p=0; p<NumParameters; ++p) {
+            const double* candidates = &Parameters[p*NumCandidates+first];
+            for (int lane=0; lane<NumLanes; ++lane) {
+                LaneParameters[p].v[lane] = candidates[std::min(lane,numInChunk-1)];
+            }
+        }
+
+        fitness = NLopt_GenericKernel::evaluate(Context,LaneParameters.data(),Workspace,isValid);
+
+        for (int lane=0; lane<numInChunk; ++lane) {
+            Fitness[first+lane] = (isValid.v[lane]) ? fitness.v[lane] : 99999;
+        }
+    }
+}
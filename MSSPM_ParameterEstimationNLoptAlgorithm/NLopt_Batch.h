@@ -0,0 +1,64 @@
+/**
+ * @file NLopt_Batch.h
+ * @brief Definition of the batched objective function evaluation
+ *
+ * This file contains the NLopt_Batch class. Population based methods (e.g., the
+ * Bees Algorithm, GN_CRS2_LM, GN_DIRECT_L) and the diagnostic parameter grids
+ * evaluate many independent parameter sets at a time. NLopt_Batch runs the biomass
+ * recursion for NumLanes of them in lock-step with NLopt_Lanes, so that each
+ * arithmetic operation is one vector instruction across the candidates.
+ *
+ * @copyright
+ * Public Domain Notice\n
+ *
+ * National Oceanic And Atmospheric Administration\n\n
+ *
+ * This software is a "United States Government Work" under the terms of the
+ * United States Copyright Act.  It was written as part of the author's official
+ * duties as a United States Government employee/contractor and thus cannot be copyrighted.
+ * This software is freely available to the public for use. The National Oceanic
+ * And Atmospheric Administration and the U.S. Government have not placed any
+ * restriction on its use or reproduction.  Although all reasonable efforts have
+ * been taken to ensure the accuracy and reliability of the software and data,
+ * the National Oceanic And Atmospheric Administration and the U.S. Government
+ * do not and cannot warrant the performance or results that may be obtained
+ * by using this software or data. The National Oceanic And Atmospheric
+ * Administration and the U.S. Government disclaim all warranties, express
+ * or implied, including warranties of performance, merchantability or fitness
+ * for any particular purpose.\n\n
+ *
+ * Please cite the author(s) in any work or product based on this material.
+ */
+
+#pragma once
+
+#include "NLopt_EvaluationContext.h"
+
+/**
+ * @brief Evaluates the fitness of several candidate parameter sets at once
+ */
+class NLopt_Batch
+{
+public:
+    /**
+     * @brief Number of candidates evaluated in lock-step (8 doubles fill an AVX-512 register or two AVX2 registers)
+     */
+    static const int NumLanes = 8;
+
+    /**
+     * @brief Calculates the fitness of each candidate. If the generic kernel hasn't been
+     * verified for the run (see NLopt_Estimator::verifyKernels), the candidates are
+     * evaluated one at a time with NLopt_Estimator::evaluateObjective instead.
+     * @param Context : the evaluation context of the current run
+     * @param Parameters : the candidates in structure-of-arrays layout, i.e. parameter p of
+     * candidate k is Parameters[p*NumCandidates+k]
+     * @param NumParameters : number of estimated parameters per candidate
+     * @param NumCandidates : number of candidates
+     * @param Fitness : the NumCandidates fitness values (99999 if a candidate's biomass became invalid)
+     */
+    static void evaluate(const NLopt_EvaluationContext& Context,
+                         const double*                  Parameters,
+                         const int&                     NumParameters,
+                         const int&                     NumCandidates,
+                         double*                        Fitness);
+};
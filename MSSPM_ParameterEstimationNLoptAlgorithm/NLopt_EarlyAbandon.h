@@ -0,0 +1,130 @@
+/**
+ * @file NLopt_EarlyAbandon.h
+ * @brief Definition of the Least Squares lower bound used to abandon hopeless evaluations
+ *
+ * This file contains the NLopt_EarlyAbandon class. While the biomass recursion runs,
+ * it accumulates enough statistics about the years simulated so far to bound the
+ * final Least Squares fitness from below. Once the bound passes the caller's
+ * incumbent fitness, the evaluation can stop, since it can no longer win.
+ *
+ * The bound holds under both Min Max and Mean scaling. Either one maps a species'
+ * estimated biomass e to a*e+b with a > 0, where a and b depend on years that haven't
+ * been simulated yet. Letting a and b be anything with a >= 0 can only lower the sum
+ * of squares, and that minimum is a least squares line fit of the rescaled observed
+ * biomass on e. The fit's residual only needs running means and co-moments. Years
+ * not simulated yet only add non-negative terms.
+ *
+ * @copyright
+ * Public Domain Notice\n
+ *
+ * National Oceanic And Atmospheric Administration\n\n
+ *
+ * This software is a "United States Government Work" under the terms of the
+ * United States Copyright Act.  It was written as part of the author's official
+ * duties as a United States Government employee/contractor and thus cannot be copyrighted.
+ * This software is freely available to the public for use. The National Oceanic
+ * And Atmospheric Administration and the U.S. Government have not placed any
+ * restriction on its use or reproduction.  Although all reasonable efforts have
+ * been taken to ensure the accuracy and reliability of the software and data,
+ * the National Oceanic And Atmospheric Administration and the U.S. Government
+ * do not and cannot warrant the performance or results that may be obtained
+ * by using this software or data. The National Oceanic And Atmospheric
+ * Administration and the U.S. Government disclaim all warranties, express
+ * or implied, including warranties of performance, merchantability or fitness
+ * for any particular purpose.\n\n
+ *
+ * Please cite the author(s) in any work or product based on this material.
+ */
+
+#pragma once
+
+#include <limits>
+#include <vector>
+
+/**
+ * @brief Running lower bound on the Least Squares fitness of a partially simulated run
+ */
+class NLopt_EarlyAbandon
+{
+private:
+    double m_AbandonAbove = std::numeric_limits<double>::infinity();
+    double m_LowerBound   = 0;
+    bool   m_isActive     = false;
+    bool   m_isAbandoned  = false;
+    std::vector<int>    m_Count;
+    std::vector<double> m_MeanEst;
+    std::vector<double> m_MeanObs;
+    std::vector<double> m_M2Est;  // sum of squared deviations of the estimated biomass
+    std::vector<double> m_M2Obs;  // sum of squared deviations of the rescaled observed biomass
+    std::vector<double> m_CoEstObs;
+
+public:
+    /**
+     * @brief Starts a new evaluation
+     * @param NumSpecies : number of species (or guilds) in the fitness
+     * @param AbandonAbove : the incumbent fitness; infinity turns the bound off
+     */
+    void reset(const int& NumSpecies, const double& AbandonAbove) {
+        m_AbandonAbove = AbandonAbove;
+        m_LowerBound   = 0;
+        m_isAbandoned  = false;
+        m_isActive     = (AbandonAbove < std::numeric_limits<double>::infinity());
+        if (m_isActive) {
+            m_Count.assign(NumSpecies,0);
+            m_MeanEst.assign(NumSpecies,0.0);
+            m_MeanObs.assign(NumSpecies,0.0);
+            m_M2Est.assign(NumSpecies,0.0);
+            m_M2Obs.assign(NumSpecies,0.0);
+            m_CoEstObs.assign(NumSpecies,0.0);
+        }
+    }
+    bool isActive() const {
+        return m_isActive;
+    }
+    /**
+     * @brief Adds one year of one species (Welford's update, to stay accurate for large biomass)
+     * @param Species : species (or guild) index
+     * @param EstBiomass : unscaled estimated biomass
+     * @param ObsBiomassRescaled : rescaled observed biomass
+     */
+    void add(const int& Species, const double& EstBiomass, const double& ObsBiomassRescaled) {
+        int n = ++m_Count[Species];
+        double deltaEst = EstBiomass         - m_MeanEst[Species];
+        double deltaObs = ObsBiomassRescaled - m_MeanObs[Species];
+        m_MeanEst[Species]  += deltaEst/n;
+        m_MeanObs[Species]  += deltaObs/n;
+        m_M2Est[Species]    += deltaEst*(EstBiomass         - m_MeanEst[Species]);
+        m_M2Obs[Species]    += deltaObs*(ObsBiomassRescaled - m_MeanObs[Species]);
+        m_CoEstObs[Species] += deltaEst*(ObsBiomassRescaled - m_MeanObs[Species]);
+    }
+    /**
+     * @brief Checks the bound over all of the years added so far
+     * @return Returns true if the fitness is certain to be worse than the incumbent
+     */
+    bool isWorse() {
+        double bound = 0;
+        for (unsigned species=0; species<m_Count.size(); ++species) {
+            double residual = m_M2Obs[species];
+            if ((m_CoEstObs[species] > 0) && (m_M2Est[species] > 0)) {
+                residual -= m_CoEstObs[species]*m_CoEstObs[species]/m_M2Est[species];
+            }
+            bound += (residual > 0) ? residual : 0;
+        }
+        // Leave a margin for rounding so a fitness equal to the incumbent is never abandoned
+        m_LowerBound  = bound;
+        m_isAbandoned = (bound*(1.0-1e-9) > m_AbandonAbove);
+        return m_isAbandoned;
+    }
+    /**
+     * @brief Whether isWorse has stopped the evaluation
+     */
+    bool isAbandoned() const {
+        return m_isAbandoned;
+    }
+    /**
+     * @brief The last bound calculated by isWorse
+     */
+    double lowerBound() const {
+        return m_LowerBound;
+    }
+};
@@ -1,30 +1,33 @@
 #include "NLopt_Estimator.h"
+#include "NLopt_GenericKernel.h"
+#include "NLopt_Gradient.h"
+#include "NLopt_Kernels.h"
+#include "nmfBoundedQueue.h"
+#include "nmfInstrumentation.h"
 
+#include <QFuture>
+#include <QThreadPool>
+#include <QtConcurrent>
+
+#include <algorithm>
 #include <iomanip>
 #include <iostream>
+#include <sstream>
 #include <vector>
 #include <stdio.h>
 #include <math.h>
 
-bool m_Quit;
 //int NLopt_Estimator::m_NLoptIters    = 0;
-int NLopt_Estimator::m_NLoptFcnEvals = 0;
-int NLopt_Estimator::m_NumObjFcnCalls = 0;
-int NLopt_Estimator::m_RunNum        = 0;
-nlopt::opt       NLopt_Estimator::m_Optimizer;
-
-std::unique_ptr<nmfGrowthForm>      NLoptGrowthForm;
-std::unique_ptr<nmfHarvestForm>     NLoptHarvestForm;
-std::unique_ptr<nmfCompetitionForm> NLoptCompetitionForm;
-std::unique_ptr<nmfPredationForm>   NLoptPredationForm;
 
 
 NLopt_Estimator::NLopt_Estimator()
 {
-    m_Quit = false;
-    m_Seed = 0;
+    m_CancellationToken = std::make_shared<nmfCancellationToken>();
+    m_ThreadPool     = nullptr;
+    m_RunNum         = 0;
+    m_NLoptFcnEvals  = 0;
+    m_NumObjFcnCalls = 0;
     m_MinimizerToEnum.clear();
-    m_MohnsRhoOffset = 0;
 
     // Load Minimizer Name Map with global algorithms
     m_MinimizerToEnum["GN_ORIG_DIRECT_L"] = nlopt::GN_ORIG_DIRECT_L;
@@ -63,6 +66,155 @@ NLopt_Estimator::getVersion()
             QString::number(bugfix));
 }
 
+void
+NLopt_Estimator::decodeModelForms(const nmfStructsQt::ModelDataStruct& NLoptDataStruct,
+                                  NLopt_EvaluationContext& Context)
+{
+    Context.isLogistic     = (NLoptDataStruct.GrowthForm      == "Logistic");
+    Context.isCatchability = (NLoptDataStruct.HarvestForm     == "Effort (qE)");
+    Context.isAlpha        = (NLoptDataStruct.CompetitionForm == "NO_K");
+    Context.isMSPROD       = (NLoptDataStruct.CompetitionForm == "MS-PROD");
+    Context.isAGGPROD      = (NLoptDataStruct.CompetitionForm == "AGG-PROD");
+    Context.isRho          = (NLoptDataStruct.PredationForm   == "Type I") ||
+                             (NLoptDataStruct.PredationForm   == "Type II") ||
+                             (NLoptDataStruct.PredationForm   == "Type III");
+    Context.isHandling     = (NLoptDataStruct.PredationForm   == "Type II") ||
+                             (NLoptDataStruct.PredationForm   == "Type III");
+    Context.isExponent     = (NLoptDataStruct.PredationForm   == "Type III");
+
+    const std::string& GrowthForm = NLoptDataStruct.GrowthForm;
+    if (GrowthForm == "Null") {
+        Context.GrowthType = NLoptNullGrowth;
+    } else if (GrowthForm == "Linear") {
+        Context.GrowthType = NLoptLinearGrowth;
+    } else if (GrowthForm == "Logistic") {
+        Context.GrowthType = NLoptLogisticGrowth;
+    } else {
+        Context.GrowthType = NLoptUnknownGrowth;
+    }
+
+    const std::string& HarvestForm = NLoptDataStruct.HarvestForm;
+    if (HarvestForm == "Null") {
+        Context.HarvestType = NLoptNullHarvest;
+    } else if (HarvestForm == "Catch") {
+        Context.HarvestType = NLoptCatchHarvest;
+    } else if (HarvestForm == "Effort (qE)") {
+        Context.HarvestType = NLoptEffortHarvest;
+    } else if (HarvestForm == "Exploitation (F)") {
+        Context.HarvestType = NLoptExploitationHarvest;
+    } else {
+        Context.HarvestType = NLoptUnknownHarvest;
+    }
+
+    const std::string& CompetitionForm = NLoptDataStruct.CompetitionForm;
+    if (CompetitionForm == "Null") {
+        Context.CompetitionType = NLoptNullCompetition;
+    } else if (CompetitionForm == "NO_K") {
+        Context.CompetitionType = NLoptNoKCompetition;
+    } else if (CompetitionForm == "MS-PROD") {
+        Context.CompetitionType = NLoptMSPRODCompetition;
+    } else if (CompetitionForm == "AGG-PROD") {
+        Context.CompetitionType = NLoptAGGPRODCompetition;
+    } else {
+        Context.CompetitionType = NLoptUnknownCompetition;
+    }
+
+    const std::string& PredationForm = NLoptDataStruct.PredationForm;
+    if (PredationForm == "Null") {
+        Context.PredationType = NLoptNullPredation;
+    } else if (PredationForm == "Type I") {
+        Context.PredationType = NLoptTypeIPredation;
+    } else if (PredationForm == "Type II") {
+        Context.PredationType = NLoptTypeIIPredation;
+    } else if (PredationForm == "Type III") {
+        Context.PredationType = NLoptTypeIIIPredation;
+    } else {
+        Context.PredationType = NLoptUnknownPredation;
+    }
+
+    if (NLoptDataStruct.ObjectiveCriterion == "Least Squares") {
+        Context.ObjectiveCriterion = NLoptLeastSquares;
+    } else if (NLoptDataStruct.ObjectiveCriterion == "Model Efficiency") {
+        Context.ObjectiveCriterion = NLoptModelEfficiency;
+    } else if (NLoptDataStruct.ObjectiveCriterion == "Maximum Likelihood") {
+        Context.ObjectiveCriterion = NLoptMaximumLikelihood;
+    } else {
+        Context.ObjectiveCriterion = NLoptUnknownCriterion;
+    }
+    // Any scaling other than Mean defaults to Min Max
+    Context.ScalingAlgorithm = (NLoptDataStruct.ScalingAlgorithm == "Mean") ?
+                                NLoptMeanScaling : NLoptMinMaxScaling;
+    Context.ObjectiveCriterionName = NLoptDataStruct.ObjectiveCriterion;
+
+    Context.NumSpecies = NLoptDataStruct.NumSpecies;
+    Context.NumGuilds  = NLoptDataStruct.NumGuilds;
+    Context.NumSpeciesOrGuilds = (Context.isAGGPROD) ? Context.NumGuilds : Context.NumSpecies;
+    Context.Layout.initialize(Context);
+}
+
+void
+NLopt_Estimator::initializeEvaluationContext(const nmfStructsQt::ModelDataStruct& NLoptDataStruct,
+                                             const int& MohnsRhoOffset,
+                                             nmfGrowthForm*      GrowthForm,
+                                             nmfHarvestForm*     HarvestForm,
+                                             nmfCompetitionForm* CompetitionForm,
+                                             nmfPredationForm*   PredationForm,
+                                             NLopt_EvaluationContext& Context)
+{
+    std::map<int,std::vector<int> > GuildSpecies = NLoptDataStruct.GuildSpecies;
+
+    decodeModelForms(NLoptDataStruct,Context);
+
+    Context.isCheckedInitBiomass = nmfUtils::isEstimateParameterChecked(NLoptDataStruct,"InitBiomass");
+    Context.NumYears  = NLoptDataStruct.RunLength+1 - MohnsRhoOffset;
+
+    Context.GrowthForm      = GrowthForm;
+    Context.HarvestForm     = HarvestForm;
+    Context.CompetitionForm = CompetitionForm;
+    Context.PredationForm   = PredationForm;
+
+    if (Context.isAGGPROD) {
+        Context.ObsBiomassBySpeciesOrGuilds = NLoptDataStruct.ObservedBiomassByGuilds;
+    } else {
+        Context.ObsBiomassBySpeciesOrGuilds = NLoptDataStruct.ObservedBiomassBySpecies;
+    }
+    Context.ObsBiomassBySpeciesOrGuildsRescaled.resize(Context.NumYears,Context.NumSpeciesOrGuilds,false);
+    Context.ObsBiomassBySpeciesOrGuildsRescaled.clear();
+    if (Context.ScalingAlgorithm == NLoptMeanScaling) {
+        rescaleMean(  Context.ObsBiomassBySpeciesOrGuilds,Context.ObsBiomassBySpeciesOrGuildsRescaled);
+    } else {
+        rescaleMinMax(Context.ObsBiomassBySpeciesOrGuilds,Context.ObsBiomassBySpeciesOrGuildsRescaled);
+    }
+    Context.Catch        = NLoptDataStruct.Catch;
+    Context.Effort       = NLoptDataStruct.Effort;
+    Context.Exploitation = NLoptDataStruct.Exploitation;
+
+    // The first year of the estimated biomass always comes from the observed species biomass
+    Context.InitialObservedBiomass.clear();
+    for (int i=0; i<Context.NumSpeciesOrGuilds; ++i) {
+        Context.InitialObservedBiomass.push_back(NLoptDataStruct.ObservedBiomassBySpecies(0,i));
+    }
+    Context.InitialObservedBiomassGuilds.clear();
+    for (int i=0; i<Context.NumGuilds; ++i) {
+        Context.InitialObservedBiomassGuilds.push_back(NLoptDataStruct.ObservedBiomassByGuilds(0,i));
+    }
+
+    NLopt_Kernels::selectKernels(Context);
+    Context.GradientMode = NLoptFiniteDifferenceGradient;
+    Context.isGenericKernelVerified = false;
+
+    // Flatten the guild map so the objective function doesn't have to look up guilds by key
+    Context.GuildSpeciesOffset.clear();
+    Context.GuildSpeciesIndex.clear();
+    Context.GuildSpeciesOffset.push_back(0);
+    for (int i=0; i<Context.NumGuilds; ++i) {
+        for (unsigned j=0; j<GuildSpecies[i].size(); ++j) {
+            Context.GuildSpeciesIndex.push_back(GuildSpecies[i][j]);
+        }
+        Context.GuildSpeciesOffset.push_back(int(Context.GuildSpeciesIndex.size()));
+    }
+}
+
 void
 NLopt_Estimator::extractParameters(const nmfStructsQt::ModelDataStruct& NLoptDataStruct,
                                    const double *EstParameters,
@@ -79,143 +231,70 @@ NLopt_Estimator::extractParameters(const nmfStructsQt::ModelDataStruct& NLoptDat
                                    std::vector<double>& exponent,
                                    std::vector<double>& surveyQ)
 {
-    bool isLogistic     = (NLoptDataStruct.GrowthForm      == "Logistic");
-    bool isCatchability = (NLoptDataStruct.HarvestForm     == "Effort (qE)");
-    bool isAlpha        = (NLoptDataStruct.CompetitionForm == "NO_K");
-    bool isMSPROD       = (NLoptDataStruct.CompetitionForm == "MS-PROD");
-    bool isAGGPROD      = (NLoptDataStruct.CompetitionForm == "AGG-PROD");
-    bool isRho          = (NLoptDataStruct.PredationForm   == "Type I") ||
-                          (NLoptDataStruct.PredationForm   == "Type II") ||
-                          (NLoptDataStruct.PredationForm   == "Type III");
-    bool isHandling     = (NLoptDataStruct.PredationForm   == "Type II") ||
-                          (NLoptDataStruct.PredationForm   == "Type III");
-    bool isExponent     = (NLoptDataStruct.PredationForm   == "Type III");
-    int m;
-    int offset = 0;
-    int NumSpecies = NLoptDataStruct.NumSpecies;
-    int NumGuilds  = NLoptDataStruct.NumGuilds;
-    int NumSpeciesOrGuilds = (isAGGPROD) ? NumGuilds : NumSpecies;
-    int MatrixSize = NumSpeciesOrGuilds*NumSpeciesOrGuilds;
-
-    initBiomass.clear();
-    growthRate.clear();
-    carryingCapacity.clear();
-    catchabilityRate.clear();
-    competitionAlpha.clear();
-    competitionBetaSpecies.clear();
-    competitionBetaGuilds.clear();
-    competitionBetaGuildsGuilds.clear();
-    predation.clear();
-    handling.clear();
-    exponent.clear();
-    surveyQ.clear();
-
-    // Always extract init biomass
-    for (int i=0; i<NumSpeciesOrGuilds; ++i) {
-        initBiomass.emplace_back(EstParameters[offset+i]);
-    }
-    offset += NumSpeciesOrGuilds;
-
-    // Always extract growth rate
-    for (int i=0; i<NumSpeciesOrGuilds; ++i) {
-        growthRate.emplace_back(EstParameters[offset+i]);
-    }
-    offset += NumSpeciesOrGuilds;
-
-    // Load the carrying capacity vector
-    for (int i=0; i<NumSpeciesOrGuilds; ++i) {
-        if (isLogistic) {
-            carryingCapacity.emplace_back(EstParameters[offset+i]);
-        } else {
-            carryingCapacity.emplace_back(0);
-        }
-    }
-    if (isLogistic) {
-        offset += NumSpeciesOrGuilds;
-    }
+    NLopt_EvaluationContext Context;
 
-    if (isCatchability) {
-        for (int i=0; i<NumSpeciesOrGuilds; ++i) {
-            catchabilityRate.emplace_back(EstParameters[offset+i]);
-        }
-        offset += NumSpeciesOrGuilds;
-    }
-
-    if (isAlpha) {
-        m = 0;
-        nmfUtils::initialize(competitionAlpha,NumSpeciesOrGuilds,NumSpeciesOrGuilds);
-        for (int i=0; i<NumSpeciesOrGuilds; ++i) {
-            for (int j=0; j<NumSpeciesOrGuilds; ++j) {
-                competitionAlpha(i,j) = EstParameters[offset + (m++)];
-            }
-        }
-        offset += MatrixSize;
-    }
-
-    if (isMSPROD) {
-        m = 0;
-        nmfUtils::initialize(competitionBetaSpecies,NumSpeciesOrGuilds,NumSpeciesOrGuilds);
-        for (int i=0; i<NumSpeciesOrGuilds; ++i) {
-            for (int j=0; j<NumSpeciesOrGuilds; ++j) {
-                competitionBetaSpecies(i,j) = EstParameters[offset + (m++)];
-            }
-        }
-        offset += MatrixSize;
-        m = 0;
-        nmfUtils::initialize(competitionBetaGuilds, NumSpeciesOrGuilds,NumGuilds);
-        for (int i=0; i<NumSpeciesOrGuilds; ++i) {
-            for (int j=0; j<NumGuilds; ++j) {
-                competitionBetaGuilds(i,j) = EstParameters[offset + (m++)];
-            }
-        }
-        offset += NumSpeciesOrGuilds*NumGuilds;
-    }
+    decodeModelForms(NLoptDataStruct,Context);
 
-    if (isAGGPROD) {
-        m = 0;
-        nmfUtils::initialize(competitionBetaGuildsGuilds, NumGuilds,NumGuilds);
-        for (int i=0; i<NumGuilds; ++i) {
-            for (int j=0; j<NumGuilds; ++j) {
-                competitionBetaGuildsGuilds(i,j) = EstParameters[offset + (m++)];
-            }
-        }
-        offset += NumGuilds*NumGuilds;
-    }
+    extractParameters(Context,EstParameters,
+                      initBiomass,growthRate,carryingCapacity,catchabilityRate,
+                      competitionAlpha,competitionBetaSpecies,
+                      competitionBetaGuilds,competitionBetaGuildsGuilds,
+                      predation,handling,exponent,surveyQ);
+}
 
-    if (isRho) {
-        m = 0;
-        nmfUtils::initialize(predation,NumSpeciesOrGuilds,NumSpeciesOrGuilds);
-        for (int i=0; i<NumSpeciesOrGuilds; ++i) {
-            for (int j=0; j<NumSpeciesOrGuilds; ++j) {
-                predation(i,j) = EstParameters[offset + (m++)];
-            }
+void
+NLopt_Estimator::extractParameters(const NLopt_EvaluationContext& Context,
+                                   const double *EstParameters,
+                                   std::vector<double>& initBiomass,
+                                   std::vector<double>& growthRate,
+                                   std::vector<double>& carryingCapacity,
+                                   std::vector<double>& catchabilityRate,
+                                   boost::numeric::ublas::matrix<double>& competitionAlpha,
+                                   boost::numeric::ublas::matrix<double>& competitionBetaSpecies,
+                                   boost::numeric::ublas::matrix<double>& competitionBetaGuilds,
+                                   boost::numeric::ublas::matrix<double>& competitionBetaGuildsGuilds,
+                                   boost::numeric::ublas::matrix<double>& predation,
+                                   boost::numeric::ublas::matrix<double>& handling,
+                                   std::vector<double>& exponent,
+                                   std::vector<double>& surveyQ)
+{
+    const NLopt_ParameterLayout& Layout = Context.Layout;
+    NLopt_ParameterViews<double> Views;
+
+    Views.set(Layout,EstParameters);
+
+    auto copyVector = [](const NLopt_VectorView<double>& View, std::vector<double>& Vector) {
+        Vector.assign(View.begin(),View.end());
+    };
+    auto copyMatrix = [](const NLopt_MatrixView<double>& View, boost::numeric::ublas::matrix<double>& Matrix) {
+        if (View.Rows == 0) {
+            Matrix.clear();
+            return;
         }
-        offset += MatrixSize;
-    }
-
-    if (isHandling) {
-        m = 0;
-        nmfUtils::initialize(handling,NumSpeciesOrGuilds,NumSpeciesOrGuilds);
-        for (int i=0; i<NumSpeciesOrGuilds; ++i) {
-            for (int j=0; j<NumSpeciesOrGuilds; ++j) {
-                handling(i,j) = EstParameters[offset + (m++)];
+        NLopt_Workspace::initialize(Matrix,View.Rows,View.Cols);
+        for (int i=0; i<View.Rows; ++i) {
+            for (int j=0; j<View.Cols; ++j) {
+                Matrix(i,j) = View(i,j);
             }
         }
-        offset += MatrixSize;
-    }
+    };
 
-    if (isExponent) {
-        for (int i=0; i<NumSpeciesOrGuilds; ++i) {
-            exponent.emplace_back(EstParameters[offset+i]);
-        }
-        offset += NumSpeciesOrGuilds;
-    }
-
-    // Survey Q
-    for (int i=0; i<NumSpeciesOrGuilds; ++i) {
-        surveyQ.emplace_back(EstParameters[offset+i]);
+    copyVector(Views.InitBiomass,initBiomass);
+    copyVector(Views.GrowthRate, growthRate);
+    if (Layout.CarryingCapacity.isPresent()) {
+        copyVector(Views.CarryingCapacity,carryingCapacity);
+    } else {
+        carryingCapacity.assign(Context.NumSpeciesOrGuilds,0);
     }
-    offset += NumSpeciesOrGuilds;
+    copyVector(Views.Catchability,catchabilityRate);
+    copyMatrix(Views.CompetitionAlpha,           competitionAlpha);
+    copyMatrix(Views.CompetitionBetaSpecies,     competitionBetaSpecies);
+    copyMatrix(Views.CompetitionBetaGuilds,      competitionBetaGuilds);
+    copyMatrix(Views.CompetitionBetaGuildsGuilds,competitionBetaGuildsGuilds);
+    copyMatrix(Views.PredationRho,               predation);
+    copyMatrix(Views.PredationHandling,          handling);
+    copyVector(Views.PredationExponent,exponent);
+    copyVector(Views.SurveyQ,surveyQ);
 }
 
 double
@@ -243,320 +322,181 @@ NLopt_Estimator::objectiveFunction(unsigned n,
                                    double* gradient,
                                    void* dataPtr)
 {
-    const int DefaultFitness = 99999;
-    nmfStructsQt::ModelDataStruct NLoptDataStruct = *((nmfStructsQt::ModelDataStruct *)dataPtr);
-    bool isAggProd = (NLoptDataStruct.CompetitionForm == "AGG-PROD");
-    double EstBiomassVal;
-    double GrowthTerm;
-    double HarvestTerm;
-    double CompetitionTerm;
-    double PredationTerm;
-    double systemCarryingCapacity;
-    double guildK;
-    double fitness=0;
-    int timeMinus1;
-    int NumYears   = NLoptDataStruct.RunLength+1 - m_MohnsRhoOffset;
-    int NumSpecies = NLoptDataStruct.NumSpecies;
-    int NumGuilds  = NLoptDataStruct.NumGuilds;
-    int guildNum = 0;
-    int NumSpeciesOrGuilds;
-    double surveyQVal;
-    std::vector<double> initBiomass;
-    std::vector<double> growthRate;
-    std::vector<double> carryingCapacity;
-    std::vector<double> guildCarryingCapacity;
-    std::vector<double> predationExponent;
-    std::vector<double> catchabilityRate;
-    std::vector<double> surveyQ;
-    boost::numeric::ublas::matrix<double> EstBiomassSpecies;
-    boost::numeric::ublas::matrix<double> EstBiomassGuilds;
-    boost::numeric::ublas::matrix<double> EstBiomassRescaled;
-    boost::numeric::ublas::matrix<double> ObsBiomassBySpeciesOrGuildsRescaled;
-    boost::numeric::ublas::matrix<double> competitionAlpha;
-    boost::numeric::ublas::matrix<double> competitionBetaSpecies;
-    boost::numeric::ublas::matrix<double> competitionBetaGuilds;
-    boost::numeric::ublas::matrix<double> competitionBetaGuildsGuilds;
-    boost::numeric::ublas::matrix<double> predationRho;
-    boost::numeric::ublas::matrix<double> predationHandling;
-    boost::numeric::ublas::matrix<double> ObsBiomassBySpeciesOrGuilds;
-    boost::numeric::ublas::matrix<double> Catch        = NLoptDataStruct.Catch;
-    boost::numeric::ublas::matrix<double> Effort       = NLoptDataStruct.Effort;
-    boost::numeric::ublas::matrix<double> Exploitation = NLoptDataStruct.Exploitation;
-    std::map<int,std::vector<int> > GuildSpecies = NLoptDataStruct.GuildSpecies;
-    std::string MSSPMName = "Run " + std::to_string(m_RunNum) + "-1";
-//std::cout << "NLopt_Estimator::objectiveFunction - start" << std::endl;
+    NLopt_SubRun& SubRun = *((NLopt_SubRun *)dataPtr);
 
-    if (m_Quit) {
+    if (SubRun.Cancellation->isCancelled()) {
        throw nlopt::forced_stop();
     }
 
-    if (isAggProd) {
-        NumSpeciesOrGuilds = NumGuilds;
-        ObsBiomassBySpeciesOrGuilds = NLoptDataStruct.ObservedBiomassByGuilds;
-    } else {
-        NumSpeciesOrGuilds = NumSpecies;
-        ObsBiomassBySpeciesOrGuilds = NLoptDataStruct.ObservedBiomassBySpecies;
-    }
+    NMF_INSTRUMENT_SCOPE(nmfPhaseObjectiveFunction);
+    NMF_INSTRUMENT_COUNT(nmfCounterEvaluations,1);
 
-    //std::cout << "\n\nSetting size of competitionAlpha: " <<  NumSpeciesOrGuilds << "x" <<  NumSpeciesOrGuilds << std::endl;
-    nmfUtils::initialize(EstBiomassSpecies,                   NumYears,           NumSpeciesOrGuilds);
-    nmfUtils::initialize(EstBiomassGuilds,                    NumYears,           NumGuilds);
-    nmfUtils::initialize(EstBiomassRescaled,                  NumYears,           NumSpeciesOrGuilds);
-    nmfUtils::initialize(ObsBiomassBySpeciesOrGuildsRescaled, NumYears,           NumSpeciesOrGuilds);
-    nmfUtils::initialize(competitionAlpha,                    NumSpeciesOrGuilds, NumSpeciesOrGuilds);
-    nmfUtils::initialize(competitionBetaSpecies,              NumSpecies,         NumSpecies);
-    nmfUtils::initialize(competitionBetaGuilds,               NumSpeciesOrGuilds, NumGuilds);
-    nmfUtils::initialize(competitionBetaGuildsGuilds,         NumGuilds,          NumGuilds);
-    nmfUtils::initialize(predationRho,                        NumSpeciesOrGuilds, NumSpeciesOrGuilds);
-    nmfUtils::initialize(predationHandling,                   NumSpeciesOrGuilds, NumSpeciesOrGuilds);
-
-    // RSK - how does this initBiomass work with SurveyQ
-    extractParameters(NLoptDataStruct, EstParameters, initBiomass,
-                      growthRate,carryingCapacity,catchabilityRate,
-                      competitionAlpha,competitionBetaSpecies,
-                      competitionBetaGuilds,competitionBetaGuildsGuilds,
-                      predationRho,predationHandling,predationExponent,surveyQ);
-
-    // Since we may be estimating SurveyQ, need to divide the Observed Biomass by the SurveyQ
-    for (int species=0; species<int(ObsBiomassBySpeciesOrGuilds.size2()); ++species) {
-        surveyQVal = surveyQ[species];
-        for (int time=0; time<int(ObsBiomassBySpeciesOrGuilds.size1()); ++time) {
-            ObsBiomassBySpeciesOrGuilds(time,species) /= surveyQVal;
-        }
+    // NLopt only sees the free parameters, so fill in the fixed ones
+    thread_local std::vector<double> Parameters;
+    {
+        NMF_INSTRUMENT_SCOPE(nmfPhaseParameterExtraction);
+        SubRun.Mapping.expand(EstParameters,Parameters);
     }
 
-    // Calculate carrying capacity for all guilds
-    systemCarryingCapacity = 0;
-    for (int i=0; i<NumGuilds; ++i) {
-        guildK = 0;
-        for (unsigned j=0; j<GuildSpecies[i].size(); ++j) {
-            guildK += carryingCapacity[GuildSpecies[i][j]];
+    double fitness = evaluateObjective(SubRun.Context,Parameters.data());
 
-            systemCarryingCapacity += guildK;
-        }
-        guildCarryingCapacity.push_back(guildK);
+    // NLopt only passes a gradient to the derivative based (LD_* and GD_*) algorithms
+    if (gradient != nullptr) {
+        NLopt_Gradient::calculate(SubRun.Context,SubRun.Mapping,Parameters.data(),gradient);
     }
 
-    for (int i=0; i<NumSpeciesOrGuilds; ++i) {
-        EstBiomassSpecies(0,i) = NLoptDataStruct.ObservedBiomassBySpecies(0,i)/surveyQ[i];
-//std::cout << "EBS(0," << i << "): " << EstBiomassSpecies(0,i) << ", " <<
-//         NLoptDataStruct.ObservedBiomassBySpecies(0,i) << ", " <<
-//         surveyQ[i] << std::endl;
-    }
+    incrementObjectiveFunctionCounter(SubRun,fitness);
 
+    return fitness;
+}
 
-    // RSK - Remember there's only initial guild biomass data
-    // Multiply by guild surveyQ data when you have it
-    for (int i=0; i<NumGuilds; ++i) {
-        EstBiomassGuilds(0,i)  = NLoptDataStruct.ObservedBiomassByGuilds(0,i);
 
-    }
+double
+NLopt_Estimator::evaluateObjective(const NLopt_EvaluationContext& Context,
+                                   const double* EstParameters,
+                                   const double& AbandonAbove)
+{
+    thread_local NLopt_Workspace Workspace;
 
+    return evaluateObjective(Context,EstParameters,Workspace,AbandonAbove);
+}
 
-    if (NLoptGrowthForm == nullptr) {
-        incrementObjectiveFunctionCounter(MSSPMName,-1.0,NLoptDataStruct);
-        return -1;
-    }
 
-//nmfUtils::printMatrix("Competition Alpha",competitionAlpha,16,10);
-//nmfUtils::printMatrix("Predation Rho",predationRho,16,10);
-
-    bool isCheckedInitBiomass = nmfUtils::isEstimateParameterChecked(NLoptDataStruct,"InitBiomass");
-
-
-// RSK take this out possible logstuff
-//for (int ii=0;ii<int(EstBiomassSpecies.size1()); ++ii) {
-//    for (int jj=0;jj<int(EstBiomassSpecies.size2()); ++jj) {
-//        EstBiomassSpecies(ii,jj) = myNaturalLog(EstBiomassSpecies(ii,jj));
-//    }
-//}
-//for (int ii=0;ii<int(Catch.size1()); ++ii) {
-//    for (int jj=0;jj<int(Catch.size2()); ++jj) {
-//        if (ii<2 and jj<2) {
-//            std::cout << "Catch (" << ii << "," << jj << "): " << Catch(ii,jj) << std::endl;
-//        }
-//    }
-//}
-    for (int time=1; time<NumYears; ++time) {
-
-        timeMinus1 = time - 1;
-        for (int species=0; species<NumSpeciesOrGuilds; ++species) {
-
-            if (isCheckedInitBiomass) { // if estimating the initial biomass
-                if (timeMinus1 == 0) {
-                    EstBiomassVal = initBiomass[species];
-                } else {
-                    EstBiomassVal = EstBiomassSpecies(timeMinus1,species);
-                }
-            } else {
-                EstBiomassVal = EstBiomassSpecies(timeMinus1,species);
-            }
+void
+NLopt_Estimator::calculateBiomass(const NLopt_EvaluationContext& Context,
+                                  const double* EstParameters,
+                                  boost::numeric::ublas::matrix<double>& EstBiomassSpecies,
+                                  boost::numeric::ublas::matrix<double>& EstBiomassGuilds)
+{
+    // Use a workspace of its own so the biomass can be handed off without copying
+    NLopt_Workspace Workspace;
+
+    evaluateObjective(Context,EstParameters,Workspace,std::numeric_limits<double>::infinity());
 
-            GrowthTerm      = NLoptGrowthForm->evaluate(species,EstBiomassVal,
-                                                        growthRate,carryingCapacity);
-            HarvestTerm     = NLoptHarvestForm->evaluate(timeMinus1,species,
-                                                         Catch,Effort,Exploitation,
-                                                         EstBiomassVal,catchabilityRate);
-            CompetitionTerm = NLoptCompetitionForm->evaluate(
-                                   timeMinus1,species,EstBiomassVal,
-                                   systemCarryingCapacity,
-                                   growthRate,
-                                   guildCarryingCapacity[guildNum],
-                                   competitionAlpha,
-                                   competitionBetaSpecies,
-                                   competitionBetaGuilds,
-                                   competitionBetaGuildsGuilds,
-                                   EstBiomassSpecies,
-                                   EstBiomassGuilds);
-            PredationTerm   = NLoptPredationForm->evaluate(
-                                   timeMinus1,species,
-                                   predationRho,predationHandling,predationExponent,
-                                   EstBiomassSpecies,EstBiomassVal);
-
-            EstBiomassVal  += GrowthTerm - HarvestTerm - CompetitionTerm - PredationTerm;
-
-//if (time == 1) {
-//std::cout << "EstBiomassVal: " << EstBiomassVal << std::endl;
-//}
-
-//if (species == 0 && time == 1) {
-//    std::cout << "nlopt year: " << time << ", val = "
-//              << EstBiomassSpecies(timeMinus1,species) << " + "
-//              << GrowthTerm << " - "
-//              << HarvestTerm << " - "
-//              << CompetitionTerm << " - "
-//              << PredationTerm << " = "
-//              << EstBiomassVal << std::endl;
-//}
-
-if (EstBiomassVal < 0) { // test code only
-    EstBiomassVal = 0;
+    EstBiomassSpecies.swap(Workspace.EstBiomassSpecies);
+    EstBiomassGuilds.swap( Workspace.EstBiomassGuilds);
 }
 
-            if ((EstBiomassVal < 0) || (std::isnan(std::fabs(EstBiomassVal)))) {
-                incrementObjectiveFunctionCounter(MSSPMName,(double)DefaultFitness,NLoptDataStruct);
-                return DefaultFitness;
-            }
 
-            EstBiomassSpecies(time,species) = EstBiomassVal;
-//std::cout << "nlopt val(" << time << "," << species << "): " << EstBiomassVal << std::endl;
-            // update EstBiomassGuilds for next time step
-            for (int i=0; i<NumGuilds; ++i) {
-                for (unsigned j=0; j<GuildSpecies[i].size(); ++j) {
-                    EstBiomassGuilds(time,i) += EstBiomassSpecies(time,GuildSpecies[i][j]);
-                }
-            }
-        } // end i
-    } // end time
-
-    // Scale the data
-    std::string m_Scaling = NLoptDataStruct.ScalingAlgorithm;
-    if (m_Scaling == "Min Max") {
-        rescaleMinMax(EstBiomassSpecies, EstBiomassRescaled);
-        rescaleMinMax(ObsBiomassBySpeciesOrGuilds, ObsBiomassBySpeciesOrGuildsRescaled);
-    } else if (m_Scaling == "Mean") {
-        rescaleMean(EstBiomassSpecies, EstBiomassRescaled);
-        rescaleMean(ObsBiomassBySpeciesOrGuilds, ObsBiomassBySpeciesOrGuildsRescaled);
-    } else {
-//      std::cout << "Error: No Scaling Algorithm detected. Defaulting to Min Max." << std::endl;
-        rescaleMinMax(EstBiomassSpecies, EstBiomassRescaled);
-        rescaleMinMax(ObsBiomassBySpeciesOrGuilds, ObsBiomassBySpeciesOrGuildsRescaled);
+double
+NLopt_Estimator::evaluateObjective(const NLopt_EvaluationContext& Context,
+                                   const double* EstParameters,
+                                   NLopt_Workspace& Workspace,
+                                   const double& AbandonAbove)
+{
+    const int DefaultFitness = 99999;
+    double systemCarryingCapacity;
+    double guildK;
+    int NumGuilds  = Context.NumGuilds;
+    int NumSpeciesOrGuilds = Context.NumSpeciesOrGuilds;
+    const std::vector<int>& GuildSpeciesOffset = Context.GuildSpeciesOffset;
+    const std::vector<int>& GuildSpeciesIndex  = Context.GuildSpeciesIndex;
+    const NLopt_VectorView<double>& surveyQ          = Workspace.Parameters.SurveyQ;
+    const NLopt_VectorView<double>& carryingCapacity = Workspace.Parameters.CarryingCapacity;
+    std::vector<double>& guildCarryingCapacity = Workspace.GuildCarryingCapacity;
+    boost::numeric::ublas::matrix<double>& EstBiomassSpecies           = Workspace.EstBiomassSpecies;
+    boost::numeric::ublas::matrix<double>& EstBiomassGuilds            = Workspace.EstBiomassGuilds;
+
+    if (Context.GrowthForm == nullptr) {
+        return -1;
     }
 
-    // temp test RSK - take this logstuff out possibly
-//for (int ii=0; ii<int(ObsBiomassBySpeciesOrGuildsRescaled.size1()); ++ii) {
-//    for (int jj=0; jj<int(ObsBiomassBySpeciesOrGuildsRescaled.size2()); ++jj) {
-//        ObsBiomassBySpeciesOrGuildsRescaled(ii,jj) = myNaturalLog(ObsBiomassBySpeciesOrGuildsRescaled(ii,jj));
-//    }
-//}
-    // Calculate fitness using the appropriate objective criterion
-    if (NLoptDataStruct.ObjectiveCriterion == "Least Squares") {
+    // Size (first call only) and zero this thread's scratch storage
+    Workspace.prepare(Context);
 
-        fitness =  nmfUtilsStatistics::calculateSumOfSquares(
-                    EstBiomassRescaled,
-                    ObsBiomassBySpeciesOrGuildsRescaled);
-//std::cout << "fitness1: " << fitness << std::endl; // OK
-    } else if (NLoptDataStruct.ObjectiveCriterion == "Model Efficiency") {
+    // RSK - how does this initBiomass work with SurveyQ
+    // The inline kernels read the parameters in place. Only the model form objects need copies.
+    Workspace.Parameters.set(Context.Layout,EstParameters);
+    if (Context.isFormParameterCopyNeeded) {
+        NMF_INSTRUMENT_SCOPE(nmfPhaseParameterExtraction);
+        extractParameters(Context, EstParameters, Workspace.InitBiomass,
+                          Workspace.GrowthRate,Workspace.CarryingCapacity,Workspace.CatchabilityRate,
+                          Workspace.CompetitionAlpha,Workspace.CompetitionBetaSpecies,
+                          Workspace.CompetitionBetaGuilds,Workspace.CompetitionBetaGuildsGuilds,
+                          Workspace.PredationRho,Workspace.PredationHandling,
+                          Workspace.PredationExponent,Workspace.SurveyQ);
+    }
 
-        // Negate the MEF here since the ranges is from -inf to 1, where 1 is best.  So we negate it,
-        // then minimize that, and then negate and plot the resulting value.
-        fitness = -nmfUtilsStatistics::calculateModelEfficiency(
-                    EstBiomassRescaled,
-                    ObsBiomassBySpeciesOrGuildsRescaled);
-    } else if (NLoptDataStruct.ObjectiveCriterion == "Maximum Likelihood") {
-        // The maximum likelihood calculations must use the unscaled data or else the
-        // results will be incorrect.
+    // The early abandon bound is only proven for Least Squares against the cached rescaled
+    // observed biomass, which is only used when every SurveyQ is positive
+    Workspace.EarlyAbandon.reset(NumSpeciesOrGuilds,
+        ((Context.ObjectiveCriterion == NLoptLeastSquares) &&
+         std::all_of(surveyQ.begin(),surveyQ.end(),[](const double& q) { return q > 0; })) ?
+        AbandonAbove : std::numeric_limits<double>::infinity());
+
+    // Calculate carrying capacity for all guilds
+    systemCarryingCapacity = 0;
+    guildCarryingCapacity.clear();
+    {
+        NMF_INSTRUMENT_SCOPE(nmfPhaseGuildAggregation);
+        for (int i=0; i<NumGuilds; ++i) {
+            guildK = 0;
+            for (int j=GuildSpeciesOffset[i]; j<GuildSpeciesOffset[i+1]; ++j) {
+                if (Context.isLogistic) {
+                    guildK += carryingCapacity[GuildSpeciesIndex[j]];
+                }
 
-        fitness =  nmfUtilsStatistics::calculateMaximumLikelihoodNoRescale(
-                    EstBiomassSpecies,
-                    ObsBiomassBySpeciesOrGuilds);
+                systemCarryingCapacity += guildK;
+            }
+            guildCarryingCapacity.push_back(guildK);
+        }
+    }
 
-        //std::cout << "fitness2: " << fitness << std::endl; // Not OK
-     }
+    for (int i=0; i<NumSpeciesOrGuilds; ++i) {
+        EstBiomassSpecies(0,i) = Context.InitialObservedBiomass[i]/surveyQ[i];
+    }
 
-    incrementObjectiveFunctionCounter(MSSPMName,fitness,NLoptDataStruct);
+    // RSK - Remember there's only initial guild biomass data
+    // Multiply by guild surveyQ data when you have it
+    for (int i=0; i<NumGuilds; ++i) {
+        EstBiomassGuilds(0,i) = Context.InitialObservedBiomassGuilds[i];
+    }
 
-    //std::cout << "NLopt_Estimator::objectiveFunction - end" << std::endl;
+    // Step the biomass forward with the kernel chosen for this run's model forms
+    if (! Context.BiomassKernel(Context,Workspace,systemCarryingCapacity)) {
+        if (Workspace.EarlyAbandon.isAbandoned()) {
+            NMF_INSTRUMENT_COUNT(nmfCounterAbandonedEvaluations,1);
+            return Workspace.EarlyAbandon.lowerBound();
+        }
+        NMF_INSTRUMENT_COUNT(nmfCounterInvalidEvaluations,1);
+        return DefaultFitness;
+    }
 
-    return fitness;
+    // Scale the data and calculate fitness using the appropriate objective criterion
+    return Context.FitnessKernel(Context,Workspace);
 }
 
 
 void
-NLopt_Estimator::incrementObjectiveFunctionCounter(std::string MSSPMName,
-                                                   double fitness,
-                                                   nmfStructsQt::ModelDataStruct NLoptDataStruct)
+NLopt_Estimator::incrementObjectiveFunctionCounter(NLopt_SubRun& SubRun,
+                                                   double fitness)
 {
-    int unused = -1;
+    int numObjFcnCalls;
 
-    // Update progress output file
+    // Update progress chart
     // RSK - comment out for now, some algorithms yield 0 evals while they're calculating
 //    m_NLoptFcnEvals = m_Optimizer.get_numevals();
 
-    ++m_NumObjFcnCalls;
-//std::cout << "m_NumObjFcnCalls,fitness: " << m_NumObjFcnCalls << "," << fitness << std::endl;
-    if (m_NumObjFcnCalls%1000 == 0) {
-
-        writeCurrentLoopFile(MSSPMName,
-                             m_NumObjFcnCalls,
-                             fitness,
-                             NLoptDataStruct.ObjectiveCriterion,
-                             unused);
+    ++SubRun.NumEvaluations;
+    numObjFcnCalls = ++(*SubRun.NumObjFcnCalls);
+    if ((numObjFcnCalls%1000 == 0) && SubRun.Progress) {
+        //
+        // Model Efficiency is to be maximized instead of minimized.  The
+        // best value is 1. Since the code is set up to minimize for Least
+        // Squares, I just negated the fitness and ran the minimization code.
+        // Now, I just need to negate the fitness again so the plot will
+        // show the fitness approaching +1.
+        //
+        if (SubRun.Context.ObjectiveCriterion == NLoptModelEfficiency) {
+            fitness = -fitness;
+        }
+        NMF_INSTRUMENT_SCOPE(nmfPhaseProgressIO);
+        NMF_INSTRUMENT_COUNT(nmfCounterProgressSamples,1);
+        SubRun.Progress->publish(SubRun.RunNum,numObjFcnCalls,fitness);
     }
 
 }
 
-void
-NLopt_Estimator::writeCurrentLoopFile(std::string &MSSPMName,
-                                      int         &NumGens,
-                                      double      &BestFitness,
-                                      std::string &ObjectiveCriterion,
-                                      int         &NumGensSinceBestFit)
-{
-    double adjustedBestFitness; // May need negating if ObjCrit is Model Efficiency
-    std::ofstream outputFile(nmfConstantsMSSPM::MSSPMProgressChartFile,
-                             std::ios::out|std::ios::app);
-
-    adjustedBestFitness = BestFitness;
-    //
-    // Model Efficiency is to be maximized instead of minimized.  The
-    // best value is 1. Since the code is set up to minimize for Least
-    // Squares, I just negated the fitness and ran the minimization code.
-    // Now, I just need to negate the fitness again so the plot will
-    // show the fitness approaching +1.
-    //
-    if (ObjectiveCriterion == "Model Efficiency") {
-        adjustedBestFitness = -adjustedBestFitness;
-    }
-
-    outputFile << MSSPMName   << ", "
-               << NumGens     << ", "
-               << adjustedBestFitness << ", "
-               << NumGensSinceBestFit << std::endl;
-
-    outputFile.close();
-}
-
 void
 NLopt_Estimator::loadInitBiomassParameterRanges(
         std::vector<std::pair<double,double> >& parameterRanges,
@@ -600,91 +540,240 @@ NLopt_Estimator::loadSurveyQParameterRanges(
 }
 
 void
-NLopt_Estimator::setStoppingCriteria(nmfStructsQt::ModelDataStruct &NLoptStruct)
+NLopt_Estimator::loadParameterRanges(
+        std::vector<std::pair<double,double> >& ParameterRanges,
+        const nmfStructsQt::ModelDataStruct&    dataStruct)
+{
+    nmfGrowthForm      growthForm(     dataStruct.GrowthForm);
+    nmfHarvestForm     harvestForm(    dataStruct.HarvestForm);
+    nmfCompetitionForm competitionForm(dataStruct.CompetitionForm);
+    nmfPredationForm   predationForm(  dataStruct.PredationForm);
+
+    loadInitBiomassParameterRanges(     ParameterRanges, dataStruct);
+    growthForm.loadParameterRanges(     ParameterRanges, dataStruct);
+    harvestForm.loadParameterRanges(    ParameterRanges, dataStruct);
+    competitionForm.loadParameterRanges(ParameterRanges, dataStruct);
+    predationForm.loadParameterRanges(  ParameterRanges, dataStruct);
+    loadSurveyQParameterRanges(         ParameterRanges, dataStruct);
+}
+
+void
+NLopt_Estimator::setStoppingCriteria(const nmfStructsQt::ModelDataStruct& NLoptStruct,
+                                     nlopt::opt& Optimizer)
 {
     if (NLoptStruct.NLoptUseStopVal) {
         std::cout << "Setting stop fitness value: " << NLoptStruct.NLoptStopVal << std::endl;
-        m_Optimizer.set_stopval(NLoptStruct.NLoptStopVal);
+        Optimizer.set_stopval(NLoptStruct.NLoptStopVal);
     }
     if (NLoptStruct.NLoptUseStopAfterTime) {
         std::cout << "Setting max run time: " << NLoptStruct.NLoptStopAfterTime << std::endl;
-        m_Optimizer.set_maxtime(NLoptStruct.NLoptStopAfterTime);
+        Optimizer.set_maxtime(NLoptStruct.NLoptStopAfterTime);
     }
     if (NLoptStruct.NLoptUseStopAfterIter) {
         std::cout << "Setting max num function evaluations: " << NLoptStruct.NLoptStopAfterIter << std::endl;
-        m_Optimizer.set_maxeval(NLoptStruct.NLoptStopAfterIter);
+        Optimizer.set_maxeval(NLoptStruct.NLoptStopAfterIter);
     }
 
 }
 
 
 void
-NLopt_Estimator::setObjectiveFunction(nmfStructsQt::ModelDataStruct& NLoptStruct,
-                                      std::string& MaxOrMin)
+NLopt_Estimator::setObjectiveFunction(NLopt_SubRun& SubRun)
 {
-    if (NLoptStruct.ObjectiveCriterion == "Least Squares") {
-        MaxOrMin = "minimum";
-        m_Optimizer.set_min_objective(objectiveFunction, &NLoptStruct);
-    } else if (NLoptStruct.ObjectiveCriterion == "Maximum Likelihood") {
-        MaxOrMin = "minimum";
-        m_Optimizer.set_min_objective(objectiveFunction, &NLoptStruct);
-    } else if (NLoptStruct.ObjectiveCriterion == "Model Efficiency") {
-        MaxOrMin = "maximum";
-        m_Optimizer.set_max_objective(objectiveFunction, &NLoptStruct);
+    if (SubRun.Context.ObjectiveCriterion == NLoptLeastSquares) {
+        SubRun.MaxOrMin = "minimum";
+        SubRun.Optimizer.set_min_objective(objectiveFunction, &SubRun);
+    } else if (SubRun.Context.ObjectiveCriterion == NLoptMaximumLikelihood) {
+        SubRun.MaxOrMin = "minimum";
+        SubRun.Optimizer.set_min_objective(objectiveFunction, &SubRun);
+    } else if (SubRun.Context.ObjectiveCriterion == NLoptModelEfficiency) {
+        SubRun.MaxOrMin = "maximum";
+        SubRun.Optimizer.set_max_objective(objectiveFunction, &SubRun);
     }
 }
 
 
 void
-NLopt_Estimator::setSeed(const bool& isSetToDeterministic)
+NLopt_Estimator::verifyKernels(NLopt_EvaluationContext& Context,
+                               const std::vector<double>& StartingPoint)
 {
-    if (isSetToDeterministic) {
-        nlopt::srand(++m_Seed);
+    double tolerance = 1e-10;
+    double specializedFitness;
+    double formFitness;
+    NLopt_BiomassKernel specializedKernel = Context.BiomassKernel;
+    bool isSpecializedCopyNeeded = Context.isFormParameterCopyNeeded;
+
+    // Evaluate the starting point with the specialized kernel and with the one that goes
+    // through the model form objects. If they disagree, the inline version of one of the
+    // forms doesn't match nmfModels, so fall back to the model form objects for this run.
+    specializedFitness = evaluateObjective(Context,StartingPoint.data());
+    NLopt_Kernels::selectFormKernels(Context);
+    formFitness = evaluateObjective(Context,StartingPoint.data());
+
+    if (std::fabs(specializedFitness-formFitness) <= tolerance*std::max(1.0,std::fabs(formFitness)) ||
+        (std::isnan(specializedFitness) && std::isnan(formFitness))) {
+        Context.BiomassKernel = specializedKernel;
+        Context.isFormParameterCopyNeeded = isSpecializedCopyNeeded;
     } else {
-        nlopt::srand_time();
+        std::cout << "Warning: Specialized kernel fitness (" << specializedFitness
+                  << ") differs from model form fitness (" << formFitness
+                  << "). Using model form kernel." << std::endl;
+    }
+
+    // The generic kernel writes the equations out itself as well, so make sure it
+    // agrees before its derivatives or batch evaluations are trusted.
+    Context.isGenericKernelVerified = false;
+    if (NLopt_GenericKernel::isSupported(Context)) {
+        bool isValid;
+        NLopt_GenericWorkspace<double> Workspace;
+        double genericFitness = NLopt_GenericKernel::evaluate(Context,StartingPoint.data(),Workspace,isValid);
+        Context.isGenericKernelVerified = isValid &&
+            (std::fabs(genericFitness-formFitness) <= 1e-8*std::max(1.0,std::fabs(formFitness)));
+        if (! Context.isGenericKernelVerified) {
+            std::cout << "Warning: Generic kernel fitness (" << genericFitness
+                      << ") differs from model form fitness (" << formFitness
+                      << "). Using model form kernel." << std::endl;
+        }
     }
 }
 
 
+bool
+NLopt_Estimator::isAGradientAlgorithm(const std::string& MinimizerAlgorithm)
+{
+    return (MinimizerAlgorithm.substr(0,3) == "LD_") ||
+           (MinimizerAlgorithm.substr(0,3) == "GD_");
+}
+
+
+unsigned long
+NLopt_Estimator::getSeed(const std::uint64_t& Seed,
+                         const int& MultiRunIndex,
+                         const int& SubRunNumber)
+{
+    // NLopt's own generator can't be keyed by a counter, so each sub-run seeds it
+    // with the first draw of its (seed, line, sub-run) stream. A deterministic run's
+    // sub-runs then get the same seeds in whatever order the pool runs them.
+    nmfRandom Random(Seed,std::uint32_t(MultiRunIndex),std::uint32_t(SubRunNumber));
+    return (unsigned long)Random.getNext64();
+}
+
+
 void
-NLopt_Estimator::setParameterBounds(nmfStructsQt::ModelDataStruct& NLoptStruct,
-                                    std::vector<std::pair<double,double> >& ParameterRanges,
-                                    const int& NumEstParameters)
+NLopt_Estimator::setParameterBounds(const std::vector<std::pair<double,double> >& ParameterRanges,
+                                    const NLopt_ParameterMapping& Mapping,
+                                    nlopt::opt& Optimizer)
 {
-    // If all lower bounds = their respective upper bounds, nlopt exits with SUCCESS but the estimated
-    // points are not exactly equal to the input parameter points. This may be a bug with NLopt or perhaps
-    // there's a tolerance or stop condition that I'm not specifying.  As a work-around, I've found that if I
-    // tweak every parameter range by the following eps value, NLopt estimates correctly. RSK 03-24-2021
-    double eps = 1e-10;
-    double lowerVal;
-    double upperVal;
+    // Parameters whose lower bound equals their upper bound aren't passed to NLopt at all.
+    // (NLopt didn't reproduce such fixed values exactly. RSK 03-24-2021)
+    int NumEstParameters = ParameterRanges.size();
     std::vector<double> lowerBounds(NumEstParameters);
     std::vector<double> upperBounds(NumEstParameters);
+    std::vector<double> freeLowerBounds;
+    std::vector<double> freeUpperBounds;
 
-    // Set parameter bounds for all parameters
+    // Set parameter bounds for the free parameters
     for (int i=0; i<NumEstParameters; ++i) {
-        lowerVal = ParameterRanges[i].first;
-        upperVal = ParameterRanges[i].second;
-        lowerBounds[i] = lowerVal;
-        upperBounds[i] = upperVal;
+        lowerBounds[i] = ParameterRanges[i].first;
+        upperBounds[i] = ParameterRanges[i].second;
     }
-    m_Optimizer.set_lower_bounds(lowerBounds);
-    m_Optimizer.set_upper_bounds(upperBounds);
+    Mapping.pack(lowerBounds,freeLowerBounds);
+    Mapping.pack(upperBounds,freeUpperBounds);
+    Optimizer.set_lower_bounds(freeLowerBounds);
+    Optimizer.set_upper_bounds(freeUpperBounds);
+}
+
+
+void
+NLopt_Estimator::loadStartingPoint(const std::vector<std::pair<double,double> >& ParameterRanges,
+                                   std::vector<double>& StartingPoint)
+{
+    double lowerVal;
+    double upperVal;
 
     // Set starting points for all parameters
-    m_Parameters.clear();
-    for (int i=0; i<NumEstParameters; ++i) {
-        if (lowerBounds[i] == upperBounds[i]) {
-            m_Parameters.push_back(lowerBounds[i]);
+    StartingPoint.clear();
+    for (unsigned i=0; i<ParameterRanges.size(); ++i) {
+        lowerVal = ParameterRanges[i].first;
+        upperVal = ParameterRanges[i].second;
+        if (lowerVal == upperVal) {
+            StartingPoint.push_back(lowerVal);
         } else {
-            m_Parameters.push_back(lowerBounds[i] + (upperBounds[i]-lowerBounds[i])/2.0);
+            StartingPoint.push_back(lowerVal + (upperVal-lowerVal)/2.0);
         }
     }
-    NLoptStruct.Parameters = m_Parameters;
 }
 
 
 
+void
+NLopt_Estimator::runSubRun(NLopt_SubRun& SubRun,
+                           const nmfStructsQt::ModelDataStruct& NLoptStruct,
+                           const std::vector<std::pair<double,double> >& ParameterRanges)
+{
+    // Each sub-run gets its own form objects since they're not safe to share between threads
+    SubRun.GrowthForm      = std::make_unique<nmfGrowthForm>(     NLoptStruct.GrowthForm);
+    SubRun.HarvestForm     = std::make_unique<nmfHarvestForm>(    NLoptStruct.HarvestForm);
+    SubRun.CompetitionForm = std::make_unique<nmfCompetitionForm>(NLoptStruct.CompetitionForm);
+    SubRun.PredationForm   = std::make_unique<nmfPredationForm>(  NLoptStruct.PredationForm);
+
+    // Build the data the objective function borrows on every evaluation
+    initializeEvaluationContext(NLoptStruct,SubRun.MohnsRhoOffset,
+                                SubRun.GrowthForm.get(),SubRun.HarvestForm.get(),
+                                SubRun.CompetitionForm.get(),SubRun.PredationForm.get(),
+                                SubRun.Context);
+    SubRun.Context.MSSPMName = "Run " + std::to_string(SubRun.RunNum) + "-1";
+
+    // Initialize the optimizer with the appropriate algorithm over the free parameters.
+    // Undeclared interaction links have [0,0] ranges, so they're neither searched over
+    // nor, if the matrix is sparse enough, evaluated.
+    SubRun.Mapping.initialize(ParameterRanges);
+    SubRun.Context.Layout.initializePatterns(ParameterRanges);
+    SubRun.Mapping.pack(SubRun.Parameters,SubRun.FreeParameters);
+    SubRun.Optimizer = nlopt::opt(SubRun.Algorithm,SubRun.Mapping.getNumFreeParameters());
+
+    // Set Seed, Parameter Bounds, Objective Function, and Stopping Criteria. NLopt's random
+    // number generator is thread local, so it must be seeded on the thread that optimizes.
+    nlopt::srand(SubRun.Seed);
+    setParameterBounds(ParameterRanges,SubRun.Mapping,SubRun.Optimizer);
+    verifyKernels(SubRun.Context,SubRun.Parameters);
+    if (isAGradientAlgorithm(NLoptStruct.MinimizerAlgorithm)) {
+        NLopt_Gradient::selectGradientMode(SubRun.Context);
+    }
+    setObjectiveFunction(SubRun);
+    setStoppingCriteria(NLoptStruct,SubRun.Optimizer);
+
+    // Run the Optimizer using the previously defined objective function
+    nlopt::result result;
+    std::ostringstream report;
+    SubRun.Fitness = 0;
+    if (SubRun.Cancellation->isCancelled()) {
+        // Stopped before this sub-run got a thread
+    } else if (SubRun.Mapping.getNumFreeParameters() == 0) {
+        // Nothing to search over
+        SubRun.Fitness = evaluateObjective(SubRun.Context,SubRun.Parameters.data());
+    } else {
+        try {
+            result = SubRun.Optimizer.optimize(SubRun.FreeParameters, SubRun.Fitness);
+            report << "Optimizer return code: " << returnCode(result) << std::endl;
+        } catch (const std::exception& e) {
+            report << "Exception thrown: " << e.what() << std::endl;
+        } catch (...) {
+            report << "Error: Unknown error from NLopt_Estimator::estimateParameters Optimizer.optimize()" << std::endl;
+        }
+        SubRun.Mapping.expand(SubRun.FreeParameters.data(),SubRun.Parameters);
+    }
+
+    // Calculate the estimated biomass here rather than have the GUI re-run the model
+    if (! SubRun.Cancellation->isCancelled()) {
+        calculateBiomass(SubRun.Context,SubRun.Parameters.data(),
+                         SubRun.EstBiomassSpecies,SubRun.EstBiomassGuilds);
+    }
+    report << "Found " + SubRun.MaxOrMin + " fitness of: " << SubRun.Fitness << std::endl;
+    SubRun.Report = report.str();
+}
+
+
 void
 NLopt_Estimator::estimateParameters(nmfStructsQt::ModelDataStruct &NLoptStruct,
                                     int& RunNumber,
@@ -695,167 +784,230 @@ NLopt_Estimator::estimateParameters(nmfStructsQt::ModelDataStruct &NLoptStruct,
     bool isAMultiRun = bools.first;
     bool isSetToDeterministic = bools.second;
     bool foundOneNLoptRun = false;
-    int NumEstParameters;
+    std::uint64_t Seed = nmfRandom::getSeed(isSetToDeterministic);
     int NumMultiRuns = 1;
     int NumSubRuns = 0;
     double fitnessStdDev = 0;
     std::string bestFitnessStr = "TBD";
-    std::string MaxOrMin;
     std::vector<std::pair<double,double> > ParameterRanges;
+    std::vector<double> StartingPoint;
+    std::vector<nmfStructsQt::ModelDataStruct> MultiRunStructs;
+    std::vector<std::vector<std::pair<double,double> > > MultiRunParameterRanges;
+    std::vector<std::unique_ptr<NLopt_SubRun> > SubRuns;
+    std::vector<QFuture<void> > Futures;
+    QThreadPool OwnThreadPool;
+    QThreadPool* ThreadPool = m_ThreadPool;
     QDateTime startTime = nmfUtilsQt::getCurrentTime();
 
     m_NLoptFcnEvals  = 0;
     m_NumObjFcnCalls = 0;
-    m_Quit           = false;
     m_RunNum        += 1;
 
     NumSubRuns  =  NLoptStruct.BeesNumRepetitions; // RSK fix this
 
-    // Define forms
-    NLoptGrowthForm      = std::make_unique<nmfGrowthForm>(     NLoptStruct.GrowthForm);
-    NLoptHarvestForm     = std::make_unique<nmfHarvestForm>(    NLoptStruct.HarvestForm);
-    NLoptCompetitionForm = std::make_unique<nmfCompetitionForm>(NLoptStruct.CompetitionForm);
-    NLoptPredationForm   = std::make_unique<nmfPredationForm>(  NLoptStruct.PredationForm);
-
-    // Load parameter ranges
-    loadInitBiomassParameterRanges(           ParameterRanges, NLoptStruct);
-    NLoptGrowthForm->loadParameterRanges(     ParameterRanges, NLoptStruct);
-    NLoptHarvestForm->loadParameterRanges(    ParameterRanges, NLoptStruct);
-    NLoptCompetitionForm->loadParameterRanges(ParameterRanges, NLoptStruct);
-    NLoptPredationForm->loadParameterRanges(  ParameterRanges, NLoptStruct);
-    loadSurveyQParameterRanges(               ParameterRanges, NLoptStruct);
-    NumEstParameters = ParameterRanges.size();
-std::cout << "*** NumEstParam: " << NumEstParameters << std::endl;
-for (int i=0; i< NumEstParameters; ++i) {
- std::cout << "  " <<    ParameterRanges[i].first << ", " << ParameterRanges[i].second << std::endl;
-}
-
     if (isAMultiRun) {
         NumMultiRuns = MultiRunLines.size();
     }
 
+    // Set up every sub-run of every multi-run line before starting any of them. Each
+    // multi-run line keeps its own copy of the data struct since the sub-runs of
+    // several lines may be running at the same time.
     for (int multiRun=0; multiRun<NumMultiRuns; ++multiRun) {
 
         NumSubRuns = 1;
         if (isAMultiRun) {
             nmfUtilsQt::reloadDataStruct(NLoptStruct,MultiRunLines[multiRun]);
             NumSubRuns = NLoptStruct.NLoptNumberOfRuns;
-            NLoptGrowthForm->setType(     NLoptStruct.GrowthForm);
-            NLoptHarvestForm->setType(    NLoptStruct.HarvestForm);
-            NLoptCompetitionForm->setType(NLoptStruct.CompetitionForm);
-            NLoptPredationForm->setType(  NLoptStruct.PredationForm);
-            ParameterRanges.clear();
-            loadInitBiomassParameterRanges(           ParameterRanges, NLoptStruct);
-            NLoptGrowthForm->loadParameterRanges(     ParameterRanges, NLoptStruct);
-            NLoptHarvestForm->loadParameterRanges(    ParameterRanges, NLoptStruct);
-            NLoptCompetitionForm->loadParameterRanges(ParameterRanges, NLoptStruct);
-            NLoptPredationForm->loadParameterRanges(  ParameterRanges, NLoptStruct);
-            loadSurveyQParameterRanges(               ParameterRanges, NLoptStruct);
-            NumEstParameters = ParameterRanges.size();
         }
 
         // This must follow the reloadNLoptStruct call
         if (NLoptStruct.EstimationAlgorithm != "NLopt Algorithm") {
             continue; // skip over rest of for statement and continue with next increment
         }
-        m_Seed = 0;
         foundOneNLoptRun = true;
 
-        for (int run=0; run<NumSubRuns; ++run) {
-
-            if (NLoptStruct.isMohnsRho) {
-                m_MohnsRhoOffset = run;
-            }
+        // Load parameter ranges
+        ParameterRanges.clear();
+        loadParameterRanges(ParameterRanges,NLoptStruct);
+std::cout << "*** NumEstParam: " << ParameterRanges.size() << std::endl;
+for (unsigned i=0; i< ParameterRanges.size(); ++i) {
+ std::cout << "  " <<    ParameterRanges[i].first << ", " << ParameterRanges[i].second << std::endl;
+}
+        loadStartingPoint(ParameterRanges,StartingPoint);
+        NLoptStruct.Parameters = StartingPoint;
 
-            // Initialize the optimizer with the appropriate algorithm
-            m_Optimizer = nlopt::opt(m_MinimizerToEnum[NLoptStruct.MinimizerAlgorithm],NumEstParameters);
-
-            // Set Parameter Bounds, Objective Function, and Stopping Criteria
-            setSeed(isSetToDeterministic);
-            setParameterBounds(NLoptStruct,ParameterRanges,NumEstParameters);
-            setObjectiveFunction(NLoptStruct,MaxOrMin);
-            setStoppingCriteria(NLoptStruct);
-
-            // Run the Optimizer using the previously defined objective function
-            nlopt::result result;
-            try {
-                double fitness=0;
-                try {
-                    std::cout << "====> Running Optimizer <====" << std::endl;
-                    result = m_Optimizer.optimize(m_Parameters, fitness);
-                    std::cout << "Optimizer return code: " << returnCode(result) << std::endl;
-                } catch (const std::exception& e) {
-                    std::cout << "Exception thrown: " << e.what() << std::endl;
-                } catch (...) {
-                    std::cout << "Error: Unknown error from NLopt_Estimator::estimateParameters m_Optimizer.optimize()" << std::endl;
-                }
+        MultiRunStructs.push_back(NLoptStruct);
+        MultiRunParameterRanges.push_back(ParameterRanges);
 
-std::cout << "Found " + MaxOrMin + " fitness of: " << fitness << std::endl;
-                //for (unsigned i=0; i<m_Parameters.size(); ++i) {
-                //    std::cout << "  Est Param[" << i << "]: " << m_Parameters[i] << std::endl;
-                //}
-
-
-                extractParameters(NLoptStruct, &m_Parameters[0],
-                        m_EstInitBiomass,
-                        m_EstGrowthRates,  m_EstCarryingCapacities,
-                        m_EstCatchability, m_EstAlpha,
-                        m_EstBetaSpecies,  m_EstBetaGuilds, m_EstBetaGuildsGuilds,
-                        m_EstPredation,    m_EstHandling,   m_EstExponent,  m_EstSurveyQ);
-
-                createOutputStr(m_Parameters.size(),
-                                NLoptStruct.TotalNumberParameters,
-                                NumSubRuns,
-                                fitness,fitnessStdDev,NLoptStruct,bestFitnessStr);
-                if (isAMultiRun) {
-                    // RSK -remove this and replace with logic writing est parameters to file
-                    // (Having to use this with a delay is pretty ad hoc.)
-                    emit SubRunCompleted(RunNumber++,
-                                         TotalIndividualRuns,
-                                         NLoptStruct.EstimationAlgorithm,
-                                         NLoptStruct.MinimizerAlgorithm,
-                                         NLoptStruct.ObjectiveCriterion,
-                                         NLoptStruct.ScalingAlgorithm,
-                                         NLoptStruct.MultiRunModelFilename,
-                                         fitness);
-                    QThread::msleep((unsigned long)(100));
-                } else {
-                    emit RunCompleted(bestFitnessStr,NLoptStruct.showDiagnosticChart);
-                }
-
-            }
-            catch (nlopt::forced_stop &e) {
-                std::cout << "User terminated application: " << e.what() << std::endl;
-            }
-            catch (std::exception &e) {
-                std::cout << "NLopt_Estimator::estimateParameters nlopt failed: " << e.what() << std::endl;
-            }
+        for (int run=0; run<NumSubRuns; ++run) {
+            std::unique_ptr<NLopt_SubRun> SubRun = std::make_unique<NLopt_SubRun>();
+            SubRun->RunNum         = m_RunNum;
+            SubRun->MultiRunIndex  = int(MultiRunStructs.size())-1;
+            SubRun->SubRunNumber   = run;
+            SubRun->NumSubRuns     = NumSubRuns;
+            SubRun->Algorithm      = m_MinimizerToEnum[NLoptStruct.MinimizerAlgorithm];
+            SubRun->MohnsRhoOffset = (NLoptStruct.isMohnsRho) ? run : 0;
+            SubRun->Seed           = getSeed(Seed,SubRun->MultiRunIndex,run);
+            SubRun->Parameters     = StartingPoint;
+            SubRun->Fitness        = 0;
+            SubRun->NumEvaluations = 0;
+            SubRun->NumObjFcnCalls = &m_NumObjFcnCalls;
+            SubRun->Cancellation   = m_CancellationToken;
+            SubRun->Progress       = nmfProgressTelemetry::instance().openChannel();
+            SubRuns.push_back(std::move(SubRun));
+        }
+    }
 
-        } // end of sub run loop
+    // Run all of the sub-runs on the thread pool. A sub-run waited on before it has
+    // started runs on the waiting thread, so the pool may be shared with other estimators.
+    if (ThreadPool == nullptr) {
+        OwnThreadPool.setMaxThreadCount(QThread::idealThreadCount());
+        ThreadPool = &OwnThreadPool;
+    }
+    // Each sub-run queues itself as it finishes, so there's always room for it.
+    nmfBoundedQueue<NLopt_SubRun*> FinishedSubRuns(SubRuns.size());
+    for (std::unique_ptr<NLopt_SubRun>& SubRun : SubRuns) {
+        NLopt_SubRun* subRun = SubRun.get();
+        const nmfStructsQt::ModelDataStruct* subRunStruct = &MultiRunStructs[subRun->MultiRunIndex];
+        const std::vector<std::pair<double,double> >* subRunRanges = &MultiRunParameterRanges[subRun->MultiRunIndex];
+        Futures.push_back(QtConcurrent::run(ThreadPool,[this,subRun,subRunStruct,subRunRanges,&FinishedSubRuns]() {
+            runSubRun(*subRun,*subRunStruct,*subRunRanges);
+            subRun->Progress->close();
+            FinishedSubRuns.push(subRun);
+        }));
+    }
 
+    // Report each sub-run as soon as it finishes. This thread gives its place in the
+    // pool up while it waits, so that the sub-runs can't be stuck behind it when the
+    // pool is shared (e.g., by the peels of a retrospective analysis).
+    ThreadPool->releaseThread();
+    for (unsigned i=0; i<SubRuns.size(); ++i) {
+        NLopt_SubRun* finishedSubRun = nullptr;
+        FinishedSubRuns.pop(finishedSubRun);
+        NLopt_SubRun& SubRun = *finishedSubRun;
+        nmfStructsQt::ModelDataStruct& SubRunStruct = MultiRunStructs[SubRun.MultiRunIndex];
+
+        std::cout << SubRun.Report;
+
+        extractParameters(SubRun.Context, &SubRun.Parameters[0],
+                m_EstInitBiomass,
+                m_EstGrowthRates,  m_EstCarryingCapacities,
+                m_EstCatchability, m_EstAlpha,
+                m_EstBetaSpecies,  m_EstBetaGuilds, m_EstBetaGuildsGuilds,
+                m_EstPredation,    m_EstHandling,   m_EstExponent,  m_EstSurveyQ);
+
+        createOutputStr(SubRun.Parameters.size(),
+                        SubRun.Mapping.getNumFreeParameters(),
+                        SubRunStruct.TotalNumberParameters,
+                        SubRun.NumSubRuns,
+                        SubRun.Fitness,fitnessStdDev,SubRunStruct,bestFitnessStr);
+        // The result keeps its own copy of the estimates, since the next sub-run
+        // overwrites them before the reader gets to this one. The sub-run's biomass
+        // is no longer needed here, so it's handed over rather than copied.
+        std::unique_ptr<nmfEstimationResult> Result = std::make_unique<nmfEstimationResult>();
+        if (isAMultiRun) {
+            Result->Type                  = nmfEstimationResult::SubRunCompleted;
+            Result->RunNumber             = RunNumber++;
+            Result->NumRuns               = TotalIndividualRuns;
+            Result->MultiRunModelFilename = SubRunStruct.MultiRunModelFilename;
+        } else {
+            Result->Type                = nmfEstimationResult::RunCompleted;
+            Result->BestFitness         = bestFitnessStr;
+            Result->showDiagnosticChart = SubRunStruct.showDiagnosticChart;
+        }
+        Result->EstimationAlgorithm = SubRunStruct.EstimationAlgorithm;
+        Result->MinimizerAlgorithm  = SubRunStruct.MinimizerAlgorithm;
+        Result->ObjectiveCriterion  = SubRunStruct.ObjectiveCriterion;
+        Result->ScalingAlgorithm    = SubRunStruct.ScalingAlgorithm;
+        Result->Fitness             = SubRun.Fitness;
+        Result->NumEvaluations      = SubRun.NumEvaluations;
+        Result->isAggProd           = SubRun.Context.isAGGPROD;
+        Result->RunLength           = SubRun.Context.NumYears-1;
+        Result->EstBiomassSpecies.swap(SubRun.EstBiomassSpecies);
+        Result->EstBiomassGuilds.swap( SubRun.EstBiomassGuilds);
+        Result->EstInitBiomass                 = m_EstInitBiomass;
+        Result->EstGrowthRates                 = m_EstGrowthRates;
+        Result->EstCarryingCapacities          = m_EstCarryingCapacities;
+        Result->EstCatchability                = m_EstCatchability;
+        Result->EstPredationExponent           = m_EstExponent;
+        Result->EstSurveyQ                     = m_EstSurveyQ;
+        Result->EstCompetitionAlpha            = m_EstAlpha;
+        Result->EstCompetitionBetaSpecies      = m_EstBetaSpecies;
+        Result->EstCompetitionBetaGuilds       = m_EstBetaGuilds;
+        Result->EstCompetitionBetaGuildsGuilds = m_EstBetaGuildsGuilds;
+        Result->EstPredationRho                = m_EstPredation;
+        Result->EstPredationHandling           = m_EstHandling;
+        pushResult(std::move(Result));
+    }
+    ThreadPool->reserveThread();
+    for (QFuture<void>& Future : Futures) {
+        Future.waitForFinished();
     }
 
-    if (isAMultiRun && foundOneNLoptRun) {
-        emit AllSubRunsCompleted(NLoptStruct.MultiRunSpeciesFilename,
-                                 NLoptStruct.MultiRunModelFilename);
+    if (isAMultiRun && foundOneNLoptRun && ! m_Ensemble) {
+        std::unique_ptr<nmfEstimationResult> Result = std::make_unique<nmfEstimationResult>();
+        Result->Type                    = nmfEstimationResult::AllSubRunsCompleted;
+        Result->MultiRunSpeciesFilename = NLoptStruct.MultiRunSpeciesFilename;
+        Result->MultiRunModelFilename   = NLoptStruct.MultiRunModelFilename;
+        pushResult(std::move(Result));
     }
 
     std::string elapsedTimeStr = "Elapsed runtime: " + nmfUtilsQt::elapsedTime(startTime);
 std::cout << elapsedTimeStr << std::endl;
 
     stopRun(elapsedTimeStr,bestFitnessStr);
+    if (! m_Ensemble) {
+        m_CancellationToken->finish();
+    }
+
+}
+
+void
+NLopt_Estimator::setCancellationToken(std::shared_ptr<nmfCancellationToken> CancellationToken)
+{
+    m_CancellationToken = CancellationToken;
+}
+
+void
+NLopt_Estimator::setResultQueue(std::shared_ptr<nmfEstimationResultQueue> ResultQueue)
+{
+    m_ResultQueue = ResultQueue;
+}
+
+void
+NLopt_Estimator::setEnsemble(std::shared_ptr<nmfEstimationEnsemble> Ensemble)
+{
+    m_Ensemble = Ensemble;
+}
 
+void
+NLopt_Estimator::setThreadPool(QThreadPool* ThreadPool)
+{
+    m_ThreadPool = ThreadPool;
 }
 
 void
-NLopt_Estimator::callback_StopTheOptimizer()
+NLopt_Estimator::pushResult(std::unique_ptr<nmfEstimationResult> Result)
 {
-   m_Quit = true;
+    bool pushed;
+
+    if (! m_ResultQueue) {
+        return;
+    }
+    if (m_Ensemble && (Result->Type == nmfEstimationResult::SubRunCompleted)) {
+        pushed = m_Ensemble->push(*m_ResultQueue,std::move(Result));
+    } else {
+        pushed = m_ResultQueue->push(std::move(Result));
+    }
+    if (pushed) {
+        emit ResultsAvailable();
+    }
 }
 
 void
 NLopt_Estimator::createOutputStr(
         const int&         numEstParameters,
+        const int&         numFreeParameters,
         const int&         numTotalParameters,
         const int&         numSubRuns,
         const double&      bestFitness,
@@ -869,11 +1021,14 @@ NLopt_Estimator::createOutputStr(
     std::string predationForm   = NLoptStruct.PredationForm;
 
     std::cout << "Est'd Parameters: " << numEstParameters << std::endl;
+    std::cout << "Free Parameters: "  << numFreeParameters << std::endl;
     std::cout << "Total Parameters: " << numTotalParameters << std::endl;
     std::cout << "Fitness std dev: "  << fitnessStdDev << std::endl;
 
     // Write to Stop file
     bestFitnessStr  = "Est'd Parameters:&nbsp;"     + std::to_string(numEstParameters);
+    bestFitnessStr += "<br>Free Parameters:&nbsp;"  + std::to_string(numFreeParameters) +
+                      "&nbsp;(fixed ranges are not searched by the optimizer)";
     bestFitnessStr += "<br>Total Parameters:&nbsp;" + std::to_string(numTotalParameters);
 
     bestFitnessStr += "<br><br>Number of Runs:&nbsp;&nbsp;&nbsp;" + std::to_string(numSubRuns);
@@ -1105,25 +1260,17 @@ NLopt_Estimator::rescaleMinMax(const boost::numeric::ublas::matrix<double> &matr
     double den;
     double minVal;
     double maxVal;
-    std::vector<double> minValues(numSpecies,0);
-    std::vector<double> maxValues(numSpecies,0);
-    std::vector<double> tmp(numYears,0);
 
-    // Find min,max values for each column of matrix
+    // Rescale each column of the matrix with (x - min)/(max-min) formula. The
+    // min and max are found in place so no temporary storage is needed.
     for (int species=0; species<numSpecies; ++species) {
-        for (int time=0; time<numYears; ++time) {
-            tmp[time] = matrix(time,species);
+        minVal = matrix(0,species);
+        maxVal = minVal;
+        for (int time=1; time<numYears; ++time) {
+            minVal = std::min(minVal,matrix(time,species));
+            maxVal = std::max(maxVal,matrix(time,species));
         }
-        std::sort(tmp.begin(),tmp.end());
-        minValues[species] = tmp.front();
-        maxValues[species] = tmp.back();
-    }
-
-    // Rescale each column of the matrix with (x - min)/(max-min) formula.
-    for (int species=0; species<numSpecies; ++species) {
-        minVal = minValues[species];
-        maxVal = maxValues[species];
-        den    = maxVal - minVal;
+        den = maxVal - minVal;
         for (int time=0; time<numYears; ++time) {
             rescaledMatrix(time,species) = (matrix(time,species) - minVal) / den;  // min max normalization
         }
@@ -1142,31 +1289,20 @@ NLopt_Estimator::rescaleMean(const boost::numeric::ublas::matrix<double> &matrix
     double minVal;
     double maxVal;
     double avgVal;
-    std::vector<double> minValues(numSpecies,0);
-    std::vector<double> maxValues(numSpecies,0);
-    std::vector<double> avgValues(numSpecies,0);
-    std::vector<double> tmp(numYears,0);
 
-    // Find min,max values for each column of matrix
+    // Rescale each column of the matrix with (x - ave)/(max-min) formula. The
+    // min, max, and average are found in place so no temporary storage is needed.
     for (int species=0; species<numSpecies; ++species) {
+        minVal = matrix(0,species);
+        maxVal = minVal;
         avgVal = 0;
         for (int time=0; time<numYears; ++time) {
-            tmp[time] = matrix(time,species);
-            avgVal += tmp[time];
+            minVal  = std::min(minVal,matrix(time,species));
+            maxVal  = std::max(maxVal,matrix(time,species));
+            avgVal += matrix(time,species);
         }
         avgVal /= numYears;
-        std::sort(tmp.begin(),tmp.end());
-        minValues[species] = tmp.front();
-        maxValues[species] = tmp.back();
-        avgValues[species] = avgVal;
-    }
-
-    // Rescale each column of the matrix with (x - ave)/(max-min) formula.
-    for (int species=0; species<numSpecies; ++species) {
-        minVal = minValues[species];
-        maxVal = maxValues[species];
-        den    = maxVal - minVal;
-        avgVal = avgValues[species];
+        den     = maxVal - minVal;
         for (int time=0; time<numYears; ++time) {
             rescaledMatrix(time,species) = (matrix(time,species) - avgVal) / den; // mean normalization
         }
@@ -39,17 +39,23 @@
 #include "nmfHarvestForm.h"
 #include "nmfCompetitionForm.h"
 #include "nmfPredationForm.h"
+#include "NLopt_EvaluationContext.h"
+#include "NLopt_Workspace.h"
+#include "NLopt_SubRun.h"
+#include "nmfCancellationToken.h"
+#include "nmfEstimationResult.h"
+#include "nmfRandom.h"
 
 #include <QDateTime>
 #include <QObject>
 #include <QString>
 #include <QThread>
+#include <QThreadPool>
 
+#include <atomic>
 #include <exception>
+#include <limits>
 #include <nlopt.hpp>
-#include <random>
-
-static int m_MohnsRhoOffset = 0;
 
 /**
  * @brief This class acts as an interface class to the NLopt library.
@@ -66,8 +72,6 @@ class  NLopt_Estimator : public QObject
 
 
 private:
-    int                                    m_Seed;
-    static nlopt::opt                      m_Optimizer;
     std::vector<double>                    m_InitialCarryingCapacities;
     std::vector<double>                    m_EstCatchability;
     std::vector<double>                    m_EstExponent;
@@ -83,14 +87,18 @@ private:
     boost::numeric::ublas::matrix<double>  m_EstPredation;
     boost::numeric::ublas::matrix<double>  m_EstHandling;
     std::map<std::string,nlopt::algorithm> m_MinimizerToEnum;
-    std::vector<double>                    m_Parameters;
-
+    std::shared_ptr<nmfCancellationToken>  m_CancellationToken;
+    std::shared_ptr<nmfEstimationResultQueue> m_ResultQueue;
+    std::shared_ptr<nmfEstimationEnsemble>    m_Ensemble;
+    QThreadPool*                              m_ThreadPool;
 
     std::string returnCode(int result);
+    void pushResult(std::unique_ptr<nmfEstimationResult> Result);
     void stopRun(const std::string &elapsedTimeStr,
                  const std::string &fitnessStr);
     void createOutputStr(
             const int&         numEstParameters,
+            const int&         numFreeParameters,
             const int&         numTotalParameters,
             const int&         numSubRuns,
             const double&      bestFitness,
@@ -102,39 +110,63 @@ private:
                                     const bool& includeTotal);
     std::string convertValues2DToOutputStr(const std::string& label,
                                     const boost::numeric::ublas::matrix<double> &matrix);
-    static void incrementObjectiveFunctionCounter(std::string MSSPMName,
-                                           double fitness,
-                                           nmfStructsQt::ModelDataStruct NLoptDataStruct);
+    static void incrementObjectiveFunctionCounter(NLopt_SubRun& SubRun,
+                                                  double fitness);
+    /**
+     * @brief Calculates the fitness of a set of parameters using the given workspace
+     * (see the public overload, which uses a thread local workspace)
+     */
+    static double evaluateObjective(
+            const NLopt_EvaluationContext& Context,
+            const double*                  EstParameters,
+            NLopt_Workspace&               Workspace,
+            const double&                  AbandonAbove);
+    static void extractParameters(
+            const NLopt_EvaluationContext&         Context,
+            const double*                          EstParameters,
+            std::vector<double>&                   InitBiomass,
+            std::vector<double>&                   GrowthRate,
+            std::vector<double>&                   CarryingCapacity,
+            std::vector<double>&                   CatchabilityRate,
+            boost::numeric::ublas::matrix<double>& CompetitionAlpha,
+            boost::numeric::ublas::matrix<double>& CompetitionBetaSpecies,
+            boost::numeric::ublas::matrix<double>& CompetitionBetaGuilds,
+            boost::numeric::ublas::matrix<double>& CompetitionBetaGuildsGuilds,
+            boost::numeric::ublas::matrix<double>& Predation,
+            boost::numeric::ublas::matrix<double>& Handling,
+            std::vector<double>&                   Exponent,
+            std::vector<double>&                   SurveyQ);
 //    double  dnorm4(double x, double mu, double sigma, int give_log);
 
-    void loadInitBiomassParameterRanges(
+    static void loadInitBiomassParameterRanges(
             std::vector<std::pair<double,double> >& parameterRanges,
             const nmfStructsQt::ModelDataStruct& dataStruct);
-    void loadSurveyQParameterRanges(
+    static void loadSurveyQParameterRanges(
             std::vector<std::pair<double,double> >& parameterRanges,
             const nmfStructsQt::ModelDataStruct& dataStruct);
-    void setStoppingCriteria(nmfStructsQt::ModelDataStruct&  NLoptStruct);
-    void setObjectiveFunction(nmfStructsQt::ModelDataStruct& NLoptStruct,
-                              std::string& MaxOrMin);
-    void setParameterBounds(nmfStructsQt::ModelDataStruct& NLoptStruct,
-                            std::vector<std::pair<double,double> >& ParameterRanges,
-                            const int& NumEstParameters);
+    void setStoppingCriteria(const nmfStructsQt::ModelDataStruct& NLoptStruct,
+                             nlopt::opt& Optimizer);
+    void setObjectiveFunction(NLopt_SubRun& SubRun);
+    void setParameterBounds(const std::vector<std::pair<double,double> >& ParameterRanges,
+                            const NLopt_ParameterMapping& Mapping,
+                            nlopt::opt& Optimizer);
+    void loadStartingPoint(const std::vector<std::pair<double,double> >& ParameterRanges,
+                           std::vector<double>& StartingPoint);
     void reloadNLoptStruct(
             nmfStructsQt::ModelDataStruct& NLoptStruct,
             const QString& MultiRunLine);
-    void setSeed(const bool& isSetToDeterministic);
+    bool isAGradientAlgorithm(const std::string& MinimizerAlgorithm);
+    unsigned long getSeed(const std::uint64_t& Seed,
+                          const int& MultiRunIndex,
+                          const int& SubRunNumber);
+    void runSubRun(NLopt_SubRun& SubRun,
+                   const nmfStructsQt::ModelDataStruct& NLoptStruct,
+                   const std::vector<std::pair<double,double> >& ParameterRanges);
 
     static double myNaturalLog(double value);
     static double myExp(double value);
 
 signals:
-    /**
-     * @brief Signal emitted at the end of a multi-run set of runs
-     * @param multiRunSpeciesFilename : name of Multi-Run Species File
-     * @param multiRunModelFilename : name of Multi-Run Model File
-     */
-    void AllSubRunsCompleted(std::string multiRunSpeciesFilename,
-                             std::string multiRunModelFilename);
     /**
      * @brief Signal emitted at the start of a multi-run set of runs
      * @param multiRunModelFilename : name of Multi-Run Model File
@@ -147,32 +179,10 @@ signals:
      */
     void QueryUserForMultiRunFilenames();
     /**
-     * @brief Signal emitted with NLopt Estimation run has complete
-     * @param bestFitness : string representing the best fitness value
-     * @param showDiagnosticsChart : boolean signfying whether the
-     * diagnostic 3d chart should be displayed after the run completes
-     */
-    void RunCompleted(std::string bestFitness,
-                      bool showDiagnosticsChart);
-    /**
-     * @brief Signal emitted when NLopt Estimation sub run of a multi run has completed
-     * @param run : current run
-     * @param numRuns : total number of runs in multi run
-     * @param EstimationAlgorithm : name of estimation algorithm
-     * @param MinimizerAlgorithm : name of the minimizer algorithm
-     * @param ObjectiveCriterion : name of the objective criterion
-     * @param ScalingAlgorithm : name of the scaling algorithm
-     * @param multiRunModelFilename : name of file that will contain the model data from all of the multi runs
-     * @param fitness : fitness value of current run
-     */
-    void SubRunCompleted(int run,
-                         int numRuns,
-                         std::string EstimationAlgorithm,
-                         std::string MinimizerAlgorithm,
-                         std::string ObjectiveCriterion,
-                         std::string ScalingAlgorithm,
-                         std::string multiRunModelFilename,
-                         double fitness);
+     * @brief Signal emitted after a sub-run, run or multi-run result has been pushed
+     * onto the result queue (see setResultQueue)
+     */
+    void ResultsAvailable();
 
 
 public:
@@ -189,17 +199,45 @@ public:
     /**
      * @brief Counts the number of function evaluations
      */
-    static int m_NLoptFcnEvals;
-
-    static int m_NumObjFcnCalls;
+    int m_NLoptFcnEvals;
+    /**
+     * @brief Counts the objective function calls of all of the sub-runs
+     */
+    std::atomic<int> m_NumObjFcnCalls;
 //    /**
 //     * @brief Counts the number of run iterations by the thousands
 //     */
 //    static int m_Counter;
     /**
-     * @brief Keeps track of the run number
+     * @brief Keeps track of this estimator's run number
+     */
+    int m_RunNum;
+    /**
+     * @brief Sets the token that stops this estimator's run. The caller keeps it and
+     * cancels it from any thread; the estimator calls finish() on it once its sub-runs are done.
+     * @param CancellationToken : the run's cancellation token
      */
-    static int m_RunNum;
+    void setCancellationToken(std::shared_ptr<nmfCancellationToken> CancellationToken);
+    /**
+     * @brief Sets the queue the estimator pushes its results onto. Pushing waits while the
+     * queue is full, so the estimator runs at most the queue's capacity ahead of the consumer.
+     * Without a queue no results are reported.
+     * @param ResultQueue : the run's result queue
+     */
+    void setResultQueue(std::shared_ptr<nmfEstimationResultQueue> ResultQueue);
+    /**
+     * @brief Makes the estimator one of several running the members of a multi-run
+     * together. Its sub-runs are numbered by the ensemble, and pushing the
+     * AllSubRunsCompleted result and finishing the cancellation token are left to
+     * whoever runs the ensemble (see nmfCoreEnsembleDispatcher).
+     * @param Ensemble : the multi-run's member numbering
+     */
+    void setEnsemble(std::shared_ptr<nmfEstimationEnsemble> Ensemble);
+    /**
+     * @brief Runs the sub-runs on the given pool rather than on one of the estimator's own
+     * @param ThreadPool : the pool (not owned)
+     */
+    void setThreadPool(QThreadPool* ThreadPool);
     /**
      * @brief The main routine that runs the NLopt Optimizer
      * @param NLoptDataStruct : structure containing all of the parameters needed by NLopt
@@ -214,6 +252,40 @@ public:
             std::pair<bool,bool>& bools,
             std::vector<QString>& MultiRunLines,
             int& TotalIndividualRuns);
+    /**
+     * @brief Decodes the model form and objective strings of the data struct into the context flags
+     * @param NLoptDataStruct : structure containing the model form names
+     * @param Context : the evaluation context whose flags and sizes are to be set
+     */
+    static void decodeModelForms(
+            const nmfStructsQt::ModelDataStruct& NLoptDataStruct,
+            NLopt_EvaluationContext&             Context);
+    /**
+     * @brief Builds the read-only data used by every objective function evaluation
+     * @param NLoptDataStruct : structure containing all of the parameters needed by NLopt
+     * @param MohnsRhoOffset : number of years peeled off of the end of the run
+     * @param GrowthForm : growth form used by the objective function
+     * @param HarvestForm : harvest form used by the objective function
+     * @param CompetitionForm : competition form used by the objective function
+     * @param PredationForm : predation form used by the objective function
+     * @param Context : the evaluation context to build
+     */
+    static void initializeEvaluationContext(
+            const nmfStructsQt::ModelDataStruct& NLoptDataStruct,
+            const int&                           MohnsRhoOffset,
+            nmfGrowthForm*                       GrowthForm,
+            nmfHarvestForm*                      HarvestForm,
+            nmfCompetitionForm*                  CompetitionForm,
+            nmfPredationForm*                    PredationForm,
+            NLopt_EvaluationContext&             Context);
+    /**
+     * @brief Loads a model's parameter ranges in the order of NLopt_ParameterLayout
+     * @param ParameterRanges : lower and upper bound of every model parameter (appended to)
+     * @param dataStruct : the model
+     */
+    static void loadParameterRanges(
+            std::vector<std::pair<double,double> >& ParameterRanges,
+            const nmfStructsQt::ModelDataStruct&    dataStruct);
     /**
      * @brief Extracts the estimated parameters from the NLopt Optimizer run
      * @param NLoptDataStruct : input parameters to the NLopt Optimizer
@@ -328,7 +400,7 @@ public:
      * @param n : unused (needed by NLopt library)
      * @param EstParameters : estimated parameter values
      * @param Gradient : unused (needed by NLopt library)
-     * @param FunctionData : input parameter estimation data
+     * @param FunctionData : pointer to the NLopt_SubRun being optimized
      * @return
      */
     static double objectiveFunction(
@@ -336,6 +408,42 @@ public:
             const double* EstParameters,
             double*       Gradient,
             void*         FunctionData);
+    /**
+     * @brief Checks the specialized and generic kernels against the model form objects
+     * at the starting point and falls back to the model form objects where they disagree
+     * @param Context : the evaluation context whose kernels are to be verified
+     * @param StartingPoint : the optimizer's starting point
+     */
+    static void verifyKernels(
+            NLopt_EvaluationContext&   Context,
+            const std::vector<double>& StartingPoint);
+    /**
+     * @brief Calculates the fitness of a set of parameters without updating the
+     * objective function counters or checking for a user stop
+     * @param Context : the evaluation context built for the run
+     * @param EstParameters : estimated parameter values
+     * @param AbandonAbove : incumbent fitness. For Least Squares runs, an evaluation that's
+     * certain to end up above it stops early and returns a lower bound that's above it
+     * instead of its fitness. Only for callers that discard anything worse than the incumbent.
+     * @return Returns the fitness value (99999 if the biomass became invalid)
+     */
+    static double evaluateObjective(
+            const NLopt_EvaluationContext& Context,
+            const double*                  EstParameters,
+            const double&                  AbandonAbove = std::numeric_limits<double>::infinity());
+    /**
+     * @brief Calculates the biomass that a set of parameters produces, i.e., the
+     * trajectory the objective function compares to the observed biomass
+     * @param Context : the evaluation context built for the run
+     * @param EstParameters : estimated parameter values
+     * @param EstBiomassSpecies : estimated biomass by species (or by guild if running AGG-PROD)
+     * @param EstBiomassGuilds : estimated biomass by guild
+     */
+    static void calculateBiomass(
+            const NLopt_EvaluationContext&         Context,
+            const double*                          EstParameters,
+            boost::numeric::ublas::matrix<double>& EstBiomassSpecies,
+            boost::numeric::ublas::matrix<double>& EstBiomassGuilds);
     /**
      * @brief Rescales each column of the input matrix with (x - ave)/(max-min)
      * @param Matrix : input matrix to be rescaled
@@ -352,27 +460,6 @@ public:
     static void rescaleMinMax(
             const boost::numeric::ublas::matrix<double>& Matrix,
             boost::numeric::ublas::matrix<double>&       RescaledMatrix);
-    /**
-     * @brief Updates the output chart data file with Optimization status. Another
-     * process reads this file and updates the progress chart accordingly.
-     * @param MSSPMName : name of the run
-     * @param NumGens : iteration number counted by thousand
-     * @param BestFitness : fitness value
-     * @param ObjectiveCriterion : name of objective criterion (Least Squares, Maximum Likelihood, or Model Efficiency)
-     * @param NumGensSinceBestFit : unused
-     */
-    static void writeCurrentLoopFile(
-            std::string& MSSPMName,
-            int&         NumGens,
-            double&      BestFitness,
-            std::string& ObjectiveCriterion,
-            int&         NumGensSinceBestFit);
-
-public slots:
-    /**
-     * @brief Callback invoked when the user stops the Estimation run
-     */
-    void callback_StopTheOptimizer();
 
 };
 
@@ -0,0 +1,212 @@
+/**
+ * @file NLopt_EvaluationContext.h
+ * @brief Definition of the read-only data used by the NLopt objective function
+ *
+ * This file contains the definition of the NLopt_EvaluationContext structure. The
+ * structure is built once per optimization and holds everything the objective
+ * function needs that does not change between evaluations: the decoded model
+ * form flags, the observed biomass, the harvest time series and the guild
+ * membership arrays.
+ *
+ * @copyright
+ * Public Domain Notice\n
+ *
+ * National Oceanic And Atmospheric Administration\n\n
+ *
+ * This software is a "United States Government Work" under the terms of the
+ * United States Copyright Act.  It was written as part of the author's official
+ * duties as a United States Government employee/contractor and thus cannot be copyrighted.
+ * This software is freely available to the public for use. The National Oceanic
+ * And Atmospheric Administration and the U.S. Government have not placed any
+ * restriction on its use or reproduction.  Although all reasonable efforts have
+ * been taken to ensure the accuracy and reliability of the software and data,
+ * the National Oceanic And Atmospheric Administration and the U.S. Government
+ * do not and cannot warrant the performance or results that may be obtained
+ * by using this software or data. The National Oceanic And Atmospheric
+ * Administration and the U.S. Government disclaim all warranties, express
+ * or implied, including warranties of performance, merchantability or fitness
+ * for any particular purpose.\n\n
+ *
+ * Please cite the author(s) in any work or product based on this material.
+ */
+
+#pragma once
+
+#include "nmfGrowthForm.h"
+#include "nmfHarvestForm.h"
+#include "nmfCompetitionForm.h"
+#include "nmfPredationForm.h"
+#include "NLopt_ParameterLayout.h"
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief Growth forms decoded from the ModelDataStruct string
+ */
+enum NLopt_GrowthType {
+    NLoptNullGrowth,
+    NLoptLinearGrowth,
+    NLoptLogisticGrowth,
+    NLoptUnknownGrowth
+};
+
+/**
+ * @brief Harvest forms decoded from the ModelDataStruct string
+ */
+enum NLopt_HarvestType {
+    NLoptNullHarvest,
+    NLoptCatchHarvest,
+    NLoptEffortHarvest,
+    NLoptExploitationHarvest,
+    NLoptUnknownHarvest
+};
+
+/**
+ * @brief Competition forms decoded from the ModelDataStruct string
+ */
+enum NLopt_CompetitionType {
+    NLoptNullCompetition,
+    NLoptNoKCompetition,
+    NLoptMSPRODCompetition,
+    NLoptAGGPRODCompetition,
+    NLoptUnknownCompetition
+};
+
+/**
+ * @brief Predation forms decoded from the ModelDataStruct string
+ */
+enum NLopt_PredationType {
+    NLoptNullPredation,
+    NLoptTypeIPredation,
+    NLoptTypeIIPredation,
+    NLoptTypeIIIPredation,
+    NLoptUnknownPredation
+};
+
+/**
+ * @brief Objective criteria decoded from the ModelDataStruct string
+ */
+enum NLopt_ObjectiveCriterion {
+    NLoptLeastSquares,
+    NLoptModelEfficiency,
+    NLoptMaximumLikelihood,
+    NLoptUnknownCriterion
+};
+
+/**
+ * @brief Scaling algorithms decoded from the ModelDataStruct string
+ */
+enum NLopt_ScalingAlgorithm {
+    NLoptMinMaxScaling,
+    NLoptMeanScaling
+};
+
+/**
+ * @brief How the objective function gradient is calculated for the derivative based minimizers
+ */
+enum NLopt_GradientMode {
+    NLoptFiniteDifferenceGradient,
+    NLoptAutoDiffGradient
+};
+
+struct NLopt_EvaluationContext;
+struct NLopt_Workspace;
+
+/**
+ * @brief Biomass recursion specialized for one combination of model forms. Returns
+ * false if the estimated biomass became invalid.
+ */
+typedef bool   (*NLopt_BiomassKernel)(const NLopt_EvaluationContext& Context,
+                                      NLopt_Workspace&               Workspace,
+                                      const double&                  SystemCarryingCapacity);
+/**
+ * @brief Scaling and fitness calculation specialized for one scaling algorithm and objective criterion
+ */
+typedef double (*NLopt_FitnessKernel)(const NLopt_EvaluationContext& Context,
+                                      NLopt_Workspace&               Workspace);
+
+/**
+ * @brief Read-only data borrowed by NLopt_Estimator::objectiveFunction
+ *
+ * The context is built once per optimization by NLopt_Estimator::initializeEvaluationContext
+ * and is owned by the NLopt_SubRun passed to NLopt as the objective function's data pointer.
+ * Nothing in it is modified or copied by the objective function.
+ */
+struct NLopt_EvaluationContext {
+    bool isLogistic;
+    bool isCatchability;
+    bool isAlpha;
+    bool isMSPROD;
+    bool isAGGPROD;
+    bool isRho;
+    bool isHandling;
+    bool isExponent;
+    bool isCheckedInitBiomass;
+    NLopt_GrowthType         GrowthType;
+    NLopt_HarvestType        HarvestType;
+    NLopt_CompetitionType    CompetitionType;
+    NLopt_PredationType      PredationType;
+    NLopt_ObjectiveCriterion ObjectiveCriterion;
+    NLopt_ScalingAlgorithm   ScalingAlgorithm;
+    int NumYears;
+    int NumSpecies;
+    int NumGuilds;
+    int NumSpeciesOrGuilds;
+    std::string MSSPMName;
+    std::string ObjectiveCriterionName;
+    /**
+     * @brief Year 0 observed species biomass (divided by SurveyQ on every evaluation)
+     */
+    std::vector<double> InitialObservedBiomass;
+    /**
+     * @brief Year 0 observed guild biomass
+     */
+    std::vector<double> InitialObservedBiomassGuilds;
+    /**
+     * @brief Observed biomass by species, or by guild if running AGG-PROD
+     */
+    boost::numeric::ublas::matrix<double> ObsBiomassBySpeciesOrGuilds;
+    /**
+     * @brief Observed biomass rescaled with the run's scaling algorithm. Dividing a column
+     * by a positive SurveyQ divides its min, max, and mean by the same amount, so the
+     * rescaled observed biomass doesn't depend on SurveyQ and is only computed once.
+     */
+    boost::numeric::ublas::matrix<double> ObsBiomassBySpeciesOrGuildsRescaled;
+    boost::numeric::ublas::matrix<double> Catch;
+    boost::numeric::ublas::matrix<double> Effort;
+    boost::numeric::ublas::matrix<double> Exploitation;
+    /**
+     * @brief Guild membership in compressed form: the species of guild i are
+     * GuildSpeciesIndex[GuildSpeciesOffset[i]] to GuildSpeciesIndex[GuildSpeciesOffset[i+1]-1]
+     */
+    std::vector<int> GuildSpeciesOffset;
+    std::vector<int> GuildSpeciesIndex;
+    /**
+     * @brief Where each parameter group lives in the estimated parameter vector
+     */
+    NLopt_ParameterLayout Layout;
+    nmfGrowthForm*      GrowthForm;
+    nmfHarvestForm*     HarvestForm;
+    nmfCompetitionForm* CompetitionForm;
+    nmfPredationForm*   PredationForm;
+    /**
+     * @brief Kernels chosen once per run by NLopt_Kernels::selectKernels
+     */
+    NLopt_BiomassKernel BiomassKernel;
+    NLopt_FitnessKernel FitnessKernel;
+    /**
+     * @brief True if the biomass kernel calls a model form object, which needs the
+     * parameters copied into vectors and matrices (see NLopt_Estimator::extractParameters)
+     */
+    bool isFormParameterCopyNeeded;
+    /**
+     * @brief Set by NLopt_Estimator::verifyKernels if NLopt_GenericKernel supports the run
+     * and agrees with the model form objects. Required for the gradient and batch paths.
+     */
+    bool isGenericKernelVerified;
+    /**
+     * @brief Chosen once per run by NLopt_Gradient::selectGradientMode
+     */
+    NLopt_GradientMode  GradientMode;
+};
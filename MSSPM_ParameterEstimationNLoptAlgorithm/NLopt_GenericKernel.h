@@ -0,0 +1,381 @@
+/**
+ * @file NLopt_GenericKernel.h
+ * @brief Definition of the scalar-generic biomass recursion and objective criteria
+ *
+ * This file contains the NLopt_GenericKernel template. It computes the same fitness
+ * as the objective function, reading the parameters directly instead of going through
+ * the model form objects, and is templated on the scalar type so that it can be run
+ * with double, with NLopt_ADVar to get the gradient, or with NLopt_Lanes to evaluate
+ * several candidates at once. Only the model forms and objective criteria whose
+ * equations are written out here are supported; everything else falls back to finite
+ * differences and to one candidate at a time.
+ *
+ * @copyright
+ * Public Domain Notice\n
+ *
+ * National Oceanic And Atmospheric Administration\n\n
+ *
+ * This software is a "United States Government Work" under the terms of the
+ * United States Copyright Act.  It was written as part of the author's official
+ * duties as a United States Government employee/contractor and thus cannot be copyrighted.
+ * This software is freely available to the public for use. The National Oceanic
+ * And Atmospheric Administration and the U.S. Government have not placed any
+ * restriction on its use or reproduction.  Although all reasonable efforts have
+ * been taken to ensure the accuracy and reliability of the software and data,
+ * the National Oceanic And Atmospheric Administration and the U.S. Government
+ * do not and cannot warrant the performance or results that may be obtained
+ * by using this software or data. The National Oceanic And Atmospheric
+ * Administration and the U.S. Government disclaim all warranties, express
+ * or implied, including warranties of performance, merchantability or fitness
+ * for any particular purpose.\n\n
+ *
+ * Please cite the author(s) in any work or product based on this material.
+ */
+
+#pragma once
+
+#include "NLopt_AutoDiff.h"
+#include "NLopt_EvaluationContext.h"
+#include "NLopt_Lanes.h"
+#include "nmfInstrumentation.h"
+
+#include <algorithm>
+#include <vector>
+
+/**
+ * @brief Scratch storage for one scalar type of the generic kernel
+ */
+template<class T>
+struct NLopt_GenericWorkspace {
+    std::vector<T> EstBiomass;         // NumYears x NumSpecies, row major
+    std::vector<T> StartBiomass;       // NumSpecies, the year's starting biomass
+    std::vector<T> Delta;              // NumSpecies, the year's change in biomass
+    std::vector<T> ObsBiomass;         // NumObsYears x NumSpecies, row major (divided by SurveyQ)
+    std::vector<T> EstBiomassRescaled; // NumYears x NumSpecies, row major
+    std::vector<T> ObsBiomassRescaled; // NumYears x NumSpecies, row major
+};
+
+/**
+ * @brief The operations of the generic kernel that differ between scalar types.
+ * Mask is true for a valid scalar; for NLopt_Lanes it holds one flag per lane.
+ */
+template<class T>
+struct NLopt_ScalarTraits {
+    typedef bool Mask;
+
+    static T clampNonNegative(const T& x) {
+        return (valueOf(x) < 0) ? T(0.0) : x;
+    }
+    static T minimum(const T& a, const T& b) {
+        return (valueOf(b) < valueOf(a)) ? b : a;
+    }
+    static T maximum(const T& a, const T& b) {
+        return (valueOf(b) > valueOf(a)) ? b : a;
+    }
+    static bool isPositive(const T& x) {
+        return valueOf(x) > 0;
+    }
+    /**
+     * @brief Flags x if it's not a number
+     * @return Returns false once there's nothing valid left to evaluate
+     */
+    static bool updateValid(const T& x, Mask& isValid) {
+        isValid = ! std::isnan(valueOf(x));
+        return isValid;
+    }
+};
+
+template<int K>
+struct NLopt_ScalarTraits<NLopt_Lanes<K> > {
+    typedef NLopt_LaneMask<K> Mask;
+
+    static NLopt_Lanes<K> clampNonNegative(NLopt_Lanes<K> x) {
+        for (int k=0; k<K; ++k) x.v[k] = (x.v[k] < 0) ? 0.0 : x.v[k];
+        return x;
+    }
+    static NLopt_Lanes<K> minimum(NLopt_Lanes<K> a, const NLopt_Lanes<K>& b) {
+        for (int k=0; k<K; ++k) a.v[k] = (b.v[k] < a.v[k]) ? b.v[k] : a.v[k];
+        return a;
+    }
+    static NLopt_Lanes<K> maximum(NLopt_Lanes<K> a, const NLopt_Lanes<K>& b) {
+        for (int k=0; k<K; ++k) a.v[k] = (b.v[k] > a.v[k]) ? b.v[k] : a.v[k];
+        return a;
+    }
+    static bool isPositive(const NLopt_Lanes<K>& x) {
+        bool retv = true;
+        for (int k=0; k<K; ++k) retv = retv && (x.v[k] > 0);
+        return retv;
+    }
+    // Invalid lanes are carried along with the others rather than stopping the batch
+    static bool updateValid(const NLopt_Lanes<K>& x, Mask& isValid) {
+        for (int k=0; k<K; ++k) isValid.v[k] = isValid.v[k] && ! std::isnan(x.v[k]);
+        return isValid.any();
+    }
+};
+
+/**
+ * @brief Scalar-generic version of the objective function
+ */
+class NLopt_GenericKernel
+{
+public:
+    /**
+     * @brief Checks whether the context's forms and objective criterion are implemented by the generic kernel
+     * @param Context : the evaluation context of the current run
+     * @return Returns true if supported
+     */
+    static bool isSupported(const NLopt_EvaluationContext& Context) {
+        return ((Context.GrowthType      == NLoptNullGrowth)          ||
+                (Context.GrowthType      == NLoptLinearGrowth)        ||
+                (Context.GrowthType      == NLoptLogisticGrowth))     &&
+               ((Context.HarvestType     == NLoptNullHarvest)         ||
+                (Context.HarvestType     == NLoptCatchHarvest)        ||
+                (Context.HarvestType     == NLoptEffortHarvest)       ||
+                (Context.HarvestType     == NLoptExploitationHarvest)) &&
+               ((Context.CompetitionType == NLoptNullCompetition)     ||
+                (Context.CompetitionType == NLoptNoKCompetition))     &&
+               ((Context.PredationType   == NLoptNullPredation)       ||
+                (Context.PredationType   == NLoptTypeIPredation))     &&
+               ((Context.ObjectiveCriterion == NLoptLeastSquares)     ||
+                (Context.ObjectiveCriterion == NLoptModelEfficiency));
+    }
+
+    /**
+     * @brief Calculates the fitness of a set of parameters
+     * @param Context : the evaluation context of the current run (must be supported)
+     * @param Parameters : the estimated parameters, laid out as described by Context.Layout
+     * @param Workspace : scratch storage for the scalar type
+     * @param isValid : set to false (per lane for NLopt_Lanes) if an estimated biomass value was not a number
+     * @return Returns the fitness value
+     */
+    template<class T>
+    static T evaluate(const NLopt_EvaluationContext&         Context,
+                      const T*                               Parameters,
+                      NLopt_GenericWorkspace<T>&             Workspace,
+                      typename NLopt_ScalarTraits<T>::Mask&  isValid)
+    {
+        typedef NLopt_ScalarTraits<T> Traits;
+        int N           = Context.NumSpeciesOrGuilds;
+        int NumYears    = Context.NumYears;
+        int NumObsYears = Context.ObsBiomassBySpeciesOrGuilds.size1();
+        const NLopt_ParameterLayout& Layout = Context.Layout;
+        const T* initBiomass      = Parameters+Layout.InitBiomass.Offset;
+        const T* growthRate       = Parameters+Layout.GrowthRate.Offset;
+        const T* carryingCapacity = Layout.CarryingCapacity.isPresent() ? Parameters+Layout.CarryingCapacity.Offset : nullptr;
+        const T* catchability     = Layout.Catchability.isPresent()     ? Parameters+Layout.Catchability.Offset     : nullptr;
+        const T* alpha            = Layout.CompetitionAlpha.isPresent() ? Parameters+Layout.CompetitionAlpha.Offset : nullptr;
+        const T* rho              = Layout.PredationRho.isPresent()     ? Parameters+Layout.PredationRho.Offset     : nullptr;
+        const T* surveyQ          = Parameters+Layout.SurveyQ.Offset;
+        T biomass;
+        T interaction;
+        std::vector<T>& EstBiomass = Workspace.EstBiomass;
+        std::vector<T>& start      = Workspace.StartBiomass;
+        std::vector<T>& delta      = Workspace.Delta;
+        std::vector<T>& ObsBiomass = Workspace.ObsBiomass;
+
+        isValid = typename Traits::Mask(true);
+
+        EstBiomass.assign(NumYears*N,T(0.0));
+        for (int species=0; species<N; ++species) {
+            EstBiomass[species] = T(Context.InitialObservedBiomass[species]) / surveyQ[species];
+        }
+
+        // A year's terms only depend on the year before, so each term is added to every
+        // species' change in biomass in turn and timed once per year
+        start.resize(N);
+        delta.resize(N);
+        for (int time=1; time<NumYears; ++time) {
+            int timeMinus1 = time - 1;
+            const T* previous = &EstBiomass[timeMinus1*N];
+            for (int species=0; species<N; ++species) {
+                if (Context.isCheckedInitBiomass && (timeMinus1 == 0)) {
+                    start[species] = initBiomass[species];
+                } else {
+                    start[species] = previous[species];
+                }
+                delta[species] = T(0.0);
+            }
+
+            {
+                NMF_INSTRUMENT_SCOPE(nmfPhaseGrowth);
+                switch (Context.GrowthType) {
+                    case NLoptLinearGrowth:
+                        for (int species=0; species<N; ++species) {
+                            delta[species] += growthRate[species]*start[species];
+                        }
+                        break;
+                    case NLoptLogisticGrowth:
+                        for (int species=0; species<N; ++species) {
+                            delta[species] += growthRate[species]*start[species]*(T(1.0)-start[species]/carryingCapacity[species]);
+                        }
+                        break;
+                    default:
+                        break;
+                }
+            }
+            {
+                NMF_INSTRUMENT_SCOPE(nmfPhaseHarvest);
+                switch (Context.HarvestType) {
+                    case NLoptCatchHarvest:
+                        for (int species=0; species<N; ++species) {
+                            delta[species] -= T(Context.Catch(timeMinus1,species));
+                        }
+                        break;
+                    case NLoptEffortHarvest:
+                        for (int species=0; species<N; ++species) {
+                            delta[species] -= catchability[species]*T(Context.Effort(timeMinus1,species))*start[species];
+                        }
+                        break;
+                    case NLoptExploitationHarvest:
+                        for (int species=0; species<N; ++species) {
+                            delta[species] -= T(Context.Exploitation(timeMinus1,species))*start[species];
+                        }
+                        break;
+                    default:
+                        break;
+                }
+            }
+            if (alpha != nullptr) {
+                NMF_INSTRUMENT_SCOPE(nmfPhaseCompetition);
+                for (int species=0; species<N; ++species) {
+                    interaction = interact(Layout.CompetitionAlphaPattern,alpha+species*N,previous,N,species);
+                    delta[species] -= interaction*start[species];
+                }
+            }
+            if (rho != nullptr) {
+                NMF_INSTRUMENT_SCOPE(nmfPhasePredation);
+                for (int species=0; species<N; ++species) {
+                    interaction = interact(Layout.PredationRhoPattern,rho+species*N,previous,N,species);
+                    delta[species] -= interaction*start[species];
+                }
+            }
+
+            for (int species=0; species<N; ++species) {
+                biomass = Traits::clampNonNegative(start[species]+delta[species]);
+                if (! Traits::updateValid(biomass,isValid)) {
+                    return T(0.0);
+                }
+                EstBiomass[time*N+species] = biomass;
+            }
+        }
+
+        // Scale the data (observed statistics use the same rows as rescaleMinMax/rescaleMean)
+        {
+            NMF_INSTRUMENT_SCOPE(nmfPhaseScaling);
+            Workspace.EstBiomassRescaled.resize(NumYears*N);
+            Workspace.ObsBiomassRescaled.resize(NumYears*N);
+            bool isMean = (Context.ScalingAlgorithm == NLoptMeanScaling);
+            rescale(EstBiomass,NumYears,NumYears,N,isMean,Workspace.EstBiomassRescaled);
+            if (std::all_of(surveyQ,surveyQ+N,[](const T& q) { return Traits::isPositive(q); })) {
+                // Doesn't depend on SurveyQ (see NLopt_EvaluationContext::ObsBiomassBySpeciesOrGuildsRescaled)
+                for (int time=0; time<NumYears; ++time) {
+                    for (int species=0; species<N; ++species) {
+                        Workspace.ObsBiomassRescaled[time*N+species] = T(Context.ObsBiomassBySpeciesOrGuildsRescaled(time,species));
+                    }
+                }
+            } else {
+                ObsBiomass.resize(NumObsYears*N);
+                for (int time=0; time<NumObsYears; ++time) {
+                    for (int species=0; species<N; ++species) {
+                        ObsBiomass[time*N+species] = T(Context.ObsBiomassBySpeciesOrGuilds(time,species)) / surveyQ[species];
+                    }
+                }
+                rescale(ObsBiomass,(isMean ? NumObsYears : NumYears),NumYears,N,isMean,Workspace.ObsBiomassRescaled);
+            }
+        }
+
+        NMF_INSTRUMENT_SCOPE(nmfPhaseFitness);
+        if (Context.ObjectiveCriterion == NLoptModelEfficiency) {
+            return -modelEfficiency(Workspace.EstBiomassRescaled,Workspace.ObsBiomassRescaled,NumYears,N);
+        }
+        return sumOfSquares(Workspace.EstBiomassRescaled,Workspace.ObsBiomassRescaled);
+    }
+
+private:
+    /**
+     * @brief Sum of a species' interaction coefficients times last year's biomass, over
+     * the declared links only if the matrix is sparse
+     */
+    template<class T>
+    static T interact(const NLopt_InteractionPattern& Pattern,
+                      const T* Coefficients,
+                      const T* Previous,
+                      const int& N,
+                      const int& Species)
+    {
+        T sum = T(0.0);
+        if (Pattern.isSparse) {
+            for (int k=Pattern.RowOffset[Species]; k<Pattern.RowOffset[Species+1]; ++k) {
+                const int& j = Pattern.Column[k];
+                sum += Coefficients[j]*Previous[j];
+            }
+        } else {
+            for (int j=0; j<N; ++j) {
+                sum += Coefficients[j]*Previous[j];
+            }
+        }
+        return sum;
+    }
+
+    template<class T>
+    static void rescale(const std::vector<T>& Matrix,
+                        const int& NumStatsYears,
+                        const int& NumYears,
+                        const int& N,
+                        const bool& isMean,
+                        std::vector<T>& Rescaled)
+    {
+        for (int species=0; species<N; ++species) {
+            T minVal = Matrix[species];
+            T maxVal = Matrix[species];
+            T avgVal = T(0.0);
+            for (int time=0; time<NumStatsYears; ++time) {
+                const T& val = Matrix[time*N+species];
+                minVal  = NLopt_ScalarTraits<T>::minimum(minVal,val);
+                maxVal  = NLopt_ScalarTraits<T>::maximum(maxVal,val);
+                avgVal += val;
+            }
+            T center = (isMean) ? avgVal/T(double(NumStatsYears)) : minVal;
+            T den    = maxVal - minVal;
+            for (int time=0; time<NumYears; ++time) {
+                Rescaled[time*N+species] = (Matrix[time*N+species] - center) / den;
+            }
+        }
+    }
+
+    template<class T>
+    static T sumOfSquares(const std::vector<T>& Est,
+                          const std::vector<T>& Obs)
+    {
+        T sum = T(0.0);
+        for (unsigned i=0; i<Est.size(); ++i) {
+            T diff = Est[i] - Obs[i];
+            sum += diff*diff;
+        }
+        return sum;
+    }
+
+    template<class T>
+    static T modelEfficiency(const std::vector<T>& Est,
+                             const std::vector<T>& Obs,
+                             const int& NumYears,
+                             const int& N)
+    {
+        T numerator   = T(0.0);
+        T denominator = T(0.0);
+        for (int species=0; species<N; ++species) {
+            T mean = T(0.0);
+            for (int time=0; time<NumYears; ++time) {
+                mean += Obs[time*N+species];
+            }
+            mean /= T(double(NumYears));
+            for (int time=0; time<NumYears; ++time) {
+                T diffEst  = Obs[time*N+species] - Est[time*N+species];
+                T diffMean = Obs[time*N+species] - mean;
+                numerator   += diffEst*diffEst;
+                denominator += diffMean*diffMean;
+            }
+        }
+        return T(1.0) - numerator/denominator;
+    }
+};
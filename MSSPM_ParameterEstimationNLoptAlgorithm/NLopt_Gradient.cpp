@@ -0,0 +1,75 @@
+#include "NLopt_Gradient.h"
+#include "NLopt_Estimator.h"
+#include "NLopt_GenericKernel.h"
+
+#include <iostream>
+
+
+void
+NLopt_Gradient::selectGradientMode(NLopt_EvaluationContext&   Context)
+{
+    // NLopt_Estimator::verifyKernels has already checked the generic kernel against
+    // the model form objects at the starting point
+    if (Context.isGenericKernelVerified) {
+        Context.GradientMode = NLoptAutoDiffGradient;
+        std::cout << "Gradient: using automatic differentiation." << std::endl;
+    } else {
+        Context.GradientMode = NLoptFiniteDifferenceGradient;
+        std::cout << "Gradient: model forms not supported by automatic differentiation. Using finite differences." << std::endl;
+    }
+}
+
+
+void
+NLopt_Gradient::calculate(const NLopt_EvaluationContext& Context,
+                          const NLopt_ParameterMapping&  Mapping,
+                          const double*                  EstParameters,
+                          double*                        Gradient)
+{
+    int NumParameters = Mapping.getNumParameters();
+    int NumFreeParameters = Mapping.getNumFreeParameters();
+
+    if (Context.GradientMode == NLoptAutoDiffGradient) {
+        bool isValid;
+        thread_local std::vector<NLopt_ADVar> Parameters;
+        thread_local std::vector<double> FullGradient;
+        thread_local NLopt_GenericWorkspace<NLopt_ADVar> Workspace;
+        NLopt_Tape& tape = NLopt_Tape::active();
+
+        // The inputs must be the first nodes on the tape
+        tape.clear();
+        Parameters.resize(NumParameters);
+        for (int i=0; i<NumParameters; ++i) {
+            Parameters[i] = NLopt_ADVar::input(EstParameters[i]);
+        }
+        NLopt_ADVar fitness = NLopt_GenericKernel::evaluate(Context,Parameters.data(),Workspace,isValid);
+        if (isValid) {
+            FullGradient.resize(NumParameters);
+            tape.gradient(fitness.Index,NumParameters,FullGradient.data());
+            Mapping.gather(FullGradient.data(),Gradient);
+        } else {
+            std::fill(Gradient,Gradient+NumFreeParameters,0.0);
+        }
+        return;
+    }
+
+    // Central finite differences, only in the free directions
+    int index;
+    double h;
+    double fitnessPlus;
+    double fitnessMinus;
+    thread_local std::vector<double> Parameters;
+    const std::vector<int>& FreeIndex = Mapping.getFreeIndices();
+
+    Parameters.assign(EstParameters,EstParameters+NumParameters);
+    for (int i=0; i<NumFreeParameters; ++i) {
+        index = FreeIndex[i];
+        h = 1e-6*std::max(1.0,std::fabs(EstParameters[index]));
+        Parameters[index] = EstParameters[index] + h;
+        fitnessPlus       = NLopt_Estimator::evaluateObjective(Context,Parameters.data());
+        Parameters[index] = EstParameters[index] - h;
+        fitnessMinus      = NLopt_Estimator::evaluateObjective(Context,Parameters.data());
+        Parameters[index] = EstParameters[index];
+        Gradient[i]       = (fitnessPlus-fitnessMinus)/(2.0*h);
+    }
+}
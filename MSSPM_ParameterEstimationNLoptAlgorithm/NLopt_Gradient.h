@@ -0,0 +1,61 @@
+/**
+ * @file NLopt_Gradient.h
+ * @brief Definition of the gradient calculation used by the derivative based NLopt minimizers
+ *
+ * This file contains the NLopt_Gradient class. When the run's model forms and objective
+ * criterion are supported by the generic kernel, the gradient is found with reverse mode
+ * automatic differentiation. Otherwise it's found with central finite differences.
+ *
+ * @copyright
+ * Public Domain Notice\n
+ *
+ * National Oceanic And Atmospheric Administration\n\n
+ *
+ * This software is a "United States Government Work" under the terms of the
+ * United States Copyright Act.  It was written as part of the author's official
+ * duties as a United States Government employee/contractor and thus cannot be copyrighted.
+ * This software is freely available to the public for use. The National Oceanic
+ * And Atmospheric Administration and the U.S. Government have not placed any
+ * restriction on its use or reproduction.  Although all reasonable efforts have
+ * been taken to ensure the accuracy and reliability of the software and data,
+ * the National Oceanic And Atmospheric Administration and the U.S. Government
+ * do not and cannot warrant the performance or results that may be obtained
+ * by using this software or data. The National Oceanic And Atmospheric
+ * Administration and the U.S. Government disclaim all warranties, express
+ * or implied, including warranties of performance, merchantability or fitness
+ * for any particular purpose.\n\n
+ *
+ * Please cite the author(s) in any work or product based on this material.
+ */
+
+#pragma once
+
+#include "NLopt_EvaluationContext.h"
+#include "NLopt_ParameterMapping.h"
+
+#include <vector>
+
+/**
+ * @brief Fills in the objective function gradient for the LD_* and GD_* minimizers
+ */
+class NLopt_Gradient
+{
+public:
+    /**
+     * @brief Chooses automatic differentiation if the generic kernel has been verified
+     * for the run, otherwise finite differences
+     * @param Context : the evaluation context whose gradient mode is to be set
+     */
+    static void selectGradientMode(NLopt_EvaluationContext& Context);
+    /**
+     * @brief Calculates the gradient of the fitness with respect to the free parameters
+     * @param Context : the evaluation context of the current run
+     * @param Mapping : the run's free parameters
+     * @param EstParameters : all of the model's parameter values
+     * @param Gradient : the Mapping.getNumFreeParameters() derivatives to fill in
+     */
+    static void calculate(const NLopt_EvaluationContext& Context,
+                          const NLopt_ParameterMapping&  Mapping,
+                          const double*                  EstParameters,
+                          double*                        Gradient);
+};
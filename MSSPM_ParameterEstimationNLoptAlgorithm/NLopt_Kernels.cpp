@@ -0,0 +1,114 @@
+#include "NLopt_Kernels.h"
+
+using namespace NLopt_Kernel;
+
+namespace {
+
+template<class Growth, class Harvest, class Competition>
+NLopt_BiomassKernel
+selectPredation(const NLopt_EvaluationContext& Context)
+{
+    switch (Context.PredationType) {
+        case NLoptNullPredation:
+            return &simulateBiomass<Growth,Harvest,Competition,NullPredation>;
+        case NLoptTypeIPredation:
+            return &simulateBiomass<Growth,Harvest,Competition,TypeIPredation>;
+        default:
+            return &simulateBiomass<Growth,Harvest,Competition,FormPredation>;
+    }
+}
+
+template<class Growth, class Harvest>
+NLopt_BiomassKernel
+selectCompetition(const NLopt_EvaluationContext& Context)
+{
+    switch (Context.CompetitionType) {
+        case NLoptNullCompetition:
+            return selectPredation<Growth,Harvest,NullCompetition>(Context);
+        case NLoptNoKCompetition:
+            return selectPredation<Growth,Harvest,NoKCompetition>(Context);
+        default:
+            return selectPredation<Growth,Harvest,FormCompetition>(Context);
+    }
+}
+
+template<class Growth>
+NLopt_BiomassKernel
+selectHarvest(const NLopt_EvaluationContext& Context)
+{
+    switch (Context.HarvestType) {
+        case NLoptNullHarvest:
+            return selectCompetition<Growth,NullHarvest>(Context);
+        case NLoptCatchHarvest:
+            return selectCompetition<Growth,CatchHarvest>(Context);
+        case NLoptEffortHarvest:
+            return selectCompetition<Growth,EffortHarvest>(Context);
+        case NLoptExploitationHarvest:
+            return selectCompetition<Growth,ExploitationHarvest>(Context);
+        default:
+            return selectCompetition<Growth,FormHarvest>(Context);
+    }
+}
+
+NLopt_BiomassKernel
+selectGrowth(const NLopt_EvaluationContext& Context)
+{
+    switch (Context.GrowthType) {
+        case NLoptNullGrowth:
+            return selectHarvest<NullGrowth>(Context);
+        case NLoptLinearGrowth:
+            return selectHarvest<LinearGrowth>(Context);
+        case NLoptLogisticGrowth:
+            return selectHarvest<LogisticGrowth>(Context);
+        default:
+            return selectHarvest<FormGrowth>(Context);
+    }
+}
+
+template<class Scaling>
+NLopt_FitnessKernel
+selectObjective(const NLopt_EvaluationContext& Context)
+{
+    switch (Context.ObjectiveCriterion) {
+        case NLoptLeastSquares:
+            return &calculateFitness<Scaling,LeastSquares>;
+        case NLoptModelEfficiency:
+            return &calculateFitness<Scaling,ModelEfficiency>;
+        case NLoptMaximumLikelihood:
+            return &calculateFitness<Scaling,MaximumLikelihood>;
+        default:
+            return &calculateFitness<Scaling,UnknownCriterion>;
+    }
+}
+
+}
+
+
+void
+NLopt_Kernels::selectKernels(NLopt_EvaluationContext& Context)
+{
+    Context.BiomassKernel = selectGrowth(Context);
+    Context.isFormParameterCopyNeeded =
+            ((Context.GrowthType      != NLoptNullGrowth)      &&
+             (Context.GrowthType      != NLoptLinearGrowth)    &&
+             (Context.GrowthType      != NLoptLogisticGrowth)) ||
+             (Context.HarvestType     == NLoptUnknownHarvest)  ||
+            ((Context.CompetitionType != NLoptNullCompetition) &&
+             (Context.CompetitionType != NLoptNoKCompetition)) ||
+            ((Context.PredationType   != NLoptNullPredation)   &&
+             (Context.PredationType   != NLoptTypeIPredation));
+
+    if (Context.ScalingAlgorithm == NLoptMeanScaling) {
+        Context.FitnessKernel = selectObjective<MeanScaling>(Context);
+    } else {
+        Context.FitnessKernel = selectObjective<MinMaxScaling>(Context);
+    }
+}
+
+
+void
+NLopt_Kernels::selectFormKernels(NLopt_EvaluationContext& Context)
+{
+    Context.BiomassKernel = &simulateBiomass<FormGrowth,FormHarvest,FormCompetition,FormPredation>;
+    Context.isFormParameterCopyNeeded = true;
+}
@@ -0,0 +1,471 @@
+/**
+ * @file NLopt_Kernels.h
+ * @brief Definition of the model form kernels used by the NLopt objective function
+ *
+ * This file contains the form tags and the biomass and fitness kernel templates.
+ * A kernel is instantiated for every supported combination of growth, harvest,
+ * competition, and predation forms (and for every scaling algorithm and objective
+ * criterion) and the right one is picked once per run, so the objective function
+ * doesn't need to compare strings or call through the model form objects for the
+ * forms that are simple enough to be written inline.
+ *
+ * @copyright
+ * Public Domain Notice\n
+ *
+ * National Oceanic And Atmospheric Administration\n\n
+ *
+ * This software is a "United States Government Work" under the terms of the
+ * United States Copyright Act.  It was written as part of the author's official
+ * duties as a United States Government employee/contractor and thus cannot be copyrighted.
+ * This software is freely available to the public for use. The National Oceanic
+ * And Atmospheric Administration and the U.S. Government have not placed any
+ * restriction on its use or reproduction.  Although all reasonable efforts have
+ * been taken to ensure the accuracy and reliability of the software and data,
+ * the National Oceanic And Atmospheric Administration and the U.S. Government
+ * do not and cannot warrant the performance or results that may be obtained
+ * by using this software or data. The National Oceanic And Atmospheric
+ * Administration and the U.S. Government disclaim all warranties, express
+ * or implied, including warranties of performance, merchantability or fitness
+ * for any particular purpose.\n\n
+ *
+ * Please cite the author(s) in any work or product based on this material.
+ */
+
+#pragma once
+
+#include "NLopt_Estimator.h"
+#include "nmfInstrumentation.h"
+
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @brief Form tags and kernel templates instantiated by NLopt_Kernels::selectKernels
+ */
+namespace NLopt_Kernel {
+
+// Growth form tags
+
+struct NullGrowth {
+    static double evaluate(const NLopt_EvaluationContext& Context, const NLopt_Workspace& Workspace,
+                           const int& Species, const double& Biomass) {
+        return 0;
+    }
+};
+
+struct LinearGrowth {
+    static double evaluate(const NLopt_EvaluationContext& Context, const NLopt_Workspace& Workspace,
+                           const int& Species, const double& Biomass) {
+        return Workspace.Parameters.GrowthRate[Species]*Biomass;
+    }
+};
+
+struct LogisticGrowth {
+    static double evaluate(const NLopt_EvaluationContext& Context, const NLopt_Workspace& Workspace,
+                           const int& Species, const double& Biomass) {
+        const NLopt_ParameterViews<double>& Parameters = Workspace.Parameters;
+        return Parameters.GrowthRate[Species]*Biomass*(1.0-Biomass/Parameters.CarryingCapacity[Species]);
+    }
+};
+
+struct FormGrowth {
+    static double evaluate(const NLopt_EvaluationContext& Context, const NLopt_Workspace& Workspace,
+                           const int& Species, const double& Biomass) {
+        return Context.GrowthForm->evaluate(Species,Biomass,
+                                            Workspace.GrowthRate,Workspace.CarryingCapacity);
+    }
+};
+
+// Harvest form tags
+
+struct NullHarvest {
+    static double evaluate(const NLopt_EvaluationContext& Context, const NLopt_Workspace& Workspace,
+                           const int& TimeMinus1, const int& Species, const double& Biomass) {
+        return 0;
+    }
+};
+
+struct CatchHarvest {
+    static double evaluate(const NLopt_EvaluationContext& Context, const NLopt_Workspace& Workspace,
+                           const int& TimeMinus1, const int& Species, const double& Biomass) {
+        return Context.Catch(TimeMinus1,Species);
+    }
+};
+
+struct EffortHarvest {
+    static double evaluate(const NLopt_EvaluationContext& Context, const NLopt_Workspace& Workspace,
+                           const int& TimeMinus1, const int& Species, const double& Biomass) {
+        return Workspace.Parameters.Catchability[Species]*Context.Effort(TimeMinus1,Species)*Biomass;
+    }
+};
+
+struct ExploitationHarvest {
+    static double evaluate(const NLopt_EvaluationContext& Context, const NLopt_Workspace& Workspace,
+                           const int& TimeMinus1, const int& Species, const double& Biomass) {
+        return Context.Exploitation(TimeMinus1,Species)*Biomass;
+    }
+};
+
+struct FormHarvest {
+    static double evaluate(const NLopt_EvaluationContext& Context, const NLopt_Workspace& Workspace,
+                           const int& TimeMinus1, const int& Species, const double& Biomass) {
+        return Context.HarvestForm->evaluate(TimeMinus1,Species,
+                                             Context.Catch,Context.Effort,Context.Exploitation,
+                                             Biomass,Workspace.CatchabilityRate);
+    }
+};
+
+/**
+ * @brief Sum of a species' interaction coefficients times last year's biomass, over
+ * the declared links only if the matrix is sparse
+ */
+inline double interact(const NLopt_InteractionPattern& Pattern, const double* Coefficients,
+                       const NLopt_EvaluationContext& Context, const NLopt_Workspace& Workspace,
+                       const int& TimeMinus1, const int& Species) {
+    double sum = 0;
+    if (Pattern.isSparse) {
+        for (int k=Pattern.RowOffset[Species]; k<Pattern.RowOffset[Species+1]; ++k) {
+            const int& j = Pattern.Column[k];
+            sum += Coefficients[j]*Workspace.EstBiomassSpecies(TimeMinus1,j);
+        }
+    } else {
+        for (int j=0; j<Context.NumSpeciesOrGuilds; ++j) {
+            sum += Coefficients[j]*Workspace.EstBiomassSpecies(TimeMinus1,j);
+        }
+    }
+    return sum;
+}
+
+// Competition form tags. UsesGuilds is false for the forms that never read the guild
+// biomass, which lets the kernel skip the per-year guild aggregation.
+
+struct NullCompetition {
+    static const bool UsesGuilds = false;
+    static double evaluate(const NLopt_EvaluationContext& Context, const NLopt_Workspace& Workspace,
+                           const int& TimeMinus1, const int& Species, const double& Biomass,
+                           const double& SystemCarryingCapacity, const double& GuildCarryingCapacity) {
+        return 0;
+    }
+};
+
+struct NoKCompetition {
+    static const bool UsesGuilds = false;
+    static double evaluate(const NLopt_EvaluationContext& Context, const NLopt_Workspace& Workspace,
+                           const int& TimeMinus1, const int& Species, const double& Biomass,
+                           const double& SystemCarryingCapacity, const double& GuildCarryingCapacity) {
+        return interact(Context.Layout.CompetitionAlphaPattern,
+                        Workspace.Parameters.CompetitionAlpha.row(Species),
+                        Context,Workspace,TimeMinus1,Species)*Biomass;
+    }
+};
+
+struct SpeciesFormCompetition {
+    static const bool UsesGuilds = false;
+    static double evaluate(const NLopt_EvaluationContext& Context, const NLopt_Workspace& Workspace,
+                           const int& TimeMinus1, const int& Species, const double& Biomass,
+                           const double& SystemCarryingCapacity, const double& GuildCarryingCapacity) {
+        return Context.CompetitionForm->evaluate(TimeMinus1,Species,Biomass,
+                                                 SystemCarryingCapacity,
+                                                 Workspace.GrowthRate,
+                                                 GuildCarryingCapacity,
+                                                 Workspace.CompetitionAlpha,
+                                                 Workspace.CompetitionBetaSpecies,
+                                                 Workspace.CompetitionBetaGuilds,
+                                                 Workspace.CompetitionBetaGuildsGuilds,
+                                                 Workspace.EstBiomassSpecies,
+                                                 Workspace.EstBiomassGuilds);
+    }
+};
+
+struct FormCompetition {
+    static const bool UsesGuilds = true;
+    static double evaluate(const NLopt_EvaluationContext& Context, const NLopt_Workspace& Workspace,
+                           const int& TimeMinus1, const int& Species, const double& Biomass,
+                           const double& SystemCarryingCapacity, const double& GuildCarryingCapacity) {
+        return SpeciesFormCompetition::evaluate(Context,Workspace,TimeMinus1,Species,Biomass,
+                                                SystemCarryingCapacity,GuildCarryingCapacity);
+    }
+};
+
+// Predation form tags
+
+struct NullPredation {
+    static double evaluate(const NLopt_EvaluationContext& Context, const NLopt_Workspace& Workspace,
+                           const int& TimeMinus1, const int& Species, const double& Biomass) {
+        return 0;
+    }
+};
+
+struct TypeIPredation {
+    static double evaluate(const NLopt_EvaluationContext& Context, const NLopt_Workspace& Workspace,
+                           const int& TimeMinus1, const int& Species, const double& Biomass) {
+        return interact(Context.Layout.PredationRhoPattern,
+                        Workspace.Parameters.PredationRho.row(Species),
+                        Context,Workspace,TimeMinus1,Species)*Biomass;
+    }
+};
+
+struct FormPredation {
+    static double evaluate(const NLopt_EvaluationContext& Context, const NLopt_Workspace& Workspace,
+                           const int& TimeMinus1, const int& Species, const double& Biomass) {
+        return Context.PredationForm->evaluate(TimeMinus1,Species,
+                                               Workspace.PredationRho,
+                                               Workspace.PredationHandling,
+                                               Workspace.PredationExponent,
+                                               Workspace.EstBiomassSpecies,Biomass);
+    }
+};
+
+// Scaling tags
+
+struct MinMaxScaling {
+    static void rescale(const boost::numeric::ublas::matrix<double>& Matrix,
+                        boost::numeric::ublas::matrix<double>&       RescaledMatrix) {
+        NLopt_Estimator::rescaleMinMax(Matrix,RescaledMatrix);
+    }
+};
+
+struct MeanScaling {
+    static void rescale(const boost::numeric::ublas::matrix<double>& Matrix,
+                        boost::numeric::ublas::matrix<double>&       RescaledMatrix) {
+        NLopt_Estimator::rescaleMean(Matrix,RescaledMatrix);
+    }
+};
+
+// Objective criterion tags. UsesRescaled is false for the criteria that work on the
+// unscaled biomass, which lets the fitness kernel skip the rescaling.
+
+struct LeastSquares {
+    static const bool UsesRescaled = true;
+    static double evaluate(const boost::numeric::ublas::matrix<double>& EstBiomass,
+                           const boost::numeric::ublas::matrix<double>& ObsBiomass) {
+        return nmfUtilsStatistics::calculateSumOfSquares(EstBiomass,ObsBiomass);
+    }
+};
+
+struct ModelEfficiency {
+    static const bool UsesRescaled = true;
+    static double evaluate(const boost::numeric::ublas::matrix<double>& EstBiomass,
+                           const boost::numeric::ublas::matrix<double>& ObsBiomass) {
+        // Negate the MEF here since the ranges is from -inf to 1, where 1 is best.  So we negate it,
+        // then minimize that, and then negate and plot the resulting value.
+        return -nmfUtilsStatistics::calculateModelEfficiency(EstBiomass,ObsBiomass);
+    }
+};
+
+struct MaximumLikelihood {
+    static const bool UsesRescaled = false;
+    static double evaluate(const boost::numeric::ublas::matrix<double>& EstBiomass,
+                           const boost::numeric::ublas::matrix<double>& ObsBiomass) {
+        // The maximum likelihood calculations must use the unscaled data or else the
+        // results will be incorrect.
+        return nmfUtilsStatistics::calculateMaximumLikelihoodNoRescale(EstBiomass,ObsBiomass);
+    }
+};
+
+struct UnknownCriterion {
+    static const bool UsesRescaled = false;
+    static double evaluate(const boost::numeric::ublas::matrix<double>& EstBiomass,
+                           const boost::numeric::ublas::matrix<double>& ObsBiomass) {
+        return 0;
+    }
+};
+
+/**
+ * @brief Steps the biomass forward from year 1 to NumYears-1 for one combination of
+ * model forms. Year 0 and the extracted parameters must already be in the workspace.
+ * A year's terms only depend on the year before, so each term is calculated for every
+ * species in turn and timed once per year, and then the terms are added up.
+ * @param Context : the evaluation context of the current run
+ * @param Workspace : the calling thread's workspace
+ * @param SystemCarryingCapacity : system carrying capacity passed to the competition form
+ * @return Returns false if an estimated biomass value is negative or not a number, or if
+ * the workspace's early abandon bound shows the fitness can't beat the incumbent
+ */
+template<class Growth, class Harvest, class Competition, class Predation>
+bool simulateBiomass(const NLopt_EvaluationContext& Context,
+                     NLopt_Workspace&               Workspace,
+                     const double&                  SystemCarryingCapacity)
+{
+    double EstBiomassVal;
+    int timeMinus1;
+    int NumYears  = Context.NumYears;
+    int NumGuilds = Context.NumGuilds;
+    int NumSpeciesOrGuilds = Context.NumSpeciesOrGuilds;
+    // RSK - guild number is always the first guild for now
+    double GuildCarryingCapacity = (NumGuilds > 0) ? Workspace.GuildCarryingCapacity[0] : 0;
+    const std::vector<int>& GuildSpeciesOffset = Context.GuildSpeciesOffset;
+    const std::vector<int>& GuildSpeciesIndex  = Context.GuildSpeciesIndex;
+    const NLopt_VectorView<double>& InitBiomass = Workspace.Parameters.InitBiomass;
+    boost::numeric::ublas::matrix<double>& EstBiomassSpecies = Workspace.EstBiomassSpecies;
+    boost::numeric::ublas::matrix<double>& EstBiomassGuilds  = Workspace.EstBiomassGuilds;
+    std::vector<double>& StartBiomass    = Workspace.StartBiomass;
+    std::vector<double>& GrowthTerm      = Workspace.GrowthTerm;
+    std::vector<double>& HarvestTerm     = Workspace.HarvestTerm;
+    std::vector<double>& CompetitionTerm = Workspace.CompetitionTerm;
+    std::vector<double>& PredationTerm   = Workspace.PredationTerm;
+    NLopt_EarlyAbandon& EarlyAbandon = Workspace.EarlyAbandon;
+
+    if (EarlyAbandon.isActive()) {
+        for (int species=0; species<NumSpeciesOrGuilds; ++species) {
+            EarlyAbandon.add(species,EstBiomassSpecies(0,species),
+                             Context.ObsBiomassBySpeciesOrGuildsRescaled(0,species));
+        }
+    }
+
+    for (int time=1; time<NumYears; ++time) {
+
+        timeMinus1 = time - 1;
+        for (int species=0; species<NumSpeciesOrGuilds; ++species) {
+            if (Context.isCheckedInitBiomass && (timeMinus1 == 0)) { // if estimating the initial biomass
+                StartBiomass[species] = InitBiomass[species];
+            } else {
+                StartBiomass[species] = EstBiomassSpecies(timeMinus1,species);
+            }
+        }
+
+        {
+            NMF_INSTRUMENT_SCOPE(nmfPhaseGrowth);
+            for (int species=0; species<NumSpeciesOrGuilds; ++species) {
+                GrowthTerm[species] = Growth::evaluate(Context,Workspace,species,StartBiomass[species]);
+            }
+        }
+        {
+            NMF_INSTRUMENT_SCOPE(nmfPhaseHarvest);
+            for (int species=0; species<NumSpeciesOrGuilds; ++species) {
+                HarvestTerm[species] = Harvest::evaluate(Context,Workspace,timeMinus1,species,StartBiomass[species]);
+            }
+        }
+        {
+            NMF_INSTRUMENT_SCOPE(nmfPhaseCompetition);
+            for (int species=0; species<NumSpeciesOrGuilds; ++species) {
+                CompetitionTerm[species] = Competition::evaluate(Context,Workspace,timeMinus1,species,StartBiomass[species],
+                                                                 SystemCarryingCapacity,GuildCarryingCapacity);
+            }
+        }
+        {
+            NMF_INSTRUMENT_SCOPE(nmfPhasePredation);
+            for (int species=0; species<NumSpeciesOrGuilds; ++species) {
+                PredationTerm[species] = Predation::evaluate(Context,Workspace,timeMinus1,species,StartBiomass[species]);
+            }
+        }
+
+        for (int species=0; species<NumSpeciesOrGuilds; ++species) {
+            EstBiomassVal  = StartBiomass[species];
+            EstBiomassVal += GrowthTerm[species] - HarvestTerm[species] - CompetitionTerm[species] - PredationTerm[species];
+
+            if (EstBiomassVal < 0) { // test code only
+                EstBiomassVal = 0;
+            }
+
+            if ((EstBiomassVal < 0) || (std::isnan(std::fabs(EstBiomassVal)))) {
+                return false;
+            }
+
+            EstBiomassSpecies(time,species) = EstBiomassVal;
+        } // end species
+
+        // update EstBiomassGuilds for next time step. The guilds are added up once per
+        // species, as each species is updated, so a species not yet updated this year
+        // (still 0) is left out of the sums made before its own update.
+        if (Competition::UsesGuilds) {
+            NMF_INSTRUMENT_SCOPE(nmfPhaseGuildAggregation);
+            for (int species=0; species<NumSpeciesOrGuilds; ++species) {
+                for (int i=0; i<NumGuilds; ++i) {
+                    for (int j=GuildSpeciesOffset[i]; j<GuildSpeciesOffset[i+1]; ++j) {
+                        if (GuildSpeciesIndex[j] <= species) {
+                            EstBiomassGuilds(time,i) += EstBiomassSpecies(time,GuildSpeciesIndex[j]);
+                        }
+                    }
+                }
+            }
+        }
+
+        if (EarlyAbandon.isActive()) {
+            for (int species=0; species<NumSpeciesOrGuilds; ++species) {
+                EarlyAbandon.add(species,EstBiomassSpecies(time,species),
+                                 Context.ObsBiomassBySpeciesOrGuildsRescaled(time,species));
+            }
+            if (EarlyAbandon.isWorse()) {
+                return false;
+            }
+        }
+    } // end time
+
+    return true;
+}
+
+/**
+ * @brief Divides the observed biomass by SurveyQ (needed by the unscaled criteria, or
+ * if a SurveyQ isn't positive and the cached rescaled observed biomass can't be used)
+ * @param Context : the evaluation context of the current run
+ * @param Workspace : the calling thread's workspace holding the SurveyQ parameters
+ */
+inline void divideObservedBySurveyQ(const NLopt_EvaluationContext& Context,
+                                    NLopt_Workspace&               Workspace)
+{
+    double surveyQVal;
+    const boost::numeric::ublas::matrix<double>& ObsBiomass = Context.ObsBiomassBySpeciesOrGuilds;
+
+    for (int species=0; species<int(ObsBiomass.size2()); ++species) {
+        surveyQVal = Workspace.Parameters.SurveyQ[species];
+        for (int time=0; time<int(ObsBiomass.size1()); ++time) {
+            Workspace.ObsBiomassBySpeciesOrGuilds(time,species) = ObsBiomass(time,species) / surveyQVal;
+        }
+    }
+}
+
+/**
+ * @brief Rescales the estimated biomass and calculates the fitness
+ * @param Context : the evaluation context of the current run
+ * @param Workspace : the calling thread's workspace holding the estimated biomass and SurveyQ
+ * @return Returns the fitness value
+ */
+template<class Scaling, class Objective>
+double calculateFitness(const NLopt_EvaluationContext& Context,
+                        NLopt_Workspace&               Workspace)
+{
+    if (Objective::UsesRescaled) {
+        const boost::numeric::ublas::matrix<double>* ObsBiomassRescaled = &Context.ObsBiomassBySpeciesOrGuildsRescaled;
+        {
+            NMF_INSTRUMENT_SCOPE(nmfPhaseScaling);
+            Scaling::rescale(Workspace.EstBiomassSpecies,
+                             Workspace.EstBiomassRescaled);
+            if (! std::all_of(Workspace.Parameters.SurveyQ.begin(),Workspace.Parameters.SurveyQ.end(),
+                              [](const double& q) { return q > 0; })) {
+                divideObservedBySurveyQ(Context,Workspace);
+                Scaling::rescale(Workspace.ObsBiomassBySpeciesOrGuilds,
+                                 Workspace.ObsBiomassBySpeciesOrGuildsRescaled);
+                ObsBiomassRescaled = &Workspace.ObsBiomassBySpeciesOrGuildsRescaled;
+            }
+        }
+        NMF_INSTRUMENT_SCOPE(nmfPhaseFitness);
+        return Objective::evaluate(Workspace.EstBiomassRescaled,*ObsBiomassRescaled);
+    }
+    divideObservedBySurveyQ(Context,Workspace);
+    NMF_INSTRUMENT_SCOPE(nmfPhaseFitness);
+    return Objective::evaluate(Workspace.EstBiomassSpecies,
+                               Workspace.ObsBiomassBySpeciesOrGuilds);
+}
+
+} // end namespace NLopt_Kernel
+
+/**
+ * @brief Picks the kernels matching the model forms, scaling algorithm, and objective criterion
+ */
+class NLopt_Kernels
+{
+public:
+    /**
+     * @brief Sets the context's kernels to the instantiations matching its decoded forms.
+     * Forms without an inline implementation are evaluated through the model form objects.
+     * @param Context : the evaluation context whose kernels are to be set
+     */
+    static void selectKernels(NLopt_EvaluationContext& Context);
+    /**
+     * @brief Sets the context's biomass kernel to the one that evaluates every form through
+     * the model form objects (i.e., the pre-kernel behavior)
+     * @param Context : the evaluation context whose biomass kernel is to be set
+     */
+    static void selectFormKernels(NLopt_EvaluationContext& Context);
+};
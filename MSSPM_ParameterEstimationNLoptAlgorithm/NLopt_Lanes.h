@@ -0,0 +1,96 @@
+/**
+ * @file NLopt_Lanes.h
+ * @brief Definition of the fixed width vector type used by the batch evaluator
+ *
+ * This file contains the NLopt_Lanes template. An NLopt_Lanes<K> holds one double
+ * for each of K candidate parameter sets and applies every arithmetic operation to
+ * all K lanes at once. The loops have a fixed trip count and no branches so that the
+ * compiler maps them onto SSE/AVX2/AVX-512 registers when the matching instruction
+ * set is enabled (qmake CONFIG+=avx2 or CONFIG+=avx512, see the library's .pro file).
+ *
+ * @copyright
+ * Public Domain Notice\n
+ *
+ * National Oceanic And Atmospheric Administration\n\n
+ *
+ * This software is a "United States Government Work" under the terms of the
+ * United States Copyright Act.  It was written as part of the author's official
+ * duties as a United States Government employee/contractor and thus cannot be copyrighted.
+ * This software is freely available to the public for use. The National Oceanic
+ * And Atmospheric Administration and the U.S. Government have not placed any
+ * restriction on its use or reproduction.  Although all reasonable efforts have
+ * been taken to ensure the accuracy and reliability of the software and data,
+ * the National Oceanic And Atmospheric Administration and the U.S. Government
+ * do not and cannot warrant the performance or results that may be obtained
+ * by using this software or data. The National Oceanic And Atmospheric
+ * Administration and the U.S. Government disclaim all warranties, express
+ * or implied, including warranties of performance, merchantability or fitness
+ * for any particular purpose.\n\n
+ *
+ * Please cite the author(s) in any work or product based on this material.
+ */
+
+#pragma once
+
+#include <cmath>
+
+/**
+ * @brief K doubles operated on in lock-step, one per candidate
+ */
+template<int K>
+struct NLopt_Lanes {
+    double v[K];
+
+    NLopt_Lanes() {}
+    NLopt_Lanes(double value) {
+        for (int k=0; k<K; ++k) v[k] = value;
+    }
+
+    NLopt_Lanes& operator+=(const NLopt_Lanes& b) {
+        for (int k=0; k<K; ++k) v[k] += b.v[k];
+        return *this;
+    }
+    NLopt_Lanes& operator-=(const NLopt_Lanes& b) {
+        for (int k=0; k<K; ++k) v[k] -= b.v[k];
+        return *this;
+    }
+    NLopt_Lanes& operator*=(const NLopt_Lanes& b) {
+        for (int k=0; k<K; ++k) v[k] *= b.v[k];
+        return *this;
+    }
+    NLopt_Lanes& operator/=(const NLopt_Lanes& b) {
+        for (int k=0; k<K; ++k) v[k] /= b.v[k];
+        return *this;
+    }
+};
+
+template<int K>
+inline NLopt_Lanes<K> operator+(NLopt_Lanes<K> a, const NLopt_Lanes<K>& b) { return a += b; }
+template<int K>
+inline NLopt_Lanes<K> operator-(NLopt_Lanes<K> a, const NLopt_Lanes<K>& b) { return a -= b; }
+template<int K>
+inline NLopt_Lanes<K> operator*(NLopt_Lanes<K> a, const NLopt_Lanes<K>& b) { return a *= b; }
+template<int K>
+inline NLopt_Lanes<K> operator/(NLopt_Lanes<K> a, const NLopt_Lanes<K>& b) { return a /= b; }
+template<int K>
+inline NLopt_Lanes<K> operator-(NLopt_Lanes<K> a) {
+    for (int k=0; k<K; ++k) a.v[k] = -a.v[k];
+    return a;
+}
+
+/**
+ * @brief Per lane flags, e.g. which candidates are still valid
+ */
+template<int K>
+struct NLopt_LaneMask {
+    bool v[K];
+
+    NLopt_LaneMask(bool value = true) {
+        for (int k=0; k<K; ++k) v[k] = value;
+    }
+    bool any() const {
+        bool retv = false;
+        for (int k=0; k<K; ++k) retv |= v[k];
+        return retv;
+    }
+};
@@ -0,0 +1,63 @@
+#include "NLopt_ParameterLayout.h"
+#include "NLopt_EvaluationContext.h"
+
+
+void
+NLopt_ParameterLayout::initialize(const NLopt_EvaluationContext& Context)
+{
+    int N = Context.NumSpeciesOrGuilds;
+    int G = Context.NumGuilds;
+    int offset = 0;
+
+    // Same order as the parameter ranges are loaded in
+    auto place = [&offset](NLopt_ParameterBlock& Block, const bool& isPresent,
+                           const int& Rows, const int& Cols) {
+        Block.Offset = offset;
+        Block.Rows   = (isPresent) ? Rows : 0;
+        Block.Cols   = (isPresent) ? Cols : 0;
+        offset      += Block.size();
+    };
+    place(InitBiomass,                 true,                 N,1);
+    place(GrowthRate,                  true,                 N,1);
+    place(CarryingCapacity,            Context.isLogistic,    N,1);
+    place(Catchability,                Context.isCatchability,N,1);
+    place(CompetitionAlpha,            Context.isAlpha,       N,N);
+    place(CompetitionBetaSpecies,      Context.isMSPROD,      N,N);
+    place(CompetitionBetaGuilds,       Context.isMSPROD,      N,G);
+    place(CompetitionBetaGuildsGuilds, Context.isAGGPROD,     G,G);
+    place(PredationRho,                Context.isRho,         N,N);
+    place(PredationHandling,           Context.isHandling,    N,N);
+    place(PredationExponent,           Context.isExponent,    N,1);
+    place(SurveyQ,                     true,                 N,1);
+    NumParameters = offset;
+
+    CompetitionAlphaPattern = NLopt_InteractionPattern();
+    PredationRhoPattern     = NLopt_InteractionPattern();
+}
+
+
+void
+NLopt_ParameterLayout::initializePatterns(const std::vector<std::pair<double,double> >& ParameterRanges)
+{
+    auto find = [&ParameterRanges](const NLopt_ParameterBlock& Block,
+                                   NLopt_InteractionPattern& Pattern) {
+        Pattern = NLopt_InteractionPattern();
+        if (! Block.isPresent() || (int(ParameterRanges.size()) < Block.Offset+Block.size())) {
+            return;
+        }
+        Pattern.RowOffset.push_back(0);
+        for (int i=0; i<Block.Rows; ++i) {
+            for (int j=0; j<Block.Cols; ++j) {
+                const std::pair<double,double>& range = ParameterRanges[Block.Offset+i*Block.Cols+j];
+                if ((range.first != 0) || (range.second != 0)) {
+                    Pattern.Column.push_back(j);
+                }
+            }
+            Pattern.RowOffset.push_back(Pattern.getNumLinks());
+        }
+        // The indirection only pays off if enough of the links are missing
+        Pattern.isSparse = (Pattern.getNumLinks() <= MaxSparseDensity*Block.size());
+    };
+    find(CompetitionAlpha,CompetitionAlphaPattern);
+    find(PredationRho,    PredationRhoPattern);
+}
@@ -0,0 +1,212 @@
+/**
+ * @file NLopt_ParameterLayout.h
+ * @brief Definition of the layout of the estimated parameter vector and views into it
+ *
+ * This file contains the NLopt_ParameterLayout structure and the NLopt_VectorView and
+ * NLopt_MatrixView types. The layout records where each parameter group lives in the
+ * flat parameter vector the optimizer works with. It's computed once per run from the
+ * model form flags. The views read a group directly out of the optimizer's buffer, so
+ * the kernels don't copy the parameters on every evaluation. The layout also holds
+ * the declared links of the competition and predation matrices in compressed sparse
+ * row form, so the kernels of a large, sparsely connected system only evaluate the
+ * links that exist.
+ *
+ * @copyright
+ * Public Domain Notice\n
+ *
+ * National Oceanic And Atmospheric Administration\n\n
+ *
+ * This software is a "United States Government Work" under the terms of the
+ * United States Copyright Act.  It was written as part of the author's official
+ * duties as a United States Government employee/contractor and thus cannot be copyrighted.
+ * This software is freely available to the public for use. The National Oceanic
+ * And Atmospheric Administration and the U.S. Government have not placed any
+ * restriction on its use or reproduction.  Although all reasonable efforts have
+ * been taken to ensure the accuracy and reliability of the software and data,
+ * the National Oceanic And Atmospheric Administration and the U.S. Government
+ * do not and cannot warrant the performance or results that may be obtained
+ * by using this software or data. The National Oceanic And Atmospheric
+ * Administration and the U.S. Government disclaim all warranties, express
+ * or implied, including warranties of performance, merchantability or fitness
+ * for any particular purpose.\n\n
+ *
+ * Please cite the author(s) in any work or product based on this material.
+ */
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+struct NLopt_EvaluationContext;
+
+/**
+ * @brief Position and shape of one parameter group (Rows == 0 if the group isn't estimated)
+ */
+struct NLopt_ParameterBlock {
+    int Offset = 0;
+    int Rows   = 0;
+    int Cols   = 0;
+
+    int size() const {
+        return Rows*Cols;
+    }
+    bool isPresent() const {
+        return (Rows > 0);
+    }
+};
+
+/**
+ * @brief Declared links of an interaction matrix in compressed sparse row form: the
+ * links of row i are in columns Column[RowOffset[i]] to Column[RowOffset[i+1]-1].
+ * A link whose range is [0,0] isn't declared. The values stay in the dense block, so
+ * only the kernels use the pattern; if isSparse is false they loop over every column.
+ */
+struct NLopt_InteractionPattern {
+    bool             isSparse = false;
+    std::vector<int> RowOffset;
+    std::vector<int> Column;
+
+    int getNumLinks() const {
+        return int(Column.size());
+    }
+};
+
+/**
+ * @brief Non-owning view of a parameter vector
+ */
+template<class T>
+struct NLopt_VectorView {
+    const T* Data = nullptr;
+    int      Size = 0;
+
+    const T& operator[](const int& i) const {
+        return Data[i];
+    }
+    int size() const {
+        return Size;
+    }
+    const T* begin() const {
+        return Data;
+    }
+    const T* end() const {
+        return Data+Size;
+    }
+};
+
+/**
+ * @brief Non-owning view of a row major parameter matrix
+ */
+template<class T>
+struct NLopt_MatrixView {
+    const T* Data   = nullptr;
+    int      Rows   = 0;
+    int      Cols   = 0;
+    int      Stride = 0;
+
+    const T& operator()(const int& i, const int& j) const {
+        return Data[i*Stride+j];
+    }
+    /**
+     * @brief Pointer to row i's Cols contiguous values
+     */
+    const T* row(const int& i) const {
+        return Data+i*Stride;
+    }
+};
+
+/**
+ * @brief Where each parameter group lives in the estimated parameter vector. The order
+ * is InitBiomass, GrowthRate, CarryingCapacity, Catchability, CompetitionAlpha,
+ * CompetitionBetaSpecies, CompetitionBetaGuilds, CompetitionBetaGuildsGuilds,
+ * PredationRho, PredationHandling, PredationExponent, SurveyQ; groups the model
+ * forms don't use take no space.
+ */
+struct NLopt_ParameterLayout {
+    NLopt_ParameterBlock InitBiomass;
+    NLopt_ParameterBlock GrowthRate;
+    NLopt_ParameterBlock CarryingCapacity;
+    NLopt_ParameterBlock Catchability;
+    NLopt_ParameterBlock CompetitionAlpha;
+    NLopt_ParameterBlock CompetitionBetaSpecies;
+    NLopt_ParameterBlock CompetitionBetaGuilds;
+    NLopt_ParameterBlock CompetitionBetaGuildsGuilds;
+    NLopt_ParameterBlock PredationRho;
+    NLopt_ParameterBlock PredationHandling;
+    NLopt_ParameterBlock PredationExponent;
+    NLopt_ParameterBlock SurveyQ;
+    NLopt_InteractionPattern CompetitionAlphaPattern;
+    NLopt_InteractionPattern PredationRhoPattern;
+    int NumParameters = 0;
+
+    /**
+     * @brief A matrix is evaluated sparsely if at most this fraction of its links are declared
+     */
+    static constexpr double MaxSparseDensity = 0.5;
+
+    /**
+     * @brief Computes the offsets and shapes from the context's form flags and sizes.
+     * The interaction patterns are reset to dense.
+     * @param Context : context whose decodeModelForms flags are set
+     */
+    void initialize(const NLopt_EvaluationContext& Context);
+    /**
+     * @brief Finds the declared links of the competition alpha and predation rho matrices
+     * @param ParameterRanges : lower and upper bound of every model parameter, in layout order
+     */
+    void initializePatterns(const std::vector<std::pair<double,double> >& ParameterRanges);
+
+    template<class T>
+    static NLopt_VectorView<T> vector(const T* Parameters, const NLopt_ParameterBlock& Block) {
+        NLopt_VectorView<T> view;
+        view.Data = Block.isPresent() ? Parameters+Block.Offset : nullptr;
+        view.Size = Block.size();
+        return view;
+    }
+    template<class T>
+    static NLopt_MatrixView<T> matrix(const T* Parameters, const NLopt_ParameterBlock& Block) {
+        NLopt_MatrixView<T> view;
+        view.Data   = Block.isPresent() ? Parameters+Block.Offset : nullptr;
+        view.Rows   = Block.Rows;
+        view.Cols   = Block.Cols;
+        view.Stride = Block.Cols;
+        return view;
+    }
+};
+
+/**
+ * @brief Views of every parameter group of one parameter vector
+ */
+template<class T>
+struct NLopt_ParameterViews {
+    NLopt_VectorView<T> InitBiomass;
+    NLopt_VectorView<T> GrowthRate;
+    NLopt_VectorView<T> CarryingCapacity;
+    NLopt_VectorView<T> Catchability;
+    NLopt_MatrixView<T> CompetitionAlpha;
+    NLopt_MatrixView<T> CompetitionBetaSpecies;
+    NLopt_MatrixView<T> CompetitionBetaGuilds;
+    NLopt_MatrixView<T> CompetitionBetaGuildsGuilds;
+    NLopt_MatrixView<T> PredationRho;
+    NLopt_MatrixView<T> PredationHandling;
+    NLopt_VectorView<T> PredationExponent;
+    NLopt_VectorView<T> SurveyQ;
+
+    /**
+     * @brief Points the views at a parameter vector (nothing is copied)
+     */
+    void set(const NLopt_ParameterLayout& Layout, const T* Parameters) {
+        InitBiomass                 = Layout.vector(Parameters,Layout.InitBiomass);
+        GrowthRate                  = Layout.vector(Parameters,Layout.GrowthRate);
+        CarryingCapacity            = Layout.vector(Parameters,Layout.CarryingCapacity);
+        Catchability                = Layout.vector(Parameters,Layout.Catchability);
+        CompetitionAlpha            = Layout.matrix(Parameters,Layout.CompetitionAlpha);
+        CompetitionBetaSpecies      = Layout.matrix(Parameters,Layout.CompetitionBetaSpecies);
+        CompetitionBetaGuilds       = Layout.matrix(Parameters,Layout.CompetitionBetaGuilds);
+        CompetitionBetaGuildsGuilds = Layout.matrix(Parameters,Layout.CompetitionBetaGuildsGuilds);
+        PredationRho                = Layout.matrix(Parameters,Layout.PredationRho);
+        PredationHandling           = Layout.matrix(Parameters,Layout.PredationHandling);
+        PredationExponent           = Layout.vector(Parameters,Layout.PredationExponent);
+        SurveyQ                     = Layout.vector(Parameters,Layout.SurveyQ);
+    }
+};
@@ -0,0 +1,68 @@
+#include "NLopt_ParameterMapping.h"
+
+
+void
+NLopt_ParameterMapping::initialize(const std::vector<std::pair<double,double> >& ParameterRanges)
+{
+    m_FreeIndex.clear();
+    m_FixedParameters.resize(ParameterRanges.size());
+    for (unsigned i=0; i<ParameterRanges.size(); ++i) {
+        m_FixedParameters[i] = ParameterRanges[i].first;
+        if (ParameterRanges[i].first != ParameterRanges[i].second) {
+            m_FreeIndex.push_back(i);
+        }
+    }
+}
+
+
+int
+NLopt_ParameterMapping::getNumFreeParameters() const
+{
+    return m_FreeIndex.size();
+}
+
+
+int
+NLopt_ParameterMapping::getNumParameters() const
+{
+    return m_FixedParameters.size();
+}
+
+
+void
+NLopt_ParameterMapping::pack(const std::vector<double>& Parameters,
+                             std::vector<double>&       FreeParameters) const
+{
+    FreeParameters.resize(m_FreeIndex.size());
+    for (unsigned i=0; i<m_FreeIndex.size(); ++i) {
+        FreeParameters[i] = Parameters[m_FreeIndex[i]];
+    }
+}
+
+
+void
+NLopt_ParameterMapping::expand(const double*        FreeParameters,
+                               std::vector<double>& Parameters) const
+{
+    Parameters = m_FixedParameters;
+    for (unsigned i=0; i<m_FreeIndex.size(); ++i) {
+        Parameters[m_FreeIndex[i]] = FreeParameters[i];
+    }
+}
+
+
+void
+NLopt_ParameterMapping::gather(const double* Gradient,
+                               double*       FreeGradient) const
+{
+    for (unsigned i=0; i<m_FreeIndex.size(); ++i) {
+        FreeGradient[i] = Gradient[m_FreeIndex[i]];
+    }
+}
+
+
+const std::vector<int>&
+NLopt_ParameterMapping::getFreeIndices() const
+{
+    return m_FreeIndex;
+}
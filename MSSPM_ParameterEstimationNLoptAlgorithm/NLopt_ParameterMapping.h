@@ -0,0 +1,86 @@
+/**
+ * @file NLopt_ParameterMapping.h
+ * @brief Definition of the mapping between the model's parameters and the optimizer's
+ *
+ * This file contains the NLopt_ParameterMapping class. Parameters whose lower bound
+ * equals their upper bound (e.g., unchecked InitBiomass and SurveyQ, or interaction
+ * cells whose range is zero) can't change, so they aren't passed to NLopt. The
+ * optimizer only sees the free parameters, and the objective function expands them
+ * back into the full parameter vector the model expects.
+ *
+ * @copyright
+ * Public Domain Notice\n
+ *
+ * National Oceanic And Atmospheric Administration\n\n
+ *
+ * This software is a "United States Government Work" under the terms of the
+ * United States Copyright Act.  It was written as part of the author's official
+ * duties as a United States Government employee/contractor and thus cannot be copyrighted.
+ * This software is freely available to the public for use. The National Oceanic
+ * And Atmospheric Administration and the U.S. Government have not placed any
+ * restriction on its use or reproduction.  Although all reasonable efforts have
+ * been taken to ensure the accuracy and reliability of the software and data,
+ * the National Oceanic And Atmospheric Administration and the U.S. Government
+ * do not and cannot warrant the performance or results that may be obtained
+ * by using this software or data. The National Oceanic And Atmospheric
+ * Administration and the U.S. Government disclaim all warranties, express
+ * or implied, including warranties of performance, merchantability or fitness
+ * for any particular purpose.\n\n
+ *
+ * Please cite the author(s) in any work or product based on this material.
+ */
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Packs the free parameters for the optimizer and expands them back for the model
+ */
+class NLopt_ParameterMapping
+{
+private:
+    std::vector<int>    m_FreeIndex;
+    std::vector<double> m_FixedParameters;
+
+public:
+    /**
+     * @brief Finds the free parameters
+     * @param ParameterRanges : lower and upper bound of every model parameter
+     */
+    void initialize(const std::vector<std::pair<double,double> >& ParameterRanges);
+    /**
+     * @brief Number of parameters the optimizer searches over
+     */
+    int getNumFreeParameters() const;
+    /**
+     * @brief Number of model parameters
+     */
+    int getNumParameters() const;
+    /**
+     * @brief Copies the free parameters' values (or bounds) out of a full-length vector
+     * @param Parameters : full-length vector
+     * @param FreeParameters : the packed free values
+     */
+    void pack(const std::vector<double>& Parameters,
+              std::vector<double>&       FreeParameters) const;
+    /**
+     * @brief Builds the full parameter vector from the free parameters and the fixed values
+     * @param FreeParameters : the getNumFreeParameters() values searched over by the optimizer
+     * @param Parameters : the full-length vector (only reallocated if its size changes)
+     */
+    void expand(const double*        FreeParameters,
+                std::vector<double>& Parameters) const;
+    /**
+     * @brief Copies the free parameters' derivatives out of a full-length gradient
+     * @param Gradient : derivatives with respect to every model parameter
+     * @param FreeGradient : derivatives with respect to the free parameters
+     */
+    void gather(const double* Gradient,
+                double*       FreeGradient) const;
+    /**
+     * @brief Model parameter index of each free parameter
+     */
+    const std::vector<int>& getFreeIndices() const;
+};
@@ -0,0 +1,116 @@
+/**
+ * @file NLopt_SubRun.h
+ * @brief Definition of the state owned by a single NLopt sub-run
+ *
+ * This file contains the definition of the NLopt_SubRun structure. Every sub-run
+ * of an estimation (multi-start runs, Mohn's Rho peels, and multi-run lines) owns
+ * its own optimizer, model form objects, evaluation context, and starting point,
+ * so that sub-runs can be run concurrently on a thread pool.
+ *
+ * @copyright
+ * Public Domain Notice\n
+ *
+ * National Oceanic And Atmospheric Administration\n\n
+ *
+ * This software is a "United States Government Work" under the terms of the
+ * United States Copyright Act.  It was written as part of the author's official
+ * duties as a United States Government employee/contractor and thus cannot be copyrighted.
+ * This software is freely available to the public for use. The National Oceanic
+ * And Atmospheric Administration and the U.S. Government have not placed any
+ * restriction on its use or reproduction.  Although all reasonable efforts have
+ * been taken to ensure the accuracy and reliability of the software and data,
+ * the National Oceanic And Atmospheric Administration and the U.S. Government
+ * do not and cannot warrant the performance or results that may be obtained
+ * by using this software or data. The National Oceanic And Atmospheric
+ * Administration and the U.S. Government disclaim all warranties, express
+ * or implied, including warranties of performance, merchantability or fitness
+ * for any particular purpose.\n\n
+ *
+ * Please cite the author(s) in any work or product based on this material.
+ */
+
+#pragma once
+
+#include "NLopt_EvaluationContext.h"
+#include "NLopt_ParameterMapping.h"
+#include "nmfCancellationToken.h"
+#include "nmfProgressTelemetry.h"
+
+#include <atomic>
+#include <memory>
+#include <nlopt.hpp>
+
+/**
+ * @brief State owned by one NLopt sub-run. A pointer to it is the objective function's data pointer.
+ */
+struct NLopt_SubRun {
+    /**
+     * @brief The estimator's run number, shown on the progress chart
+     */
+    int           RunNum;
+    /**
+     * @brief Index into the estimator's list of multi-run data structs
+     */
+    int           MultiRunIndex;
+    /**
+     * @brief Sub-run number within its multi-run line (0 based)
+     */
+    int           SubRunNumber;
+    /**
+     * @brief Number of sub-runs in its multi-run line
+     */
+    int           NumSubRuns;
+    int           MohnsRhoOffset;
+    /**
+     * @brief Seed passed to nlopt::srand on the worker thread (NLopt's generator is thread local)
+     */
+    unsigned long Seed;
+    std::unique_ptr<nmfGrowthForm>      GrowthForm;
+    std::unique_ptr<nmfHarvestForm>     HarvestForm;
+    std::unique_ptr<nmfCompetitionForm> CompetitionForm;
+    std::unique_ptr<nmfPredationForm>   PredationForm;
+    NLopt_EvaluationContext Context;
+    nlopt::algorithm        Algorithm;
+    nlopt::opt              Optimizer;
+    /**
+     * @brief Which of the model's parameters the optimizer searches over
+     */
+    NLopt_ParameterMapping  Mapping;
+    /**
+     * @brief Starting point on input and estimated parameters on output (all model parameters)
+     */
+    std::vector<double>     Parameters;
+    /**
+     * @brief The free parameters as seen by the optimizer
+     */
+    std::vector<double>     FreeParameters;
+    double                  Fitness;
+    std::string             MaxOrMin;
+    /**
+     * @brief The optimizer's outcome, written on the sub-run's thread and printed by the
+     * estimator in sub-run order so that concurrent sub-runs don't interleave their output
+     */
+    std::string             Report;
+    /**
+     * @brief Biomass at the estimated parameters, calculated on the sub-run's thread
+     * once the optimizer is done (see NLopt_Estimator::calculateBiomass)
+     */
+    boost::numeric::ublas::matrix<double> EstBiomassSpecies;
+    boost::numeric::ublas::matrix<double> EstBiomassGuilds;
+    /**
+     * @brief Number of objective function evaluations made by this sub-run
+     */
+    int                     NumEvaluations;
+    /**
+     * @brief Objective function call counter shared by all of an estimator's sub-runs (drives the progress chart)
+     */
+    std::atomic<int>*        NumObjFcnCalls;
+    /**
+     * @brief Progress chart samples published by this sub-run's thread
+     */
+    std::shared_ptr<nmfProgressChannel> Progress;
+    /**
+     * @brief Cancelled when the user stops the run
+     */
+    std::shared_ptr<const nmfCancellationToken> Cancellation;
+};
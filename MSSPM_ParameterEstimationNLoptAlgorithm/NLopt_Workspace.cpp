@@ -0,0 +1,73 @@
+#include "NLopt_Workspace.h"
+
+std::atomic<long> NLopt_Workspace::m_NumAllocations(0);
+
+
+void
+NLopt_Workspace::prepare(const NLopt_EvaluationContext& Context)
+{
+    int NumObsYears = Context.ObsBiomassBySpeciesOrGuilds.size1();
+    int N = Context.NumSpeciesOrGuilds;
+    int G = Context.NumGuilds;
+
+    if ((NumYears           != Context.NumYears)   ||
+        (NumObsYears        != this->NumObsYears)  ||
+        (NumSpecies         != Context.NumSpecies) ||
+        (NumGuilds          != G)                  ||
+        (NumSpeciesOrGuilds != N))
+    {
+        NumYears           = Context.NumYears;
+        this->NumObsYears  = NumObsYears;
+        NumSpecies         = Context.NumSpecies;
+        NumGuilds          = G;
+        NumSpeciesOrGuilds = N;
+
+        // Reserve enough so that clear() followed by emplace_back never reallocates
+        for (std::vector<double>* vec : {&InitBiomass,&GrowthRate,&CarryingCapacity,
+                                         &PredationExponent,&CatchabilityRate,&SurveyQ}) {
+            vec->reserve(N);
+        }
+        GuildCarryingCapacity.reserve(G);
+        for (std::vector<double>* vec : {&StartBiomass,&GrowthTerm,&HarvestTerm,
+                                         &CompetitionTerm,&PredationTerm}) {
+            vec->resize(N);
+        }
+        ++m_NumAllocations;
+    }
+
+    initialize(EstBiomassSpecies,                   NumYears,    N);
+    initialize(EstBiomassGuilds,                    NumYears,    G);
+    initialize(EstBiomassRescaled,                  NumYears,    N);
+    initialize(ObsBiomassBySpeciesOrGuilds,         NumObsYears, N);
+    initialize(ObsBiomassBySpeciesOrGuildsRescaled, NumYears,    N);
+
+    // The parameter copies are only read by the model form objects
+    if (Context.isFormParameterCopyNeeded) {
+        initialize(CompetitionAlpha,                N,           N);
+        initialize(CompetitionBetaSpecies,          NumSpecies,  NumSpecies);
+        initialize(CompetitionBetaGuilds,           N,           G);
+        initialize(CompetitionBetaGuildsGuilds,     G,           G);
+        initialize(PredationRho,                    N,           N);
+        initialize(PredationHandling,               N,           N);
+    }
+}
+
+
+void
+NLopt_Workspace::initialize(boost::numeric::ublas::matrix<double>& Matrix,
+                            const int& NumRows,
+                            const int& NumCols)
+{
+    if ((int(Matrix.size1()) != NumRows) || (int(Matrix.size2()) != NumCols)) {
+        Matrix.resize(NumRows,NumCols,false);
+        ++m_NumAllocations;
+    }
+    Matrix.clear();
+}
+
+
+long
+NLopt_Workspace::getNumAllocations()
+{
+    return m_NumAllocations.load();
+}
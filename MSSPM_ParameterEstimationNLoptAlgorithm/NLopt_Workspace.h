@@ -0,0 +1,109 @@
+/**
+ * @file NLopt_Workspace.h
+ * @brief Definition of the scratch storage used by the NLopt objective function
+ *
+ * This file contains the definition of the NLopt_Workspace structure. Each thread
+ * that evaluates the objective function owns one workspace. Its matrices and
+ * vectors are sized from the evaluation context the first time they're used and
+ * are then reused, so that steady-state evaluations don't touch the heap.
+ *
+ * @copyright
+ * Public Domain Notice\n
+ *
+ * National Oceanic And Atmospheric Administration\n\n
+ *
+ * This software is a "United States Government Work" under the terms of the
+ * United States Copyright Act.  It was written as part of the author's official
+ * duties as a United States Government employee/contractor and thus cannot be copyrighted.
+ * This software is freely available to the public for use. The National Oceanic
+ * And Atmospheric Administration and the U.S. Government have not placed any
+ * restriction on its use or reproduction.  Although all reasonable efforts have
+ * been taken to ensure the accuracy and reliability of the software and data,
+ * the National Oceanic And Atmospheric Administration and the U.S. Government
+ * do not and cannot warrant the performance or results that may be obtained
+ * by using this software or data. The National Oceanic And Atmospheric
+ * Administration and the U.S. Government disclaim all warranties, express
+ * or implied, including warranties of performance, merchantability or fitness
+ * for any particular purpose.\n\n
+ *
+ * Please cite the author(s) in any work or product based on this material.
+ */
+
+#pragma once
+
+#include "NLopt_EarlyAbandon.h"
+#include "NLopt_EvaluationContext.h"
+
+#include <atomic>
+#include <vector>
+
+/**
+ * @brief Per-thread scratch matrices and vectors for NLopt_Estimator::objectiveFunction
+ */
+struct NLopt_Workspace {
+    int NumYears           = -1;
+    int NumObsYears        = -1;
+    int NumSpecies         = -1;
+    int NumGuilds          = -1;
+    int NumSpeciesOrGuilds = -1;
+    // Parameter copies for the model form objects (see NLopt_EvaluationContext::isFormParameterCopyNeeded)
+    std::vector<double> InitBiomass;
+    std::vector<double> GrowthRate;
+    std::vector<double> CarryingCapacity;
+    std::vector<double> GuildCarryingCapacity;
+    std::vector<double> PredationExponent;
+    std::vector<double> CatchabilityRate;
+    std::vector<double> SurveyQ;
+    // One year's biomass and model form terms, by species (see simulateBiomass)
+    std::vector<double> StartBiomass;
+    std::vector<double> GrowthTerm;
+    std::vector<double> HarvestTerm;
+    std::vector<double> CompetitionTerm;
+    std::vector<double> PredationTerm;
+    boost::numeric::ublas::matrix<double> EstBiomassSpecies;
+    boost::numeric::ublas::matrix<double> EstBiomassGuilds;
+    boost::numeric::ublas::matrix<double> EstBiomassRescaled;
+    boost::numeric::ublas::matrix<double> ObsBiomassBySpeciesOrGuilds;
+    boost::numeric::ublas::matrix<double> ObsBiomassBySpeciesOrGuildsRescaled;
+    boost::numeric::ublas::matrix<double> CompetitionAlpha;
+    boost::numeric::ublas::matrix<double> CompetitionBetaSpecies;
+    boost::numeric::ublas::matrix<double> CompetitionBetaGuilds;
+    boost::numeric::ublas::matrix<double> CompetitionBetaGuildsGuilds;
+    boost::numeric::ublas::matrix<double> PredationRho;
+    boost::numeric::ublas::matrix<double> PredationHandling;
+    /**
+     * @brief Views into the parameter vector being evaluated
+     */
+    NLopt_ParameterViews<double> Parameters;
+    /**
+     * @brief Lower bound on the fitness of the evaluation in progress (inactive unless
+     * an incumbent fitness was passed to NLopt_Estimator::evaluateObjective)
+     */
+    NLopt_EarlyAbandon EarlyAbandon;
+
+    /**
+     * @brief Sizes the workspace for the given context. Storage is only
+     * reallocated when the context's dimensions differ from the last call;
+     * otherwise the matrices are just zeroed.
+     * @param Context : the evaluation context of the current run
+     */
+    void prepare(const NLopt_EvaluationContext& Context);
+    /**
+     * @brief Zeroes the matrix, reallocating it only if its shape changes
+     * @param Matrix : matrix to size and zero
+     * @param NumRows : number of rows required
+     * @param NumCols : number of columns required
+     */
+    static void initialize(boost::numeric::ublas::matrix<double>& Matrix,
+                           const int& NumRows,
+                           const int& NumCols);
+    /**
+     * @brief Number of times any workspace has had to (re)allocate storage. A
+     * steady-state objective function evaluation leaves this unchanged.
+     * @return Returns the running count of workspace allocations
+     */
+    static long getNumAllocations();
+
+private:
+    static std::atomic<long> m_NumAllocations;
+};
@@ -14,7 +14,8 @@ nmfSimulatedData::nmfSimulatedData(
 
 bool
 nmfSimulatedData::createSimulatedBiomass(QString filename,
-                                         const int& errorPct)
+                                         const int& errorPct,
+                                         const std::uint64_t& Seed)
 {
     bool retv = true;
     int RunLength=0;
@@ -182,7 +183,7 @@ nmfSimulatedData::createSimulatedBiomass(QString filename,
 std::cout << "sim year: " << time << ", val = " << lastYearBiomass << " + " << simGrowthValue << " - " << simHarvestValue << " - "
           << simCompetitionValue << " - " << simPredationValue <<  " = " << val << std::endl;
 
-            addError(val,errorPct);
+            addError(Seed,time,species,val,errorPct);
             SimulatedBiomass(time,species) = (val < 0) ? 0 : val;
 //std::cout << "sim val(" << time << "," << species << "): " << SimulatedBiomass(time,species) << std::endl;
         }
@@ -221,9 +222,15 @@ std::cout << "Model: " << formCheck.toStdString() << std::endl;
 }
 
 bool
-nmfSimulatedData::addError(double& value, const int& errorPct)
+nmfSimulatedData::addError(const std::uint64_t& Seed,
+                           const int& time,
+                           const int& species,
+                           double& value,
+                           const int& errorPct)
 {
-    double factor = nmfUtils::getRandomNumber(0,-1,1);
+    // Each value's error has its own (year, species) stream, so with a fixed seed the
+    // simulated biomass is the same every time and doesn't depend on the order it's made in
+    double factor = nmfRandom::getUniform(Seed,time,species,0,-1,1);
     double error = value * (errorPct/100.0);
 
     value += factor*error;
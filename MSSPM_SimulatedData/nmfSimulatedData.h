@@ -11,6 +11,7 @@
 #include "nmfDatabase.h"
 #include "nmfLogger.h"
 #include "nmfUtils.h"
+#include "nmfRandom.h"
 #include "nmfGrowthForm.h"
 #include "nmfHarvestForm.h"
 #include "nmfCompetitionForm.h"
@@ -22,7 +23,11 @@ class nmfSimulatedData
     nmfDatabase* m_Database;
     nmfLogger*   m_Logger;
 
-    bool addError(double& value, const int& errorPct);
+    bool addError(const std::uint64_t& Seed,
+                  const int& time,
+                  const int& species,
+                  double& value,
+                  const int& errorPct);
     bool getCompetitionSystemCarryingCapacity(
             const bool isAggProd,
             const int& NumGuilds,
@@ -83,9 +88,13 @@ public:
 
     /**
      * @brief Creates a simulated Biomass time series with the current model settings
+     * @param filename : name of the .csv file the biomass is written to
+     * @param errorPct : the ± percent error added to each biomass value
+     * @param Seed : seed of the errors' random streams (see nmfRandom::getSeed)
      */
     bool createSimulatedBiomass(QString filename,
-                                const int& errorPct);
+                                const int& errorPct,
+                                const std::uint64_t& Seed);
 };
 
 #endif // nmfSimulatedData_H
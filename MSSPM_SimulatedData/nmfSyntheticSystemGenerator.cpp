@@ -0,0 +1,770 @@
+
+#include "nmfSyntheticSystemGenerator.h"
+#include "nmfConstantsMSSPM.h"
+#include "nmfUtils.h"
+#include "NLopt_Estimator.h"
+
+#include <QDataStream>
+#include <QFile>
+#include <QString>
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+namespace {
+
+// "MSSY" followed by the version of the file layout
+const quint32 FileMagic   = 0x4D535359;
+const quint32 FileVersion = 1;
+
+const std::vector<std::string> GrowthForms      = {"Linear","Logistic"};
+const std::vector<std::string> HarvestForms     = {"Null","Catch","Effort (qE)","Exploitation (F)"};
+const std::vector<std::string> CompetitionForms = {"Null","NO_K","MS-PROD","AGG-PROD"};
+const std::vector<std::string> PredationForms   = {"Null","Type I","Type II","Type III"};
+
+bool isOneOf(const std::string& Value,
+             const std::vector<std::string>& List)
+{
+    return std::find(List.begin(),List.end(),Value) != List.end();
+}
+
+std::string makeName(const std::string& Prefix,
+                     const int& Num,
+                     const int& Count)
+{
+    std::ostringstream name;
+
+    name << Prefix << std::setw(int(std::to_string(Count).size())) << std::setfill('0') << Num+1;
+
+    return name.str();
+}
+
+std::vector<std::vector<double> > scaleRows(const boost::numeric::ublas::matrix<double>& Matrix,
+                                            const double& Factor)
+{
+    std::vector<std::vector<double> > rows(Matrix.size1(),std::vector<double>(Matrix.size2(),0.0));
+
+    for (unsigned i=0; i<Matrix.size1(); ++i) {
+        for (unsigned j=0; j<Matrix.size2(); ++j) {
+            rows[i][j] = Factor*Matrix(i,j);
+        }
+    }
+    return rows;
+}
+
+std::vector<double> scaleVector(const std::vector<double>& Vector,
+                                const double& Factor)
+{
+    std::vector<double> scaled(Vector);
+
+    for (double& value : scaled) {
+        value *= Factor;
+    }
+    return scaled;
+}
+
+void writeString(QDataStream& Stream, const std::string& Value)
+{
+    Stream << QString::fromStdString(Value);
+}
+
+void readString(QDataStream& Stream, std::string& Value)
+{
+    QString value;
+    Stream >> value;
+    Value = value.toStdString();
+}
+
+void writeVector(QDataStream& Stream, const std::vector<double>& Vector)
+{
+    Stream << quint32(Vector.size());
+    for (const double& value : Vector) {
+        Stream << value;
+    }
+}
+
+void readVector(QDataStream& Stream, std::vector<double>& Vector)
+{
+    quint32 size = 0;
+    double value;
+
+    Vector.clear();
+    Stream >> size;
+    for (quint32 i=0; (i<size) && (Stream.status() == QDataStream::Ok); ++i) {
+        Stream >> value;
+        Vector.push_back(value);
+    }
+}
+
+void writeMatrix(QDataStream& Stream, const boost::numeric::ublas::matrix<double>& Matrix)
+{
+    Stream << quint32(Matrix.size1()) << quint32(Matrix.size2());
+    for (unsigned i=0; i<Matrix.size1(); ++i) {
+        for (unsigned j=0; j<Matrix.size2(); ++j) {
+            Stream << Matrix(i,j);
+        }
+    }
+}
+
+void readMatrix(QDataStream& Stream, boost::numeric::ublas::matrix<double>& Matrix)
+{
+    quint32 size1 = 0;
+    quint32 size2 = 0;
+    std::vector<double> values;
+    double value;
+
+    Stream >> size1 >> size2;
+    // Read into a vector first so a corrupt size can't allocate a huge matrix
+    for (quint64 i=0; (i<quint64(size1)*size2) && (Stream.status() == QDataStream::Ok); ++i) {
+        Stream >> value;
+        values.push_back(value);
+    }
+    if (values.size() != quint64(size1)*size2) {
+        Matrix.resize(0,0,false);
+        return;
+    }
+    Matrix.resize(size1,size2,false);
+    for (quint32 i=0; i<size1; ++i) {
+        for (quint32 j=0; j<size2; ++j) {
+            Matrix(i,j) = values[i*size2+j];
+        }
+    }
+}
+
+}
+
+bool
+nmfSyntheticSystemGenerator::generate(const nmfSyntheticSystemSettings& Settings,
+                                      nmfSyntheticSystem& System,
+                                      std::string& ErrorMsg)
+{
+    ErrorMsg.clear();
+    if ((Settings.NumSpecies < 1) || (Settings.NumGuilds < 1) ||
+        (Settings.NumGuilds > Settings.NumSpecies) || (Settings.RunLength < 1)) {
+        ErrorMsg = "nmfSyntheticSystemGenerator: Need at least 1 species, 1 to NumSpecies guilds and a run length of at least 1";
+        return false;
+    }
+    if (! isOneOf(Settings.GrowthForm,     GrowthForms)      ||
+        ! isOneOf(Settings.HarvestForm,    HarvestForms)     ||
+        ! isOneOf(Settings.CompetitionForm,CompetitionForms) ||
+        ! isOneOf(Settings.PredationForm,  PredationForms)) {
+        ErrorMsg = "nmfSyntheticSystemGenerator: Unknown form in: " + Settings.GrowthForm + ", " +
+                Settings.HarvestForm + ", " + Settings.CompetitionForm + ", " + Settings.PredationForm;
+        return false;
+    }
+    if ((Settings.Connectance < 0) || (Settings.Connectance > 1) ||
+        (Settings.InteractionStrength < 0) ||
+        (Settings.HarvestRateMin < 0) || (Settings.HarvestRateMin > Settings.HarvestRateMax) ||
+        (Settings.HarvestRateMax >= 1) || (Settings.ObservationErrorPct < 0) ||
+        (Settings.RangeMinFactor <= 0) || (Settings.RangeMinFactor > 1) || (Settings.RangeMaxFactor < 1)) {
+        ErrorMsg = "nmfSyntheticSystemGenerator: Connectance, interaction strength, harvest rates, "
+                   "observation error or range factors out of range";
+        return false;
+    }
+
+    System = nmfSyntheticSystem();
+    System.Settings = Settings;
+    // The guilds, and each attempt's parameters and observations, have random number
+    // streams of their own, so the same settings always end on the same system
+    nmfRandom guildRandom(Settings.Seed,0,0,0);
+    if (! assignGuilds(Settings,guildRandom,System.Settings.GuildNum,ErrorMsg)) {
+        return false;
+    }
+    for (int species=0; species<Settings.NumSpecies; ++species) {
+        System.SpeciesNames.push_back(makeName("Species_",species,Settings.NumSpecies));
+    }
+    for (int guild=0; guild<Settings.NumGuilds; ++guild) {
+        System.GuildNames.push_back(makeName("Guild_",guild,Settings.NumGuilds));
+    }
+
+    // Draw until the biomass stays well-posed
+    for (int attempt=0; attempt<MaxAttempts; ++attempt) {
+        nmfRandom parameterRandom(  Settings.Seed,std::uint32_t(attempt),0,1);
+        nmfRandom observationRandom(Settings.Seed,std::uint32_t(attempt),0,2);
+        drawParameters(parameterRandom,System);
+        if (simulate(observationRandom,System)) {
+            fillDataStruct(System);
+            return true;
+        }
+    }
+
+    ErrorMsg = "nmfSyntheticSystemGenerator: No well-posed system found in " + std::to_string(MaxAttempts) +
+               " attempts. Try a lower interaction strength or harvest rate.";
+    return false;
+}
+
+bool
+nmfSyntheticSystemGenerator::assignGuilds(const nmfSyntheticSystemSettings& Settings,
+                                          nmfRandom& Random,
+                                          std::vector<int>& GuildNum,
+                                          std::string& ErrorMsg)
+{
+    const int NumSpecies = Settings.NumSpecies;
+    const int NumGuilds  = Settings.NumGuilds;
+    std::vector<int> numInGuild(NumGuilds,0);
+    std::vector<int> order(NumSpecies);
+
+    if (! Settings.GuildNum.empty()) {
+        GuildNum = Settings.GuildNum;
+    } else if (Settings.GuildStructure == "Even") {
+        GuildNum.clear();
+        for (int species=0; species<NumSpecies; ++species) {
+            GuildNum.push_back(int((long long)species*NumGuilds/NumSpecies));
+        }
+    } else if (Settings.GuildStructure == "Random") {
+        // Shuffle the species, give the first NumGuilds of them a guild each and
+        // put the rest in random guilds
+        for (int species=0; species<NumSpecies; ++species) {
+            order[species] = species;
+        }
+        for (int i=NumSpecies-1; i>0; --i) {
+            std::swap(order[i],order[std::min(i,int(Random.getUniform(0,i+1)))]);
+        }
+        GuildNum.assign(NumSpecies,0);
+        for (int i=0; i<NumSpecies; ++i) {
+            GuildNum[order[i]] = (i < NumGuilds) ? i : std::min(NumGuilds-1,int(Random.getUniform(0,NumGuilds)));
+        }
+    } else {
+        ErrorMsg = "nmfSyntheticSystemGenerator: Unknown guild structure: " + Settings.GuildStructure;
+        return false;
+    }
+
+    if (int(GuildNum.size()) != NumSpecies) {
+        ErrorMsg = "nmfSyntheticSystemGenerator: Need a guild for each of the " + std::to_string(NumSpecies) + " species";
+        return false;
+    }
+    for (int guild : GuildNum) {
+        if ((guild < 0) || (guild >= NumGuilds)) {
+            ErrorMsg = "nmfSyntheticSystemGenerator: Found guild number out of range: " + std::to_string(guild);
+            return false;
+        }
+        ++numInGuild[guild];
+    }
+    if (std::find(numInGuild.begin(),numInGuild.end(),0) != numInGuild.end()) {
+        ErrorMsg = "nmfSyntheticSystemGenerator: Every guild needs at least one species";
+        return false;
+    }
+
+    return true;
+}
+
+void
+nmfSyntheticSystemGenerator::drawParameters(nmfRandom& Random,
+                                            nmfSyntheticSystem& System)
+{
+    const nmfSyntheticSystemSettings& Settings = System.Settings;
+    const bool isAggProd = (Settings.CompetitionForm == "AGG-PROD");
+    const int NumSpecies = Settings.NumSpecies;
+    const int NumGuilds  = Settings.NumGuilds;
+    const int NumSpeciesOrGuilds = (isAggProd) ? NumGuilds : NumSpecies;
+    const double harvestRate = (Settings.HarvestForm == "Null") ? 0.0 :
+                               (Settings.HarvestRateMin+Settings.HarvestRateMax)/2.0;
+    nmfSyntheticParameters& Truth = System.TrueParameters;
+    std::vector<double> guildK(NumGuilds,0.0);
+
+    Truth = nmfSyntheticParameters();
+    for (int i=0; i<NumSpeciesOrGuilds; ++i) {
+        double K = Random.getUniform(5000.0,50000.0);
+        double r;
+        if (Settings.GrowthForm == "Linear") {
+            // Linear growth has no ceiling, so keep it within a factor of 2 of the
+            // harvest over the run
+            r = std::max(0.001,harvestRate + Random.getUniform(-0.5,0.5)*std::log(4.0)/Settings.RunLength);
+        } else {
+            r = Random.getUniform(std::max(0.2,2.0*harvestRate),std::max(0.6,3.0*harvestRate));
+        }
+        Truth.GrowthRate.push_back(r);
+        Truth.CarryingCapacity.push_back(K);
+        Truth.InitBiomass.push_back(K*Random.getUniform(0.3,0.8));
+        Truth.Catchability.push_back(Random.getUniform(0.001,0.005));
+        Truth.SurveyQ.push_back((Settings.isRelativeBiomass) ? Random.getUniform(0.2,1.0) : 1.0);
+        guildK[(isAggProd) ? i : Settings.GuildNum[i]] += K;
+    }
+
+    // Row i of an interaction matrix takes at most Strength of species i's growth at
+    // carrying capacity, spread over the species it interacts with. Pairs interact
+    // with probability Connectance; hasDiagonal species always interact with themselves.
+    auto drawInteractions = [&](const int& NumRows,
+                                const int& NumCols,
+                                const bool& hasDiagonal,
+                                const double& Strength,
+                                const std::vector<double>& ColumnK,
+                                boost::numeric::ublas::matrix<double>& Matrix) {
+        nmfUtils::initialize(Matrix,NumRows,NumCols);
+        for (int i=0; i<NumRows; ++i) {
+            std::vector<int> partners;
+            for (int j=0; j<NumCols; ++j) {
+                if ((i == j) && (NumRows == NumCols)) {
+                    if (hasDiagonal) {
+                        partners.push_back(j);
+                    }
+                } else if (Random.getUniform(0.0,1.0) < Settings.Connectance) {
+                    partners.push_back(j);
+                }
+            }
+            for (int j : partners) {
+                Matrix(i,j) = Random.getUniform(0.5,1.0)*Strength*Truth.GrowthRate[i] /
+                              (partners.size()*ColumnK[j]);
+            }
+        }
+    };
+
+    const double strength = Settings.InteractionStrength;
+    if (Settings.CompetitionForm == "NO_K") {
+        drawInteractions(NumSpeciesOrGuilds,NumSpeciesOrGuilds,true,strength,
+                         Truth.CarryingCapacity,Truth.CompetitionAlpha);
+    } else if (Settings.CompetitionForm == "MS-PROD") {
+        drawInteractions(NumSpecies,NumSpecies,true,strength/2.0,
+                         Truth.CarryingCapacity,Truth.CompetitionBetaSpecies);
+        drawInteractions(NumSpecies,NumGuilds,false,strength/2.0,
+                         guildK,Truth.CompetitionBetaGuilds);
+    } else if (isAggProd) {
+        drawInteractions(NumGuilds,NumGuilds,true,strength,
+                         guildK,Truth.CompetitionBetaGuildsGuilds);
+    }
+
+    // Prey i is eaten by predator j; nothing eats itself
+    if (Settings.PredationForm != "Null") {
+        drawInteractions(NumSpeciesOrGuilds,NumSpeciesOrGuilds,false,strength,
+                         Truth.CarryingCapacity,Truth.PredationRho);
+    }
+    if ((Settings.PredationForm == "Type II") || (Settings.PredationForm == "Type III")) {
+        nmfUtils::initialize(Truth.PredationHandling,NumSpeciesOrGuilds,NumSpeciesOrGuilds);
+        for (int i=0; i<NumSpeciesOrGuilds; ++i) {
+            for (int j=0; j<NumSpeciesOrGuilds; ++j) {
+                if (Truth.PredationRho(i,j) > 0) {
+                    Truth.PredationHandling(i,j) = Random.getUniform(0.5,1.0)/Truth.CarryingCapacity[i];
+                }
+            }
+        }
+    }
+    if (Settings.PredationForm == "Type III") {
+        // Scale rho back down by the extra power of the prey biomass
+        for (int i=0; i<NumSpeciesOrGuilds; ++i) {
+            double exponent = Random.getUniform(1.0,1.2);
+            Truth.PredationExponent.push_back(exponent);
+            for (int j=0; j<NumSpeciesOrGuilds; ++j) {
+                Truth.PredationRho(i,j) /= std::pow(Truth.CarryingCapacity[i],exponent-1.0);
+            }
+        }
+    }
+}
+
+bool
+nmfSyntheticSystemGenerator::simulate(nmfRandom& Random,
+                                      nmfSyntheticSystem& System)
+{
+    const nmfSyntheticSystemSettings& Settings = System.Settings;
+    const nmfSyntheticParameters& Truth = System.TrueParameters;
+    const bool isAggProd = (Settings.CompetitionForm == "AGG-PROD");
+    const int NumSpecies = Settings.NumSpecies;
+    const int NumGuilds  = Settings.NumGuilds;
+    const int NumSpeciesOrGuilds = (isAggProd) ? NumGuilds : NumSpecies;
+    const int RunLength  = Settings.RunLength;
+    const double errorFraction = Settings.ObservationErrorPct/100.0;
+    nmfStructsQt::ModelDataStruct& dataStruct = System.dataStruct;
+    boost::numeric::ublas::matrix<double>& Biomass      = System.TrueBiomassSpecies;
+    boost::numeric::ublas::matrix<double>& GuildBiomass = System.TrueBiomassGuilds;
+    std::vector<int> guildNum(NumSpeciesOrGuilds);
+    std::vector<double> guildK(NumSpeciesOrGuilds,0.0);
+    std::vector<double> guildShare(NumSpecies,0.0);
+    std::vector<double> guildShareTotal(NumGuilds,0.0);
+    double systemK = 0;
+    double biomass;
+    double value;
+    double observed;
+
+    nmfGrowthForm      growthForm(     Settings.GrowthForm);
+    nmfHarvestForm     harvestForm(    Settings.HarvestForm);
+    nmfCompetitionForm competitionForm(Settings.CompetitionForm);
+    nmfPredationForm   predationForm(  Settings.PredationForm);
+
+    // Each guild is its own species in AGG-PROD
+    for (int i=0; i<NumSpeciesOrGuilds; ++i) {
+        guildNum[i] = (isAggProd) ? i : Settings.GuildNum[i];
+        systemK += Truth.CarryingCapacity[i];
+    }
+    for (int i=0; i<NumSpeciesOrGuilds; ++i) {
+        for (int j=0; j<NumSpeciesOrGuilds; ++j) {
+            if (guildNum[j] == guildNum[i]) {
+                guildK[i] += Truth.CarryingCapacity[j];
+            }
+        }
+    }
+
+    nmfUtils::initialize(Biomass,               RunLength+1,NumSpeciesOrGuilds);
+    nmfUtils::initialize(GuildBiomass,          RunLength+1,NumGuilds);
+    nmfUtils::initialize(dataStruct.Catch,       RunLength+1,NumSpeciesOrGuilds);
+    nmfUtils::initialize(dataStruct.Effort,      RunLength+1,NumSpeciesOrGuilds);
+    nmfUtils::initialize(dataStruct.Exploitation,RunLength+1,NumSpeciesOrGuilds);
+
+    // Every harvest series describes the same fishing, so any harvest form fits the system
+    auto fish = [&](const int& Time) {
+        for (int i=0; i<NumSpeciesOrGuilds; ++i) {
+            double rate = (Settings.HarvestForm == "Null") ? 0.0 :
+                          Random.getUniform(Settings.HarvestRateMin,Settings.HarvestRateMax);
+            dataStruct.Catch(Time,i)        = rate*Biomass(Time,i);
+            dataStruct.Effort(Time,i)       = rate/Truth.Catchability[i];
+            dataStruct.Exploitation(Time,i) = rate;
+        }
+    };
+
+    for (int i=0; i<NumSpeciesOrGuilds; ++i) {
+        Biomass(0,i) = Truth.InitBiomass[i];
+        GuildBiomass(0,guildNum[i]) += Biomass(0,i);
+    }
+    fish(0);
+
+    for (int time=1; time<=RunLength; ++time) {
+        int timeMinus1 = time-1;
+        for (int i=0; i<NumSpeciesOrGuilds; ++i) {
+            biomass = Biomass(timeMinus1,i);
+            value   = biomass +
+                      growthForm.evaluate(i,biomass,Truth.GrowthRate,Truth.CarryingCapacity) -
+                      harvestForm.evaluate(timeMinus1,i,dataStruct.Catch,dataStruct.Effort,
+                                           dataStruct.Exploitation,biomass,Truth.Catchability) -
+                      competitionForm.evaluate(timeMinus1,i,biomass,systemK,Truth.GrowthRate,guildK[i],
+                                               Truth.CompetitionAlpha,Truth.CompetitionBetaSpecies,
+                                               Truth.CompetitionBetaGuilds,Truth.CompetitionBetaGuildsGuilds,
+                                               Biomass,GuildBiomass) -
+                      predationForm.evaluate(timeMinus1,i,Truth.PredationRho,Truth.PredationHandling,
+                                             Truth.PredationExponent,Biomass,biomass);
+            // Well-posed: no species collapses or explodes
+            if (! std::isfinite(value) ||
+                (value < 0.01*Truth.CarryingCapacity[i]) ||
+                (value > 10.0*Truth.CarryingCapacity[i])) {
+                return false;
+            }
+            Biomass(time,i) = value;
+        }
+        for (int i=0; i<NumSpeciesOrGuilds; ++i) {
+            GuildBiomass(time,guildNum[i]) += Biomass(time,i);
+        }
+        fish(time);
+    }
+
+    // Observe the biomass with error. In AGG-PROD the species' observations are
+    // fixed shares of their guild's.
+    nmfUtils::initialize(dataStruct.ObservedBiomassBySpecies,RunLength+1,NumSpecies);
+    nmfUtils::initialize(dataStruct.ObservedBiomassByGuilds, RunLength+1,NumGuilds);
+    if (isAggProd) {
+        for (int species=0; species<NumSpecies; ++species) {
+            guildShare[species] = Random.getUniform(0.5,1.5);
+            guildShareTotal[Settings.GuildNum[species]] += guildShare[species];
+        }
+    }
+    for (int time=0; time<=RunLength; ++time) {
+        for (int i=0; i<NumSpeciesOrGuilds; ++i) {
+            observed = Truth.SurveyQ[i]*Biomass(time,i)*(1.0 + Random.getUniform(-errorFraction,errorFraction));
+            if (isAggProd) {
+                dataStruct.ObservedBiomassByGuilds(time,i) = observed;
+            } else {
+                dataStruct.ObservedBiomassBySpecies(time,i)          = observed;
+                dataStruct.ObservedBiomassByGuilds(time,guildNum[i]) += observed;
+            }
+        }
+        if (isAggProd) {
+            for (int species=0; species<NumSpecies; ++species) {
+                int guild = Settings.GuildNum[species];
+                dataStruct.ObservedBiomassBySpecies(time,species) =
+                        dataStruct.ObservedBiomassByGuilds(time,guild)*guildShare[species]/guildShareTotal[guild];
+            }
+        }
+    }
+
+    return true;
+}
+
+void
+nmfSyntheticSystemGenerator::fillDataStruct(nmfSyntheticSystem& System)
+{
+    const nmfSyntheticSystemSettings& Settings = System.Settings;
+    const nmfSyntheticParameters& Truth = System.TrueParameters;
+    const bool isAggProd = (Settings.CompetitionForm == "AGG-PROD");
+    const bool isRho     = (Settings.PredationForm   != "Null");
+    const int NumSpeciesOrGuilds = (isAggProd) ? Settings.NumGuilds : Settings.NumSpecies;
+    const double minFactor = Settings.RangeMinFactor;
+    const double maxFactor = Settings.RangeMaxFactor;
+    nmfStructsQt::ModelDataStruct& dataStruct = System.dataStruct;
+    std::vector<std::pair<double,double> > parameterRanges;
+
+    // Keep the observations and harvest made by simulate() (or read by load())
+    nmfStructsQt::ModelDataStruct observations;
+    observations.ObservedBiomassBySpecies.swap(dataStruct.ObservedBiomassBySpecies);
+    observations.ObservedBiomassByGuilds.swap( dataStruct.ObservedBiomassByGuilds);
+    observations.Catch.swap(       dataStruct.Catch);
+    observations.Effort.swap(      dataStruct.Effort);
+    observations.Exploitation.swap(dataStruct.Exploitation);
+    dataStruct = observations;
+
+    dataStruct.isMohnsRho            = false;
+    dataStruct.showDiagnosticChart   = false;
+    dataStruct.useFixedSeed          = true;
+    dataStruct.NumSpecies            = Settings.NumSpecies;
+    dataStruct.NumGuilds             = Settings.NumGuilds;
+    dataStruct.RunLength             = Settings.RunLength;
+    dataStruct.GrowthForm            = Settings.GrowthForm;
+    dataStruct.HarvestForm           = Settings.HarvestForm;
+    dataStruct.CompetitionForm       = Settings.CompetitionForm;
+    dataStruct.PredationForm         = Settings.PredationForm;
+    dataStruct.ObjectiveCriterion    = Settings.ObjectiveCriterion;
+    dataStruct.ScalingAlgorithm      = Settings.ScalingAlgorithm;
+    dataStruct.EstimationAlgorithm   = "NLopt Algorithm";
+    dataStruct.MinimizerAlgorithm    = "GN_ORIG_DIRECT_L";
+    dataStruct.NLoptNumberOfRuns     = 1;
+    dataStruct.NLoptUseStopVal       = false;
+    dataStruct.NLoptUseStopAfterTime = false;
+    dataStruct.NLoptUseStopAfterIter = true;
+    dataStruct.NLoptStopVal          = 0;
+    dataStruct.NLoptStopAfterTime    = 0;
+    dataStruct.NLoptStopAfterIter    = 10000;
+    dataStruct.BeesNumTotal          = 40;
+    dataStruct.BeesNumElite          = 5;
+    dataStruct.BeesNumOther          = 2;
+    dataStruct.BeesNumEliteSites     = 3;
+    dataStruct.BeesNumBestSites      = 5;
+    dataStruct.BeesNumRepetitions    = 1;
+    dataStruct.BeesMaxGenerations    = 100;
+    dataStruct.BeesNeighborhoodSize  = 4;
+    dataStruct.GAGenerations         = 0;
+    dataStruct.GAConvergence         = 0;
+    dataStruct.Benchmark = ((Settings.CompetitionForm == "NO_K") || isRho) ?
+                           "LogisticMultiSpecies" : Settings.GrowthForm;
+
+    for (const std::string& name : nmfConstantsMSSPM::EstimateCheckboxNames) {
+        nmfStructsQt::EstimateRunBox runBox;
+        runBox.parameter = name;
+        runBox.state     = std::make_pair(true,true);
+        dataStruct.EstimateRunBoxes.push_back(runBox);
+    }
+
+    // Like nmfCoreModelLoader, AGG-PROD models treat each guild as a species
+    for (int i=0; i<NumSpeciesOrGuilds; ++i) {
+        int guild = (isAggProd) ? i : Settings.GuildNum[i];
+        dataStruct.GuildNum.push_back(guild);
+        dataStruct.GuildSpecies[guild].push_back(i);
+    }
+
+    dataStruct.InitBiomass         = Truth.InitBiomass;
+    dataStruct.InitBiomassMin      = scaleVector(Truth.InitBiomass,     minFactor);
+    dataStruct.InitBiomassMax      = scaleVector(Truth.InitBiomass,     maxFactor);
+    dataStruct.GrowthRate          = Truth.GrowthRate;
+    dataStruct.GrowthRateMin       = scaleVector(Truth.GrowthRate,      minFactor);
+    dataStruct.GrowthRateMax       = scaleVector(Truth.GrowthRate,      maxFactor);
+    dataStruct.CarryingCapacity    = Truth.CarryingCapacity;
+    dataStruct.CarryingCapacityMin = scaleVector(Truth.CarryingCapacity,minFactor);
+    dataStruct.CarryingCapacityMax = scaleVector(Truth.CarryingCapacity,maxFactor);
+    dataStruct.Catchability        = Truth.Catchability;
+    dataStruct.CatchabilityMin     = scaleVector(Truth.Catchability,    minFactor);
+    dataStruct.CatchabilityMax     = scaleVector(Truth.Catchability,    maxFactor);
+    // SurveyQ is only estimated for relative biomass
+    dataStruct.SurveyQ             = Truth.SurveyQ;
+    dataStruct.SurveyQMin          = scaleVector(Truth.SurveyQ,(Settings.isRelativeBiomass) ? minFactor : 1.0);
+    dataStruct.SurveyQMax          = scaleVector(Truth.SurveyQ,(Settings.isRelativeBiomass) ? maxFactor : 1.0);
+
+    // Pairs that don't interact get a range of [0,0], so they aren't estimated
+    dataStruct.CompetitionMin                 = scaleRows(Truth.CompetitionAlpha,           minFactor);
+    dataStruct.CompetitionMax                 = scaleRows(Truth.CompetitionAlpha,           maxFactor);
+    dataStruct.CompetitionBetaSpeciesMin      = scaleRows(Truth.CompetitionBetaSpecies,     minFactor);
+    dataStruct.CompetitionBetaSpeciesMax      = scaleRows(Truth.CompetitionBetaSpecies,     maxFactor);
+    dataStruct.CompetitionBetaGuildsMin       = scaleRows(Truth.CompetitionBetaGuilds,      minFactor);
+    dataStruct.CompetitionBetaGuildsMax       = scaleRows(Truth.CompetitionBetaGuilds,      maxFactor);
+    dataStruct.CompetitionBetaGuildsGuildsMin = scaleRows(Truth.CompetitionBetaGuildsGuilds,minFactor);
+    dataStruct.CompetitionBetaGuildsGuildsMax = scaleRows(Truth.CompetitionBetaGuildsGuilds,maxFactor);
+    dataStruct.PredationRhoMin                = scaleRows(Truth.PredationRho,               minFactor);
+    dataStruct.PredationRhoMax                = scaleRows(Truth.PredationRho,               maxFactor);
+    dataStruct.PredationHandlingMin           = scaleRows(Truth.PredationHandling,          minFactor);
+    dataStruct.PredationHandlingMax           = scaleRows(Truth.PredationHandling,          maxFactor);
+    dataStruct.PredationExponentMin           = scaleVector(Truth.PredationExponent,        minFactor);
+    dataStruct.PredationExponentMax           = scaleVector(Truth.PredationExponent,        maxFactor);
+
+    // Count the parameters that are actually estimated (i.e., have an open range)
+    NLopt_Estimator::loadParameterRanges(parameterRanges,dataStruct);
+    dataStruct.TotalNumberParameters = 0;
+    for (const std::pair<double,double>& range : parameterRanges) {
+        if (range.first < range.second) {
+            ++dataStruct.TotalNumberParameters;
+        }
+    }
+}
+
+bool
+nmfSyntheticSystemGenerator::save(const nmfSyntheticSystem& System,
+                                  const std::string& Filename,
+                                  std::string& ErrorMsg)
+{
+    const nmfSyntheticSystemSettings& Settings = System.Settings;
+    const nmfSyntheticParameters& Truth = System.TrueParameters;
+    QFile file(QString::fromStdString(Filename));
+
+    ErrorMsg.clear();
+    if (! file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        ErrorMsg = "nmfSyntheticSystemGenerator: Couldn't open for writing: " + Filename;
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_15);
+    stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+
+    stream << FileMagic << FileVersion;
+    stream << qint32(Settings.NumSpecies) << qint32(Settings.NumGuilds)
+           << qint32(Settings.RunLength)  << qint32(Settings.StartYear);
+    writeString(stream,Settings.GrowthForm);
+    writeString(stream,Settings.HarvestForm);
+    writeString(stream,Settings.CompetitionForm);
+    writeString(stream,Settings.PredationForm);
+    writeString(stream,Settings.ObjectiveCriterion);
+    writeString(stream,Settings.ScalingAlgorithm);
+    writeString(stream,Settings.GuildStructure);
+    stream << quint32(Settings.GuildNum.size());
+    for (int guild : Settings.GuildNum) {
+        stream << qint32(guild);
+    }
+    stream << Settings.Connectance << Settings.InteractionStrength
+           << Settings.HarvestRateMin << Settings.HarvestRateMax
+           << Settings.ObservationErrorPct << Settings.isRelativeBiomass
+           << Settings.RangeMinFactor << Settings.RangeMaxFactor
+           << quint64(Settings.Seed);
+    for (const std::string& name : System.SpeciesNames) {
+        writeString(stream,name);
+    }
+    for (const std::string& name : System.GuildNames) {
+        writeString(stream,name);
+    }
+
+    writeVector(stream,Truth.InitBiomass);
+    writeVector(stream,Truth.GrowthRate);
+    writeVector(stream,Truth.CarryingCapacity);
+    writeVector(stream,Truth.Catchability);
+    writeVector(stream,Truth.SurveyQ);
+    writeVector(stream,Truth.PredationExponent);
+    writeMatrix(stream,Truth.CompetitionAlpha);
+    writeMatrix(stream,Truth.CompetitionBetaSpecies);
+    writeMatrix(stream,Truth.CompetitionBetaGuilds);
+    writeMatrix(stream,Truth.CompetitionBetaGuildsGuilds);
+    writeMatrix(stream,Truth.PredationRho);
+    writeMatrix(stream,Truth.PredationHandling);
+
+    writeMatrix(stream,System.TrueBiomassSpecies);
+    writeMatrix(stream,System.TrueBiomassGuilds);
+    writeMatrix(stream,System.dataStruct.ObservedBiomassBySpecies);
+    writeMatrix(stream,System.dataStruct.ObservedBiomassByGuilds);
+    writeMatrix(stream,System.dataStruct.Catch);
+    writeMatrix(stream,System.dataStruct.Effort);
+    writeMatrix(stream,System.dataStruct.Exploitation);
+
+    if (stream.status() != QDataStream::Ok) {
+        ErrorMsg = "nmfSyntheticSystemGenerator: Couldn't write: " + Filename;
+        return false;
+    }
+    file.close();
+
+    return true;
+}
+
+bool
+nmfSyntheticSystemGenerator::load(const std::string& Filename,
+                                  nmfSyntheticSystem& System,
+                                  std::string& ErrorMsg)
+{
+    quint32 magic   = 0;
+    quint32 version = 0;
+    quint32 numGuildNums = 0;
+    qint32  numSpecies;
+    qint32  numGuilds;
+    qint32  runLength;
+    qint32  startYear;
+    qint32  guild;
+    quint64 seed;
+    std::string name;
+    QFile file(QString::fromStdString(Filename));
+
+    ErrorMsg.clear();
+    if (! file.open(QIODevice::ReadOnly)) {
+        ErrorMsg = "nmfSyntheticSystemGenerator: Couldn't open for reading: " + Filename;
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_15);
+    stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+
+    stream >> magic >> version;
+    if ((magic != FileMagic) || (version != FileVersion)) {
+        ErrorMsg = "nmfSyntheticSystemGenerator: Not a synthetic system file (or from another version): " + Filename;
+        return false;
+    }
+
+    System = nmfSyntheticSystem();
+    nmfSyntheticSystemSettings& Settings = System.Settings;
+    nmfSyntheticParameters& Truth = System.TrueParameters;
+
+    stream >> numSpecies >> numGuilds >> runLength >> startYear;
+    Settings.NumSpecies = numSpecies;
+    Settings.NumGuilds  = numGuilds;
+    Settings.RunLength  = runLength;
+    Settings.StartYear  = startYear;
+    readString(stream,Settings.GrowthForm);
+    readString(stream,Settings.HarvestForm);
+    readString(stream,Settings.CompetitionForm);
+    readString(stream,Settings.PredationForm);
+    readString(stream,Settings.ObjectiveCriterion);
+    readString(stream,Settings.ScalingAlgorithm);
+    readString(stream,Settings.GuildStructure);
+    stream >> numGuildNums;
+    Settings.GuildNum.clear();
+    for (quint32 i=0; (i<numGuildNums) && (stream.status() == QDataStream::Ok); ++i) {
+        stream >> guild;
+        Settings.GuildNum.push_back(guild);
+    }
+    stream >> Settings.Connectance >> Settings.InteractionStrength
+           >> Settings.HarvestRateMin >> Settings.HarvestRateMax
+           >> Settings.ObservationErrorPct >> Settings.isRelativeBiomass
+           >> Settings.RangeMinFactor >> Settings.RangeMaxFactor
+           >> seed;
+    Settings.Seed = seed;
+    for (int i=0; (i<Settings.NumSpecies) && (stream.status() == QDataStream::Ok); ++i) {
+        readString(stream,name);
+        System.SpeciesNames.push_back(name);
+    }
+    for (int i=0; (i<Settings.NumGuilds) && (stream.status() == QDataStream::Ok); ++i) {
+        readString(stream,name);
+        System.GuildNames.push_back(name);
+    }
+
+    readVector(stream,Truth.InitBiomass);
+    readVector(stream,Truth.GrowthRate);
+    readVector(stream,Truth.CarryingCapacity);
+    readVector(stream,Truth.Catchability);
+    readVector(stream,Truth.SurveyQ);
+    readVector(stream,Truth.PredationExponent);
+    readMatrix(stream,Truth.CompetitionAlpha);
+    readMatrix(stream,Truth.CompetitionBetaSpecies);
+    readMatrix(stream,Truth.CompetitionBetaGuilds);
+    readMatrix(stream,Truth.CompetitionBetaGuildsGuilds);
+    readMatrix(stream,Truth.PredationRho);
+    readMatrix(stream,Truth.PredationHandling);
+
+    readMatrix(stream,System.TrueBiomassSpecies);
+    readMatrix(stream,System.TrueBiomassGuilds);
+    readMatrix(stream,System.dataStruct.ObservedBiomassBySpecies);
+    readMatrix(stream,System.dataStruct.ObservedBiomassByGuilds);
+    readMatrix(stream,System.dataStruct.Catch);
+    readMatrix(stream,System.dataStruct.Effort);
+    readMatrix(stream,System.dataStruct.Exploitation);
+
+    if ((stream.status() != QDataStream::Ok) ||
+        (int(Settings.GuildNum.size()) != Settings.NumSpecies) ||
+        (int(System.dataStruct.ObservedBiomassBySpecies.size1()) != Settings.RunLength+1)) {
+        ErrorMsg = "nmfSyntheticSystemGenerator: Found a truncated or corrupt file: " + Filename;
+        return false;
+    }
+
+    fillDataStruct(System);
+
+    return true;
+}
@@ -0,0 +1,203 @@
+/**
+ * @file nmfSyntheticSystemGenerator.h
+ * @brief Definition for the database-free synthetic system generator
+ *
+ * This file contains the definition for nmfSyntheticSystemGenerator. Unlike
+ * nmfSimulatedData, which simulates the system stored in the project
+ * database, the generator draws random multispecies systems of any size,
+ * form combination and guild structure. It simulates them with the model
+ * form classes, observes them with noise and returns the true parameters,
+ * the observations and a ModelDataStruct that's ready to be estimated. The
+ * same settings and seed always give the same system, and a system may be
+ * saved to and loaded from a compact binary file.
+ *
+ * @copyright
+ * Public Domain Notice\n
+ *
+ * National Oceanic And Atmospheric Administration\n\n
+ *
+ * This software is a "United States Government Work" under the terms of the
+ * United States Copyright Act.  It was written as part of the author's official
+ * duties as a United States Government employee/contractor and thus cannot be copyrighted.
+ * This software is freely available to the public for use. The National Oceanic
+ * And Atmospheric Administration and the U.S. Government have not placed any
+ * restriction on its use or reproduction.  Although all reasonable efforts have
+ * been taken to ensure the accuracy and reliability of the software and data,
+ * the National Oceanic And Atmospheric Administration and the U.S. Government
+ * do not and cannot warrant the performance or results that may be obtained
+ * by using this software or data. The National Oceanic And Atmospheric
+ * Administration and the U.S. Government disclaim all warranties, express
+ * or implied, including warranties of performance, merchantability or fitness
+ * for any particular purpose.\n\n
+ *
+ * Please cite the author(s) in any work or product based on this material.
+ */
+
+#pragma once
+
+#include "nmfRandom.h"
+#include "nmfStructsQt.h"
+
+#include <boost/numeric/ublas/matrix.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief What kind of system to generate
+ */
+struct nmfSyntheticSystemSettings {
+    int NumSpecies;
+    int NumGuilds;
+    int RunLength;
+    int StartYear;
+    std::string GrowthForm;
+    std::string HarvestForm;
+    std::string CompetitionForm;
+    std::string PredationForm;
+    std::string ObjectiveCriterion;
+    std::string ScalingAlgorithm;
+    /**
+     * @brief "Even" for guilds of contiguous species of about the same size, or "Random".
+     * Either way every guild gets at least one species.
+     */
+    std::string GuildStructure;
+    /**
+     * @brief Guild of each species; overrides GuildStructure if not empty. A generated
+     * system's settings always hold the guilds it was given.
+     */
+    std::vector<int> GuildNum;
+    /**
+     * @brief Fraction of the possible species pairs that interact (competition and predation)
+     */
+    double Connectance;
+    /**
+     * @brief Fraction of its growth at carrying capacity that a species loses to all of its
+     * interactions together (at most)
+     */
+    double InteractionStrength;
+    /**
+     * @brief Each year's fraction of a species that's fished is drawn from this range
+     */
+    double HarvestRateMin;
+    double HarvestRateMax;
+    /**
+     * @brief Observation error, in percent, applied to the observed biomass
+     */
+    double ObservationErrorPct;
+    /**
+     * @brief Observe the biomass relative to a survey catchability (estimate SurveyQ) instead of absolutely
+     */
+    bool isRelativeBiomass;
+    /**
+     * @brief The parameter ranges are the true values times these factors
+     */
+    double RangeMinFactor;
+    double RangeMaxFactor;
+    std::uint64_t Seed;
+
+    nmfSyntheticSystemSettings() :
+        NumSpecies(10), NumGuilds(2), RunLength(30), StartYear(1990),
+        GrowthForm("Logistic"), HarvestForm("Catch"),
+        CompetitionForm("Null"), PredationForm("Null"),
+        ObjectiveCriterion("Least Squares"), ScalingAlgorithm("Min Max"),
+        GuildStructure("Even"), Connectance(1.0), InteractionStrength(0.1),
+        HarvestRateMin(0.05), HarvestRateMax(0.15), ObservationErrorPct(10.0),
+        isRelativeBiomass(false), RangeMinFactor(0.5), RangeMaxFactor(1.5),
+        Seed(1) {}
+};
+
+/**
+ * @brief The true parameters of a synthetic system, by species (or by guild if running AGG-PROD)
+ */
+struct nmfSyntheticParameters {
+    std::vector<double> InitBiomass;
+    std::vector<double> GrowthRate;
+    std::vector<double> CarryingCapacity;
+    std::vector<double> Catchability;
+    std::vector<double> SurveyQ;
+    std::vector<double> PredationExponent;
+    boost::numeric::ublas::matrix<double> CompetitionAlpha;
+    boost::numeric::ublas::matrix<double> CompetitionBetaSpecies;
+    boost::numeric::ublas::matrix<double> CompetitionBetaGuilds;
+    boost::numeric::ublas::matrix<double> CompetitionBetaGuildsGuilds;
+    boost::numeric::ublas::matrix<double> PredationRho;
+    boost::numeric::ublas::matrix<double> PredationHandling;
+};
+
+/**
+ * @brief A generated system: its truth, its observations and the model to estimate it with
+ */
+struct nmfSyntheticSystem {
+    nmfSyntheticSystemSettings Settings;
+    std::vector<std::string>   SpeciesNames;
+    std::vector<std::string>   GuildNames;
+    nmfSyntheticParameters     TrueParameters;
+    /**
+     * @brief Simulated biomass without observation error (RunLength+1 years)
+     */
+    boost::numeric::ublas::matrix<double> TrueBiomassSpecies;
+    boost::numeric::ublas::matrix<double> TrueBiomassGuilds;
+    /**
+     * @brief The model, with the observations, harvest and parameter ranges filled in
+     * the way nmfCoreModelLoader fills them from a project database. The catch, effort
+     * and exploitation are by species (or by guild if running AGG-PROD).
+     */
+    nmfStructsQt::ModelDataStruct dataStruct;
+};
+
+/**
+ * @brief Generates random but well-posed multispecies systems without a database
+ */
+class nmfSyntheticSystemGenerator
+{
+    static bool assignGuilds(const nmfSyntheticSystemSettings& Settings,
+                             nmfRandom& Random,
+                             std::vector<int>& GuildNum,
+                             std::string& ErrorMsg);
+    static void drawParameters(nmfRandom& Random,
+                               nmfSyntheticSystem& System);
+    static bool simulate(nmfRandom& Random,
+                         nmfSyntheticSystem& System);
+    static void fillDataStruct(nmfSyntheticSystem& System);
+
+public:
+    /**
+     * @brief Number of times a system is redrawn when its biomass collapses or explodes
+     */
+    static const int MaxAttempts = 20;
+
+    /**
+     * @brief Generates a system. The biomass of every species stays above 1% and
+     * below 10 times its carrying capacity; systems that don't are redrawn.
+     * @param Settings : what kind of system to generate
+     * @param System : the generated system
+     * @param ErrorMsg : why the system couldn't be generated
+     * @return Returns false if the settings are invalid or no well-posed system was found
+     */
+    static bool generate(const nmfSyntheticSystemSettings& Settings,
+                         nmfSyntheticSystem& System,
+                         std::string& ErrorMsg);
+    /**
+     * @brief Saves a system to a compact binary file
+     * @param System : the system to save
+     * @param Filename : name of the file
+     * @param ErrorMsg : why the file couldn't be written
+     * @return Returns false if the file couldn't be written
+     */
+    static bool save(const nmfSyntheticSystem& System,
+                     const std::string& Filename,
+                     std::string& ErrorMsg);
+    /**
+     * @brief Loads a system saved by save(). The data struct is rebuilt from the saved
+     * truth and observations, so it doesn't depend on the generator's random numbers.
+     * @param Filename : name of the file
+     * @param System : the loaded system
+     * @param ErrorMsg : why the file couldn't be read
+     * @return Returns false if the file couldn't be read or isn't a saved system
+     */
+    static bool load(const std::string& Filename,
+                     nmfSyntheticSystem& System,
+                     std::string& ErrorMsg);
+};